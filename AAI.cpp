@@ -10,6 +10,7 @@
 #include <math.h>
 #include <stdarg.h>
 #include <time.h>
+#include <chrono>
 
 #include "AAI.h"
 #include "AAIMap.h"
@@ -19,6 +20,12 @@
 #include "AAIExecute.h"
 #include "AAIUnitTable.h"
 #include "AAIBuildTask.h"
+#include "AAIBuildTaskRegistry.h"
+#include "AAITaskScheduler.h"
+#include "AAIEventRecorder.h"
+#include "AAIRecordingCallback.h"
+#include "AAILogger.h"
+#include "AAIProfiler.h"
 #include "AAIConstructor.h"
 #include "AAIAttackManager.h"
 #include "AIExport.h"
@@ -26,6 +33,7 @@
 #include "AAIGroup.h"
 #include "AAISector.h"
 #include "AAIUnitTypes.h"
+#include "AAIUnitDataCache.h"
 
 #include "System/SafeUtil.h"
 
@@ -35,7 +43,10 @@ using namespace springLegacyAI;
 
 
 #include "CUtils/SimpleProfiler.h"
-#define AAI_SCOPED_TIMER(part) SCOPED_TIMER(part, profiler);
+#define AAI_SCOPED_TIMER(part) SCOPED_TIMER(part, profiler); \
+	static const int profilerSectionId = AAIProfiler::GetSectionId(part); \
+	AAIProfiler::ScopedSection profilerSection(m_profiler, profilerSectionId);
+#define AAI_RECORD_EVENT(...) AAIEventRecorder::EventScope eventScope(m_eventRecorder, __VA_ARGS__);
 
 AAIBuildTree AAI::s_buildTree;
 
@@ -43,8 +54,10 @@ int AAI::s_aaiInstances = 0;
 
 AAI::AAI(int skirmishAIId, const struct SSkirmishAICallback* callback) :
 	m_aiCallback(nullptr),
+	m_unitDataCache(nullptr),
 	m_skirmishAIId(skirmishAIId),
 	m_skirmishAICallbacks(callback),
+	m_buildTasks(nullptr),
 	m_map(nullptr),
 	m_brain(nullptr),
 	m_execute(nullptr),
@@ -52,24 +65,69 @@ AAI::AAI(int skirmishAIId, const struct SSkirmishAICallback* callback) :
 	m_buildTable(nullptr),
 	m_airForceManager(nullptr),
 	m_attackManager(nullptr),
+	m_scheduler(nullptr),
+	m_eventRecorder(nullptr),
+	m_recordingCallback(nullptr),
 	profiler(nullptr),
+	m_profiler(nullptr),
 	m_side(0),
-	m_logFile(nullptr),
+	m_logger(nullptr),
 	m_initialized(false),
 	m_configLoaded(false),
 	m_aaiInstance(0),
 	m_gamePhase(0)
 {
-	// initialize random numbers generator
-	srand (time(nullptr));
 }
 
 AAI::~AAI()
 {
 	--s_aaiInstances;
-	if (m_initialized == false)
-		return;
 
+	if(m_initialized)
+	{
+		SaveGameData();
+
+		spring::SafeDelete(m_scheduler);
+		spring::SafeDelete(m_attackManager);
+		spring::SafeDelete(m_airForceManager);
+
+		// delete unit groups
+		for(auto groupList = m_unitGroupsOfCategoryLists.begin(); groupList != m_unitGroupsOfCategoryLists.end(); ++groupList)
+		{
+			for(std::list<AAIGroup*>::iterator group = groupList->begin(); group != groupList->end(); ++group)
+				delete (*group);
+			
+			groupList->clear();
+		}
+
+		spring::SafeDelete(m_brain);
+		spring::SafeDelete(m_execute);
+		spring::SafeDelete(m_unitTable);
+		spring::SafeDelete(m_map);
+		spring::SafeDelete(m_buildTable);
+	}
+
+	// objects created by InitAI() in any case (i.e. also if initialization failed): the thread of the logger must be stopped
+	// and the recorded events must be flushed
+	spring::SafeDelete(m_buildTasks);
+	spring::SafeDelete(m_unitDataCache);
+	spring::SafeDelete(m_recordingCallback);
+	spring::SafeDelete(m_eventRecorder);
+	spring::SafeDelete(profiler);
+	spring::SafeDelete(m_profiler);
+
+	m_initialized = false;
+	spring::SafeDelete(m_logger);
+
+	// last instance of AAI shall clean up config
+	if(s_aaiInstances == 0)
+	{
+		AAIConfig::Delete();
+	}
+}
+
+void AAI::SaveGameData()
+{
 	// save several AI data
 	Log("\nShutting down....\n\n");
 
@@ -120,45 +178,39 @@ AAI::~AAI()
 		Log("\n");
 	}
 
-	// delete buildtasks
-	for(std::list<AAIBuildTask*>::iterator task = build_tasks.begin(); task != build_tasks.end(); ++task)
+	Log("\nUnit data requests / engine calls / saved engine calls:\n");
+	for(int request = 0; request < static_cast<int>(EUnitDataRequest::NUMBER_OF_REQUEST_TYPES); ++request)
 	{
-		delete (*task);
+		const EUnitDataRequest requestType = static_cast<EUnitDataRequest>(request);
+		const uint64_t requests    = m_unitDataCache->GetNumberOfRequests(requestType);
+		const uint64_t engineCalls = m_unitDataCache->GetNumberOfEngineCalls(requestType);
+
+		Log("%-10s: %llu / %llu / %llu\n", AAIUnitDataCache::GetRequestName(requestType), static_cast<unsigned long long>(requests),
+							static_cast<unsigned long long>(engineCalls), static_cast<unsigned long long>(requests - engineCalls));
 	}
-	build_tasks.clear();
 
-	// save game learning data
-	if(GetAAIInstance() == 1)
-		m_buildTable->SaveModLearnData(gamePhase, m_brain->GetAttackedByRates(), m_map->GetMapType());
+	m_scheduler->LogStatistics(this);
 
-	spring::SafeDelete(m_attackManager);
-	spring::SafeDelete(m_airForceManager);
+	if(m_eventRecorder)
+		m_eventRecorder->LogStatistics(this);
 
-	// delete unit groups
-	for(auto groupList = m_unitGroupsOfCategoryLists.begin(); groupList != m_unitGroupsOfCategoryLists.end(); ++groupList)
-	{
-		for(std::list<AAIGroup*>::iterator group = groupList->begin(); group != groupList->end(); ++group)
-			delete (*group);
-		
-		groupList->clear();
-	}
+	// export profiling data
+	char profileFilename[2048];
+	SNPRINTF(profileFilename, 2048, "%sAAI_profile_team_%d.csv", AILOG_PATH, m_myTeamId);
+	m_aiCallback->GetValue(AIVAL_LOCATE_FILE_W, profileFilename);
 
-	spring::SafeDelete(m_brain);
-	spring::SafeDelete(m_execute);
-	spring::SafeDelete(m_unitTable);
-	spring::SafeDelete(m_map);
-	spring::SafeDelete(m_buildTable);
-	spring::SafeDelete(profiler);
+	if(m_profiler->ExportCSV(profileFilename) == false)
+		Log(ELogLevel::FAILURE, ELogCategory::GENERAL, "Could not write profiling data to %s\n", profileFilename);
 
-	m_initialized = false;
-	fclose(m_logFile);
-	m_logFile = nullptr;
+	SNPRINTF(profileFilename, 2048, "%sAAI_profile_team_%d.json", AILOG_PATH, m_myTeamId);
+	m_aiCallback->GetValue(AIVAL_LOCATE_FILE_W, profileFilename);
 
-	// last instance of AAI shall clean up config
-	if(s_aaiInstances == 0)
-	{
-		AAIConfig::Delete();
-	}
+	if(m_profiler->ExportJSON(profileFilename) == false)
+		Log(ELogLevel::FAILURE, ELogCategory::GENERAL, "Could not write profiling data to %s\n", profileFilename);
+
+	// save game learning data
+	if(GetAAIInstance() == 1)
+		m_buildTable->SaveModLearnData(gamePhase, m_brain->GetAttackedByRates(), m_map->GetMapType());
 }
 
 //void AAI::EnemyDamaged(int damaged,int attacker,float damage,float3 dir) {}
@@ -168,9 +220,11 @@ void AAI::InitAI(IGlobalAICallback* callback, int team)
 	char profilerName[16];
 	SNPRINTF(profilerName, sizeof(profilerName), "%s:%i", "AAI", team);
 	profiler = new Profiler(profilerName);
+	m_profiler = new AAIProfiler();
 
 	AAI_SCOPED_TIMER("InitAI")
 	m_aiCallback = callback->GetAICallback();
+	m_buildTasks = new AAIBuildTaskRegistry(m_aiCallback->GetMaxUnits());
 
 	m_myTeamId = m_aiCallback->GetMyTeam();
 
@@ -181,7 +235,8 @@ void AAI::InitAI(IGlobalAICallback* callback, int team)
 
 	m_aiCallback->GetValue(AIVAL_LOCATE_FILE_W, filename);
 
-	m_logFile = fopen(filename,"w");
+	m_logger = new AAILogger();
+	m_logger->Open(filename);
 
 	Log("AAI %s running game %s\n \n", AAI_VERSION, m_aiCallback->GetModHumanName());
 
@@ -198,6 +253,42 @@ void AAI::InitAI(IGlobalAICallback* callback, int team)
 
 	m_configLoaded = gameConfigLoaded && generalConfigLoaded;
 
+	m_logger->SetMinLevel(static_cast<ELogLevel>(cfg->LOG_LEVEL));
+	m_profiler->SetSpikeThreshold(cfg->PROFILER_SPIKE_THRESHOLD);
+
+	// initialize random numbers generator (different seed for every game unless set in general config)
+	int randomSeed = cfg->RANDOM_SEED;
+
+	if(randomSeed == 0)
+	{
+		const uint64_t time = static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+		randomSeed = std::max(static_cast<int>((time ^ (time >> 31)) & 0x7FFFFFFFu), 1);
+	}
+
+	m_random.Seed( static_cast<uint64_t>(randomSeed) ^ (static_cast<uint64_t>(team) * 0x9E3779B97F4A7C15ull) );
+	Log("Random seed: %i (set RANDOM_SEED in general config to repeat)\n", randomSeed);
+
+	// start recording of events (if activated) - all queries to the engine are passed through the recording callback from now on
+	if(m_configLoaded && cfg->RECORD_EVENTS)
+	{
+		m_eventRecorder = new AAIEventRecorder();
+
+		char eventFilename[2048];
+		SNPRINTF(eventFilename, 2048, "%sAAI_events_team_%d.bin", AILOG_PATH, team);
+		m_aiCallback->GetValue(AIVAL_LOCATE_FILE_W, eventFilename);
+
+		if(m_eventRecorder->Open(eventFilename, m_skirmishAIId, randomSeed, m_aiCallback))
+		{
+			m_recordingCallback = new AAIRecordingCallback(m_aiCallback, m_skirmishAIId, m_skirmishAICallbacks, m_eventRecorder);
+			m_aiCallback = m_recordingCallback;
+		}
+		else
+			Log(ELogLevel::FAILURE, ELogCategory::GENERAL, "Could not open file %s to record events\n", eventFilename);
+	}
+
+	// the cache keeps the callback -> must be created after recording callback has been set up
+	m_unitDataCache = new AAIUnitDataCache(m_aiCallback);
+
 	if (m_configLoaded == false)
 	{
 		std::string errorMsg =
@@ -245,6 +336,10 @@ void AAI::InitAI(IGlobalAICallback* callback, int team)
 	// init attack manager
 	m_attackManager = new AAIAttackManager(this);
 
+	// init scheduler for periodic tasks (phases shifted depending on AI id to avoid several instances executing tasks in the same frame)
+	m_scheduler = new AAITaskScheduler(m_profiler, cfg->FRAME_TIME_BUDGET, 7 * m_skirmishAIId);
+	AddScheduledTasks();
+
 	Log("Tidal/Wind strength: %f / %f\n", m_aiCallback->GetTidalStrength(), (m_aiCallback->GetMaxWind() + m_aiCallback->GetMinWind()) * 0.5f);
 
 	LogConsole("AAI loaded");
@@ -253,8 +348,12 @@ void AAI::InitAI(IGlobalAICallback* callback, int team)
 void AAI::UnitDamaged(int damaged, int attacker, float /*damage*/, float3 /*dir*/)
 {
 	AAI_SCOPED_TIMER("UnitDamaged")
+	AAI_RECORD_EVENT(ERecordedEvent::UNIT_DAMAGED, damaged, attacker)
+
+	// health of damaged unit has changed within the current frame
+	m_unitDataCache->InvalidateUnit(UnitId(damaged));
 
-	const springLegacyAI::UnitDef* attackedDef = m_aiCallback->GetUnitDef(damaged);
+	const springLegacyAI::UnitDef* attackedDef = m_unitDataCache->GetUnitDef(UnitId(damaged));
 	if(attackedDef == nullptr)
 		return;
 		
@@ -264,7 +363,7 @@ void AAI::UnitDamaged(int damaged, int attacker, float /*damage*/, float3 /*dir*
 	if(category.IsCommander())
 		m_brain->DefendCommander(attacker);
 
-	const springLegacyAI::UnitDef* attackerDef = m_aiCallback->GetUnitDef(attacker);
+	const springLegacyAI::UnitDef* attackerDef = m_unitDataCache->GetUnitDef(UnitId(attacker));
 
 	if(attackerDef == nullptr)
 	{
@@ -293,7 +392,7 @@ void AAI::UnitDamaged(int damaged, int attacker, float /*damage*/, float3 /*dir*
 			m_execute->CheckKeepDistanceToEnemy(unit, unitDefId, enemyDefId);
 
 		const AAITargetType&  enemyTargetType = s_buildTree.GetTargetType(enemyDefId);
-		const float3          pos = m_aiCallback->GetUnitPos(attacker);
+		const float3          pos = m_unitDataCache->GetUnitPos(UnitId(attacker));
 		
 		// building has been attacked
 		if (category.IsBuilding() )
@@ -321,11 +420,14 @@ void AAI::UnitDamaged(int damaged, int attacker, float /*damage*/, float3 /*dir*
 void AAI::UnitCreated(int unit, int builder)
 {
 	AAI_SCOPED_TIMER("UnitCreated")
+	AAI_RECORD_EVENT(ERecordedEvent::UNIT_CREATED, unit, builder)
 	if (m_configLoaded == false)
 		return;
 
 	// get unit's id
-	const springLegacyAI::UnitDef* def = m_aiCallback->GetUnitDef(unit);
+	m_unitDataCache->InvalidateUnit(UnitId(unit));
+
+	const springLegacyAI::UnitDef* def = m_unitDataCache->GetUnitDef(UnitId(unit));
 	const UnitDefId unitDefId(def->id);
 	
 	m_unitTable->AddUnit(unit, unitDefId.id);
@@ -341,7 +443,7 @@ void AAI::UnitCreated(int unit, int builder)
 		m_unitTable->ConstructionStarted(category);
 
 		if(category.IsCommander() == false)
-			Log("Error: Starting unit is not in unit category \"commander\"!\n");
+			Log(ELogLevel::FAILURE, ELogCategory::GENERAL, "Starting unit is not in unit category \"commander\"!\n");
 
 		m_execute->InitAI(UnitId(unit), unitDefId);
 
@@ -368,7 +470,7 @@ void AAI::UnitCreated(int unit, int builder)
 
 		if (s_buildTree.GetMovementType(unitDefId).IsStatic())
 		{
-			const float3 position = m_aiCallback->GetUnitPos(unit);
+			const float3 position = m_unitDataCache->GetUnitPos(UnitId(unit));
 			m_map->InitBuilding(unitDefId, position);
 		}
 	}
@@ -391,11 +493,10 @@ void AAI::ConstructionStarted(UnitId unitId, UnitDefId unitDefId, UnitId constru
 	// construction of building started
 	if (s_buildTree.GetMovementType(unitDefId).IsStatic())
 	{
-		const float3 buildsite = m_aiCallback->GetUnitPos(unitId.id);
+		const float3 buildsite = m_unitDataCache->GetUnitPos(unitId);
 
 		// create new buildtask
-		AAIBuildTask *task = new AAIBuildTask(unitId, unitDefId, buildsite, constructor);
-		build_tasks.push_back(task);
+		AAIBuildTask *task = m_buildTasks->AddBuildTask(unitId, unitDefId, buildsite, constructor);
 
 		m_unitTable->units[constructor.id].cons->ConstructionStarted(unitId, task);
 
@@ -413,11 +514,12 @@ void AAI::ConstructionStarted(UnitId unitId, UnitDefId unitDefId, UnitId constru
 void AAI::UnitFinished(int unit)
 {
 	AAI_SCOPED_TIMER("UnitFinished")
+	AAI_RECORD_EVENT(ERecordedEvent::UNIT_FINISHED, unit)
 	if (m_initialized == false)
         return;
 
 	// get unit's id
-	const springLegacyAI::UnitDef* def = m_aiCallback->GetUnitDef(unit);
+	const springLegacyAI::UnitDef* def = m_unitDataCache->GetUnitDef(UnitId(unit));
 	const UnitDefId unitDefId(def->id);
 	const UnitId    unitId(unit);
 
@@ -430,16 +532,10 @@ void AAI::UnitFinished(int unit)
 	if (s_buildTree.GetMovementType(unitDefId).IsStatic())
 	{
 		// delete buildtask
-		for(auto task = build_tasks.begin(); task != build_tasks.end(); ++task)
-		{
-			if( (*task)->CheckIfConstructionFinished(m_unitTable, unitId) )
-			{
-				AAIBuildTask *build_task = *task;
-				build_tasks.erase(task);
-				spring::SafeDelete(build_task);
-				break;
-			}
-		}
+		AAIBuildTask *buildTask = m_buildTasks->GetBuildTask(unitId);
+
+		if( buildTask && buildTask->CheckIfConstructionFinished(m_unitTable, unitId) )
+			m_buildTasks->RemoveBuildTask(unitId);
 
 		// check if building belongs to one of this groups
 		if (category.IsMetalExtractor())
@@ -482,7 +578,7 @@ void AAI::UnitFinished(int unit)
 		}
 		else if(category.IsStaticAssistance())
 		{
-			float3 position = GetAICallback()->GetUnitPos(unit);
+			float3 position = m_unitDataCache->GetUnitPos(UnitId(unit));
 			position.x += 32.0f;
 			position.z += 32.0f;
 
@@ -533,18 +629,19 @@ void AAI::UnitFinished(int unit)
 void AAI::UnitDestroyed(int unit, int attacker)
 {
 	AAI_SCOPED_TIMER("UnitDestroyed")
+	AAI_RECORD_EVENT(ERecordedEvent::UNIT_DESTROYED, unit, attacker)
 	// get unit's id
-	const springLegacyAI::UnitDef* def = m_aiCallback->GetUnitDef(unit);
+	const springLegacyAI::UnitDef* def = m_unitDataCache->GetUnitDef(UnitId(unit));
 	UnitDefId unitDefId(def->id);
 
-	float3 pos = m_aiCallback->GetUnitPos(unit);
+	float3 pos = m_unitDataCache->GetUnitPos(UnitId(unit));
 
 	AAISector* sector = m_map->GetSectorOfPos(pos);
 
 	// update threat map
 	if (attacker && sector)
 	{
-		const springLegacyAI::UnitDef* att_def = m_aiCallback->GetUnitDef(attacker);
+		const springLegacyAI::UnitDef* att_def = m_unitDataCache->GetUnitDef(UnitId(attacker));
 
 		if (att_def)
 			sector->UpdateThreatValues(unitDefId, UnitDefId(att_def->id));
@@ -561,16 +658,10 @@ void AAI::UnitDestroyed(int unit, int attacker)
 		if( category.IsBuilding() )
 		{
 			// delete buildtask
-			for(auto task = build_tasks.begin(); task != build_tasks.end(); ++task)
-			{
-				if( (*task)->CheckIfConstructionFailed(this, UnitId(unit)) )
-				{
-					AAIBuildTask *buildTask = *task;
-					build_tasks.erase(task);
-					spring::SafeDelete(buildTask);
-					break;
-				}
-			}
+			AAIBuildTask *buildTask = m_buildTasks->GetBuildTask(UnitId(unit));
+
+			if( buildTask && buildTask->CheckIfConstructionFailed(this, UnitId(unit)) )
+				m_buildTasks->RemoveBuildTask(UnitId(unit));
 		}
 		// unfinished unit
 		else
@@ -600,7 +691,7 @@ void AAI::UnitDestroyed(int unit, int attacker)
 		// update buildtable
 		if(UnitId(attacker).IsValid() )
 		{
-			const springLegacyAI::UnitDef* defAttacker = m_aiCallback->GetUnitDef(attacker);
+			const springLegacyAI::UnitDef* defAttacker = m_unitDataCache->GetUnitDef(UnitId(attacker));
 
 			if(defAttacker)
 			{
@@ -632,7 +723,7 @@ void AAI::UnitDestroyed(int unit, int attacker)
 
 				// mark spots of destroyed mexes as unoccupied
 				if(sector)
-					sector->FreeMetalSpot(m_aiCallback->GetUnitPos(unit), unitDefId);
+					sector->FreeMetalSpot(m_unitDataCache->GetUnitPos(UnitId(unit)), unitDefId);
 			}
 			else if (category.IsPowerPlant())
 			{
@@ -699,6 +790,8 @@ void AAI::UnitDestroyed(int unit, int attacker)
 	}
 
 	m_unitTable->RemoveUnit(unit);
+
+	m_unitDataCache->InvalidateUnit(UnitId(unit));
 }
 
 void AAI::UnitIdle(int unit)
@@ -706,6 +799,7 @@ void AAI::UnitIdle(int unit)
 	const UnitId unitId(unit);
 
 	AAI_SCOPED_TIMER("UnitIdle")
+	AAI_RECORD_EVENT(ERecordedEvent::UNIT_IDLE, unit)
 	// if factory is idle, start construction of further units
 	if (m_unitTable->units[unit].cons)
 	{
@@ -736,15 +830,16 @@ void AAI::UnitIdle(int unit)
 void AAI::UnitMoveFailed(int unit)
 {
 	AAI_SCOPED_TIMER("UnitMoveFailed")
+	AAI_RECORD_EVENT(ERecordedEvent::UNIT_MOVE_FAILED, unit)
 	if (m_unitTable->units[unit].cons)
 	{
 		m_unitTable->units[unit].cons->CheckIfConstructionFailed();
 	}
 
-	float3 pos = m_aiCallback->GetUnitPos(unit);
+	float3 pos = m_unitDataCache->GetUnitPos(UnitId(unit));
 
-	pos.x = pos.x - 64 + 32 * (rand()%5);
-	pos.z = pos.z - 64 + 32 * (rand()%5);
+	pos.x = pos.x - 64 + 32 * m_random.NextInt(5);
+	pos.z = pos.z - 64 + 32 * m_random.NextInt(5);
 
 	if (pos.x < 0)
 		pos.x = 0;
@@ -759,27 +854,68 @@ void AAI::UnitMoveFailed(int unit)
 		m_execute->SendUnitToPosition(UnitId(unit), pos);
 }
 
-void AAI::EnemyEnterLOS(int /*enemy*/) {}
-void AAI::EnemyLeaveLOS(int /*enemy*/) {}
-void AAI::EnemyEnterRadar(int /*enemy*/) {}
-void AAI::EnemyLeaveRadar(int /*enemy*/) {}
+void AAI::EnemyEnterLOS(int enemy)
+{
+	AAI_SCOPED_TIMER("EnemyEnterLOS")
+	AAI_RECORD_EVENT(ERecordedEvent::ENEMY_ENTER_LOS, enemy)
+	m_unitDataCache->InvalidateUnit(UnitId(enemy));
+
+	if(m_map)
+		m_map->EnemyEnteredLOS(UnitId(enemy));
+}
+
+void AAI::EnemyLeaveLOS(int enemy)
+{
+	AAI_SCOPED_TIMER("EnemyLeaveLOS")
+	AAI_RECORD_EVENT(ERecordedEvent::ENEMY_LEAVE_LOS, enemy)
+	m_unitDataCache->InvalidateUnit(UnitId(enemy));
+
+	if(m_map)
+		m_map->EnemyLeftLOS(UnitId(enemy));
+}
+
+void AAI::EnemyEnterRadar(int enemy)
+{
+	AAI_SCOPED_TIMER("EnemyEnterRadar")
+	AAI_RECORD_EVENT(ERecordedEvent::ENEMY_ENTER_RADAR, enemy)
+	m_unitDataCache->InvalidateUnit(UnitId(enemy));
+
+	if(m_map)
+		m_map->EnemyEnteredRadar(UnitId(enemy));
+}
+
+void AAI::EnemyLeaveRadar(int enemy)
+{
+	AAI_SCOPED_TIMER("EnemyLeaveRadar")
+	AAI_RECORD_EVENT(ERecordedEvent::ENEMY_LEAVE_RADAR, enemy)
+	m_unitDataCache->InvalidateUnit(UnitId(enemy));
+
+	if(m_map)
+		m_map->EnemyLeftRadar(UnitId(enemy));
+}
 
 void AAI::EnemyDestroyed(int enemy, int attacker)
 {
 	AAI_SCOPED_TIMER("EnemyDestroyed")
+	AAI_RECORD_EVENT(ERecordedEvent::ENEMY_DESTROYED, enemy, attacker)
 	// remove enemy from unittable
 	if(UnitId(enemy).IsValid())
 		m_unitTable->EnemyKilled(enemy);
 
+	if(m_map)
+		m_map->EnemyDestroyed(UnitId(enemy));
+
 	if(UnitId(attacker).IsValid())
 	{
 		// get unit's id
-		const springLegacyAI::UnitDef* defKilled   = m_aiCallback->GetUnitDef(enemy);
-		const springLegacyAI::UnitDef* defAttacker = m_aiCallback->GetUnitDef(attacker);
+		const springLegacyAI::UnitDef* defKilled   = m_unitDataCache->GetUnitDef(UnitId(enemy));
+		const springLegacyAI::UnitDef* defAttacker = m_unitDataCache->GetUnitDef(UnitId(attacker));
 
 		if (defAttacker && defKilled)
 			s_buildTree.UpdateCombatPowerStatistics(UnitDefId(defAttacker->id), UnitDefId(defKilled->id));
 	}
+
+	m_unitDataCache->InvalidateUnit(UnitId(enemy));
 }
 
 void AAI::Update()
@@ -791,6 +927,13 @@ void AAI::Update()
 		return;
 	}
 
+	m_profiler->BeginFrame(tick);
+
+	AAI_SCOPED_TIMER("Update")
+	AAI_RECORD_EVENT(ERecordedEvent::UPDATE, tick)
+
+	m_unitDataCache->NextFrame();
+
 	GamePhase gamePhase(tick);
 
 	if(gamePhase > m_gamePhase)
@@ -809,16 +952,31 @@ void AAI::Update()
 		return;
 	}
 
+	m_scheduler->Update(tick);
+}
+
+void AAI::AddScheduledTasks()
+{
+	// update income
+	m_scheduler->AddTask("Update-Income", 30, 0, 3.0f, [this]() {
+		AAI_SCOPED_TIMER("Update-Income")
+		m_brain->UpdateResources(m_aiCallback);
+	});
+
 	// scouting
-	if (!((tick + 2 * GetAAIInstance()) % 45))
-	{
+	m_scheduler->AddTask("Scouting_1", 45, 0, 2.0f, [this]() {
 		AAI_SCOPED_TIMER("Scouting_1")
 		m_map->CheckUnitsInLOSUpdate();
-	}
+	});
+
+	// registered enemy units are maintained by events -> compare with units currently detected from time to time (in case events have been missed)
+	m_scheduler->AddTask("Reconcile-Enemy-Units", 900, 23, 1.0f, [this]() {
+		AAI_SCOPED_TIMER("Reconcile-Enemy-Units")
+		m_map->ReconcileEnemyUnits();
+	});
 
 	// update groups
-	if (!((tick+7) % 150))
-	{
+	m_scheduler->AddTask("Groups", 150, 7, 2.0f, [this]() {
 		AAI_SCOPED_TIMER("Groups")
 		for (const auto category : AAIUnitCategory::m_combatUnitCategories)
 		{
@@ -827,21 +985,9 @@ void AAI::Update()
 				group->Update();
 			}
 		}
+	});
 
-		return;
-	}
-
-	// unit management
-	if (!(tick % 650))
-	{
-		AAI_SCOPED_TIMER("Unit-Management")
-		m_execute->AdjustUnitProductionRate();
-		m_brain->BuildUnits();
-		m_execute->BuildScouts();
-	}
-
-	if (!((tick+39) % 500))
-	{
+	m_scheduler->AddTask("Check-Attack", 500, 39, 2.0f, [this]() {
 		AAI_SCOPED_TIMER("Check-Attack")
 		// check attack
 		m_attackManager->Update(*m_threatMap);
@@ -850,87 +996,78 @@ void AAI::Update()
 		m_threatMap->UpdateLocalEnemyCombatPower(ETargetType::AIR, Map()->GetSectorMap());
 		m_airForceManager->CheckStaticBombTargets(*m_threatMap);
 		m_airForceManager->AirRaidBestTarget(2.0f);
-		return;
-	}
-
-	// ressource management
-	if (!(tick % 200))
-	{
-		AAI_SCOPED_TIMER("Resource-Management")
-		m_execute->CheckRessources();
-	}
+	});
 
 	// update sectors
-	if (!((tick+15) % 120))
-	{
+	m_scheduler->AddTask("Update-Sectors", 120, 15, 2.0f, [this]() {
 		AAI_SCOPED_TIMER("Update-Sectors")
 		m_brain->UpdateAttackedByValues();
 		m_map->UpdateSectors(m_threatMap);
 		m_brain->UpdatePressureByEnemy(m_map->GetSectorMap());
-	}
+	});
+
+	// unit management
+	m_scheduler->AddTask("Unit-Management", 650, 0, 1.0f, [this]() {
+		AAI_SCOPED_TIMER("Unit-Management")
+		m_execute->AdjustUnitProductionRate();
+		m_brain->BuildUnits();
+		m_execute->BuildScouts();
+	});
+
+	// ressource management
+	m_scheduler->AddTask("Resource-Management", 200, 0, 1.5f, [this]() {
+		AAI_SCOPED_TIMER("Resource-Management")
+		m_execute->CheckRessources();
+	});
 
 	// builder management
-	if (!(tick % 917))
-	{
+	m_scheduler->AddTask("Builder-Management", 917, 0, 1.0f, [this]() {
 		AAI_SCOPED_TIMER("Builder-Management")
 		m_brain->UpdateDefenceCapabilities();
-	}
-
-	// update income
-	if (!(tick % 30))
-	{
-		AAI_SCOPED_TIMER("Update-Income")
-		m_brain->UpdateResources(m_aiCallback);
-	}
+	});
 
 	// building management
-	if (!(tick % 97))
-	{
+	m_scheduler->AddTask("Building-Management", 97, 0, 1.5f, [this]() {
 		AAI_SCOPED_TIMER("Building-Management")
 		m_execute->CheckConstruction();
-	}
+	});
 
 	// builder/factory management
-	if (!(tick % 677))
-	{
+	m_scheduler->AddTask("BuilderAndFactory-Management", 677, 0, 1.0f, [this]() {
 		AAI_SCOPED_TIMER("BuilderAndFactory-Management")
 		m_unitTable->UpdateConstructors();
 		m_execute->CheckConstructionOfNanoTurret();
-	}
+	});
 
-	if (!(tick % 337))
-	{
+	m_scheduler->AddTask("Check-Factories", 337, 0, 1.0f, [this]() {
 		AAI_SCOPED_TIMER("Check-Factories")
 		m_execute->CheckFactories();
-	}
+	});
 
-	if (!(tick % 1079))
-	{
+	m_scheduler->AddTask("Check-Defenses", 1079, 0, 1.0f, [this]() {
 		AAI_SCOPED_TIMER("Check-Defenses")
 		m_execute->CheckDefences();
-	}
+	});
 
 	// build radar/jammer
-	if (!((tick+77) % 1200))
-	{
+	m_scheduler->AddTask("Check-Recon", 1200, 77, 1.0f, [this]() {
+		AAI_SCOPED_TIMER("Check-Recon")
 		m_execute->CheckRecon();
 		//execute->CheckJammer();
 		m_execute->CheckStationaryArty();
 		//execute->CheckAirBase();
-	}
+	});
 
 	// upgrade mexes
-	if (!((tick+11) % 300))
-	{
+	m_scheduler->AddTask("Check Upgrades", 300, 11, 1.0f, [this]() {
 		AAI_SCOPED_TIMER("Check Upgrades")
 		m_execute->CheckExtractorUpgrade();
 		m_execute->CheckRadarUpgrade();
 		//execute->CheckJammerUpgrade();
-	}
+	});
 
 	// recheck rally points
-	if (!(tick % 1877))
-	{
+	m_scheduler->AddTask("Recheck-Rally-Points", 1877, 0, 1.0f, [this]() {
 		AAI_SCOPED_TIMER("Recheck-Rally-Points")
 		for (const auto category : AAIUnitCategory::m_combatUnitCategories)
 		{
@@ -939,7 +1076,7 @@ void AAI::Update()
 				group->CheckUpdateOfRallyPoint();
 			}
 		}
-	}
+	});
 }
 
 const int* AAI::GetLosMap()
@@ -950,12 +1087,31 @@ const int* AAI::GetLosMap()
 
 	m_skirmishAICallbacks->Map_getLosMap(m_skirmishAIId, &m_losMap[0], m_losMap.size());
 
+	// LOS and radar map are fetched via the C callback (i.e. not passed through the recording callback)
+	if(m_eventRecorder)
+		m_eventRecorder->RecordMap(ERecordedEvent::LOS_MAP, &m_losMap[0], static_cast<int>(m_losMap.size()));
+
 	return &m_losMap[0];
 }
 
+std::vector<int> AAI::GetRadarMap() const
+{
+	std::vector<int> radarMap(m_skirmishAICallbacks->Map_getRadarMap(m_skirmishAIId, nullptr, 0));
+
+	if(radarMap.empty() == false)
+	{
+		m_skirmishAICallbacks->Map_getRadarMap(m_skirmishAIId, &radarMap[0], radarMap.size());
+
+		if(m_eventRecorder)
+			m_eventRecorder->RecordMap(ERecordedEvent::RADAR_MAP, &radarMap[0], static_cast<int>(radarMap.size()));
+	}
+
+	return radarMap;
+}
+
 UnitDefId AAI::GetUnitDefId(UnitId unitId) const
 {
-	const springLegacyAI::UnitDef* def = m_aiCallback->GetUnitDef(unitId.id);
+	const springLegacyAI::UnitDef* def = m_unitDataCache->GetUnitDef(unitId);
 
 	if(def)
 		return UnitDefId(def->id);
@@ -972,6 +1128,8 @@ int AAI::HandleEvent(int msg, const void* data)
 		case AI_EVENT_UNITCAPTURED: // 2
 			{
 				const IGlobalAI::ChangeTeamEvent* cte = (const IGlobalAI::ChangeTeamEvent*) data;
+				AAI_RECORD_EVENT(ERecordedEvent::HANDLE_EVENT, msg, cte->unit, cte->oldteam, cte->newteam)
+				m_unitDataCache->InvalidateUnit(UnitId(cte->unit));
 
 				const int myAllyTeamId = m_aiCallback->GetMyAllyTeam();
 				const bool oldEnemy = !m_aiCallback->IsAllied(myAllyTeamId, m_aiCallback->GetTeamAllyTeam(cte->oldteam));
@@ -984,10 +1142,9 @@ int AAI::HandleEvent(int msg, const void* data)
 				} else if (!oldEnemy && newEnemy) {
 					// unit changed from an ally to an enemy team
 					// we lost a friend! :(
-					EnemyCreated(cte->unit);
-					if (!m_aiCallback->UnitBeingBuilt(cte->unit)) {
-						EnemyFinished(cte->unit);
-					}
+					// (no enter LOS/radar events for units already within LOS/radar coverage)
+					if(m_map)
+						m_map->AddEnemyUnit(UnitId(cte->unit));
 				}
 
 				if (cte->oldteam == m_aiCallback->GetMyTeam()) {
@@ -1009,14 +1166,22 @@ int AAI::HandleEvent(int msg, const void* data)
 
 void AAI::Log(const char* format, ...)
 {
-	if(m_logFile != NULL)
+	if(m_logger && m_logger->IsEnabled(ELogLevel::INFO))
 	{
 		va_list args;
 		va_start(args, format);
-		const int bytes = vfprintf(m_logFile, format, args);
-		if (bytes<0) { //write to stderr if write to file failed
-			vfprintf(stderr, format, args);
-		}
+		m_logger->Write(ELogLevel::INFO, ELogCategory::GENERAL, format, args);
+		va_end(args);
+	}
+}
+
+void AAI::Log(ELogLevel level, ELogCategory category, const char* format, ...)
+{
+	if(m_logger && m_logger->IsEnabled(level))
+	{
+		va_list args;
+		va_start(args, format);
+		m_logger->Write(level, category, format, args);
 		va_end(args);
 	}
 }
@@ -18,6 +18,7 @@
 
 #include "aidef.h"
 #include "AAIBuildTree.h"
+#include "AAIRandom.h"
 
 namespace springLegacyAI {
 	class IAICallback;
@@ -27,8 +28,16 @@ using namespace springLegacyAI;
 
 class AAIExecute;
 class Profiler;
+class AAIProfiler;
 class AAIBrain;
 class AAIBuildTask;
+class AAIBuildTaskRegistry;
+class AAITaskScheduler;
+class AAIEventRecorder;
+class AAIRecordingCallback;
+class AAILogger;
+enum class ELogLevel : int;
+enum class ELogCategory : int;
 class AAIAirForceManager;
 class AAIAttackManager;
 class AAIBuildTable;
@@ -36,6 +45,7 @@ class AAIUnitTable;
 class AAIMap;
 class AAIThreatMap;
 class AAIGroup;
+class AAIUnitDataCache;
 
 class AAI : public IGlobalAI
 {
@@ -64,6 +74,10 @@ public:
 	void EnemyDamaged(int /*damaged*/,int /*attacker*/,float /*damage*/,float3 /*dir*/) {}	//called when an enemy inside los or radar is damaged
 	void EnemyDestroyed(int enemy, int attacker);
 	void Log(const char* format, ...);
+
+	//! @brief Writes the given message to the log file (if level is not below the min log level set in general config)
+	void Log(ELogLevel level, ELogCategory category, const char* format, ...);
+
 	void LogConsole(const char* format, ...);
 
 	int HandleEvent(int msg, const void *data);
@@ -84,8 +98,12 @@ public:
 	void Update();
 
 	//! Workaround to get current LOS Map (ai callback version of legacy CPP interface is bugged)
+	//! Fetches the whole map from the engine - use AAIMap::GetLosMap() for LOS queries
 	const int* GetLosMap();
 
+	//! @brief Fetches the radar coverage (non zero if covered) from the engine
+	std::vector<int> GetRadarMap() const;
+
 	//! @brief Returns the unitDefId for a given unitId
 	UnitDefId GetUnitDefId(UnitId unitId) const;
 
@@ -95,13 +113,20 @@ public:
 	//! @brief Returns pointer to AI callback
 	IAICallback* GetAICallback() const { return m_aiCallback; }
 
+	//! @brief Returns the unit data cache (use instead of AI callback to query position, unit def, health, or team of units)
+	AAIUnitDataCache* UnitData() const { return m_unitDataCache; }
+
+	//! @brief Returns the random number generator of this AAI instance (use instead of rand())
+	AAIRandom& Random() { return m_random; }
+
 	//! @brief Returns the side of this AAI instance
 	int GetSide() const { return m_side; }
 
 	//! @brief Return team (not ally team) of this AAI instance
 	int GetMyTeamId() const { return m_myTeamId; }
 
-	std::list<AAIBuildTask*>& GetBuildTasks() { return build_tasks; }
+	//! @brief Returns the build tasks (i.e. buildings under construction) of this AAI instance
+	const AAIBuildTaskRegistry& GetBuildTasks() const { return *m_buildTasks; }
 
 	//! @brief Returns the list of units groups for the given unit category
 	std::list<AAIGroup*>& GetUnitGroupsList(const AAIUnitCategory& category) 
@@ -122,9 +147,18 @@ public:
 private:
 	Profiler* GetProfiler(){ return profiler; }
 
+	//! @brief Registers the periodic tasks (e.g. update of sectors, check of factories) at the scheduler
+	void AddScheduledTasks();
+
+	//! @brief Writes statistics of the game to the log file, exports the profiling data, and saves the learning data
+	void SaveGameData();
+
 	//! Pointer to AI callback
 	IAICallback* m_aiCallback;
 
+	//! Memoises position, unit def, health, and team of units queried via the AI callback (invalidated every frame)
+	AAIUnitDataCache* m_unitDataCache;
+
 	//! The ID of the AI (used to access the correct SkirmishAICallback)
 	int m_skirmishAIId;
 
@@ -134,8 +168,8 @@ private:
 	//! LOS Map
 	std::vector<int> m_losMap;
 
-	// list of buildtasks
-	std::list<AAIBuildTask*> build_tasks;
+	//! Buildtasks (i.e. buildings under construction), accessed by unit id of the building
+	AAIBuildTaskRegistry* m_buildTasks;
 
 	//! Stores information about the map (shared between all AAI instances) and AI specific map related data (e.g. build map, threat map, defence maps, sectors, ...)
 	AAIMap*             m_map;
@@ -164,16 +198,31 @@ private:
 	//! List of groups of unit of the different categories
 	std::vector< std::list<AAIGroup*> > m_unitGroupsOfCategoryLists;
 
+	//! Executes periodic tasks within the time budget per frame
+	AAITaskScheduler* m_scheduler;
+
+	//! Random number generator (seeded with the random seed from the general config or the current time and the team id, i.e. independent of other instances)
+	AAIRandom m_random;
+
+	//! Records events and engine responses for later analysis (nullptr if not activated in general config)
+	AAIEventRecorder* m_eventRecorder;
+
+	//! Passes all queries to the callback of the engine and records the responses (used as m_aiCallback while recording, nullptr otherwise)
+	AAIRecordingCallback* m_recordingCallback;
+
 	Profiler* profiler;
 
+	//! Collects execution time histograms of the timed sections and call trees of frames exceeding the spike threshold
+	AAIProfiler* m_profiler;
+
 	//! Id of the team (not ally team) of the AAI instance
 	int m_myTeamId;
 
 	//! Side of this AAI instance; 0 always neutral, for TA-like mods 1 = Arm, 2 = Core
 	int m_side;
 
-	//! File to which log messages are written
-	FILE *m_logFile;
+	//! Writes the log messages to the log file of this instance (without blocking)
+	AAILogger* m_logger;
 
 	//! Initialization state - true if AAI has been sucessfully initialized and ready to run
 	bool m_initialized;
@@ -21,6 +21,7 @@
 #include "AAIBrain.h"
 #include "AAIAttackManager.h"
 #include "AAIThreatMap.h"
+#include "AAIUnitDataCache.h"
 
 #include "LegacyCpp/UnitDef.h"
 
@@ -36,9 +37,9 @@ AAIAirForceManager::~AAIAirForceManager(void)
 void AAIAirForceManager::CheckTarget(const UnitId& unitId, const AAITargetType& targetType, float health)
 {
 	// do not attack own units
-	if(ai->GetAICallback()->GetUnitTeam(unitId.id) != ai->GetMyTeamId()) 
+	if(ai->UnitData()->GetUnitTeam(unitId) != ai->GetMyTeamId()) 
 	{
-		const float3     position = ai->GetAICallback()->GetUnitPos(unitId.id);
+		const float3     position = ai->UnitData()->GetUnitPos(unitId);
 		const AAISector* sector   = ai->Map()->GetSectorOfPos(position);
 
 		// check if unit is within the map
@@ -8,6 +8,7 @@
 // -------------------------------------------------------------------------
 
 #include "AAI.h"
+#include "AAILogger.h"
 #include "AAIBrain.h"
 #include "AAIBuildTable.h"
 #include "AAIExecute.h"
@@ -201,7 +202,7 @@ void AAIBrain::ExpandBaseAtStartup()
 {
 	if(m_sectorsInDistToBase[0].size() == 0)
 	{
-		ai->Log("ERROR: Failed to expand initial base - no starting sector set!\n");
+		ai->Log(ELogLevel::FAILURE, ELogCategory::BRAIN, "Failed to expand initial base - no starting sector set!\n");
 		return;
 	}
 
@@ -448,10 +449,10 @@ float AAIBrain::Affordable()
 	return 25.0f / (ai->GetAICallback()->GetMetalIncome() + 5.0f);
 }
 
-bool IsRandomNumberBelow(float threshold)
+bool IsRandomNumberBelow(AAIRandom& random, float threshold)
 {
 	// determine random float in [0:1]
-	const float randomValue = 0.01f * static_cast<float>(std::rand()%101);
+	const float randomValue = 0.01f * static_cast<float>(random.NextInt(101));
 	return randomValue < threshold;
 }
 
@@ -485,9 +486,9 @@ void AAIBrain::BuildUnits()
 
 			//ai->Log("Air selected - bomb targets: %f      enemy pressure: %f   bomber ratio: %f\n", ai->AirForceMgr()->GetNumberOfBombTargets(), m_estimatedPressureByEnemies, bomberRatio); 
 
-			if(IsRandomNumberBelow(bomberRatio))
+			if(IsRandomNumberBelow(ai->Random(), bomberRatio))
 			{
-				ai->Log("bomber selected\n"); 
+				AAI_LOG_DEBUG(ai, ELogCategory::BRAIN, "bomber selected\n"); 
 				finalCombatPower[ETargetType::SURFACE] = 0.0f;
 				finalCombatPower[ETargetType::FLOATER] = 0.0f;
 				finalCombatPower[ETargetType::AIR]     = 0.0f;
@@ -602,7 +603,7 @@ AAIMovementType AAIBrain::DetermineMovementTypeForCombatUnitConstruction(const G
 	// boost air craft ratio if many possible targets for bombing run identified (boost factor between 0.75 and 1.5)
 	const float dynamicAirCraftRatio = cfg->AIRCRAFT_RATIO * (0.75f * (1.0f + ai->AirForceMgr()->GetNumberOfBombTargets()));
 
-	if( IsRandomNumberBelow(dynamicAirCraftRatio) && !gamePhase.IsStartingPhase())
+	if( IsRandomNumberBelow(ai->Random(), dynamicAirCraftRatio) && !gamePhase.IsStartingPhase())
 	{
 		moveType.SetMovementType(EMovementType::MOVEMENT_TYPE_AIR);
 	}
@@ -619,7 +620,7 @@ AAIMovementType AAIBrain::DetermineMovementTypeForCombatUnitConstruction(const G
 		// ratio of sea units is determined: 40% by  water ratio on map, 60 % ratio of enemy buildings on sea
 		float waterUnitRatio = 0.4f * AAIMap::s_waterTilesRatio + 0.6f * offshoreBuildingRatio;
 
-		if(IsRandomNumberBelow(waterUnitRatio) )
+		if(IsRandomNumberBelow(ai->Random(), waterUnitRatio) )
 		{
 			moveType.AddMovementType(EMovementType::MOVEMENT_TYPE_SEA_FLOATER);
 			moveType.AddMovementType(EMovementType::MOVEMENT_TYPE_SEA_SUBMERGED);
@@ -628,7 +629,7 @@ AAIMovementType AAIBrain::DetermineMovementTypeForCombatUnitConstruction(const G
 		{
 			moveType.AddMovementType(EMovementType::MOVEMENT_TYPE_AMPHIBIOUS);
 
-			if(IsRandomNumberBelow(1.0f - waterUnitRatio))
+			if(IsRandomNumberBelow(ai->Random(), 1.0f - waterUnitRatio))
 				moveType.AddMovementType(EMovementType::MOVEMENT_TYPE_GROUND);
 		}
 	}
@@ -664,29 +665,29 @@ UnitSelectionCriteria AAIBrain::DetermineCombatUnitSelectionCriteria() const
 	}
 	else
 	{
-		if( IsRandomNumberBelow(cfg->FAST_UNITS_RATIO) )
+		if( IsRandomNumberBelow(ai->Random(), cfg->FAST_UNITS_RATIO) )
 		{
 			// speed in 0.5 to 1.5
-			const float speed = static_cast<float>(rand()%6);
+			const float speed = static_cast<float>(ai->Random().NextInt(6));
 			unitSelectionCriteria.speed = 0.5f + 0.2f * speed;
 		}
 		else
 		{
 			// speed in 0.1 to 0.5
-			const float speed = static_cast<float>(rand()%5);
+			const float speed = static_cast<float>(ai->Random().NextInt(5));
 			unitSelectionCriteria.speed = 0.1f + 0.1f * speed;
 		}
 
-		if( IsRandomNumberBelow(cfg->HIGH_RANGE_UNITS_RATIO) )
+		if( IsRandomNumberBelow(ai->Random(), cfg->HIGH_RANGE_UNITS_RATIO) )
 		{
 			// range in 0.5 to 1.5
-			const float range = static_cast<float>(rand()%6);
+			const float range = static_cast<float>(ai->Random().NextInt(6));
 			unitSelectionCriteria.range = 0.5f + 0.2f * range;
 		}
 		else
 		{
 			// range in 0.1 to 0.5
-			const float range = static_cast<float>(rand()%5);
+			const float range = static_cast<float>(ai->Random().NextInt(5));
 			unitSelectionCriteria.range = 0.1f + 0.1f * range;
 		}
 	}
@@ -868,13 +869,13 @@ ScoutSelectionCriteria AAIBrain::DetermineScoutSelectionCriteria() const
 	else
 	{
 		// speed in 0.5 to 1.5
-		selectionCriteria.speed      = 0.5f + 0.2f * static_cast<float>(rand()%6);
+		selectionCriteria.speed      = 0.5f + 0.2f * static_cast<float>(ai->Random().NextInt(6));
 
 		// range in 0.5 to 2.0
-		selectionCriteria.sightRange = 0.5f + 0.3f * static_cast<float>(rand()%6);
+		selectionCriteria.sightRange = 0.5f + 0.3f * static_cast<float>(ai->Random().NextInt(6));
 
 		// cloakable in 0 to 1
-		selectionCriteria.cloakable  = 0.0f + 0.25f * static_cast<float>(rand()%4);
+		selectionCriteria.cloakable  = 0.0f + 0.25f * static_cast<float>(ai->Random().NextInt(4));
 	}
 
 	return selectionCriteria;
@@ -957,15 +958,15 @@ StaticDefenceSelectionCriteria AAIBrain::DetermineStaticDefenceSelectionCriteria
 
 	// range ranges from 0.1 to 1.5, depending on ratio of units with high ranges
 	float range;
-	if( IsRandomNumberBelow(cfg->HIGH_RANGE_UNITS_RATIO) && (sector->GetNumberOfBuildings(EUnitCategory::STATIC_DEFENCE) > 1) )
+	if( IsRandomNumberBelow(ai->Random(), cfg->HIGH_RANGE_UNITS_RATIO) && (sector->GetNumberOfBuildings(EUnitCategory::STATIC_DEFENCE) > 1) )
 	{
 		// range in 0.5 to 1.5
-		range = 0.5f + 0.2f * static_cast<float>(rand()%6);
+		range = 0.5f + 0.2f * static_cast<float>(ai->Random().NextInt(6));
 	}
 	else
 	{
 		// range in 0.1 to 0.5
-		range = 0.1f + 0.1f * static_cast<float>(rand()%5);
+		range = 0.1f + 0.1f * static_cast<float>(ai->Random().NextInt(5));
 	}
 
 	// importance of terrain (for placement of defence) depends on range
@@ -10,6 +10,7 @@
 #include "System/SafeUtil.h"
 #include "AAIBuildTable.h"
 #include "AAI.h"
+#include "AAILogger.h"
 #include "AAIBrain.h"
 #include "AAIExecute.h"
 #include "AAIUnitTable.h"
@@ -22,7 +23,8 @@ using namespace springLegacyAI;
 
 AttackedByRatesPerGamePhaseAndMapType AAIBuildTable::s_attackedByRates;
 
-AAIBuildTable::AAIBuildTable(AAI* ai)
+AAIBuildTable::AAIBuildTable(AAI* ai) :
+	m_constructorAvailabilityGeneration(1u)
 {
 	this->ai = ai;
 
@@ -58,6 +60,9 @@ AAIBuildTable::AAIBuildTable(AAI* ai)
 
 	m_buildqueues.resize( ai->s_buildTree.GetNumberOfFactories() );
 
+	m_staticDefenceCombatPowerStatistics.resize(ai->s_buildTree.GetNumberOfSides() * AAITargetType::numberOfTargetTypes);
+	m_constructorSelectionStatistics.resize(numOfUnits+1);
+
 	// If first instance of AAI: Try to load combat power&attacked by rates; if no stored data availble init with default values
 	// (combat power and attacked by rates are both static)
 	if(ai->GetAAIInstance() == 1)
@@ -90,6 +95,8 @@ void AAIBuildTable::ConstructorFinished(UnitDefId constructor)
 		++units_dynamic[unitDefId.id].constructorsAvailable;
 		--units_dynamic[unitDefId.id].constructorsRequested;
 	}
+
+	++m_constructorAvailabilityGeneration;
 }
 
 void AAIBuildTable::ConstructorKilled(UnitDefId constructor)
@@ -98,6 +105,8 @@ void AAIBuildTable::ConstructorKilled(UnitDefId constructor)
 	{
 		--units_dynamic[unitDefId.id].constructorsAvailable;
 	}
+
+	++m_constructorAvailabilityGeneration;
 }
 
 void AAIBuildTable::UnfinishedConstructorKilled(UnitDefId constructor)
@@ -567,22 +576,13 @@ UnitDefId AAIBuildTable::SelectStaticDefence(int side, const StaticDefenceSelect
 {
 	// get data needed for selection
 	AAIUnitCategory category(EUnitCategory::STATIC_DEFENCE);
-	const std::list<UnitDefId> unitList = ai->s_buildTree.GetUnitsInCategory(category, side);
+	const std::list<UnitDefId>& unitList = ai->s_buildTree.GetUnitsInCategory(category, side);
 
 	const StatisticalData& costs      = ai->s_buildTree.GetUnitStatistics(side).GetUnitCostStatistics(category);
 	const StatisticalData& ranges     = ai->s_buildTree.GetUnitStatistics(side).GetUnitPrimaryAbilityStatistics(category);
 	const StatisticalData& buildtimes = ai->s_buildTree.GetUnitStatistics(side).GetUnitBuildtimeStatistics(category);
 
-	// calculate combat power
-	StatisticalData combatPowerStat;		
-
-	for(auto defence : unitList)
-	{
-		const float defenceCombatPower = ai->s_buildTree.GetCombatPower(defence).GetValue(selectionCriteria.targetType);
-		combatPowerStat.AddValue(defenceCombatPower);
-	}
-
-	combatPowerStat.Finalize();
+	const StatisticalData& combatPowerStat = GetStaticDefenceCombatPowerStatistics(side, selectionCriteria.targetType);
 
 	// start with selection
 	UnitDefId selectedDefence;
@@ -600,7 +600,7 @@ UnitDefId AAIBuildTable::SelectStaticDefence(int side, const StaticDefenceSelect
 							+ selectionCriteria.buildtime   * buildtimes.GetDeviationFromMax( unitData.m_buildtime )
 							+ selectionCriteria.range       * ranges.GetDeviationFromZero( unitData.m_primaryAbility )
 							+ selectionCriteria.combatPower * combatPowerStat.GetDeviationFromZero( myCombatPower )
-							+ 0.05f * ((float)(rand()%(selectionCriteria.randomness+1)));
+							+ 0.05f * ((float)(ai->Random().NextInt(selectionCriteria.randomness+1)));
 
 			if(myRating > bestRating)
 			{
@@ -776,7 +776,7 @@ UnitDefId AAIBuildTable::SelectScout(int side, const ScoutSelectionCriteria& sco
 							+ scoutSelectionCriteria.cost       * costs.GetDeviationFromMax(ai->s_buildTree.GetTotalCost(scoutUnitDefId))
 							+ scoutSelectionCriteria.speed      * speeds.GetDeviationFromZero(ai->s_buildTree.GetMaxSpeed(scoutUnitDefId))
 							+ scoutSelectionCriteria.cloakable  * cloakable
-							+ (0.03f * ((float)(rand()%randomness)));
+							+ (0.03f * ((float)(ai->Random().NextInt(randomness))));
 			
 			if(moveType.IsMobileSea())
 				rating *= (0.2f + 0.8f * AAIMap::s_waterTilesRatio);
@@ -794,7 +794,7 @@ UnitDefId AAIBuildTable::SelectScout(int side, const ScoutSelectionCriteria& sco
 	return selectedScout;
 }
 
-void AAIBuildTable::SelectCombatUnits(std::list<UnitDefId>& unitList, int side, const AAIMovementType& allowedMoveTypes, bool constructorAvailable) const
+void AAIBuildTable::SelectCombatUnits(std::vector<UnitDefId>& unitList, int side, const AAIMovementType& allowedMoveTypes, bool constructorAvailable) const
 {
 	std::vector<bool> checkCategory(AAIUnitCategory::m_combatUnitCategories.size(), false);
 
@@ -837,99 +837,214 @@ void AAIBuildTable::SelectCombatUnits(std::list<UnitDefId>& unitList, int side,
 	}
 }
 
-UnitDefId AAIBuildTable::SelectCombatUnit(int side, const AAIMovementType& allowedMoveTypes, const TargetTypeValues& combatPowerCriteria, const UnitSelectionCriteria& unitCriteria, const std::vector<float>& factoryUtilization, int randomness, bool constructorAvailable) const
+const CombatUnitSelectionData& AAIBuildTable::GetCombatUnitSelectionData(int side, const AAIMovementType& allowedMoveTypes, bool constructorAvailable) const
 {
+	const uint64_t key =   (static_cast<uint64_t>(allowedMoveTypes.GetMovementType()) << 32)
+						 | (static_cast<uint64_t>(side) << 1)
+						 | (constructorAvailable ? 1u : 0u);
+
+	// selectable units only depend on availability of constructors if a constructor is required
+	const unsigned int generation = constructorAvailable ? m_constructorAvailabilityGeneration : 1u;
+
+	CombatUnitSelectionData& selectionData = m_combatUnitSelectionData[key];
+
 	//-----------------------------------------------------------------------------------------------------------------
-	// get data needed for selection
+	// determine candidates and their (static) properties
 	//-----------------------------------------------------------------------------------------------------------------
+	if(selectionData.constructorAvailabilityGeneration != generation)
+	{
+		selectionData.constructorAvailabilityGeneration = generation;
+		selectionData.combatPowerValid = false;
+		selectionData.unitDefIds.clear();
+
+		SelectCombatUnits(selectionData.unitDefIds, side, allowedMoveTypes, constructorAvailable);
+
+		StatisticalData costs, ranges, speeds;
+
+		for(auto unitDefId : selectionData.unitDefIds)
+		{
+			const UnitTypeProperties& unitData = ai->s_buildTree.GetUnitTypeProperties(unitDefId);
 
-	std::list<UnitDefId> unitList;
-	SelectCombatUnits(unitList, side, allowedMoveTypes, constructorAvailable);
+			costs.AddValue(unitData.m_totalCost);
+			ranges.AddValue(unitData.m_primaryAbility);
+			speeds.AddValue(unitData.m_secondaryAbility);
+		}
+
+		costs.Finalize();
+		ranges.Finalize();
+		speeds.Finalize();
+
+		const size_t numberOfCandidates = selectionData.unitDefIds.size();
+		selectionData.costs.resize(numberOfCandidates);
+		selectionData.costDeviations.resize(numberOfCandidates);
+		selectionData.rangeDeviations.resize(numberOfCandidates);
+		selectionData.speedDeviations.resize(numberOfCandidates);
+
+		for(size_t i = 0; i < numberOfCandidates; ++i)
+		{
+			const UnitTypeProperties& unitData = ai->s_buildTree.GetUnitTypeProperties(selectionData.unitDefIds[i]);
 
-	StatisticalData costStatistics;
-	StatisticalData rangeStatistics;
-	StatisticalData speedStatistics;
-	StatisticalData combatPowerStat;
-	StatisticalData combatEfficiencyStat;
-	std::vector<float> combatPowerValues(unitList.size()); // values for individual units (in order of appearance in unitList)
+			selectionData.costs[i]           = unitData.m_totalCost;
+			selectionData.costDeviations[i]  = costs.GetDeviationFromMax(unitData.m_totalCost);
+			selectionData.rangeDeviations[i] = ranges.GetDeviationFromZero(unitData.m_primaryAbility);
+			selectionData.speedDeviations[i] = speeds.GetDeviationFromZero(unitData.m_secondaryAbility);
+		}
+	}
 
-	int i = 0;
-	for(auto unitDefId : unitList)
+	//-----------------------------------------------------------------------------------------------------------------
+	// update combat power columns if combat power has changed since last update
+	//-----------------------------------------------------------------------------------------------------------------
+	if( (selectionData.combatPowerValid == false) || (selectionData.combatPowerGeneration != ai->s_buildTree.GetCombatPowerGeneration()) )
 	{
-		const UnitTypeProperties& unitData = ai->s_buildTree.GetUnitTypeProperties(unitDefId);
+		selectionData.combatPowerValid      = true;
+		selectionData.combatPowerGeneration = ai->s_buildTree.GetCombatPowerGeneration();
 
-		const float combatPower = combatPowerCriteria.CalculateWeightedSum(ai->s_buildTree.GetCombatPower(unitDefId)); 
-		const float combatEff   = combatPower / unitData.m_totalCost;
+		const size_t numberOfCandidates = selectionData.unitDefIds.size();
 
-		costStatistics.AddValue(unitData.m_totalCost);
-		rangeStatistics.AddValue(unitData.m_primaryAbility);
-		speedStatistics.AddValue(unitData.m_secondaryAbility);
-		combatPowerStat.AddValue(combatPower);
-		combatEfficiencyStat.AddValue(combatEff);
-		combatPowerValues[i] = combatPower;
+		for(auto& column : selectionData.combatPower)
+			column.resize(numberOfCandidates);
 
-		++i;
+		for(size_t i = 0; i < numberOfCandidates; ++i)
+		{
+			const TargetTypeValues& combatPower = ai->s_buildTree.GetCombatPower(selectionData.unitDefIds[i]);
+
+			for(int targetType = 0; targetType < AAITargetType::numberOfTargetTypes; ++targetType)
+				selectionData.combatPower[targetType][i] = combatPower.m_values[targetType];
+		}
 	}
 
-	costStatistics.Finalize();
-	rangeStatistics.Finalize();
-	speedStatistics.Finalize();
-	combatPowerStat.Finalize();
-	combatEfficiencyStat.Finalize();
+	return selectionData;
+}
+
+const StatisticalData& AAIBuildTable::GetStaticDefenceCombatPowerStatistics(int side, const AAITargetType& targetType) const
+{
+	CombatPowerStatistics& combatPowerStatistics = m_staticDefenceCombatPowerStatistics[(side-1) * AAITargetType::numberOfTargetTypes + targetType.GetArrayIndex()];
 
+	if( (combatPowerStatistics.valid == false) || (combatPowerStatistics.combatPowerGeneration != ai->s_buildTree.GetCombatPowerGeneration()) )
+	{
+		combatPowerStatistics.valid                 = true;
+		combatPowerStatistics.combatPowerGeneration = ai->s_buildTree.GetCombatPowerGeneration();
+		combatPowerStatistics.statistics            = StatisticalData();
+
+		for(auto defence : ai->s_buildTree.GetUnitsInCategory(EUnitCategory::STATIC_DEFENCE, side))
+			combatPowerStatistics.statistics.AddValue( ai->s_buildTree.GetCombatPower(defence).GetValue(targetType) );
+
+		combatPowerStatistics.statistics.Finalize();
+	}
+
+	return combatPowerStatistics.statistics;
+}
+
+const ConstructorSelectionStatistics& AAIBuildTable::GetConstructorSelectionStatistics(UnitDefId unitDefId) const
+{
+	ConstructorSelectionStatistics& constructorStatistics = m_constructorSelectionStatistics[unitDefId.id];
+
+	if(constructorStatistics.valid == false)
+	{
+		constructorStatistics.valid = true;
+
+		for(auto constructor : ai->s_buildTree.GetConstructedByList(unitDefId))
+		{
+			constructorStatistics.costs.AddValue( ai->s_buildTree.GetTotalCost(constructor) );
+			constructorStatistics.buildtimes.AddValue( ai->s_buildTree.GetBuildtime(constructor) );
+			constructorStatistics.buildpower.AddValue( ai->s_buildTree.GetBuildspeed(constructor) );
+		}
+
+		constructorStatistics.costs.Finalize();
+		constructorStatistics.buildtimes.Finalize();
+		constructorStatistics.buildpower.Finalize();
+	}
+
+	return constructorStatistics;
+}
+
+UnitDefId AAIBuildTable::SelectCombatUnit(int side, const AAIMovementType& allowedMoveTypes, const TargetTypeValues& combatPowerCriteria, const UnitSelectionCriteria& unitCriteria, const std::vector<float>& factoryUtilization, int randomness, bool constructorAvailable) const
+{
 	//-----------------------------------------------------------------------------------------------------------------
-	// begin with selection
+	// get data needed for selection
 	//-----------------------------------------------------------------------------------------------------------------
 
-	//ai->Log("Selected combat unit (move type %u): cost %f  range %f   speed %f   power %f   efficiency %f   fact. ut. %f   combat: %f %f %f %f %f\n", static_cast<uint32_t>(allowedMoveTypes.GetMovementType()),
-	//unitCriteria.cost, unitCriteria.range, unitCriteria.speed, unitCriteria.power, unitCriteria.efficiency, unitCriteria.factoryUtilization,
-	//combatPowerCriteria.m_values[0], combatPowerCriteria.m_values[1], combatPowerCriteria.m_values[2], combatPowerCriteria.m_values[3], combatPowerCriteria.m_values[4]);
+	const CombatUnitSelectionData& selectionData = GetCombatUnitSelectionData(side, allowedMoveTypes, constructorAvailable);
 
-	UnitDefId selectedUnitType;
-	float highestRating(0.0f);
-	i = 0;
-	for(const auto& unitDefId : unitList)
+	const int numberOfCandidates = static_cast<int>(selectionData.unitDefIds.size());
+
+	// combat power depends on the given criteria -> weighted sum of combat power columns (processed column by column)
+	std::vector<float> combatPower(numberOfCandidates, 0.0f);
+
+	for(int targetType = 0; targetType < AAITargetType::numberOfTargetTypes; ++targetType)
 	{
-		const UnitTypeProperties& unitData = ai->s_buildTree.GetUnitTypeProperties(unitDefId);
+		const float  weight = combatPowerCriteria.m_values[targetType];
+		const float* column = selectionData.combatPower[targetType].data();
+
+		for(int i = 0; i < numberOfCandidates; ++i)
+			combatPower[i] += column[i] * weight;
+	}
+
+	std::vector<float> combatEfficiency(numberOfCandidates);
+
+	for(int i = 0; i < numberOfCandidates; ++i)
+		combatEfficiency[i] = combatPower[i] / selectionData.costs[i];
+
+	float maxCombatPower(0.0f), maxCombatEfficiency(0.0f);
 
+	for(int i = 0; i < numberOfCandidates; ++i)
+	{
+		maxCombatPower      = std::max(maxCombatPower,      combatPower[i]);
+		maxCombatEfficiency = std::max(maxCombatEfficiency, combatEfficiency[i]);
+	}
+
+	// factory utilization and random values cannot be determined in batches
+	std::vector<float> minFactoryUtilizations(numberOfCandidates);
+	std::vector<float> randomValues(numberOfCandidates);
+
+	for(int i = 0; i < numberOfCandidates; ++i)
+	{
 		float minFactoryUtilization(0.0f);
-		for(const auto& factory : ai->s_buildTree.GetConstructedByList(unitDefId))
+		for(const auto& factory : ai->s_buildTree.GetConstructedByList(selectionData.unitDefIds[i]))
 		{
 			const float utilization = factoryUtilization[ai->s_buildTree.GetUnitTypeProperties(factory).m_factoryId.id];
 
 			if(utilization > minFactoryUtilization)
 				minFactoryUtilization = utilization;
 		}
-			
-		const float combatEff = combatPowerValues[i] / unitData.m_totalCost;
-
-		const float rating =  unitCriteria.cost  * costStatistics.GetDeviationFromMax( unitData.m_totalCost )
-							+ unitCriteria.range * rangeStatistics.GetDeviationFromZero( unitData.m_primaryAbility )
-							+ unitCriteria.speed * speedStatistics.GetDeviationFromZero( unitData.m_secondaryAbility )
-							+ unitCriteria.power * combatPowerStat.GetDeviationFromZero( combatPowerValues[i] )
-							+ unitCriteria.efficiency * combatEfficiencyStat.GetDeviationFromZero( combatEff )
-							+ unitCriteria.factoryUtilization * minFactoryUtilization
-							+ 0.1f * ((float)(rand()%randomness));
-
-		/*ai->Log("%s: %f  -  %f %f %f %f %f %f\n", unitData.m_name.c_str(), rating, 
-												unitCriteria.cost * costStatistics.GetDeviationFromMax(unitData.m_totalCost), 
-												unitCriteria.range * rangeStatistics.GetDeviationFromZero(unitData.m_primaryAbility),
-												unitCriteria.speed * speedStatistics.GetDeviationFromZero(unitData.m_secondaryAbility),
-												unitCriteria.power * combatPowerStat.GetDeviationFromZero(combatPowerValues[i]),
-												unitCriteria.efficiency * combatEfficiencyStat.GetDeviationFromZero(combatEff),
-												minFactoryUtilization);*/
-
-		if(rating > highestRating)
+
+		minFactoryUtilizations[i] = minFactoryUtilization;
+		randomValues[i]           = (float)(ai->Random().NextInt(randomness));
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// calculate ratings and select unit with highest rating
+	//-----------------------------------------------------------------------------------------------------------------
+	const float combatPowerWeight      = (maxCombatPower      != 0.0f) ? unitCriteria.power      : 0.0f;
+	const float combatEfficiencyWeight = (maxCombatEfficiency != 0.0f) ? unitCriteria.efficiency : 0.0f;
+	const float combatPowerNorm        = (maxCombatPower      != 0.0f) ? maxCombatPower          : 1.0f;
+	const float combatEfficiencyNorm   = (maxCombatEfficiency != 0.0f) ? maxCombatEfficiency     : 1.0f;
+
+	std::vector<float> ratings(numberOfCandidates);
+
+	for(int i = 0; i < numberOfCandidates; ++i)
+	{
+		ratings[i] =  unitCriteria.cost       * selectionData.costDeviations[i]
+					+ unitCriteria.range      * selectionData.rangeDeviations[i]
+					+ unitCriteria.speed      * selectionData.speedDeviations[i]
+					+ combatPowerWeight       * (combatPower[i] / combatPowerNorm)
+					+ combatEfficiencyWeight  * (combatEfficiency[i] / combatEfficiencyNorm)
+					+ unitCriteria.factoryUtilization * minFactoryUtilizations[i]
+					+ 0.1f * randomValues[i];
+	}
+
+	UnitDefId selectedUnitType;
+	float highestRating(0.0f);
+
+	for(int i = 0; i < numberOfCandidates; ++i)
+	{
+		if(ratings[i] > highestRating)
 		{
-			highestRating       = rating;
-			selectedUnitType.id = unitDefId.id;
+			highestRating    = ratings[i];
+			selectedUnitType = selectionData.unitDefIds[i];
 		}
-		
-		++i;
 	}
 
-	//ai->Log("Selected: %s\n", ai->s_buildTree.GetUnitTypeProperties(selectedUnitType).m_name.c_str() );
-
 	return selectedUnitType;
 }
 
@@ -1030,20 +1145,11 @@ UnitDefId AAIBuildTable::SelectConstructorFor(UnitDefId unitDefId) const
 	//-----------------------------------------------------------------------------------------------------------------
 	// determine statistical data needed for selection
 	//-----------------------------------------------------------------------------------------------------------------
-	StatisticalData costStatistics;
-	StatisticalData buildtimeStatistics;
-	StatisticalData buildpowerStatistics;
-
-	for(auto constructor : ai->s_buildTree.GetConstructedByList(unitDefId))
-	{
-		costStatistics.AddValue( ai->s_buildTree.GetTotalCost(constructor) );
-		buildtimeStatistics.AddValue( ai->s_buildTree.GetBuildtime(constructor) );
-		buildpowerStatistics.AddValue( ai->s_buildTree.GetBuildspeed(constructor) );
-	}
+	const ConstructorSelectionStatistics& constructorStatistics = GetConstructorSelectionStatistics(unitDefId);
 
-	costStatistics.Finalize();
-	buildtimeStatistics.Finalize();
-	buildpowerStatistics.Finalize();
+	const StatisticalData& costStatistics       = constructorStatistics.costs;
+	const StatisticalData& buildtimeStatistics  = constructorStatistics.buildtimes;
+	const StatisticalData& buildpowerStatistics = constructorStatistics.buildpower;
 
 	//-----------------------------------------------------------------------------------------------------------------
 	// select constructor according to determined criteria
@@ -1145,7 +1251,7 @@ UnitDefId AAIBuildTable::RequestFactoryFor(UnitDefId unitDefId)
 			}
 
 			// debug
-			ai->Log("RequestFactoryFor(%s) requested %s\n", ai->s_buildTree.GetUnitTypeProperties(unitDefId).m_name.c_str(), ai->s_buildTree.GetUnitTypeProperties(selectedConstructor).m_name.c_str());
+			ai->Log(ELogLevel::INFO, ELogCategory::BUILD_TABLE, "RequestFactoryFor(%s) requested %s\n", ai->s_buildTree.GetUnitTypeProperties(unitDefId).m_name.c_str(), ai->s_buildTree.GetUnitTypeProperties(selectedConstructor).m_name.c_str());
 		}
 		// mobile constructor requested
 		else
@@ -1153,7 +1259,7 @@ UnitDefId AAIBuildTable::RequestFactoryFor(UnitDefId unitDefId)
 			const bool successful = RequestMobileConstructor(selectedConstructor);
 
 			if(successful)
-				ai->Log("RequestFactoryFor(%s) requested %s\n", ai->s_buildTree.GetUnitTypeProperties(unitDefId).m_name.c_str(), ai->s_buildTree.GetUnitTypeProperties(selectedConstructor).m_name.c_str());
+				ai->Log(ELogLevel::INFO, ELogCategory::BUILD_TABLE, "RequestFactoryFor(%s) requested %s\n", ai->s_buildTree.GetUnitTypeProperties(unitDefId).m_name.c_str(), ai->s_buildTree.GetUnitTypeProperties(selectedConstructor).m_name.c_str());
 			//else
 			//	ai->Log("RequestFactoryFor(%s) failed to request %s\n", ai->s_buildTree.GetUnitTypeProperties(unitDefId).m_name.c_str(), ai->s_buildTree.GetUnitTypeProperties(selectedConstructor).m_name.c_str());
 		}
@@ -1171,7 +1277,7 @@ void AAIBuildTable::RequestBuilderFor(UnitDefId building)
 		const bool successful = RequestMobileConstructor(selectedBuilder);
 
 		if(successful)
-			ai->Log("RequestBuilderFor(%s) requested %s\n", ai->s_buildTree.GetUnitTypeProperties(building).m_name.c_str(), ai->s_buildTree.GetUnitTypeProperties(selectedBuilder).m_name.c_str());
+			ai->Log(ELogLevel::INFO, ELogCategory::BUILD_TABLE, "RequestBuilderFor(%s) requested %s\n", ai->s_buildTree.GetUnitTypeProperties(building).m_name.c_str(), ai->s_buildTree.GetUnitTypeProperties(selectedBuilder).m_name.c_str());
 		//else
 		//	ai->Log("RequestBuilderFor(%s) failed to request %s\n", ai->s_buildTree.GetUnitTypeProperties(building).m_name.c_str(), ai->s_buildTree.GetUnitTypeProperties(selectedBuilder).m_name.c_str());
 	}
@@ -16,9 +16,12 @@ class AAI;
 #include "AAIBuildTree.h"
 #include "AAIUnitTypes.h"
 #include <assert.h>
+#include <array>
+#include <cstdint>
 #include <list>
 #include <vector>
 #include <string>
+#include <unordered_map>
 
 //using namespace std;
 
@@ -100,6 +103,64 @@ struct ExtractorSelectionCriteria
 	float armed;          //!< Extra rating if extractor is armed
 };
 
+//! Candidates for the selection of combat units stored as structure of arrays (one column per criterion) to allow batched
+//! (vectorisable) calculation of the ratings. Only changes with availability of constructors (candidates) or combat power.
+struct CombatUnitSelectionData
+{
+	CombatUnitSelectionData() : constructorAvailabilityGeneration(0u), combatPowerGeneration(0u), combatPowerValid(false) {}
+
+	//! The generation of constructor availability the candidates have been determined for
+	unsigned int           constructorAvailabilityGeneration;
+
+	//! The generation of combat power the combat power columns have been determined for
+	unsigned int           combatPowerGeneration;
+
+	//! Whether combat power columns have been determined
+	bool                   combatPowerValid;
+
+	//! The unit types that may be selected
+	std::vector<UnitDefId> unitDefIds;
+
+	//! Total cost of every candidate
+	std::vector<float>     costs;
+
+	//! Deviation of cost from max cost of all candidates (normalized)
+	std::vector<float>     costDeviations;
+
+	//! Deviation of range (primary ability) from zero (normalized)
+	std::vector<float>     rangeDeviations;
+
+	//! Deviation of speed (secondary ability) from zero (normalized)
+	std::vector<float>     speedDeviations;
+
+	//! Combat power of every candidate, one column per target type
+	std::array<std::vector<float>, AAITargetType::numberOfTargetTypes> combatPower;
+};
+
+//! Statistical data of a property of a group of unit types and the combat power generation it has been determined for
+struct CombatPowerStatistics
+{
+	CombatPowerStatistics() : valid(false), combatPowerGeneration(0u) {}
+
+	bool            valid;
+
+	unsigned int    combatPowerGeneration;
+
+	StatisticalData statistics;
+};
+
+//! Statistics of the constructors of a unit type used to select the most suitable constructor (static data, determined on first request)
+struct ConstructorSelectionStatistics
+{
+	ConstructorSelectionStatistics() : valid(false) {}
+
+	bool            valid;
+
+	StatisticalData costs;
+	StatisticalData buildtimes;
+	StatisticalData buildpower;
+};
+
 //! Data used to calculate rating of factories
 class FactoryRatingInputData
 {
@@ -254,7 +315,16 @@ private:
 	bool IsBuildingSelectable(UnitDefId building, bool water, bool mustBeConstructable) const;
 
 	//! @brief Adds combat units matching the given criteria to the list
-	void SelectCombatUnits(std::list<UnitDefId>& unitList, int side, const AAIMovementType& allowedMoveTypes, bool constructorAvailable) const;
+	void SelectCombatUnits(std::vector<UnitDefId>& unitList, int side, const AAIMovementType& allowedMoveTypes, bool constructorAvailable) const;
+
+	//! @brief Returns the (cached) candidates and their statistics for the selection of combat units matching the given criteria
+	const CombatUnitSelectionData& GetCombatUnitSelectionData(int side, const AAIMovementType& allowedMoveTypes, bool constructorAvailable) const;
+
+	//! @brief Returns the (cached) statistics of the combat power of the static defences of the given side against the given target type
+	const StatisticalData& GetStaticDefenceCombatPowerStatistics(int side, const AAITargetType& targetType) const;
+
+	//! @brief Returns the (cached) statistics of the constructors of the given unit type
+	const ConstructorSelectionStatistics& GetConstructorSelectionStatistics(UnitDefId unitDefId) const;
 
 	//! @brief Returns a power plant based on the given criteria
 	UnitDefId SelectPowerPlant(int side, const PowerPlantSelectionCriteria& selectionCriteria, bool water, bool mustBeConstructable) const;
@@ -289,6 +359,18 @@ private:
 	//! Rates of attacks by different combat categories per map and game phase
 	static AttackedByRatesPerGamePhaseAndMapType s_attackedByRates;
 
+	//! Incremented whenever the number of available constructors for any unit type changes (invalidates cached selection data)
+	unsigned int m_constructorAvailabilityGeneration;
+
+	//! Cached combat unit selection data (key combines side, allowed movement types, and whether a constructor must be available)
+	mutable std::unordered_map<uint64_t, CombatUnitSelectionData> m_combatUnitSelectionData;
+
+	//! Cached combat power statistics of static defences for every side and target type
+	mutable std::vector<CombatPowerStatistics> m_staticDefenceCombatPowerStatistics;
+
+	//! Cached statistics of the constructors for every unit type
+	mutable std::vector<ConstructorSelectionStatistics> m_constructorSelectionStatistics;
+
 	AAI *ai;
 
 	// all the unit defs, FIXME: this can't be made static as spring seems to free the memory returned by GetUnitDefList()
@@ -0,0 +1,129 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include <algorithm>
+#include <new>
+
+#include "AAIBuildTaskRegistry.h"
+
+AAIBuildTaskRegistry::AAIBuildTaskRegistry(int maxUnits) :
+	m_firstFreeNode(-1),
+	m_firstNode(-1),
+	m_lastNode(-1),
+	m_numberOfBuildTasks(0)
+{
+	m_nodeOfUnit.resize(maxUnits, -1);
+}
+
+AAIBuildTaskRegistry::~AAIBuildTaskRegistry(void)
+{
+	Clear();
+}
+
+AAIBuildTask* AAIBuildTaskRegistry::AddBuildTask(UnitId unitId, UnitDefId unitDefId, const float3& buildsite, UnitId constructor)
+{
+	// there may be only one task per unit
+	RemoveBuildTask(unitId);
+
+	if(unitId.id >= static_cast<int>(m_nodeOfUnit.size()))
+		m_nodeOfUnit.resize(unitId.id + 1, -1);
+
+	// allocate new slab if no unused nodes left
+	if(m_firstFreeNode < 0)
+	{
+		const int firstIndex = static_cast<int>(m_slabs.size()) * s_nodesPerSlab;
+		m_slabs.push_back( std::unique_ptr<Node[]>(new Node[s_nodesPerSlab]) );
+
+		for(int i = 0; i < s_nodesPerSlab; ++i)
+			GetNode(firstIndex + i).next = (i < s_nodesPerSlab - 1) ? (firstIndex + i + 1) : -1;
+
+		m_firstFreeNode = firstIndex;
+	}
+
+	const int index = m_firstFreeNode;
+	Node& node = GetNode(index);
+	m_firstFreeNode = node.next;
+
+	new (&node.storage) AAIBuildTask(unitId, unitDefId, buildsite, constructor);
+
+	// append to list of tasks
+	node.previous = m_lastNode;
+	node.next     = -1;
+
+	if(m_lastNode >= 0)
+		GetNode(m_lastNode).next = index;
+	else
+		m_firstNode = index;
+
+	m_lastNode = index;
+
+	m_nodeOfUnit[unitId.id] = index;
+	++m_numberOfBuildTasks;
+
+	return node.Task();
+}
+
+AAIBuildTask* AAIBuildTaskRegistry::GetBuildTask(UnitId unitId) const
+{
+	if( unitId.IsValid() && (unitId.id < static_cast<int>(m_nodeOfUnit.size())) && (m_nodeOfUnit[unitId.id] >= 0) )
+		return GetNode(m_nodeOfUnit[unitId.id]).Task();
+	else
+		return nullptr;
+}
+
+void AAIBuildTaskRegistry::RemoveBuildTask(UnitId unitId)
+{
+	if( (unitId.IsValid() == false) || (unitId.id >= static_cast<int>(m_nodeOfUnit.size())) || (m_nodeOfUnit[unitId.id] < 0) )
+		return;
+
+	const int index = m_nodeOfUnit[unitId.id];
+	Node& node = GetNode(index);
+
+	node.Task()->~AAIBuildTask();
+
+	// unlink from list of tasks
+	if(node.previous >= 0)
+		GetNode(node.previous).next = node.next;
+	else
+		m_firstNode = node.next;
+
+	if(node.next >= 0)
+		GetNode(node.next).previous = node.previous;
+	else
+		m_lastNode = node.previous;
+
+	// return node to pool
+	node.next       = m_firstFreeNode;
+	m_firstFreeNode = index;
+
+	m_nodeOfUnit[unitId.id] = -1;
+	--m_numberOfBuildTasks;
+}
+
+void AAIBuildTaskRegistry::Clear()
+{
+	for(int index = m_firstNode; index >= 0; )
+	{
+		Node& node = GetNode(index);
+		const int next = node.next;
+
+		node.Task()->~AAIBuildTask();
+
+		node.next       = m_firstFreeNode;
+		m_firstFreeNode = index;
+
+		index = next;
+	}
+
+	std::fill(m_nodeOfUnit.begin(), m_nodeOfUnit.end(), -1);
+
+	m_firstNode = -1;
+	m_lastNode  = -1;
+	m_numberOfBuildTasks = 0;
+}
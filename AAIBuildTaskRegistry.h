@@ -0,0 +1,102 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_BUILDTASKREGISTRY_H
+#define AAI_BUILDTASKREGISTRY_H
+
+#include <vector>
+#include <memory>
+#include <type_traits>
+
+#include "System/float3.h"
+#include "aidef.h"
+#include "AAIBuildTask.h"
+
+//! @brief Stores the build tasks (i.e. buildings currently under construction) of an AAI instance. Tasks are allocated from slabs
+//!        of fixed size (recycled via a free list) and indexed by the unit id of the building, i.e. lookup, insertion, and removal take
+//!        constant time. Tasks are linked in order of creation to allow iteration in a stable order.
+class AAIBuildTaskRegistry
+{
+private:
+	//! Element of the pool; storage for one task and the links to the previous/next task (in order of creation)
+	struct Node
+	{
+		typename std::aligned_storage<sizeof(AAIBuildTask), alignof(AAIBuildTask)>::type storage;
+
+		AAIBuildTask* Task() { return reinterpret_cast<AAIBuildTask*>(&storage); }
+
+		//! Index of the previous/next task (or next free node if unused), -1 if none
+		int previous, next;
+	};
+
+public:
+	//! Iterates over all build tasks in order of creation
+	class Iterator
+	{
+	public:
+		Iterator(const AAIBuildTaskRegistry* registry, int node) : m_registry(registry), m_node(node) {}
+
+		AAIBuildTask* operator*() const { return m_registry->GetNode(m_node).Task(); }
+
+		Iterator& operator++() { m_node = m_registry->GetNode(m_node).next; return *this; }
+
+		bool operator!=(const Iterator& other) const { return m_node != other.m_node; }
+
+	private:
+		const AAIBuildTaskRegistry* m_registry;
+
+		int m_node;
+	};
+
+	AAIBuildTaskRegistry(int maxUnits);
+
+	~AAIBuildTaskRegistry(void);
+
+	//! @brief Creates a new build task for the given unit (unit id must not belong to another build task)
+	AAIBuildTask* AddBuildTask(UnitId unitId, UnitDefId unitDefId, const float3& buildsite, UnitId constructor);
+
+	//! @brief Returns the build task of the given unit (nullptr if there is none)
+	AAIBuildTask* GetBuildTask(UnitId unitId) const;
+
+	//! @brief Deletes the build task of the given unit (if there is one)
+	void RemoveBuildTask(UnitId unitId);
+
+	//! @brief Deletes all build tasks
+	void Clear();
+
+	//! @brief Returns the number of build tasks
+	int GetNumberOfBuildTasks() const { return m_numberOfBuildTasks; }
+
+	Iterator begin() const { return Iterator(this, m_firstNode); }
+
+	Iterator end() const { return Iterator(this, -1); }
+
+private:
+	Node& GetNode(int index) const { return m_slabs[index / s_nodesPerSlab][index % s_nodesPerSlab]; }
+
+	//! Number of nodes that are allocated at once
+	static const int s_nodesPerSlab = 64;
+
+	//! The slabs the nodes are allocated from
+	std::vector< std::unique_ptr<Node[]> > m_slabs;
+
+	//! Index of the node storing the build task for a unit (-1 if there is none), accessed by unit id
+	std::vector<int> m_nodeOfUnit;
+
+	//! Index of first unused node (-1 if all nodes of all slabs are in use)
+	int m_firstFreeNode;
+
+	//! Index of the oldest/newest build task (-1 if none)
+	int m_firstNode, m_lastNode;
+
+	//! Number of build tasks currently stored
+	int m_numberOfBuildTasks;
+};
+
+#endif
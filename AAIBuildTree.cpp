@@ -27,7 +27,9 @@ using namespace springLegacyAI;
 
 AAIBuildTree::AAIBuildTree() :
 	m_initialized(false),
-	m_numberOfSides(0)
+	m_wordsPerBitset(0),
+	m_numberOfSides(0),
+	m_combatPowerGeneration(0u)
 {
 	m_unitCategoryNames.resize(AAIUnitCategory::numberOfUnitCategories);
 	m_unitCategoryNames[AAIUnitCategory(EUnitCategory::UNKNOWN).GetArrayIndex()].append("Unknown");
@@ -59,6 +61,7 @@ AAIBuildTree::~AAIBuildTree(void)
 	m_initialized = false;
 	m_unitTypeCanBeConstructedtByLists.clear();
 	m_unitTypeCanConstructLists.clear();
+	m_canConstructBitsets.clear();
 	m_unitTypeProperties.clear();
 	m_sideOfUnitType.clear();
 	m_startUnitsOfSide.clear();
@@ -101,6 +104,7 @@ bool AAIBuildTree::LoadCombatPowerOfUnits(FILE* inputFile)
 		m_combatPowerOfUnits[id][ETargetType::STATIC]    = inputValues[4];
 	}
 
+	++m_combatPowerGeneration;
 	UpdateUnitTypesOfCombatUnits();
 
 	return true;
@@ -218,6 +222,7 @@ void AAIBuildTree::InitCombatPowerOfUnits(springLegacyAI::IAICallback* cb)
 		}
 	}
 
+	++m_combatPowerGeneration;
 	UpdateUnitTypesOfCombatUnits();
 }
 
@@ -275,6 +280,8 @@ float AAIBuildTree::CalculateCombatPowerChange(UnitDefId attackerUnitDefId, Unit
 
 void AAIBuildTree::UpdateCombatPowerStatistics(UnitDefId attackerUnitDefId, UnitDefId killedUnitDefId)
 {
+	++m_combatPowerGeneration;
+
 	const AAIUnitCategory& attackerCategory = GetUnitCategory(attackerUnitDefId);
 	const AAIUnitCategory& killedCategory   = GetUnitCategory(killedUnitDefId);
 
@@ -323,6 +330,8 @@ bool AAIBuildTree::Generate(springLegacyAI::IAICallback* cb)
 	// unit ids start with 1 -> add one additional element to arrays to be able to directly access unit def with corresponding id
 	m_unitTypeCanBeConstructedtByLists.resize(numberOfUnitTypes+1);
 	m_unitTypeCanConstructLists.resize(numberOfUnitTypes+1);
+	m_wordsPerBitset = (numberOfUnitTypes + 64) / 64;
+	m_canConstructBitsets.resize((numberOfUnitTypes+1) * m_wordsPerBitset, 0u);
 	m_unitTypeProperties.resize(numberOfUnitTypes+1);
 	m_sideOfUnitType.resize(numberOfUnitTypes+1, 0);
 	m_combatPowerOfUnits.resize(numberOfUnitTypes+1);
@@ -348,6 +357,7 @@ bool AAIBuildTree::Generate(springLegacyAI::IAICallback* cb)
 
 			m_unitTypeCanConstructLists[id].push_back( UnitDefId(canConstructId) );
 			m_unitTypeCanBeConstructedtByLists[canConstructId].push_back( UnitDefId(id) );
+			m_canConstructBitsets[id * m_wordsPerBitset + (canConstructId >> 6)] |= (uint64_t(1) << (canConstructId & 63));
 		}
 	}
 
@@ -1094,19 +1104,6 @@ float AAIBuildTree::GetMaxDamage(const springLegacyAI::UnitDef* unitDef) const
 	return maxDamage;
 }
 
-bool AAIBuildTree::CanBuildUnitType(UnitDefId unitDefIdBuilder, UnitDefId unitDefId) const
-{
-    // look in build options of builder for unit type
-    for(std::list<UnitDefId>::const_iterator id = m_unitTypeCanConstructLists[unitDefIdBuilder.id].begin(); id != m_unitTypeCanConstructLists[unitDefIdBuilder.id].end(); ++id)
-    {
-        if((*id).id == unitDefId.id)
-            return true;
-    }
-
-    // unit type not found in build options
-    return false;
-}
-
 bool AAIBuildTree::IsStartingUnit(UnitDefId unitDefId) const
 {
     if(m_initialized == false)
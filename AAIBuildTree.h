@@ -16,6 +16,7 @@
 #include "LegacyCpp/IAICallback.h"
 
 #include <stdio.h>
+#include <cstdint>
 #include <list>
 #include <vector>
 
@@ -46,7 +47,11 @@ public:
 	void PrintSummaryToFile(const std::string& filename, springLegacyAI::IAICallback* cb) const;
 
 	//! @brief Returns whether given the given unit type can be constructed by the given constructor unit type
-	bool CanBuildUnitType(UnitDefId unitDefIdBuilder, UnitDefId unitDefId) const;
+	bool CanBuildUnitType(UnitDefId unitDefIdBuilder, UnitDefId unitDefId) const
+	{
+		const uint64_t word = m_canConstructBitsets[unitDefIdBuilder.id * m_wordsPerBitset + (unitDefId.id >> 6)];
+		return ( (word >> (unitDefId.id & 63)) & 1u ) != 0u;
+	}
 
 	//! @brief Return side of given unit type (0 if not initialized)
 	int GetSideOfUnitType(UnitDefId unitDefId) const { return m_initialized ? m_sideOfUnitType[unitDefId.id] : 0; }
@@ -129,6 +134,9 @@ public:
 	//! @brief Returns the corresponding human readable name of the given category
 	const std::string& GetCategoryName(const AAIUnitCategory& category) const { return m_unitCategoryNames[category.GetArrayIndex()]; }
 
+	//! @brief Returns the current generation of combat power values (changes whenever the combat power of any unit type has been updated)
+	unsigned int GetCombatPowerGeneration() const { return m_combatPowerGeneration; }
+
 private:
 	//! @brief Sets side for given unit type, and recursively calls itself for all unit types that can be constructed by it.
 	void AssignSideToUnitType(int side, UnitDefId unitDefId);
@@ -186,6 +194,12 @@ private:
 	//! For every unit type, a list of unit types (unit type id) that it may contsruct (e.g. empty if it cannot construct any units) 
 	std::vector< std::list<UnitDefId> >           m_unitTypeCanConstructLists;
 
+	//! For every unit type, a bitset (m_wordsPerBitset words, bit i set if unit type with id i can be constructed) of the unit types it may construct
+	std::vector<uint64_t>                         m_canConstructBitsets;
+
+	//! Number of 64 bit words of the bitset of every unit type
+	int                                           m_wordsPerBitset;
+
 	//! Properties of every unit type needed by other parts of AAI for decision making
 	std::vector< UnitTypeProperties >             m_unitTypeProperties;
 
@@ -213,6 +227,9 @@ private:
 	//! The combat power of every unit
 	std::vector<TargetTypeValues>                 m_combatPowerOfUnits;
 
+	//! Incremented whenever combat power values change (used to invalidate data derived from combat power, e.g. cached statistics)
+	unsigned int                                  m_combatPowerGeneration;
+
 	//! This vetcor stores the UnitDefIds corresponding to any valid factory id
 	std::vector<UnitDefId>                        m_factoryIdsTable;
 };
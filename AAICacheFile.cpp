@@ -0,0 +1,171 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include "AAICacheFile.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+
+AAICacheFile::AAICacheFile(const char* version, uint32_t mapHash, int xMapSize, int yMapSize)
+{
+	std::memset(&m_header, 0, sizeof(CacheFileHeader));
+	std::strncpy(m_header.version, version, sizeof(m_header.version) - 1);
+	m_header.mapHash          = mapHash;
+	m_header.xMapSize         = xMapSize;
+	m_header.yMapSize         = yMapSize;
+	m_header.numberOfSections = 0;
+}
+
+void AAICacheFile::AddSection(const void* data, size_t size)
+{
+	CacheFileSection section;
+	section.offset = static_cast<uint32_t>(m_data.size());
+	section.size   = static_cast<uint32_t>(size);
+	section.crc    = CalculateCRC(static_cast<const char*>(data), size);
+
+	m_sections.push_back(section);
+	m_data.insert(m_data.end(), static_cast<const char*>(data), static_cast<const char*>(data) + size);
+}
+
+bool AAICacheFile::Write(const std::string& filename) const
+{
+	FILE* file = fopen(filename.c_str(), "wb");
+
+	if(file == nullptr)
+		return false;
+
+	CacheFileHeader header(m_header);
+	header.numberOfSections = static_cast<uint32_t>(m_sections.size());
+
+	bool successful = (fwrite(&header, sizeof(CacheFileHeader), 1, file) == 1);
+
+	if(successful && !m_sections.empty())
+		successful = (fwrite(m_sections.data(), sizeof(CacheFileSection), m_sections.size(), file) == m_sections.size());
+
+	if(successful && !m_data.empty())
+		successful = (fwrite(m_data.data(), 1, m_data.size(), file) == m_data.size());
+
+	fclose(file);
+
+	return successful;
+}
+
+bool AAICacheFile::Read(const std::string& filename, int expectedNumberOfSections)
+{
+	FILE* file = fopen(filename.c_str(), "rb");
+
+	if(file == nullptr)
+		return false;
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// check if file matches version, map, and expected content
+	//-----------------------------------------------------------------------------------------------------------------
+	CacheFileHeader header;
+
+	const bool headerValid =    (fread(&header, sizeof(CacheFileHeader), 1, file) == 1)
+							 && (std::strncmp(header.version, m_header.version, sizeof(header.version)) == 0)
+							 && (header.mapHash  == m_header.mapHash)
+							 && (header.xMapSize == m_header.xMapSize)
+							 && (header.yMapSize == m_header.yMapSize)
+							 && (header.numberOfSections == static_cast<uint32_t>(expectedNumberOfSections));
+
+	if(headerValid == false)
+	{
+		fclose(file);
+		return false;
+	}
+
+	std::vector<CacheFileSection> sections(header.numberOfSections);
+
+	if( !sections.empty() && (fread(sections.data(), sizeof(CacheFileSection), sections.size(), file) != sections.size()) )
+	{
+		fclose(file);
+		return false;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// read data of all sections at once and verify checksums
+	//-----------------------------------------------------------------------------------------------------------------
+	size_t dataSize(0);
+
+	for(const auto& section : sections)
+		dataSize = std::max(dataSize, static_cast<size_t>(section.offset) + static_cast<size_t>(section.size));
+
+	// reject truncated/corrupted files before allocating memory
+	const long dataStart = ftell(file);
+	fseek(file, 0, SEEK_END);
+	const long fileSize = ftell(file);
+	fseek(file, dataStart, SEEK_SET);
+
+	if( (dataStart < 0) || (fileSize < dataStart) || (static_cast<size_t>(fileSize - dataStart) != dataSize) )
+	{
+		fclose(file);
+		return false;
+	}
+
+	std::vector<char> data(dataSize);
+
+	const bool dataRead = (dataSize == 0) || (fread(data.data(), 1, dataSize, file) == dataSize);
+	fclose(file);
+
+	if(dataRead == false)
+		return false;
+
+	for(const auto& section : sections)
+	{
+		if(CalculateCRC(data.data() + section.offset, section.size) != section.crc)
+			return false;
+	}
+
+	m_sections.swap(sections);
+	m_data.swap(data);
+
+	return true;
+}
+
+bool AAICacheFile::CopySection(int section, void* data, size_t size) const
+{
+	if( (section < 0) || (section >= GetNumberOfSections()) || (GetSectionSize(section) != size) )
+		return false;
+
+	if(size > 0)
+		std::memcpy(data, GetSectionData(section), size);
+
+	return true;
+}
+
+uint32_t AAICacheFile::CalculateCRC(const char* data, size_t size)
+{
+	// lookup table for the standard CRC32 polynomial (reversed representation)
+	static const std::array<uint32_t, 256> crcTable = []()
+	{
+		std::array<uint32_t, 256> table;
+
+		for(uint32_t i = 0; i < 256; ++i)
+		{
+			uint32_t crc = i;
+
+			for(int bit = 0; bit < 8; ++bit)
+				crc = (crc & 1u) ? (0xEDB88320u ^ (crc >> 1)) : (crc >> 1);
+
+			table[i] = crc;
+		}
+
+		return table;
+	}();
+
+	uint32_t crc = 0xFFFFFFFFu;
+
+	for(size_t i = 0; i < size; ++i)
+		crc = crcTable[(crc ^ static_cast<uint8_t>(data[i])) & 0xFFu] ^ (crc >> 8);
+
+	return crc ^ 0xFFFFFFFFu;
+}
@@ -0,0 +1,93 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_CACHEFILE_H
+#define AAI_CACHEFILE_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+//! Header of a binary cache file
+struct CacheFileHeader
+{
+	//! Format version of the file (zero terminated)
+	char     version[32];
+
+	//! Hash of the map the stored data belong to
+	uint32_t mapHash;
+
+	//! Horizontal size of the map (in map tiles)
+	int32_t  xMapSize;
+
+	//! Vertical size of the map (in map tiles)
+	int32_t  yMapSize;
+
+	//! Number of sections stored in the file
+	uint32_t numberOfSections;
+};
+
+//! Location and checksum of a section of a binary cache file
+struct CacheFileSection
+{
+	//! Offset of the section (in bytes, relative to the start of the section data)
+	uint32_t offset;
+
+	//! Size of the section in bytes
+	uint32_t size;
+
+	//! CRC32 checksum of the data of the section
+	uint32_t crc;
+};
+
+//! A binary cache file consists of a header (format version, map hash, map dimensions), a table of sections
+//! (offset, size, and CRC32 checksum of every section) and the data of the sections. The data of all sections
+//! is read/written with one bulk operation.
+class AAICacheFile
+{
+public:
+	AAICacheFile(const char* version, uint32_t mapHash, int xMapSize, int yMapSize);
+
+	//! @brief Appends a section containing the given data (call for every section before writing the file)
+	void AddSection(const void* data, size_t size);
+
+	//! @brief Writes header, section table, and data to the given file; returns whether successful
+	bool Write(const std::string& filename) const;
+
+	//! @brief Reads the given file; returns false if file could not be read, does not match the version/map or if any checksum is incorrect
+	bool Read(const std::string& filename, int expectedNumberOfSections);
+
+	//! @brief Returns the number of sections
+	int GetNumberOfSections() const { return static_cast<int>(m_sections.size()); }
+
+	//! @brief Returns the size (in bytes) of the given section
+	size_t GetSectionSize(int section) const { return m_sections[section].size; }
+
+	//! @brief Returns the data of the given section
+	const char* GetSectionData(int section) const { return m_data.data() + m_sections[section].offset; }
+
+	//! @brief Copies the data of the given section to the given buffer; returns false (without copying) if size of section does not match
+	bool CopySection(int section, void* data, size_t size) const;
+
+	//! @brief Calculates the CRC32 checksum of the given data
+	static uint32_t CalculateCRC(const char* data, size_t size);
+
+private:
+	//! The header of the file
+	CacheFileHeader               m_header;
+
+	//! Location and checksum of the sections
+	std::vector<CacheFileSection> m_sections;
+
+	//! The data of all sections
+	std::vector<char>             m_data;
+};
+
+#endif
@@ -9,6 +9,7 @@
 
 #include "AAIConfig.h"
 #include "AAI.h"
+#include "AAILogger.h"
 #include "System/SafeCStrings.h"
 #include "System/StringUtil.h"
 
@@ -21,6 +22,8 @@
 
 #include "LegacyCpp/UnitDef.h"
 
+#include <algorithm>
+
 AAIConfig* AAIConfig::m_config = nullptr;
 
 static bool IsFSGoodChar(const char c) {
@@ -57,7 +60,7 @@ int AAIConfig::ReadNextInteger(AAI* ai, FILE* file)
 	int value(0);
 	const int result = fscanf(file, "%i", &value);
 	if (result != 1)
-		ai->Log("Error while parsing config");
+		ai->Log(ELogLevel::FAILURE, ELogCategory::GENERAL, "Could not parse value in config file\n");
 
 	return value;
 }
@@ -67,7 +70,7 @@ float AAIConfig::ReadNextFloat(AAI* ai, FILE* file)
 	float value(0.0f);
 	const int result = fscanf(file, "%f", &value);
 	if (result != 1) {
-		ai->Log("Error while parsing config");
+		ai->Log(ELogLevel::FAILURE, ELogCategory::GENERAL, "Could not parse value in config file\n");
 	}
 
 	return value;
@@ -79,7 +82,7 @@ std::string AAIConfig::ReadNextString(AAI* ai, FILE* file)
 	const int result = fscanf(file, "%s", buffer);
 	if (result != 1)
 	{
-		ai->Log("Error while parsing config");
+		ai->Log(ELogLevel::FAILURE, ELogCategory::GENERAL, "Could not parse value in config file\n");
 		buffer[0] = 0;
 	}
 
@@ -167,8 +170,16 @@ AAIConfig::AAIConfig() :
 
 	LEARN_RATE = 5;
 	CLIFF_SLOPE = 0.085f;
+	TERRAIN_DETECTION_RANGE = 6;
+	MAP_ANALYSIS_THREADS = 0;
+	FRAME_TIME_BUDGET = 2000;
 	WATER_MAP_RATIO = 0.8f;
 	LAND_WATER_MAP_RATIO = 0.3f;
+	EXPORT_CONTINENT_MAP = false;
+	RECORD_EVENTS = false;
+	LOG_LEVEL = 1;
+	PROFILER_SPIKE_THRESHOLD = 20000;
+	RANDOM_SEED = 0;
 }
 
 std::string AAIConfig::GetFileName(springLegacyAI::IAICallback* cb, const std::string& filename, const std::string& prefix, const std::string& suffix, bool write) const
@@ -241,9 +252,12 @@ bool AAIConfig::LoadGameConfig(AAI *ai)
 
 	if (file == NULL)
 	{
-		ai->Log("ERROR: Unable to find mod config file (required). Possible file names:\n");
+		// file names in one message (every message of failure level is tagged)
+		std::string filenames;
 		for(const auto& filename : possibleConfigFilenames)
-			ai->Log("%s\n", filename.c_str());
+			filenames += "\n" + filename;
+
+		ai->Log(ELogLevel::FAILURE, ELogCategory::GENERAL, "Unable to find mod config file (required). Possible file names:%s\n", filenames.c_str());
 		return false;
    	}
 
@@ -391,16 +405,17 @@ bool AAIConfig::LoadGameConfig(AAI *ai)
 
 	if(errorOccurred)
 	{
-		ai->Log("Mod config file %s contains erroneous keyword: %s\n", configfile.c_str(), keyword);
+		ai->Log(ELogLevel::FAILURE, ELogCategory::GENERAL, "Mod config file %s contains erroneous keyword: %s\n", configfile.c_str(), keyword);
 		return false;
 	}
 
 	if(unknownUnits.empty() == false)
 	{
-		ai->Log("Warning: The following unknown units were found when loading the mod configuration:\n");
-		for(auto unitName : unknownUnits)
-			ai->Log("%s ", unitName.c_str());
-		ai->Log("\n");
+		std::string unitNames;
+		for(const auto& unitName : unknownUnits)
+			unitNames += unitName + " ";
+
+		ai->Log(ELogLevel::WARNING, ELogCategory::GENERAL, "The following unknown units were found when loading the mod configuration:\n%s\n", unitNames.c_str());
 	}
 
 	fclose(file);
@@ -420,7 +435,7 @@ bool AAIConfig::LoadGeneralConfig(AAI* ai)
 	FILE* file = fopen(filename.c_str(), "r");
 
 	if(file == NULL) {
-		ai->Log("ERROR: Couldn't load general config file %s\n", filename.c_str());
+		ai->Log(ELogLevel::FAILURE, ELogCategory::GENERAL, "Couldn't load general config file %s\n", filename.c_str());
 		return false;
 	}
 
@@ -435,6 +450,22 @@ bool AAIConfig::LoadGeneralConfig(AAI* ai)
 			WATER_MAP_RATIO = ReadNextFloat(ai, file);
 		} else if(!strcmp(keyword, "LAND_WATER_MAP_RATIO")) {
 			LAND_WATER_MAP_RATIO = ReadNextFloat(ai, file);
+		} else if(!strcmp(keyword, "TERRAIN_DETECTION_RANGE")) {
+			TERRAIN_DETECTION_RANGE = std::max(1, ReadNextInteger(ai, file));
+		} else if(!strcmp(keyword, "MAP_ANALYSIS_THREADS")) {
+			MAP_ANALYSIS_THREADS = std::max(0, ReadNextInteger(ai, file));
+		} else if(!strcmp(keyword, "FRAME_TIME_BUDGET")) {
+			FRAME_TIME_BUDGET = std::max(0, ReadNextInteger(ai, file));
+		} else if(!strcmp(keyword, "EXPORT_CONTINENT_MAP")) {
+			EXPORT_CONTINENT_MAP = (ReadNextInteger(ai, file) != 0);
+		} else if(!strcmp(keyword, "PROFILER_SPIKE_THRESHOLD")) {
+			PROFILER_SPIKE_THRESHOLD = std::max(0, ReadNextInteger(ai, file));
+		} else if(!strcmp(keyword, "LOG_LEVEL")) {
+			LOG_LEVEL = std::min(std::max(0, ReadNextInteger(ai, file)), 3);
+		} else if(!strcmp(keyword, "RECORD_EVENTS")) {
+			RECORD_EVENTS = (ReadNextInteger(ai, file) != 0);
+		} else if(!strcmp(keyword, "RANDOM_SEED")) {
+			RANDOM_SEED = std::max(0, ReadNextInteger(ai, file));
 		}
 		else 
 		{
@@ -446,7 +477,7 @@ bool AAIConfig::LoadGeneralConfig(AAI* ai)
 	fclose(file);
 
 	if(errorOccurred) {
-		ai->Log("General config file contains erroneous keyword %s\n", keyword);
+		ai->Log(ELogLevel::FAILURE, ELogCategory::GENERAL, "General config file contains erroneous keyword %s\n", keyword);
 		return false;
 	}
 	ai->Log("General config file loaded\n");
@@ -459,7 +490,7 @@ const springLegacyAI::UnitDef* AAIConfig::GetUnitDef(AAI* ai, const std::string&
 	const springLegacyAI::UnitDef* unitDef = ai->GetAICallback()->GetUnitDef(name.c_str());
 
 	if (unitDef == nullptr)
-		ai->Log("ERROR: loading unit - could not find unit %s\n", name.c_str());
+		ai->Log(ELogLevel::FAILURE, ELogCategory::GENERAL, "Loading unit - could not find unit %s\n", name.c_str());
 
 	return unitDef;
 }
@@ -139,10 +139,20 @@ public:
 
 	// internal
 	float CLIFF_SLOPE;  // cells with greater slope will be considered to be cliffs
+	int   TERRAIN_DETECTION_RANGE; // range (in plateau map tiles) within which height differences are considered for the plateau map
+	int   MAP_ANALYSIS_THREADS; // number of threads used for analysis of the map at game start (0: all available cores, 1: serial)
+	int   FRAME_TIME_BUDGET; // time (in microseconds) per frame for periodic tasks (tasks exceeding the budget are deferred to later frames)
 
 	// game specific
 	int   LEARN_RATE;
 
+	// debugging
+	bool  EXPORT_CONTINENT_MAP; // additionally store continent map as text file when continent cache is created
+	int   PROFILER_SPIKE_THRESHOLD; // time (in microseconds) per frame above which the call tree of the frame is added to the spike report of the profiler (0 to deactivate)
+	int   LOG_LEVEL; // messages below this level are not written to the log file (0: debug, 1: info, 2: warning, 3: error)
+	bool  RECORD_EVENTS; // write events received from the engine (and engine responses) to a binary file in the log directory
+	int   RANDOM_SEED; // seed of the random number generator (0: determined from current time, seed used is written to the log file)
+
 	/**
 	 * open a file in springs data directory
 	 * @param filename relative path of the file in the spring data dir
@@ -19,6 +19,7 @@
 #include "AAIConfig.h"
 #include "AAIMap.h"
 #include "AAISector.h"
+#include "AAIUnitDataCache.h"
 
 
 #include "LegacyCpp/UnitDef.h"
@@ -180,7 +181,7 @@ void AAIConstructor::Update()
 						// can this thing resurrect? If so, maybe we should raise the corpses instead of consuming them?
 						if(def->canResurrect)
 						{
-							if(rand()%2 == 1)
+							if(ai->Random().NextInt(2) == 1)
 								c.id = CMD_RESURRECT;
 							else
 								c.id = CMD_RECLAIM;
@@ -233,7 +234,7 @@ void AAIConstructor::CheckAssistance()
 
 		if(assistanceNeeded)
 		{
-			AAIConstructor* assistant = ai->UnitTable()->FindClosestAssistant(ai->GetAICallback()->GetUnitPos(m_myUnitId.id), 5, true);
+			AAIConstructor* assistant = ai->UnitTable()->FindClosestAssistant(ai->UnitData()->GetUnitPos(m_myUnitId), 5, true);
 
 			if(assistant)
 			{
@@ -487,7 +488,7 @@ void AAIConstructor::CheckRetreatFromAttackBy(const AAIUnitCategory& attackedByC
 {
 	if(m_activity.IsDestroyed() == false)
 	{
-		const float3 unitPos = ai->GetAICallback()->GetUnitPos(m_myUnitId.id);
+		const float3 unitPos = ai->UnitData()->GetUnitPos(m_myUnitId);
 
 		const AAISector* sector = ai->Map()->GetSectorOfPos(unitPos);
 
@@ -500,7 +501,7 @@ void AAIConstructor::CheckRetreatFromAttackBy(const AAIUnitCategory& attackedByC
 			{
 				// dont flee outside from scouts of the base if health is > 50%
 				if(   attackedByCategory.IsScout()
-				   && (ai->GetAICallback()->GetUnitHealth(m_myUnitId.id) > 0.5f * ai->s_buildTree.GetHealth(m_myDefId)) )
+				   && (ai->UnitData()->GetUnitHealth(m_myUnitId) > 0.5f * ai->s_buildTree.GetHealth(m_myDefId)) )
 					return;	
 			}
 		}
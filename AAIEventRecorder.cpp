@@ -0,0 +1,349 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include <algorithm>
+
+#include "AAIEventRecorder.h"
+#include "AAI.h"
+
+#include "LegacyCpp/IAICallback.h"
+#include "LegacyCpp/UnitDef.h"
+#include "LegacyCpp/WeaponDef.h"
+#include "LegacyCpp/MoveData.h"
+
+const char    AAIEventRecorder::s_fileMagic[4] = {'A', 'A', 'I', 'E'};
+const int32_t AAIEventRecorder::s_fileVersion  = 2;
+
+//! Size of buffered data that triggers writing to the file
+static const size_t s_flushThreshold = 64 * 1024;
+
+AAIEventRecorder::EventScope::EventScope(AAIEventRecorder* recorder, ERecordedEvent event, int value1, int value2, int value3, int value4) :
+	m_recorder(recorder)
+{
+	if(m_recorder == nullptr)
+		return;
+
+	if(m_recorder->m_eventDepth == 0)
+	{
+		if(event == ERecordedEvent::UPDATE)
+			m_recorder->m_currentFrame = value1;
+
+		if(m_recorder->IsRecording())
+		{
+			const int values[4] = {value1, value2, value3, value4};
+
+			m_recorder->BeginRecord(event);
+			for(int i = 0; i < AAIEventRecorder::GetNumberOfValues(event); ++i)
+				m_recorder->Write(static_cast<int32_t>(values[i]));
+		}
+
+		m_start = std::chrono::steady_clock::now();
+	}
+
+	++m_recorder->m_eventDepth;
+}
+
+AAIEventRecorder::EventScope::~EventScope()
+{
+	if(m_recorder == nullptr)
+		return;
+
+	--m_recorder->m_eventDepth;
+
+	if(m_recorder->m_eventDepth == 0)
+	{
+		const float time = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - m_start).count();
+		m_recorder->AddTime(m_recorder->m_currentFrame, time);
+
+		if(m_recorder->m_buffer.size() > s_flushThreshold)
+			m_recorder->Flush();
+	}
+}
+
+AAIEventRecorder::AAIEventRecorder() :
+	m_file(nullptr),
+	m_eventDepth(0),
+	m_currentFrame(0)
+{
+}
+
+AAIEventRecorder::~AAIEventRecorder()
+{
+	if(m_file != nullptr)
+	{
+		Flush();
+		fclose(m_file);
+	}
+}
+
+// Header: magic, version, skirmish AI id, random seed, team, ally team, max units, map width/height (in map tiles), LOS map resolution
+// (as returned by the callback), map name, map hash, mod name, mod human name, mod short name, mod hash, extractor radius, max metal,
+// min/max wind, tidal strength, height map (width * height floats), metal map (width/2 * height/2 bytes), number of unit definitions
+// followed by the unit definitions (in the order of their ids). Strings are stored as length followed by the characters.
+bool AAIEventRecorder::Open(const char* filename, int skirmishAIId, int randomSeed, springLegacyAI::IAICallback* aiCallback)
+{
+	m_file = fopen(filename, "wb");
+
+	if(m_file == nullptr)
+		return false;
+
+	m_buffer.reserve(2 * s_flushThreshold);
+	m_buffer.insert(m_buffer.end(), s_fileMagic, s_fileMagic + sizeof(s_fileMagic));
+	Write(s_fileVersion);
+	Write(static_cast<int32_t>(skirmishAIId));
+	Write(static_cast<int32_t>(randomSeed));
+	Write(static_cast<int32_t>(aiCallback->GetMyTeam()));
+	Write(static_cast<int32_t>(aiCallback->GetMyAllyTeam()));
+	Write(static_cast<int32_t>(aiCallback->GetMaxUnits()));
+
+	const int xMapSize = aiCallback->GetMapWidth();
+	const int yMapSize = aiCallback->GetMapHeight();
+	Write(static_cast<int32_t>(xMapSize));
+	Write(static_cast<int32_t>(yMapSize));
+	Write(static_cast<int32_t>(aiCallback->GetLosMapResolution()));
+
+	Write(std::string(aiCallback->GetMapName()));
+	Write(static_cast<int32_t>(aiCallback->GetMapHash()));
+	Write(std::string(aiCallback->GetModName()));
+	Write(std::string(aiCallback->GetModHumanName()));
+	Write(std::string(aiCallback->GetModShortName()));
+	Write(static_cast<int32_t>(aiCallback->GetModHash()));
+
+	Write(aiCallback->GetExtractorRadius());
+	Write(aiCallback->GetMaxMetal());
+	Write(aiCallback->GetMinWind());
+	Write(aiCallback->GetMaxWind());
+	Write(aiCallback->GetTidalStrength());
+
+	const float* heightMap = aiCallback->GetHeightMap();
+	for(int i = 0; i < xMapSize * yMapSize; ++i)
+		Write(heightMap[i]);
+
+	const unsigned char* metalMap = aiCallback->GetMetalMap();
+	m_buffer.insert(m_buffer.end(), metalMap, metalMap + (xMapSize/2) * (yMapSize/2));
+
+	// unit definitions (only the data used by AAI)
+	const int numberOfUnitDefs = aiCallback->GetNumUnitDefs();
+	std::vector<const springLegacyAI::UnitDef*> unitDefs(numberOfUnitDefs, nullptr);
+	if(numberOfUnitDefs > 0)
+		aiCallback->GetUnitDefList(&unitDefs[0]);
+
+	std::sort(unitDefs.begin(), unitDefs.end(), [](const springLegacyAI::UnitDef* lhs, const springLegacyAI::UnitDef* rhs) { return lhs->id < rhs->id; });
+
+	Write(static_cast<int32_t>(numberOfUnitDefs));
+
+	for(const springLegacyAI::UnitDef* unitDef : unitDefs)
+	{
+		Write(static_cast<int32_t>(unitDef->id));
+		Write(unitDef->name);
+		Write(unitDef->humanName);
+
+		const int32_t intValues[] = { unitDef->xsize, unitDef->zsize, unitDef->highTrajectoryType, static_cast<int32_t>(unitDef->category),
+		                              unitDef->canfly, unitDef->canCloak, unitDef->canAssist, unitDef->canResurrect, unitDef->floater,
+		                              unitDef->builder, unitDef->isAirBase, unitDef->needGeo };
+		for(const int32_t value : intValues)
+			Write(value);
+
+		const float floatValues[] = { unitDef->metalCost, unitDef->energyCost, unitDef->buildTime, unitDef->energyUpkeep, unitDef->metalMake,
+		                              unitDef->energyMake, unitDef->metalStorage, unitDef->energyStorage, unitDef->extractsMetal,
+		                              unitDef->windGenerator, unitDef->tidalGenerator, unitDef->speed, unitDef->turnRate, unitDef->buildSpeed,
+		                              unitDef->losRadius, unitDef->radarRadius, unitDef->sonarRadius, unitDef->jammerRadius,
+		                              unitDef->sonarJamRadius, unitDef->seismicRadius, unitDef->minWaterDepth, unitDef->health, unitDef->power };
+		for(const float value : floatValues)
+			Write(value);
+
+		// move data: move family (-1 if none), depth, submarine
+		Write(static_cast<int32_t>(unitDef->movedata ? static_cast<int>(unitDef->movedata->moveFamily) : -1));
+		Write(unitDef->movedata ? unitDef->movedata->depth : 0.0f);
+		Write(static_cast<int32_t>(unitDef->movedata ? unitDef->movedata->subMarine : false));
+
+		Write(static_cast<int32_t>(unitDef->buildOptions.size()));
+		for(const auto& buildOption : unitDef->buildOptions)
+			Write(buildOption.second);
+
+		// weapons: name, target categories, range, stockpile, no auto target, shield, damages
+		Write(static_cast<int32_t>(unitDef->weapons.size()));
+		for(const auto& weapon : unitDef->weapons)
+		{
+			Write(weapon.def->name);
+			Write(static_cast<int32_t>(weapon.onlyTargetCat));
+			Write(weapon.def->range);
+			Write(static_cast<int32_t>(weapon.def->stockpile));
+			Write(static_cast<int32_t>(weapon.def->noAutoTarget));
+			Write(static_cast<int32_t>(weapon.def->isShield));
+
+			Write(static_cast<int32_t>(weapon.def->damages.GetNumTypes()));
+			for(int i = 0; i < weapon.def->damages.GetNumTypes(); ++i)
+				Write(weapon.def->damages[i]);
+		}
+	}
+
+	Flush();
+	return true;
+}
+
+void AAIEventRecorder::RecordResponse(ERecordedEvent response, std::initializer_list<Value> values)
+{
+	if(IsRecording() == false)
+		return;
+
+	BeginRecord(response);
+
+	for(const Value& value : values)
+		Write(value.GetBits());
+}
+
+void AAIEventRecorder::RecordUnitList(ERecordedEvent response, const int* unitIds, int numberOfUnits, std::initializer_list<float> area)
+{
+	if(IsRecording() == false)
+		return;
+
+	BeginRecord(response);
+
+	for(const float value : area)
+		Write(value);
+
+	Write(static_cast<int32_t>(numberOfUnits));
+
+	for(int i = 0; i < numberOfUnits; ++i)
+		Write(static_cast<int32_t>(unitIds[i]));
+}
+
+void AAIEventRecorder::RecordMap(ERecordedEvent response, const int* map, int size)
+{
+	if(IsRecording() == false)
+		return;
+
+	// count runs first to store number of runs in front of them
+	int32_t runs(0);
+	for(int i = 0; i < size; ++i)
+	{
+		if( (i == 0) || (map[i] != map[i-1]) )
+			++runs;
+	}
+
+	BeginRecord(response);
+	Write(runs);
+
+	for(int start = 0; start < size; )
+	{
+		int end = start + 1;
+		while( (end < size) && (map[end] == map[start]) )
+			++end;
+
+		Write(static_cast<int32_t>(map[start]));
+		Write(static_cast<int32_t>(end - start));
+
+		start = end;
+	}
+}
+
+int AAIEventRecorder::GetNumberOfValues(ERecordedEvent type)
+{
+	switch(type)
+	{
+		case ERecordedEvent::UNIT_CREATED:
+		case ERecordedEvent::UNIT_DESTROYED:
+		case ERecordedEvent::UNIT_DAMAGED:
+		case ERecordedEvent::ENEMY_DESTROYED:
+		case ERecordedEvent::UNIT_DEF:
+		case ERecordedEvent::UNIT_HEALTH:
+		case ERecordedEvent::UNIT_TEAM:
+		case ERecordedEvent::RESOURCE:
+		case ERecordedEvent::UNIT_ALLY_TEAM:
+		case ERecordedEvent::UNIT_BEING_BUILT:
+		case ERecordedEvent::UNIT_COMMANDS:
+		case ERecordedEvent::TEAM_ALLY_TEAM:
+			return 2;
+		case ERecordedEvent::ELEVATION:
+		case ERecordedEvent::IS_ALLIED:
+		case ERecordedEvent::GIVE_ORDER:
+			return 3;
+		case ERecordedEvent::HANDLE_EVENT:
+		case ERecordedEvent::UNIT_POS:
+			return 4;
+		case ERecordedEvent::CAN_BUILD_AT:
+			return 6;
+		case ERecordedEvent::CLOSEST_BUILD_SITE:
+			return 10;
+		case ERecordedEvent::LOS_MAP:
+		case ERecordedEvent::RADAR_MAP:
+		case ERecordedEvent::ENEMY_UNITS:
+		case ERecordedEvent::ENEMY_UNITS_IN_AREA:
+		case ERecordedEvent::ENEMY_UNITS_IN_RADAR_AND_LOS:
+		case ERecordedEvent::FRIENDLY_UNITS:
+			return -1;
+		default:
+			return 1;
+	}
+}
+
+void AAIEventRecorder::LogStatistics(AAI* ai) const
+{
+	if(m_frameTimes.empty())
+		return;
+
+	std::vector<float> sortedTimes(m_frameTimes);
+	std::sort(sortedTimes.begin(), sortedTimes.end());
+
+	auto percentile = [&sortedTimes](float p) { return sortedTimes[ std::min(static_cast<size_t>(p * sortedTimes.size()), sortedTimes.size() - 1) ]; };
+
+	ai->Log("\nTime per frame (us) over %u frames: p50 %.0f  p90 %.0f  p99 %.0f  p99.9 %.0f  max %.0f\n", static_cast<unsigned int>(sortedTimes.size()),
+				percentile(0.5f), percentile(0.9f), percentile(0.99f), percentile(0.999f), sortedTimes.back());
+
+	// determine worst frames
+	std::vector<int> indices(m_frameTimes.size());
+	for(size_t i = 0; i < indices.size(); ++i)
+		indices[i] = static_cast<int>(i);
+
+	const size_t numberOfWorstFrames = std::min(indices.size(), static_cast<size_t>(10));
+	std::partial_sort(indices.begin(), indices.begin() + numberOfWorstFrames, indices.end(), [this](int lhs, int rhs) { return m_frameTimes[lhs] > m_frameTimes[rhs]; });
+
+	ai->Log("Worst frames (frame / time in us):");
+	for(size_t i = 0; i < numberOfWorstFrames; ++i)
+		ai->Log("  %i / %.0f", m_frames[indices[i]], m_frameTimes[indices[i]]);
+	ai->Log("\n");
+}
+
+void AAIEventRecorder::Write(int32_t value)
+{
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+	m_buffer.insert(m_buffer.end(), bytes, bytes + sizeof(value));
+}
+
+void AAIEventRecorder::Write(float value)
+{
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+	m_buffer.insert(m_buffer.end(), bytes, bytes + sizeof(value));
+}
+
+void AAIEventRecorder::Write(const std::string& text)
+{
+	Write(static_cast<int32_t>(text.size()));
+	m_buffer.insert(m_buffer.end(), text.begin(), text.end());
+}
+
+void AAIEventRecorder::Flush()
+{
+	if( (m_file != nullptr) && (m_buffer.empty() == false) )
+		fwrite(&m_buffer[0], 1, m_buffer.size(), m_file);
+
+	m_buffer.clear();
+}
+
+void AAIEventRecorder::AddTime(int frame, float time)
+{
+	if( m_frames.empty() || (m_frames.back() != frame) )
+	{
+		m_frames.push_back(frame);
+		m_frameTimes.push_back(time);
+	}
+	else
+		m_frameTimes.back() += time;
+}
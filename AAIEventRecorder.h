@@ -0,0 +1,180 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_EVENTRECORDER_H
+#define AAI_EVENTRECORDER_H
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <initializer_list>
+
+class AAI;
+
+namespace springLegacyAI {
+	class IAICallback;
+}
+
+//! The types of records stored by the event recorder (stored as one byte in front of every record). Responses of the engine are
+//! stored with the arguments of the query (to detect whether a replay still matches the recorded game) followed by the result.
+enum class ERecordedEvent : uint8_t
+{
+	UPDATE                       =  0, //!< frame
+	UNIT_CREATED                 =  1, //!< unit, builder
+	UNIT_FINISHED                =  2, //!< unit
+	UNIT_IDLE                    =  3, //!< unit
+	UNIT_DESTROYED               =  4, //!< unit, attacker
+	UNIT_DAMAGED                 =  5, //!< damaged, attacker (damage and direction are not used by AAI)
+	UNIT_MOVE_FAILED             =  6, //!< unit
+	ENEMY_ENTER_LOS              =  7, //!< enemy
+	ENEMY_LEAVE_LOS              =  8, //!< enemy
+	ENEMY_ENTER_RADAR            =  9, //!< enemy
+	ENEMY_LEAVE_RADAR            = 10, //!< enemy
+	ENEMY_DESTROYED              = 11, //!< enemy, attacker
+	HANDLE_EVENT                 = 12, //!< message, unit, old team, new team
+	UNIT_POS                     = 13, //!< response: unit, x, y, z
+	UNIT_DEF                     = 14, //!< response: unit, unit def id (0 if none)
+	UNIT_HEALTH                  = 15, //!< response: unit, health
+	UNIT_TEAM                    = 16, //!< response: unit, team
+	LOS_MAP                      = 17, //!< response: number of runs, (value, length) for every run
+	RESOURCE                     = 18, //!< response: resource (see ERecordedResource), value
+	RADAR_MAP                    = 19, //!< response: number of runs, (value, length) for every run
+	CURRENT_FRAME                = 20, //!< response: frame
+	UNIT_ALLY_TEAM               = 21, //!< response: unit, ally team
+	UNIT_BEING_BUILT             = 22, //!< response: unit, being built (0/1)
+	UNIT_COMMANDS                = 23, //!< response: unit, number of commands
+	ENEMY_UNITS                  = 24, //!< response: number of units, unit ids
+	ENEMY_UNITS_IN_AREA          = 25, //!< response: x, y, z, radius, number of units, unit ids
+	ENEMY_UNITS_IN_RADAR_AND_LOS = 26, //!< response: number of units, unit ids
+	FRIENDLY_UNITS               = 27, //!< response: number of units, unit ids
+	CAN_BUILD_AT                 = 28, //!< response: unit def id, x, y, z, facing, possible (0/1)
+	CLOSEST_BUILD_SITE           = 29, //!< response: unit def id, x, y, z, search radius, min distance, facing, x, y, z of build site
+	ELEVATION                    = 30, //!< response: x, z, elevation
+	IS_ALLIED                    = 31, //!< response: ally team, ally team, allied (0/1)
+	TEAM_ALLY_TEAM               = 32, //!< response: team, ally team
+	GIVE_ORDER                   = 33  //!< response: unit, command id, result
+};
+
+//! The resources stored in RESOURCE records
+enum class ERecordedResource : int32_t
+{
+	METAL          = 0,
+	METAL_INCOME   = 1,
+	METAL_USAGE    = 2,
+	METAL_STORAGE  = 3,
+	ENERGY         = 4,
+	ENERGY_INCOME  = 5,
+	ENERGY_USAGE   = 6,
+	ENERGY_STORAGE = 7
+};
+
+//! @brief Writes the events received from the engine and the engine's responses to all queries of AAI to a compact binary file
+//!        (all values stored as 32 bit ints/floats in native byte order). The file starts with the static data of the game (map,
+//!        mod, unit definitions) followed by the events and responses in the order they occurred. Only events received directly
+//!        from the engine are recorded, i.e. events triggered while handling another event (e.g. UnitCreated() called from
+//!        HandleEvent()) are omitted. Furthermore, the time spent handling events is accumulated for every frame to report
+//!        percentiles/worst frames at the end of the game.
+class AAIEventRecorder
+{
+public:
+	//! Records the given event (if not nested in another event) and measures the time until the end of the scope
+	class EventScope
+	{
+	public:
+		EventScope(AAIEventRecorder* recorder, ERecordedEvent event, int value1 = 0, int value2 = 0, int value3 = 0, int value4 = 0);
+
+		~EventScope();
+
+	private:
+		AAIEventRecorder* m_recorder;
+
+		std::chrono::steady_clock::time_point m_start;
+	};
+
+	AAIEventRecorder();
+
+	~AAIEventRecorder();
+
+	//! @brief Opens the given file and writes the header (static data of the game fetched via the given callback); returns false if file could not be opened
+	bool Open(const char* filename, int skirmishAIId, int randomSeed, springLegacyAI::IAICallback* aiCallback);
+
+	//! @brief Returns true if events are currently written to a file
+	bool IsRecording() const { return m_file != nullptr; }
+
+	//! A value of a record (ints and floats are both stored with 32 bits)
+	class Value
+	{
+	public:
+		Value(int32_t value) : m_bits(value) {}
+
+		Value(float value) { memcpy(&m_bits, &value, sizeof(m_bits)); }
+
+		int32_t GetBits() const { return m_bits; }
+
+	private:
+		int32_t m_bits;
+	};
+
+	//! @brief Records a response from the engine consisting of the given values (if recording)
+	void RecordResponse(ERecordedEvent response, std::initializer_list<Value> values);
+
+	//! @brief Records a list of units returned by the engine (area of the query stored in front of the units if given)
+	void RecordUnitList(ERecordedEvent response, const int* unitIds, int numberOfUnits, std::initializer_list<float> area = {});
+
+	//! @brief Records the given LOS/radar map (run length encoded)
+	void RecordMap(ERecordedEvent response, const int* map, int size);
+
+	//! @brief Returns the number of values of records with fixed size (-1 for unit lists and maps)
+	static int GetNumberOfValues(ERecordedEvent type);
+
+	//! Identifies event log files (followed by the file version)
+	static const char    s_fileMagic[4];
+	static const int32_t s_fileVersion;
+
+	//! @brief Writes percentiles and the worst frames of the time spent handling events to the log file
+	void LogStatistics(AAI* ai) const;
+
+private:
+	void BeginRecord(ERecordedEvent type) { m_buffer.push_back(static_cast<uint8_t>(type)); }
+
+	void Write(int32_t value);
+
+	void Write(float value);
+
+	void Write(const std::string& text);
+
+	//! @brief Writes the buffered data to the file
+	void Flush();
+
+	//! @brief Adds the given time to the time spent in the given frame
+	void AddTime(int frame, float time);
+
+	//! The file the events are written to (nullptr if not recording)
+	FILE*                m_file;
+
+	//! Data that has not been written to the file yet
+	std::vector<uint8_t> m_buffer;
+
+	//! Nesting level of events that are currently handled
+	int                  m_eventDepth;
+
+	//! The current frame (i.e. frame of last update event)
+	int                  m_currentFrame;
+
+	//! Time in microseconds spent handling events in every frame that has been recorded
+	std::vector<float>   m_frameTimes;
+
+	//! The frames corresponding to the times stored in m_frameTimes
+	std::vector<int>     m_frames;
+};
+
+#endif
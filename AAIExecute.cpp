@@ -9,16 +9,19 @@
 
 
 #include "AAI.h"
+#include "AAILogger.h"
 #include "AAIExecute.h"
 #include "AAIBrain.h"
 #include "AAIUnitTable.h"
 #include "AAIConstructor.h"
 #include "AAIBuildTask.h"
+#include "AAIBuildTaskRegistry.h"
 #include "AAIConfig.h"
 #include "AAIMap.h"
 #include "AAIGroup.h"
 #include "AAISector.h"
 #include "AAIHelperFunctions.h"
+#include "AAIUnitDataCache.h"
 
 #include "LegacyCpp/UnitDef.h"
 #include "LegacyCpp/CommandQueue.h"
@@ -66,7 +69,7 @@ void AAIExecute::InitAI(UnitId commanderUnitId, UnitDefId commanderDefId)
 	ai->Log("My team / ally team: %i / %i\n", ai->GetMyTeamId(), ai->GetAICallback()->GetMyAllyTeam());
 
 	// tell the brain about the starting sector
-	const float3 pos = ai->GetAICallback()->GetUnitPos(commanderUnitId.id);
+	const float3 pos = ai->UnitData()->GetUnitPos(commanderUnitId);
 	int x = pos.x/AAIMap::xSectorSize;
 	int y = pos.z/AAIMap::ySectorSize;
 
@@ -138,7 +141,7 @@ void AAIExecute::AddUnitToGroup(const UnitId& unitId, const UnitDefId& unitDefId
 	const AAIMovementType& moveType = ai->s_buildTree.GetMovementType(unitDefId);
 	if( moveType.CannotMoveToOtherContinents() )
 	{
-		const float3 unitPos = ai->GetAICallback()->GetUnitPos(unitId.id);
+		const float3 unitPos = ai->UnitData()->GetUnitPos(unitId);
 		continentId = AAIMap::GetContinentID(unitPos);
 	}
 
@@ -167,7 +170,7 @@ void AAIExecute::BuildCombatUnitOfCategory(const AAIMovementType& moveType, cons
 	//ai->Log("Requesting combat unit of move type %i - combat power vs surface/air/floater/submerged: %f / %f / %f / %f\n", static_cast<int>(moveType.GetMovementType()), combatPowerCriteria[ETargetType::SURFACE], combatPowerCriteria[ETargetType::AIR], combatPowerCriteria[ETargetType::FLOATER], combatPowerCriteria[ETargetType::SUBMERGED]); 
 
 	// determine random float in [0:1]
-	const float randomValue = 0.01f * static_cast<float>(std::rand()%101);
+	const float randomValue = 0.01f * static_cast<float>(ai->Random().NextInt(101));
 
 	// select unit independently from available constructor from time to time (to make sure AAI will order factories for advanced units as the game progresses)
 	const float contructorRequiredRate = moveType.IsAir() ? 0.5f : 0.85f;
@@ -201,7 +204,7 @@ void AAIExecute::BuildScouts()
 	{
 		const ScoutSelectionCriteria scoutSelectionCriteria = ai->Brain()->DetermineScoutSelectionCriteria();
 		const uint32_t               suitableMovementTypes  = ai->Map()->GetSuitableMovementTypesForMap();
-		const bool                   availableFactoryNeeded = (rand()%5 == 1) ? false : true;
+		const bool                   availableFactoryNeeded = (ai->Random().NextInt(5) == 1) ? false : true;
 		
 		const UnitDefId scoutId = ai->BuildTable()->SelectScout(ai->GetSide(), scoutSelectionCriteria, suitableMovementTypes, availableFactoryNeeded);
 
@@ -227,7 +230,7 @@ BuildSite AAIExecute::DetermineBuildsite(UnitId builder, UnitDefId buildingDefId
 	//-----------------------------------------------------------------------------------------------------------------
 	// check the sector of the builder first
 	//-----------------------------------------------------------------------------------------------------------------
-	const float3 builderPosition = ai->GetAICallback()->GetUnitPos(builder.id);
+	const float3 builderPosition = ai->UnitData()->GetUnitPos(builder);
 	const AAISector* sector = ai->Map()->GetSectorOfPos(builderPosition);
 
 	if(sector && (sector->GetDistanceToBase() == 0) )
@@ -268,7 +271,7 @@ BuildSite AAIExecute::DetermineBuildsiteInSector(UnitDefId building, const AAISe
 
 BuildSite AAIExecute::DetermineBuildsiteForUnit(UnitId constructor, UnitDefId unitDefId) const
 {
-	const float3 constructorPosition = ai->GetAICallback()->GetUnitPos(constructor.id);
+	const float3 constructorPosition = ai->UnitData()->GetUnitPos(constructor);
 	
 	BuildSite selectedBuildsite;
 	float minDist = AAIMap::s_maxSquaredMapDist;
@@ -376,7 +379,7 @@ BuildOrderStatus AAIExecute::TryConstructionOf(UnitDefId building, const AAISect
 			else
 				ai->Brain()->ExpandBase(EMapType::WATER);
 
-			ai->Log("Base expanded when looking for buildsite for %s\n", ai->s_buildTree.GetUnitTypeProperties(building).m_name.c_str());
+			ai->Log(ELogLevel::INFO, ELogCategory::EXECUTE, "Base expanded when looking for buildsite for %s\n", ai->s_buildTree.GetUnitTypeProperties(building).m_name.c_str());
 			return BuildOrderStatus::NO_BUILDSITE_FOUND;
 		}
 	}
@@ -559,7 +562,7 @@ bool AAIExecute::BuildPowerPlant()
 	{
 		// probability of trying to build sea power plant first is related to current water ratio of the base
 		// determine random float in [0:1]
-		const float randomValue = 0.01f * static_cast<float>(std::rand()%101);
+		const float randomValue = 0.01f * static_cast<float>(ai->Random().NextInt(101));
 
 		if( randomValue < ai->Brain()->GetBaseWaterRatio() )
 		{
@@ -741,7 +744,7 @@ bool AAIExecute::BuildMetalMaker()
 				else
 				{
 					ai->Brain()->ExpandBase(EMapType::LAND);
-					ai->Log("Base expanded by BuildMetalMaker()\n");
+					ai->Log(ELogLevel::INFO, ELogCategory::EXECUTE, "Base expanded by BuildMetalMaker()\n");
 				}
 			}
 		}
@@ -781,7 +784,7 @@ bool AAIExecute::BuildMetalMaker()
 				else
 				{
 					ai->Brain()->ExpandBase(EMapType::WATER);
-					ai->Log("Base expanded by BuildMetalMaker() (water sector)\n");
+					ai->Log(ELogLevel::INFO, ELogCategory::EXECUTE, "Base expanded by BuildMetalMaker() (water sector)\n");
 				}
 			}
 		}
@@ -817,7 +820,7 @@ bool AAIExecute::BuildStorage()
 
 	// probability of trying to build sea power plant first is related to current water ratio of the base
 	// determine random float in [0:1]
-	const float randomValue = 0.01f * static_cast<float>(std::rand()%101);
+	const float randomValue = 0.01f * static_cast<float>(ai->Random().NextInt(101));
 
 	if( randomValue < ai->Brain()->GetBaseWaterRatio() )
 	{
@@ -915,7 +918,7 @@ bool AAIExecute::BuildAirBase()
 				else
 				{
 					ai->Getbrain()->ExpandBase(LAND_SECTOR);
-					ai->Log("Base expanded by BuildAirBase()\n");
+					ai->Log(ELogLevel::INFO, ELogCategory::EXECUTE, "Base expanded by BuildAirBase()\n");
 				}
 			}
 		}
@@ -955,7 +958,7 @@ bool AAIExecute::BuildAirBase()
 				else
 				{
 					ai->Getbrain()->ExpandBase(WATER_SECTOR);
-					ai->Log("Base expanded by BuildAirBase() (water sector)\n");
+					ai->Log(ELogLevel::INFO, ELogCategory::EXECUTE, "Base expanded by BuildAirBase() (water sector)\n");
 				}
 			}
 		}
@@ -1231,12 +1234,12 @@ bool AAIExecute::BuildStaticConstructor()
 		if(isSeaFactory)
 		{
 			ai->Brain()->ExpandBase(EMapType::WATER, false);
-			ai->Log("Base expanded by BuildFactory() (water sector)\n");
+			ai->Log(ELogLevel::INFO, ELogCategory::EXECUTE, "Base expanded by BuildFactory() (water sector)\n");
 		}
 		else
 		{
 			expanded = ai->Brain()->ExpandBase(EMapType::LAND, false);
-			ai->Log("Base expanded by BuildFactory()\n");
+			ai->Log(ELogLevel::INFO, ELogCategory::EXECUTE, "Base expanded by BuildFactory()\n");
 		}
 
 		return false;	
@@ -1393,7 +1396,7 @@ void AAIExecute::BuildStaticDefenceForExtractor(UnitId extractorId, UnitDefId ex
 	if(ai->UnitTable()->activeFactories < cfg->MIN_FACTORIES_FOR_DEFENCES)
 		return;
 
-	const float3 extractorPos = ai->GetAICallback()->GetUnitPos(extractorId.id);
+	const float3 extractorPos = ai->UnitData()->GetUnitPos(extractorId);
 
 	const MapPos& centerOfBase = ai->Brain()->GetCenterOfBase(); 
 	const float3 base_pos(centerOfBase.x * SQUARE_SIZE, 0.0f, centerOfBase.y * SQUARE_SIZE);
@@ -1612,7 +1615,7 @@ void AAIExecute::CheckExtractorUpgrade()
 			{
 				if(    spot->extractorDefId.IsValid() 
 				    && spot->extractorUnitId.IsValid()
-					&& ai->GetAICallback()->GetUnitTeam(spot->extractorUnitId.id) == ai->GetMyTeamId())	// only upgrade own extractors
+					&& ai->UnitData()->GetUnitTeam(spot->extractorUnitId) == ai->GetMyTeamId())	// only upgrade own extractors
 				{
 					const bool isLand = ai->s_buildTree.GetMovementType( spot->extractorDefId ).IsStaticLand();
 
@@ -1663,7 +1666,7 @@ void AAIExecute::CheckRadarUpgrade()
 		if(upgrade)
 		{
 			// better radar found, clear buildpos
-			AAIConstructor *builder = ai->UnitTable()->FindClosestAssistant(ai->GetAICallback()->GetUnitPos(sensor.id), 10, true);
+			AAIConstructor *builder = ai->UnitTable()->FindClosestAssistant(ai->UnitData()->GetUnitPos(sensor), 10, true);
 
 			if(builder)
 			{
@@ -2124,7 +2127,7 @@ void AAIExecute::CheckKeepDistanceToEnemy(UnitId unit, UnitDefId unitDefId, Unit
 	{
 		const float fallbackDist = std::min(1.25f * enemyWeaponRange, weaponRange);
 
-		float3 pos = GetFallBackPos( ai->GetAICallback()->GetUnitPos(unit.id), fallbackDist);
+		float3 pos = GetFallBackPos( ai->UnitData()->GetUnitPos(unit), fallbackDist);
 
 		if(pos.x > 0.0f)
 		{
@@ -2157,7 +2160,7 @@ float3 AAIExecute::GetFallBackPos(const float3& pos, float maxFallbackDist) cons
 
 		for(int k = 0; k < numberOfEnemies; ++k)
 		{
-			float3 enemy_pos = ai->GetAICallback()->GetUnitPos(ai->Map()->UnitsInLOS()[k]);
+			float3 enemy_pos = ai->UnitData()->GetUnitPos(UnitId(ai->Map()->UnitsInLOS()[k]));
 
 			// get distance to enemy
 			float dx   = enemy_pos.x - pos.x;
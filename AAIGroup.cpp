@@ -20,6 +20,8 @@
 #include "AAIMap.h"
 #include "AAISector.h"
 #include "AAIBrain.h"
+#include "AAIUnitDataCache.h"
+#include "AAILogger.h"
 
 
 #include "LegacyCpp/UnitDef.h"
@@ -159,9 +161,9 @@ bool AAIGroup::RemoveUnit(UnitId unitId, UnitId attackerUnitId)
 	const UnitDefId unitDefId = ai->GetUnitDefId(unitId);
 
 	if(unitDefId.IsValid())
-		ai->Log("Error: Failed to remove unit %s from group of %s!\n", ai->s_buildTree.GetUnitTypeProperties(unitDefId).m_name.c_str(), ai->s_buildTree.GetUnitTypeProperties(m_groupDefId).m_name.c_str() );
+		ai->Log(ELogLevel::FAILURE, ELogCategory::GENERAL, "Failed to remove unit %s from group of %s!\n", ai->s_buildTree.GetUnitTypeProperties(unitDefId).m_name.c_str(), ai->s_buildTree.GetUnitTypeProperties(m_groupDefId).m_name.c_str() );
 	else
-		ai->Log("Error: Failed to remove unit with unknown unit type from group of %s!\n", ai->s_buildTree.GetUnitTypeProperties(m_groupDefId).m_name.c_str() );
+		ai->Log(ELogLevel::FAILURE, ELogCategory::GENERAL, "Failed to remove unit with unknown unit type from group of %s!\n", ai->s_buildTree.GetUnitTypeProperties(m_groupDefId).m_name.c_str() );
 	return false;
 }
 
@@ -244,7 +246,7 @@ float3 AAIGroup::GetGroupPosition() const
 	if(!m_units.empty())
 	{
 		std::list<UnitId>::const_iterator unit = std::prev(m_units.end());
-		return ai->GetAICallback()->GetUnitPos( (*unit).id );
+		return ai->UnitData()->GetUnitPos(*unit);
 	}
 	else
 		return ZeroVector;
@@ -338,7 +340,7 @@ void AAIGroup::DefendUnit(UnitId unitId, const float3& enemyPosition, float urge
 
 		GiveOrderToGroup(&cmd, urgency, GUARDING, "Group::Defend");
 
-		const float3 defendedUnitPosition = ai->GetAICallback()->GetUnitPos(unitId.id);
+		const float3 defendedUnitPosition = ai->UnitData()->GetUnitPos(unitId);
 
 		m_targetPosition = defendedUnitPosition;
 		m_targetSector   = ai->Map()->GetSectorOfPos(defendedUnitPosition);
@@ -372,7 +374,7 @@ UnitId AAIGroup::GetRandomUnit() const
 		return UnitId();
 	else
 	{
-		const int selectedUnitId = rand()%static_cast<int>(m_units.size());
+		const int selectedUnitId = ai->Random().NextInt(static_cast<int>(m_units.size()));
 
 		auto unit = m_units.begin();
 
@@ -487,7 +489,7 @@ void AAIGroup::UnitIdle(UnitId unitId, AAIAttackManager* attackManager)
 	if(m_attack)
 	{
 		//check if idle unit is in target sector
-		const float3 pos = ai->GetAICallback()->GetUnitPos(unitId.id);
+		const float3 pos = ai->UnitData()->GetUnitPos(unitId);
 		const AAISector *sector = ai->Map()->GetSectorOfPos(pos);
 
 		if( (sector == m_targetSector) || (m_targetSector == nullptr) )
@@ -537,7 +539,7 @@ void AAIGroup::UnitIdle(UnitId unitId, AAIAttackManager* attackManager)
 	else if( (m_task == GROUP_RETREATING) || (m_task == GROUP_DEFENDING) ) 
 	{
 		//check if retreating units is in target sector
-		const float3 pos = ai->GetAICallback()->GetUnitPos(unitId.id);
+		const float3 pos = ai->UnitData()->GetUnitPos(unitId);
 
 		const AAISector* temp = ai->Map()->GetSectorOfPos(pos);
 
@@ -650,6 +652,6 @@ void AAIGroup::UpdateRallyPoint()
 	}
 	else
 	{
-		ai->Log("Failed to determine rally point for goup of unit type %s!\n", ai->s_buildTree.GetUnitTypeProperties(m_groupDefId).m_name.c_str());
+		ai->Log(ELogLevel::WARNING, ELogCategory::GENERAL, "Failed to determine rally point for goup of unit type %s!\n", ai->s_buildTree.GetUnitTypeProperties(m_groupDefId).m_name.c_str());
 	}
 }
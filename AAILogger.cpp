@@ -0,0 +1,176 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "AAILogger.h"
+
+//! Prefixes written in front of messages of the different categories
+static const char* const s_categoryPrefixes[static_cast<int>(ELogCategory::NUMBER_OF_CATEGORIES)] = {"", "[Brain] ", "[Execute] ", "[BuildTable] ", "[Map] "};
+
+//! Tags written in front of messages of the different levels (after the category prefix)
+static const char* const s_levelTags[] = {"", "", "WARNING: ", "ERROR: "};
+
+//! Max length of a single message (longer messages are truncated)
+static const size_t s_maxMessageLength = 4096;
+
+AAILogger::AAILogger(size_t bufferSize) :
+	m_file(nullptr),
+	m_minLevel(ELogLevel::INFO),
+	m_buffer(bufferSize),
+	m_writePosition(0u),
+	m_readPosition(0u),
+	m_droppedMessages(0u),
+	m_reportedDroppedMessages(0u),
+	m_formatBuffer(s_maxMessageLength),
+	m_stop(false)
+{
+}
+
+AAILogger::~AAILogger()
+{
+	if(m_file == nullptr)
+		return;
+
+	m_stop.store(true);
+	m_writerThread.join();
+
+	fclose(m_file);
+}
+
+bool AAILogger::Open(const char* filename)
+{
+	m_file = fopen(filename, "w");
+
+	if(m_file == nullptr)
+		return false;
+
+	m_writerThread = std::thread(&AAILogger::Run, this);
+	return true;
+}
+
+void AAILogger::Write(ELogLevel level, ELogCategory category, const char* format, va_list args)
+{
+	if(IsEnabled(level) == false)
+		return;
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// format message (incl. category prefix and level tag)
+	//-----------------------------------------------------------------------------------------------------------------
+	const char* prefix = s_categoryPrefixes[static_cast<int>(category)];
+	const char* tag    = s_levelTags[static_cast<int>(level)];
+
+	const int categoryPrefixLength = static_cast<int>(strlen(prefix));
+	const int tagLength            = static_cast<int>(strlen(tag));
+	memcpy(&m_formatBuffer[0], prefix, categoryPrefixLength);
+	memcpy(&m_formatBuffer[categoryPrefixLength], tag, tagLength);
+
+	const int prefixLength = categoryPrefixLength + tagLength;
+
+	const int messageLength = vsnprintf(&m_formatBuffer[prefixLength], m_formatBuffer.size() - prefixLength, format, args);
+
+	if(messageLength < 0)
+		return;
+
+	const uint32_t length = static_cast<uint32_t>( std::min(static_cast<size_t>(prefixLength + messageLength), m_formatBuffer.size() - 1) );
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// add to ring buffer (if sufficient space left)
+	//-----------------------------------------------------------------------------------------------------------------
+	const uint64_t writePosition = m_writePosition.load(std::memory_order_relaxed);
+	const uint64_t readPosition  = m_readPosition.load(std::memory_order_acquire);
+
+	const uint64_t requiredSpace = sizeof(length) + length;
+
+	if(writePosition - readPosition + requiredSpace > m_buffer.size())
+	{
+		m_droppedMessages.fetch_add(1u, std::memory_order_relaxed);
+		return;
+	}
+
+	CopyToBuffer(writePosition, reinterpret_cast<const char*>(&length), sizeof(length));
+	CopyToBuffer(writePosition + sizeof(length), &m_formatBuffer[0], length);
+
+	m_writePosition.store(writePosition + requiredSpace, std::memory_order_release);
+}
+
+void AAILogger::CopyToBuffer(uint64_t position, const char* data, size_t size)
+{
+	const size_t start     = static_cast<size_t>(position % m_buffer.size());
+	const size_t firstPart = std::min(size, m_buffer.size() - start);
+
+	memcpy(&m_buffer[start], data, firstPart);
+
+	if(firstPart < size)
+		memcpy(&m_buffer[0], data + firstPart, size - firstPart);
+}
+
+void AAILogger::CopyFromBuffer(uint64_t position, char* data, size_t size) const
+{
+	const size_t start     = static_cast<size_t>(position % m_buffer.size());
+	const size_t firstPart = std::min(size, m_buffer.size() - start);
+
+	memcpy(data, &m_buffer[start], firstPart);
+
+	if(firstPart < size)
+		memcpy(data + firstPart, &m_buffer[0], size - firstPart);
+}
+
+bool AAILogger::WritePendingMessages()
+{
+	const uint64_t writePosition = m_writePosition.load(std::memory_order_acquire);
+	uint64_t       readPosition  = m_readPosition.load(std::memory_order_relaxed);
+
+	const bool messagesPending = (readPosition != writePosition);
+
+	char message[s_maxMessageLength];
+
+	while(readPosition != writePosition)
+	{
+		uint32_t length;
+		CopyFromBuffer(readPosition, reinterpret_cast<char*>(&length), sizeof(length));
+		CopyFromBuffer(readPosition + sizeof(length), message, length);
+
+		// write to stderr if write to file failed
+		if(fwrite(message, 1, length, m_file) != length)
+			fwrite(message, 1, length, stderr);
+
+		readPosition += sizeof(length) + length;
+
+		// release space as soon as possible
+		m_readPosition.store(readPosition, std::memory_order_release);
+	}
+
+	const uint64_t droppedMessages = m_droppedMessages.load(std::memory_order_relaxed);
+
+	if(droppedMessages != m_reportedDroppedMessages)
+	{
+		fprintf(m_file, "[Logger] %llu message(s) dropped (log buffer full)\n", static_cast<unsigned long long>(droppedMessages - m_reportedDroppedMessages));
+		m_reportedDroppedMessages = droppedMessages;
+	}
+
+	if(messagesPending)
+		fflush(m_file);
+
+	return messagesPending;
+}
+
+void AAILogger::Run()
+{
+	while(m_stop.load() == false)
+	{
+		if(WritePendingMessages() == false)
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+
+	// write messages added before stop has been signalled
+	WritePendingMessages();
+}
@@ -0,0 +1,113 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_LOGGER_H
+#define AAI_LOGGER_H
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <cstdint>
+#include <vector>
+#include <atomic>
+#include <thread>
+
+//! Log levels (messages below the minimum level set in the general config are discarded)
+enum class ELogLevel : int
+{
+	DEBUGGING = 0, //!< Detailed information only needed when debugging (calls removed at compile time unless AAI_DEBUG_LOG is defined)
+	INFO      = 1, //!< General information about decisions of the AI
+	WARNING   = 2, //!< Unexpected situations the AI can handle (tagged with "WARNING:" in the log file)
+	FAILURE   = 3  //!< Failures (e.g. missing config data, tagged with "ERROR:" in the log file)
+};
+
+//! Categories of log messages (written in front of the message, except for general messages)
+enum class ELogCategory : int
+{
+	GENERAL     = 0,
+	BRAIN       = 1,
+	EXECUTE     = 2,
+	BUILD_TABLE = 3,
+	MAP         = 4,
+	NUMBER_OF_CATEGORIES = 5
+};
+
+//! Logs a debug message (removed at compile time unless AAI_DEBUG_LOG is defined)
+#ifdef AAI_DEBUG_LOG
+	#define AAI_LOG_DEBUG(ai, category, ...) (ai)->Log(ELogLevel::DEBUGGING, category, __VA_ARGS__)
+#else
+	#define AAI_LOG_DEBUG(ai, category, ...) ((void)0)
+#endif
+
+//! @brief Writes log messages of one AAI instance to its log file without blocking the calling (engine) thread: messages are formatted
+//!        by the calling thread into a lock-free single producer/single consumer ring buffer that is drained by a background thread.
+//!        If the buffer is full, messages are dropped (and the number of dropped messages is written to the log file).
+//!        Only one thread may write messages (i.e. the engine thread calling the AI).
+class AAILogger
+{
+public:
+	//! @brief Creates a logger with a ring buffer of the given size (in bytes)
+	explicit AAILogger(size_t bufferSize = 1024 * 1024);
+
+	//! @brief Writes all pending messages and closes the log file
+	~AAILogger();
+
+	//! @brief Opens the given log file and starts the writer thread; returns false if file could not be opened
+	bool Open(const char* filename);
+
+	//! @brief Messages below the given level will be discarded
+	void SetMinLevel(ELogLevel minLevel) { m_minLevel = minLevel; }
+
+	//! @brief Returns true if messages of the given level will be written
+	bool IsEnabled(ELogLevel level) const { return (m_file != nullptr) && (level >= m_minLevel); }
+
+	//! @brief Formats the given message (incl. category prefix and level tag) and adds it to the buffer (dropped if buffer is full)
+	void Write(ELogLevel level, ELogCategory category, const char* format, va_list args);
+
+	//! @brief Returns the number of messages that have been dropped because the buffer was full
+	uint64_t GetNumberOfDroppedMessages() const { return m_droppedMessages.load(std::memory_order_relaxed); }
+
+private:
+	//! @brief Copies the given data to the ring buffer starting at the given position (wraps around at the end of the buffer)
+	void CopyToBuffer(uint64_t position, const char* data, size_t size);
+
+	//! @brief Copies data from the ring buffer starting at the given position to the given destination
+	void CopyFromBuffer(uint64_t position, char* data, size_t size) const;
+
+	//! @brief Writes all messages currently stored in the buffer to the file; returns true if at least one message has been written
+	bool WritePendingMessages();
+
+	//! @brief Main function of the writer thread
+	void Run();
+
+	//! The log file (nullptr if not opened)
+	FILE*                 m_file;
+
+	//! Messages below this level are discarded
+	ELogLevel             m_minLevel;
+
+	//! The ring buffer; every message is stored as its size (uint32) followed by the characters
+	std::vector<char>     m_buffer;
+
+	//! Total number of bytes written/read (position in buffer is given by modulo buffer size)
+	std::atomic<uint64_t> m_writePosition, m_readPosition;
+
+	//! Number of dropped messages (and the number already reported in the log file by the writer thread)
+	std::atomic<uint64_t> m_droppedMessages;
+	uint64_t              m_reportedDroppedMessages;
+
+	//! Used by the calling thread to format messages
+	std::vector<char>     m_formatBuffer;
+
+	//! Signals the writer thread to write remaining messages and stop
+	std::atomic<bool>     m_stop;
+
+	std::thread           m_writerThread;
+};
+
+#endif
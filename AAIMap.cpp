@@ -14,16 +14,78 @@
 #include "AAIConfig.h"
 #include "AAISector.h"
 #include "AAIUnitTable.h"
+#include "AAICacheFile.h"
+#include "AAIThreadPool.h"
+#include "AAIUnitDataCache.h"
+#include "AAILogger.h"
 
 #include "System/SafeUtil.h"
 #include "LegacyCpp/UnitDef.h"
 
 #include <inttypes.h>
+#include <cstring>
+#include <algorithm>
 
 using namespace springLegacyAI;
 
 #define MAP_CACHE_PATH "cache/"
 
+//! Number of rows of the build map/plateau map processed per band when map analysis is split up into bands
+constexpr int rowsPerBuildMapBand(64);
+constexpr int rowsPerPlateauMapBand(32);
+
+//! @brief Returns the thread pool for the analysis of the map (started with the number of threads set in the general config when needed for the first time)
+static AAIThreadPool& GetMapAnalysisThreadPool(std::unique_ptr<AAIThreadPool>& threadPool)
+{
+	if(threadPool == nullptr)
+		threadPool.reset(new AAIThreadPool(cfg->MAP_ANALYSIS_THREADS));
+
+	return *threadPool;
+}
+
+//! Sections of the map cache file
+enum class EMapCacheSection : int
+{
+	GENERAL            = 0, //!< General map data (MapCacheGeneralData)
+	BUILD_MAP          = 1, //!< Tile types of the build map
+	PLATEAU_MAP        = 2, //!< The plateau map
+	METAL_SPOTS        = 3, //!< The detected metal spots (MapCacheMetalSpot)
+	NUMBER_OF_SECTIONS = 4
+};
+
+//! General map data stored in the map cache file
+struct MapCacheGeneralData
+{
+	int32_t isMetalMap;
+	int32_t mapType;
+	float   waterTilesRatio;
+	int32_t metalSpotsOnLand;
+	int32_t metalSpotsInSea;
+	int32_t terrainDetectionRange;
+};
+
+//! Metal spot as stored in the map cache file
+struct MapCacheMetalSpot
+{
+	float x, y, z;
+	float amount;
+};
+
+//! Sections of the continent cache file
+enum class EContinentCacheSection : int
+{
+	CONTINENT_MAP      = 0, //!< Run length encoded continent map (pairs of continent id and number of tiles)
+	CONTINENTS         = 1, //!< The continents (ContinentCacheEntry)
+	NUMBER_OF_SECTIONS = 2
+};
+
+//! Continent as stored in the continent cache file
+struct ContinentCacheEntry
+{
+	int32_t size;
+	int32_t water;
+};
+
 float AAIMap::s_maxSquaredMapDist;
 int AAIMap::xSize;
 int AAIMap::ySize;
@@ -53,7 +115,8 @@ AAIContinentMap               AAIMap::s_continentMap;
 AAIDefenceMaps                AAIMap::s_defenceMaps;
 AAIMapType                    AAIMap::s_mapType;
 AAITeamSectorMap              AAIMap::s_teamSectorMap;
-std::vector<BuildMapTileType> AAIMap::s_buildmap;
+AAIBuildMap                   AAIMap::s_buildmap;
+AAIBuildMapTileCounts         AAIMap::s_buildMapTileCounts;
 std::vector<int>              AAIMap::blockmap;
 std::vector<float>            AAIMap::plateau_map;
 
@@ -66,7 +129,8 @@ AAIMap::AAIMap(AAI *ai, int xMapSize, int yMapSize, int losMapResolution) :
 	m_unitsInLOS(cfg->MAX_UNITS, 0),
 	m_scoutedEnemyUnitsMap(xMapSize, yMapSize, losMapResolution),
 	m_centerOfEnemyBase(xMapSize/2 , yMapSize/2),
-	m_lastLOSUpdateInFrame(0)
+	m_lastLOSUpdateInFrame(0),
+	m_radarMapResolution(-1)
 {
 	// all static vars are only initialized by the first AAI instance
 	if(ai->GetAAIInstance() == 1)
@@ -78,6 +142,12 @@ AAIMap::AAIMap(AAI *ai, int xMapSize, int yMapSize, int losMapResolution) :
 
 		s_maxSquaredMapDist = static_cast<float>(xSize*xSize + ySize*ySize);
 
+		// discard data of a previous game (AAI may be started again after the last instance has been deleted)
+		metal_spots.clear();
+		s_continents.clear();
+		s_landContinentSizeStatistics = StatisticalData();
+		s_seaContinentSizeStatistics  = StatisticalData();
+
 		this->losMapResolution = losMapResolution;
 		xLOSMapSize = xMapSize / losMapResolution;
 		yLOSMapSize = yMapSize / losMapResolution;
@@ -96,7 +166,8 @@ AAIMap::AAIMap(AAI *ai, int xMapSize, int yMapSize, int losMapResolution) :
 		xSectorSize = xSectorSizeMap * SQUARE_SIZE;
 		ySectorSize = ySectorSizeMap * SQUARE_SIZE;
 
-		s_buildmap.resize(xMapSize*yMapSize);
+		s_buildmap.Init(xMapSize, yMapSize);
+		s_buildMapTileCounts.Init(&s_buildmap, xMapSize, yMapSize);
 		blockmap.resize(xMapSize*yMapSize, 0);
 		plateau_map.resize(xMapSize/4*xMapSize/4, 0.0f);
 
@@ -106,11 +177,16 @@ AAIMap::AAIMap(AAI *ai, int xMapSize, int yMapSize, int losMapResolution) :
 
 		s_continentMap.Init(xMapSize, yMapSize);
 
-		InitContinents();
+		// worker threads are only needed for the analysis of the map at game start (i.e. not started if data can be loaded from cache files)
+		std::unique_ptr<AAIThreadPool> threadPool;
 
-		ReadMapCacheFile();
+		InitContinents(threadPool);
+
+		ReadMapCacheFile(threadPool);
 	}
 
+	m_losMap.Init(xLOSMapSize, yLOSMapSize);
+
 	ai->Log("Map size: %i x %i    LOS map size: %i x %i  (los res: %i)\n", xMapSize, yMapSize, xLOSMapSize, yLOSMapSize, losMapResolution);
 
 	m_sectorMap.resize(xSectors, std::vector<AAISector>(ySectors));
@@ -122,6 +198,9 @@ AAIMap::AAIMap(AAI *ai, int xMapSize, int yMapSize, int losMapResolution) :
 			m_sectorMap[x][y].Init(ai, x, y);
 	}
 
+	// register enemy units that are already within LOS/radar coverage (changes are reported by events afterwards)
+	ReconcileEnemyUnits();
+
 	// add metalspots to their sectors
 	for(auto& spot : metal_spots)
 	{
@@ -196,7 +275,7 @@ AAIMap::~AAIMap(void)
 
 		fclose(file);
 
-		s_buildmap.clear();
+		s_buildmap.Clear();
 		blockmap.clear();
 		plateau_map.clear();
 	}
@@ -204,213 +283,180 @@ AAIMap::~AAIMap(void)
 	m_unitsInLOS.clear();
 }
 
-void AAIMap::ReadMapCacheFile()
+void AAIMap::ReadMapCacheFile(std::unique_ptr<AAIThreadPool>& threadPool)
 {
-	// try to read cache file
-	bool loaded = false;
-
-	const size_t buffer_sizeMax = 512;
-	char buffer[buffer_sizeMax];
+	const std::string mapCacheFilename = LocateMapCacheFile();
 
-	const std::string mapCache_filename = LocateMapCacheFile();
-
-	FILE *file;
-
-	if((file = fopen(mapCache_filename.c_str(), "r")) != NULL)
+	if(LoadMapCache(mapCacheFilename))
 	{
-		// check if correct version
-		fscanf(file, "%s ", buffer);
-
-		if(strcmp(buffer, MAP_CACHE_VERSION))
-		{
-			ai->LogConsole("Mapcache out of date - creating new one");
-			fclose(file);
-		}
-		else
-		{
-			int temp;
-			float temp_float;
-
-			// load if its a metal map
-			fscanf(file, "%i ", &temp);
-			s_isMetalMap = (bool)temp;
-
-			// load map type
-			fscanf(file, "%s ", buffer);
-
-			if(!strcmp(buffer, "LAND_MAP"))
-				s_mapType.SetMapType(EMapType::LAND);
-			else if(!strcmp(buffer, "LAND_WATER_MAP"))
-				s_mapType.SetMapType(EMapType::LAND_WATER);
-			else if(!strcmp(buffer, "WATER_MAP"))
-				s_mapType.SetMapType(EMapType::WATER);
-			else
-				s_mapType.SetMapType(EMapType::UNKNOWN);
-
-			// load water ratio
-			fscanf(file, "%f ", &s_waterTilesRatio);
-
-			// load buildmap
-			for(int y = 0; y < yMapSize; ++y)
-			{
-				for(int x = 0; x < xMapSize; ++x)
-				{
-					unsigned int value;
-					fscanf(file, "%u", &value);
-
-					const int cell = x + y * xMapSize;
-					s_buildmap[cell].m_tileType = static_cast<uint8_t>(value);
-				}
-			}
-
-			//const springLegacyAI::UnitDef* def = ai->GetAICallback()->GetUnitDef("armmine1");
-
-			// load plateau map
-			for(int y = 0; y < yMapSize/4; ++y)
-			{
-				for(int x = 0; x < xMapSize/4; ++x)
-				{
-					const int cell = x + y * (xMapSize/4);
-					fscanf(file, "%f ", &plateau_map[cell]);
-
-					/*if(	plateau_map[cell] > 0.0f)
-					{
-						float3 myPos(static_cast<float>(x*4), 0.0, static_cast<float>(y*4) );
-						BuildMapPos2Pos(&myPos, def); 
-						myPos.y = ai->GetAICallback()->GetElevation(myPos.x, myPos.z);
-						ai->GetAICallback()->DrawUnit("armmine1", myPos, 0.0f, 1000, ai->GetAICallback()->GetMyAllyTeam(), true, true);	
-					}*/
-				}
-			}
-
-			// load metal spots
-			AAIMetalSpot spot;
-			fscanf(file, "%i ", &temp);
-
-			for(int i = 0; i < temp; ++i)
-			{
-				fscanf(file, "%f %f %f %f ", &(spot.pos.x), &(spot.pos.y), &(spot.pos.z), &(spot.amount));
-				spot.occupied = false;
-				metal_spots.push_back(spot);
-			}
-
-			fscanf(file, "%i %i ", &s_metalSpotsOnLand, &s_metalSpotsInSea);
-
-			fclose(file);
-
-			ai->Log("Map cache file successfully loaded\n");
-
-			loaded = true;
-		}
+		ai->Log("Map cache file successfully loaded\n");
 	}
-
-	if(!loaded)  // create new map data
+	else  // create new map data
 	{
+		ai->LogConsole("No valid map cache found - creating new one");
+
 		// detect cliffs/water and create plateau map
-		AnalyseMap();
+		AnalyseMap(GetMapAnalysisThreadPool(threadPool));
 
 		DetermineMapType();
 
 		// search for metal spots after analysis of map for cliffs/water to avoid overriding of blocked underwater metal spots (5) with water (4)
-		DetectMetalSpots();
+		DetectMetalSpots(GetMapAnalysisThreadPool(threadPool));
 
-		//////////////////////////////////////////////////////////////////////////////////////////////////////
 		// save mod independent map data
-		const std::string mapCache_filename = LocateMapCacheFile();
+		SaveMapCache(mapCacheFilename);
+	}
+}
 
-		file = fopen(mapCache_filename.c_str(), "w+");
+bool AAIMap::LoadMapCache(const std::string& filename)
+{
+	AAICacheFile cacheFile(MAP_CACHE_VERSION, ai->GetAICallback()->GetMapHash(), xMapSize, yMapSize);
 
-		fprintf(file, "%s\n", MAP_CACHE_VERSION);
+	if(cacheFile.Read(filename, static_cast<int>(EMapCacheSection::NUMBER_OF_SECTIONS)) == false)
+		return false;
 
-		// save if its a metal map
-		fprintf(file, "%i\n", (int)s_isMetalMap);
+	//-----------------------------------------------------------------------------------------------------------------
+	// check size of all sections before any data is copied (map analysis relies on unmodified build/plateau map)
+	//-----------------------------------------------------------------------------------------------------------------
+	const size_t buildMapSize    = s_buildmap.GetDataSize();
+	const size_t plateauMapSize  = plateau_map.size() * sizeof(float);
+	const size_t metalSpotsSize  = cacheFile.GetSectionSize(static_cast<int>(EMapCacheSection::METAL_SPOTS));
 
-		const char *temp_buffer = GetMapTypeString(s_mapType);
+	const bool sectionSizesValid =    (cacheFile.GetSectionSize(static_cast<int>(EMapCacheSection::GENERAL))     == sizeof(MapCacheGeneralData))
+								   && (cacheFile.GetSectionSize(static_cast<int>(EMapCacheSection::BUILD_MAP))   == buildMapSize)
+								   && (cacheFile.GetSectionSize(static_cast<int>(EMapCacheSection::PLATEAU_MAP)) == plateauMapSize)
+								   && (metalSpotsSize % sizeof(MapCacheMetalSpot) == 0);
 
-		// save map type
-		fprintf(file, "%s\n", temp_buffer);
+	if(sectionSizesValid == false)
+		return false;
 
-		// save water ratio
-		fprintf(file, "%f\n", s_waterTilesRatio);
+	MapCacheGeneralData generalData;
+	cacheFile.CopySection(static_cast<int>(EMapCacheSection::GENERAL), &generalData, sizeof(MapCacheGeneralData));
 
-		// save buildmap
-		for(int y = 0; y < yMapSize; ++y)
-		{
-			for(int x = 0; x < xMapSize; ++x)
-			{
-				const int cell = x + y * xMapSize;
-				fprintf(file, "%u ", s_buildmap[cell].m_tileType);
-			}
-			fprintf(file, "\n");
-		}
+	// plateau map has been calculated with different settings
+	if(generalData.terrainDetectionRange != cfg->TERRAIN_DETECTION_RANGE)
+		return false;
 
-		// save plateau map
-		for(int y = 0; y < yMapSize/4; ++y)
-		{
-			for(int x = 0; x < xMapSize/4; ++x)
-			{
-				const int cell = x + y * (xMapSize/4);
-				fprintf(file, "%f ", plateau_map[cell]);
-			}
-			fprintf(file, "\n");
-		}
-			
-		// save mex spots
-		s_metalSpotsOnLand = 0;
-		s_metalSpotsInSea = 0;
+	//-----------------------------------------------------------------------------------------------------------------
+	// load general data, build map, and plateau map
+	//-----------------------------------------------------------------------------------------------------------------
+	cacheFile.CopySection(static_cast<int>(EMapCacheSection::BUILD_MAP),   s_buildmap.GetData(), buildMapSize);
+	cacheFile.CopySection(static_cast<int>(EMapCacheSection::PLATEAU_MAP), plateau_map.data(), plateauMapSize);
+	s_buildMapTileCounts.SetAreaOutdated(0, 0, xMapSize, yMapSize);
 
-		fprintf(file, "%u\n", static_cast<unsigned int>(metal_spots.size()) );
+	s_isMetalMap       = static_cast<bool>(generalData.isMetalMap);
+	s_waterTilesRatio  = generalData.waterTilesRatio;
+	s_metalSpotsOnLand = generalData.metalSpotsOnLand;
+	s_metalSpotsInSea  = generalData.metalSpotsInSea;
 
-		for(std::list<AAIMetalSpot>::iterator spot = metal_spots.begin(); spot != metal_spots.end(); ++spot)
-		{
-			fprintf(file, "%f %f %f %f \n", spot->pos.x, spot->pos.y, spot->pos.z, spot->amount);
+	if( (generalData.mapType >= 0) && (generalData.mapType < AAIMapType::numberOfMapTypes) )
+		s_mapType.SetMapType( static_cast<EMapType>(generalData.mapType) );
+	else
+		s_mapType.SetMapType(EMapType::UNKNOWN);
 
-			if(spot->pos.y >= 0.0f)
-				++s_metalSpotsOnLand;
-			else
-				++s_metalSpotsInSea;
-		}
+	//-----------------------------------------------------------------------------------------------------------------
+	// load metal spots
+	//-----------------------------------------------------------------------------------------------------------------
+	const char* metalSpotData       = cacheFile.GetSectionData(static_cast<int>(EMapCacheSection::METAL_SPOTS));
+	const size_t numberOfMetalSpots = metalSpotsSize / sizeof(MapCacheMetalSpot);
 
-		fprintf(file, "%i %i\n", s_metalSpotsOnLand, s_metalSpotsInSea);
+	for(size_t i = 0; i < numberOfMetalSpots; ++i)
+	{
+		MapCacheMetalSpot cachedSpot;
+		std::memcpy(&cachedSpot, metalSpotData + i * sizeof(MapCacheMetalSpot), sizeof(MapCacheMetalSpot));
 
-		fclose(file);
+		metal_spots.push_back( AAIMetalSpot(float3(cachedSpot.x, cachedSpot.y, cachedSpot.z), cachedSpot.amount) );
+	}
 
-		ai->Log("New map cache-file created\n");
+	return true;
+}
+
+void AAIMap::SaveMapCache(const std::string& filename)
+{
+	s_metalSpotsOnLand = 0;
+	s_metalSpotsInSea  = 0;
+
+	std::vector<MapCacheMetalSpot> cachedSpots;
+	cachedSpots.reserve(metal_spots.size());
+
+	for(const auto& spot : metal_spots)
+	{
+		MapCacheMetalSpot cachedSpot;
+		cachedSpot.x      = spot.pos.x;
+		cachedSpot.y      = spot.pos.y;
+		cachedSpot.z      = spot.pos.z;
+		cachedSpot.amount = spot.amount;
+		cachedSpots.push_back(cachedSpot);
+
+		if(spot.pos.y >= 0.0f)
+			++s_metalSpotsOnLand;
+		else
+			++s_metalSpotsInSea;
 	}
+
+	MapCacheGeneralData generalData;
+	generalData.isMetalMap       = static_cast<int32_t>(s_isMetalMap);
+	generalData.mapType          = static_cast<int32_t>(s_mapType.GetArrayIndex());
+	generalData.waterTilesRatio  = s_waterTilesRatio;
+	generalData.metalSpotsOnLand = s_metalSpotsOnLand;
+	generalData.metalSpotsInSea  = s_metalSpotsInSea;
+	generalData.terrainDetectionRange = cfg->TERRAIN_DETECTION_RANGE;
+
+	// sections must be added in the order given by EMapCacheSection
+	AAICacheFile cacheFile(MAP_CACHE_VERSION, ai->GetAICallback()->GetMapHash(), xMapSize, yMapSize);
+	cacheFile.AddSection(&generalData,       sizeof(MapCacheGeneralData));
+	cacheFile.AddSection(s_buildmap.GetData(), s_buildmap.GetDataSize());
+	cacheFile.AddSection(plateau_map.data(), plateau_map.size() * sizeof(float));
+	cacheFile.AddSection(cachedSpots.data(), cachedSpots.size() * sizeof(MapCacheMetalSpot));
+
+	if(cacheFile.Write(filename))
+		ai->Log("New map cache-file created\n");
+	else
+		ai->Log(ELogLevel::FAILURE, ELogCategory::MAP, "Failed to write map cache file %s\n", filename.c_str());
 }
 
-void AAIMap::InitContinents()
+void AAIMap::InitContinents(std::unique_ptr<AAIThreadPool>& threadPool)
 {
 	//-----------------------------------------------------------------------------------------------------------------
 	// try to load continent data from cache file
 	//-----------------------------------------------------------------------------------------------------------------
 	const std::string continentsCachefilename = cfg->GetFileName(ai->GetAICallback(), cfg->GetUniqueName(ai->GetAICallback(), true, false, true, false), MAP_CACHE_PATH, "_continent.dat", true);
-	const bool continentsLoadedFromCache = ReadContinentFile(continentsCachefilename);
 
 	//-----------------------------------------------------------------------------------------------------------------
 	// create new continent data and store them to cache file if loading failed
 	//-----------------------------------------------------------------------------------------------------------------
-	if(continentsLoadedFromCache == false)
+	if(LoadContinentCache(continentsCachefilename))
 	{
+		ai->Log("Continent cache file successfully loaded\n");
+	}
+	else
+	{
+		ai->LogConsole("No valid continent cache found - creating new one");
+
 		// create new continent maps
 		const float *heightMap = ai->GetAICallback()->GetHeightMap();
-		s_continentMap.DetectContinents(s_continents, heightMap, xMapSize, yMapSize);
+		s_continentMap.DetectContinents(GetMapAnalysisThreadPool(threadPool), s_continents, heightMap, xMapSize, yMapSize);
 
-		// store results to cache file
-		FILE* file = fopen(continentsCachefilename.c_str(), "w+");
+		SaveContinentCache(continentsCachefilename);
 
-		fprintf(file, "%s\n",  CONTINENT_DATA_VERSION);
+		// human readable version of the continent map for debugging purposes
+		if(cfg->EXPORT_CONTINENT_MAP)
+		{
+			const std::string continentMapFilename = cfg->GetFileName(ai->GetAICallback(), cfg->GetUniqueName(ai->GetAICallback(), true, false, true, false), MAP_CACHE_PATH, "_continent.txt", true);
+			FILE* file = fopen(continentMapFilename.c_str(), "w+");
 
-		// save continent map
-		s_continentMap.SaveToFile(file);
+			if(file != nullptr)
+			{
+				s_continentMap.SaveToFile(file);
 
-		// save continents
-		fprintf(file, "\n%i\n", static_cast<int>(s_continents.size()) );
+				fprintf(file, "\n%i\n", static_cast<int>(s_continents.size()) );
 
-		for(size_t c = 0; c < s_continents.size(); ++c)
-			fprintf(file, "%i %i\n", s_continents[c].size, static_cast<int>(s_continents[c].water) );
+				for(const auto& continent : s_continents)
+					fprintf(file, "%i %i\n", continent.size, static_cast<int>(continent.water) );
 
-		fclose(file);
+				fclose(file);
+			}
+		}
 	}
 
 	//-----------------------------------------------------------------------------------------------------------------
@@ -429,52 +475,71 @@ void AAIMap::InitContinents()
 	s_seaContinentSizeStatistics.Finalize();
 }
 
-bool AAIMap::ReadContinentFile(const std::string& filename)
+bool AAIMap::LoadContinentCache(const std::string& filename)
 {
-	FILE* file = fopen(filename.c_str(), "r");
+	AAICacheFile cacheFile(CONTINENT_DATA_VERSION, ai->GetAICallback()->GetMapHash(), xMapSize, yMapSize);
 
-	if(file != NULL)
-	{
-		char buffer[4096];
-		// check if correct version
-		fscanf(file, "%s ", buffer);
-
-		if(strcmp(buffer, CONTINENT_DATA_VERSION))
-		{
-			ai->LogConsole("Continent cache out of date - creating new one");
-			fclose(file);
-			return false;
-		}
-		else
-		{
-			s_continentMap.LoadFromFile(file);
+	if(cacheFile.Read(filename, static_cast<int>(EContinentCacheSection::NUMBER_OF_SECTIONS)) == false)
+		return false;
 
-			// load continents
-			int numberOfContinents;
-			fscanf(file, "%i ", &numberOfContinents);
+	const size_t runsSize       = cacheFile.GetSectionSize(static_cast<int>(EContinentCacheSection::CONTINENT_MAP));
+	const size_t continentsSize = cacheFile.GetSectionSize(static_cast<int>(EContinentCacheSection::CONTINENTS));
 
-			s_continents.resize(numberOfContinents);
+	if( (runsSize % (2 * sizeof(int32_t)) != 0) || (continentsSize % sizeof(ContinentCacheEntry) != 0) )
+		return false;
 
-			for(int i = 0; i < numberOfContinents; ++i)
-			{
-				int seaContinent;
-				fscanf(file, "%i %i ", &s_continents[i].size, &seaContinent);
+	//-----------------------------------------------------------------------------------------------------------------
+	// decode continent map
+	//-----------------------------------------------------------------------------------------------------------------
+	std::vector<int32_t> runs(runsSize / sizeof(int32_t));
+	cacheFile.CopySection(static_cast<int>(EContinentCacheSection::CONTINENT_MAP), runs.data(), runsSize);
 
-				s_continents[i].water = static_cast<bool>(seaContinent);
-				s_continents[i].id = i;
-			}
+	if(s_continentMap.DecodeRunLength(runs) == false)
+		return false;
 
-			fclose(file);
+	//-----------------------------------------------------------------------------------------------------------------
+	// load continents
+	//-----------------------------------------------------------------------------------------------------------------
+	std::vector<ContinentCacheEntry> cachedContinents(continentsSize / sizeof(ContinentCacheEntry));
+	cacheFile.CopySection(static_cast<int>(EContinentCacheSection::CONTINENTS), cachedContinents.data(), continentsSize);
 
-			ai->Log("Continent cache file successfully loaded\n");
+	s_continents.resize(cachedContinents.size());
 
-			return true;
-		}
+	for(size_t i = 0; i < cachedContinents.size(); ++i)
+	{
+		s_continents[i].id    = static_cast<int>(i);
+		s_continents[i].size  = cachedContinents[i].size;
+		s_continents[i].water = static_cast<bool>(cachedContinents[i].water);
 	}
-	else
+
+	return true;
+}
+
+void AAIMap::SaveContinentCache(const std::string& filename)
+{
+	std::vector<int32_t> runs;
+	s_continentMap.EncodeRunLength(runs);
+
+	std::vector<ContinentCacheEntry> cachedContinents;
+	cachedContinents.reserve(s_continents.size());
+
+	for(const auto& continent : s_continents)
 	{
-		return false;
+		ContinentCacheEntry cachedContinent;
+		cachedContinent.size  = continent.size;
+		cachedContinent.water = static_cast<int32_t>(continent.water);
+		cachedContinents.push_back(cachedContinent);
 	}
+
+	// sections must be added in the order given by EContinentCacheSection
+	AAICacheFile cacheFile(CONTINENT_DATA_VERSION, ai->GetAICallback()->GetMapHash(), xMapSize, yMapSize);
+	cacheFile.AddSection(runs.data(),             runs.size()             * sizeof(int32_t));
+	cacheFile.AddSection(cachedContinents.data(), cachedContinents.size() * sizeof(ContinentCacheEntry));
+
+	if(cacheFile.Write(filename))
+		ai->Log("New continent cache-file created\n");
+	else
+		ai->Log(ELogLevel::FAILURE, ELogCategory::MAP, "Failed to write continent cache file %s\n", filename.c_str());
 }
 
 std::string AAIMap::LocateMapLearnFile() const
@@ -647,26 +712,12 @@ void AAIMap::ChangeBuildMapOccupation(int xPos, int yPos, int xSize, int ySize,
 	const int xEnd = std::min(xPos + xSize, xMapSize);
 	const int yEnd = std::min(yPos + ySize, yMapSize);
 
-	for(int y = yPos; y < yEnd; ++y)
-	{
-		for(int x = xPos; x < xEnd; ++x)
-		{
-			if(occupy)
-				s_buildmap[x+y*xMapSize].OccupyTile();
-			else
-				s_buildmap[x+y*xMapSize].FreeTile();
+	s_buildMapTileCounts.SetAreaOutdated(xPos, yPos, xEnd, yEnd);
 
-			// debug
-			/*if(x%2 == 0 && y%2 == 0)
-			{
-				const springLegacyAI::UnitDef* unitDef = ai->GetAICallback()->GetUnitDef("armmine1");
-				float3 myPos;
-				ConvertMapPosToUnitPos(MapPos(x,y), myPos, ai->s_buildTree.GetFootprint(unitDef->id) ); 
-				myPos.y = ai->GetAICallback()->GetElevation(myPos.x, myPos.z);
-				ai->GetAICallback()->DrawUnit("armmine1", myPos, 0.0f, 2000, ai->GetAICallback()->GetMyAllyTeam(), true, true);
-			}*/
-		}
-	}
+	if(occupy)
+		s_buildmap.OccupyTiles(xPos, yPos, xEnd, yEnd);
+	else
+		s_buildmap.FreeTiles(xPos, yPos, xEnd, yEnd);
 }
 
 BuildSite AAIMap::DetermineRandomBuildsite(UnitDefId unitDefId, int xStart, int xEnd, int yStart, int yEnd, int tries) const
@@ -683,10 +734,10 @@ BuildSite AAIMap::DetermineRandomBuildsite(UnitDefId unitDefId, int xStart, int
 		MapPos mapPos(xStart, yStart);
 
 		if( randomXRange > 0)
-			mapPos.x += rand()%randomXRange;
+			mapPos.x += ai->Random().NextInt(randomXRange);
 
 		if( randomYRange > 0)
-			mapPos.y += rand()%randomYRange;
+			mapPos.y += ai->Random().NextInt(randomYRange);
 
 		BuildSite buildSite = CheckIfSuitableBuildSite(footprint, unitDef, mapPos);
 
@@ -699,7 +750,7 @@ BuildSite AAIMap::DetermineRandomBuildsite(UnitDefId unitDefId, int xStart, int
 
 BuildSite AAIMap::FindBuildsiteCloseToUnit(UnitDefId buildingDefId, UnitId unitId) const
 {
-	const float3 unitPosition = ai->GetAICallback()->GetUnitPos(unitId.id);
+	const float3 unitPosition = ai->UnitData()->GetUnitPos(unitId);
 
 	const UnitFootprint            footprint = DetermineRequiredFreeBuildspace(buildingDefId);
 	const springLegacyAI::UnitDef* unitDef   = &ai->BuildTable()->GetUnitDef(buildingDefId.id);
@@ -789,7 +840,7 @@ BuildSite AAIMap::DetermineElevatedBuildsite(UnitDefId buildingDefId, int xStart
 					elevatedTerrainFactor = 0.5f * (1.0f + 0.01f * std::max(-100.0f, std::min( plateau_map[plateauMapCellIndex], 100.0f)));
 				}
 
-				const float rating = 0.05f * (float)(rand()%20) + 5.0f * edgeDistanceFactor + 3.0 * elevatedTerrainFactor;
+				const float rating = 0.05f * (float)(ai->Random().NextInt(20)) + 5.0f * edgeDistanceFactor + 3.0 * elevatedTerrainFactor;
 
 				if(rating > bestBuildSite.Rating())
 				{
@@ -885,7 +936,7 @@ BuildSite AAIMap::DetermineBuildsiteForStaticDefence(UnitDefId staticDefence, co
 				const int cell = (xPos/4 + (xMapSize/4) * yPos/4);
 				const float terrainValue = std::min(AAIConstants::maxCombatPower, terrainModifier * plateau_map[cell]);
 
-				float rating = defenceValue + distanceValue + terrainValue + 0.2f * (float)(rand()%10);
+				float rating = defenceValue + distanceValue + terrainValue + 0.2f * (float)(ai->Random().NextInt(10));
 
 				// determine minimum distance from buildpos to the edges of the map
 				const int edge_distance = GetEdgeDistance(xPos, yPos);
@@ -936,21 +987,17 @@ BuildSite AAIMap::CheckIfSuitableBuildSite(const UnitFootprint& footprint, const
 
 bool AAIMap::CanBuildAt(const MapPos& mapPos, const UnitFootprint& footprint) const
 {
-	if( (mapPos.x+footprint.xSize > xMapSize) || (mapPos.y+footprint.ySize > yMapSize) )
+	if( (mapPos.x < 0) || (mapPos.y < 0) || (mapPos.x+footprint.xSize > xMapSize) || (mapPos.y+footprint.ySize > yMapSize) )
 		return false; // buildsite too close to edges of map
+	else if(footprint.xSize * footprint.ySize <= maxTilesCheckedDirectly)
+	{
+		// small footprints: checking the tiles (stops at first invalid one) is faster than looking up the tile counts
+		return (s_buildmap.IsTileTypeSetInArea(footprint.invalidTileTypes, mapPos.x, mapPos.y, mapPos.x+footprint.xSize, mapPos.y+footprint.ySize) == false);
+	}
 	else
 	{
-		for(int y = mapPos.y; y < mapPos.y+footprint.ySize; ++y)
-		{
-			for(int x = mapPos.x; x < mapPos.x+footprint.xSize; ++x)
-			{
-				// all squares must be valid
-				if(s_buildmap[x+y*xMapSize].IsTileTypeSet(footprint.invalidTileTypes))
-					return false;
-			}
-		}
-
-		return true;
+		// all squares must be valid
+		return (s_buildMapTileCounts.CountTiles(footprint.invalidTileTypes, mapPos.x, mapPos.y, mapPos.x+footprint.xSize, mapPos.y+footprint.ySize) == 0);
 	}
 }
 
@@ -965,7 +1012,7 @@ void AAIMap::CheckRows(int xPos, int yPos, int xSize, int ySize, bool add)
 		{
 			if(y >= yMapSize)
 			{
-				ai->Log("ERROR: y = %i index out of range when checking horizontal rows", y);
+				ai->Log(ELogLevel::FAILURE, ELogCategory::MAP, "y = %i index out of range when checking horizontal rows", y);
 				return;
 			}
 
@@ -975,7 +1022,7 @@ void AAIMap::CheckRows(int xPos, int yPos, int xSize, int ySize, bool add)
 			for(int x = xPos+xSize; x < xPos+xSize+cfg->MAX_XROW; ++x)
 			{
 				// abort when first non occupied tile is found
-				if(s_buildmap[x+y*xMapSize].IsTileTypeSet(nonOccupiedTile))
+				if(s_buildmap.IsTileTypeSet(x, y, nonOccupiedTile))
 				{
 					xRight = x;
 					break;
@@ -988,7 +1035,7 @@ void AAIMap::CheckRows(int xPos, int yPos, int xSize, int ySize, bool add)
 			int xLeft(-1);
 			for(int x = xPos-1; x >= xPos - cfg->MAX_XROW; --x)
 			{
-				if(s_buildmap[x+y*xMapSize].IsTileTypeSet(nonOccupiedTile))
+				if(s_buildmap.IsTileTypeSet(x, y, nonOccupiedTile))
 				{
 					xLeft = x;
 					break;
@@ -1033,7 +1080,7 @@ void AAIMap::CheckRows(int xPos, int yPos, int xSize, int ySize, bool add)
 		{
 			if(x >= xMapSize)
 			{
-				ai->Log("ERROR: x = %i index out of range when checking vertical rows", x);
+				ai->Log(ELogLevel::FAILURE, ELogCategory::MAP, "x = %i index out of range when checking vertical rows", x);
 				return;
 			}
 
@@ -1042,7 +1089,7 @@ void AAIMap::CheckRows(int xPos, int yPos, int xSize, int ySize, bool add)
 			int yBottom(-1);
 			for(int y = yPos+ySize; y < yPos+ySize+cfg->MAX_YROW; ++y)
 			{
-				if(s_buildmap[x+y*xMapSize].IsTileTypeSet(nonOccupiedTile))
+				if(s_buildmap.IsTileTypeSet(x, y, nonOccupiedTile))
 				{
 					yBottom = y;
 					break;
@@ -1055,7 +1102,7 @@ void AAIMap::CheckRows(int xPos, int yPos, int xSize, int ySize, bool add)
 			int yTop(-1);
 			for(int y = yPos-1; y >= yPos - cfg->MAX_YROW; --y)
 			{
-				if(s_buildmap[x+y*xMapSize].IsTileTypeSet(nonOccupiedTile))
+				if(s_buildmap.IsTileTypeSet(x, y, nonOccupiedTile))
 				{
 					yTop = y;
 					break;
@@ -1101,6 +1148,8 @@ void AAIMap::BlockTiles(int xPos, int yPos, int width, int height, bool block)
 	const int xEnd   = std::min(xPos + width, xMapSize);
 	const int yEnd   = std::min(yPos + height, yMapSize);
 
+	s_buildMapTileCounts.SetAreaOutdated(xStart, yStart, xEnd, yEnd);
+
 	for(int y = yStart; y < yEnd; ++y)
 	{
 		for(int x = xStart; x < xEnd; ++x)
@@ -1111,8 +1160,8 @@ void AAIMap::BlockTiles(int xPos, int yPos, int width, int height, bool block)
 			{
 				// if no building ordered that cell to be blocked, update buildmap
 				// (only if space is not already occupied by a building)
-				if( (blockmap[tileIndex] == 0) && (s_buildmap[tileIndex].IsTileTypeSet(EBuildMapTileType::FREE)) )
-					s_buildmap[tileIndex].BlockTile();	
+				if( (blockmap[tileIndex] == 0) && (s_buildmap.IsTileTypeSet(x, y, EBuildMapTileType::FREE)) )
+					s_buildmap.BlockTile(x, y);	
 
 				++blockmap[tileIndex];
 			}
@@ -1124,8 +1173,8 @@ void AAIMap::BlockTiles(int xPos, int yPos, int width, int height, bool block)
 
 					// if cell is not blocked anymore, mark cell on buildmap as empty (only if it has been marked bloked
 					//					- if it is not marked as blocked its occupied by another building or unpassable)
-					if(blockmap[tileIndex] == 0 && s_buildmap[tileIndex].IsTileTypeSet(EBuildMapTileType::BLOCKED_SPACE))
-						s_buildmap[tileIndex].FreeTile();	
+					if(blockmap[tileIndex] == 0 && s_buildmap.IsTileTypeSet(x, y, EBuildMapTileType::BLOCKED_SPACE))
+						s_buildmap.FreeTile(x, y);	
 				}
 			}
 
@@ -1204,103 +1253,239 @@ UnitFootprint AAIMap::DetermineRequiredFreeBuildspace(UnitDefId unitDefId) const
 
 int AAIMap::GetCliffyCells(int xPos, int yPos, int xSize, int ySize) const
 {
-	int cliffs(0);
-
 	// count cells with big slope
-	for(int y = yPos; y < yPos + ySize; ++y)
-	{
-		for(int x = xPos; x < xPos + xSize; ++x)
-		{
-			if(s_buildmap[x+y*xMapSize].IsTileTypeSet(EBuildMapTileType::CLIFF))
-				++cliffs;
-		}
-	}
-
-	return cliffs;
+	return s_buildmap.CountTiles(EBuildMapTileType::CLIFF, xPos, yPos, xPos + xSize, yPos + ySize);
 }
 
-void AAIMap::AnalyseMap()
+void AAIMap::AnalyseMap(AAIThreadPool& threadPool)
 {
 	const float *height_map = ai->GetAICallback()->GetHeightMap();
 
-	const int xPlateauMapSize(xMapSize/4);
 	const int yPlateauMapSize(yMapSize/4);
 
 	//-----------------------------------------------------------------------------------------------------------------
 	// determine tile type
 	//-----------------------------------------------------------------------------------------------------------------
-	int waterCells(0);
-	for(int y = 0; y < yMapSize; ++y)
+	std::vector<int> waterCellsPerBand(AAIThreadPool::GetNumberOfBands(yMapSize, rowsPerBuildMapBand), 0);
+
+	threadPool.ProcessRowBands(yMapSize, rowsPerBuildMapBand, [&](int band, int yStart, int yEnd)
 	{
-		for(int x = 0; x < xMapSize; ++x)
-		{
-			s_buildmap[x+y*xMapSize].SetTileType(EBuildMapTileType::FREE);
+		int waterCells(0);
 
-			// determine tile type (land or water)
-			if(height_map[x + y * xMapSize] < 0.0f)
+		for(int y = yStart; y < yEnd; ++y)
+		{
+			for(int x = 0; x < xMapSize; ++x)
 			{
-				s_buildmap[x+y*xMapSize].SetTileType(EBuildMapTileType::WATER);
-				++waterCells;
-			}
-			else
-				s_buildmap[x+y*xMapSize].SetTileType(EBuildMapTileType::LAND);
+				s_buildmap.SetTileType(x, y, EBuildMapTileType::FREE);
 
-			// determine slope to detect cliffs
-			if( (x < xMapSize - 4) && (y < yMapSize - 4) )
-			{
-				const float xSlope = (height_map[y * xMapSize + x] - height_map[y * xMapSize + x + 4])/64.0f;
+				// determine tile type (land or water)
+				if(height_map[x + y * xMapSize] < 0.0f)
+				{
+					s_buildmap.SetTileType(x, y, EBuildMapTileType::WATER);
+					++waterCells;
+				}
+				else
+					s_buildmap.SetTileType(x, y, EBuildMapTileType::LAND);
 
-				// check x-direction
-				if( (xSlope > cfg->CLIFF_SLOPE) || (-xSlope > cfg->CLIFF_SLOPE) )
-					s_buildmap[x+y*xMapSize].SetTileType(EBuildMapTileType::CLIFF);
-				else	// check y-direction
+				// determine slope to detect cliffs
+				if( (x < xMapSize - 4) && (y < yMapSize - 4) )
 				{
-					const float ySlope = (height_map[y * xMapSize + x] - height_map[(y+4) * xMapSize + x])/64.0f;
+					const float xSlope = (height_map[y * xMapSize + x] - height_map[y * xMapSize + x + 4])/64.0f;
 
-					if(ySlope > cfg->CLIFF_SLOPE || -ySlope > cfg->CLIFF_SLOPE)
-						s_buildmap[x+y*xMapSize].SetTileType(EBuildMapTileType::CLIFF);
-					else
-						s_buildmap[x+y*xMapSize].SetTileType(EBuildMapTileType::FLAT);
+					// check x-direction
+					if( (xSlope > cfg->CLIFF_SLOPE) || (-xSlope > cfg->CLIFF_SLOPE) )
+						s_buildmap.SetTileType(x, y, EBuildMapTileType::CLIFF);
+					else	// check y-direction
+					{
+						const float ySlope = (height_map[y * xMapSize + x] - height_map[(y+4) * xMapSize + x])/64.0f;
+
+						if(ySlope > cfg->CLIFF_SLOPE || -ySlope > cfg->CLIFF_SLOPE)
+							s_buildmap.SetTileType(x, y, EBuildMapTileType::CLIFF);
+						else
+							s_buildmap.SetTileType(x, y, EBuildMapTileType::FLAT);
+					}
 				}
+				else
+					s_buildmap.SetTileType(x, y, EBuildMapTileType::FLAT);
 			}
-			else
-				s_buildmap[x+y*xMapSize].SetTileType(EBuildMapTileType::FLAT);
 		}
-	}
+
+		waterCellsPerBand[band] = waterCells;
+	});
+
+	int waterCells(0);
+	for(int bandWaterCells : waterCellsPerBand)
+		waterCells += bandWaterCells;
+
+	s_buildMapTileCounts.SetAreaOutdated(0, 0, xMapSize, yMapSize);
 
 	s_waterTilesRatio = static_cast<float>(waterCells) / static_cast<float>(xMapSize*yMapSize);
 
 	//-----------------------------------------------------------------------------------------------------------------
-	// calculate plateau map
+	// calculate plateau map (requires tile types of all rows to be determined)
+	//-----------------------------------------------------------------------------------------------------------------
+	const int terrainDetectionRange = cfg->TERRAIN_DETECTION_RANGE;
+
+	threadPool.ProcessRowBands(yPlateauMapSize, rowsPerPlateauMapBand, [&](int band, int yStart, int yEnd)
+	{
+		CalculatePlateauMap(height_map, terrainDetectionRange, yStart, yEnd);
+	});
+}
+
+void AAIMap::CalculatePlateauMap(const float* heightMap, int terrainDetectionRange, int yStart, int yEnd)
+{
+	// Every (center) tile with a distance of at least terrainDetectionRange to the map edges adds the height difference
+	// of every tile within [x-range, x+range-1] x [y-range, y+range-1] to the value of that tile (positive differences
+	// only if the tile is not a cliff). This is evaluated per tile: non-cliff tiles receive n * height minus the sum of
+	// the heights of the n center tiles within range (summed area table), cliff tiles only the (negative) differences to
+	// higher center tiles (center tiles are inserted into a 2D Fenwick tree in order of decreasing height).
+	const int xPlateauMapSize(xMapSize/4);
+	const int yPlateauMapSize(yMapSize/4);
+
+	auto heightOfTile = [&](int x, int y) { return heightMap[4 * (x + y * xMapSize)]; };
+
+	// center tiles that may affect tiles in the given rows
+	const int xCenterMin = terrainDetectionRange;
+	const int xCenterMax = xPlateauMapSize - terrainDetectionRange - 1;
+	const int yCenterMin = std::max(terrainDetectionRange, yStart - terrainDetectionRange + 1);
+	const int yCenterMax = std::min(yPlateauMapSize - terrainDetectionRange - 1, yEnd + terrainDetectionRange - 1);
+
+	const int xCenters = std::max(0, xCenterMax - xCenterMin + 1);
+	const int yCenters = std::max(0, yCenterMax - yCenterMin + 1);
+	const int tableWidth(xCenters + 1);
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// summed area table of the heights of the center tiles (double precision to avoid cancellation on large maps)
+	//-----------------------------------------------------------------------------------------------------------------
+	std::vector<double> heightSums(tableWidth * (yCenters + 1), 0.0);
+
+	for(int cy = 0; cy < yCenters; ++cy)
+	{
+		double rowSum(0.0);
+
+		for(int cx = 0; cx < xCenters; ++cx)
+		{
+			rowSum += heightOfTile(xCenterMin + cx, yCenterMin + cy);
+			heightSums[(cy+1) * tableWidth + cx + 1] = heightSums[cy * tableWidth + cx + 1] + rowSum;
+		}
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// process non-cliff tiles, store cliff tiles (and the center tiles within their range) for later processing
 	//-----------------------------------------------------------------------------------------------------------------
-	constexpr int TERRAIN_DETECTION_RANGE(6);
+	struct CenterTileRange
+	{
+		int   tileIndex;
+		float height;
+		int   xMin, xMax, yMin, yMax;
+	};
+
+	std::vector<CenterTileRange> cliffTiles;
+
+	for(int y = yStart; y < yEnd; ++y)
+	{
+		for(int x = 0; x < xPlateauMapSize; ++x)
+		{
+			const int tileIndex = x + y * xPlateauMapSize;
+
+			CenterTileRange range;
+			range.tileIndex = tileIndex;
+			range.height    = heightOfTile(x, y);
+			range.xMin      = std::max(xCenterMin, x - terrainDetectionRange + 1) - xCenterMin;
+			range.xMax      = std::min(xCenterMax, x + terrainDetectionRange)     - xCenterMin;
+			range.yMin      = std::max(yCenterMin, y - terrainDetectionRange + 1) - yCenterMin;
+			range.yMax      = std::min(yCenterMax, y + terrainDetectionRange)     - yCenterMin;
+
+			plateau_map[tileIndex] = 0.0f;
+
+			if( (range.xMin > range.xMax) || (range.yMin > range.yMax) )
+				continue;
 
-	for(int y = TERRAIN_DETECTION_RANGE; y < yPlateauMapSize - TERRAIN_DETECTION_RANGE; ++y)
+			const int buildMapTileIndex = 4 * (x + y * xMapSize);
+
+			//! @todo Investigate the reason for the exclusion of positive differences of cliff tiles
+			if(s_buildmap.IsTileTypeSet(buildMapTileIndex % xMapSize, buildMapTileIndex / xMapSize, EBuildMapTileType::CLIFF))
+			{
+				cliffTiles.push_back(range);
+			}
+			else
+			{
+				const int    centerTiles = (range.xMax - range.xMin + 1) * (range.yMax - range.yMin + 1);
+				const double heightSum   =   heightSums[(range.yMax+1) * tableWidth + range.xMax + 1] - heightSums[range.yMin * tableWidth + range.xMax + 1]
+				                           - heightSums[(range.yMax+1) * tableWidth + range.xMin]     + heightSums[range.yMin * tableWidth + range.xMin];
+
+				plateau_map[tileIndex] = static_cast<float>(static_cast<double>(centerTiles) * static_cast<double>(range.height) - heightSum);
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// process cliff tiles in order of decreasing height; all center tiles higher than the current tile have been
+	// added to the Fenwick trees (number and height sum of center tiles) before it is processed
+	//-----------------------------------------------------------------------------------------------------------------
+	if(cliffTiles.empty() == false)
 	{
-		for(int x = TERRAIN_DETECTION_RANGE; x < xPlateauMapSize - TERRAIN_DETECTION_RANGE; ++x)
+		std::vector<int>   centerTiles(xCenters * yCenters);
+		std::vector<float> centerTileHeights(xCenters * yCenters);
+
+		for(int i = 0; i < static_cast<int>(centerTiles.size()); ++i)
 		{
-			const float height = height_map[4 * (x + y * xMapSize)];
+			centerTiles[i]       = i;
+			centerTileHeights[i] = heightOfTile(xCenterMin + i % xCenters, yCenterMin + i / xCenters);
+		}
+
+		auto heightOfCenterTile = [&](int centerTile) { return centerTileHeights[centerTile]; };
+
+		std::sort(centerTiles.begin(), centerTiles.end(), [&](int lhs, int rhs) { return heightOfCenterTile(lhs) > heightOfCenterTile(rhs); });
+		std::sort(cliffTiles.begin(),  cliffTiles.end(),  [](const CenterTileRange& lhs, const CenterTileRange& rhs) { return lhs.height > rhs.height; });
+
+		std::vector<int>    higherTiles(tableWidth * (yCenters + 1), 0);
+		std::vector<double> higherTilesHeightSums(tableWidth * (yCenters + 1), 0.0);
 
-			for(int j = y - TERRAIN_DETECTION_RANGE; j < y + TERRAIN_DETECTION_RANGE; ++j)
+		auto addCenterTile = [&](int cx, int cy, float height)
+		{
+			for(int j = cy + 1; j <= yCenters; j += (j & -j))
 			{
-				for(int i = x - TERRAIN_DETECTION_RANGE; i < x + TERRAIN_DETECTION_RANGE; ++i)
+				for(int i = cx + 1; i <= xCenters; i += (i & -i))
 				{
-					const float diff = (height_map[4 * (i + j * xMapSize)] - height);
+					higherTiles[j * tableWidth + i]           += 1;
+					higherTilesHeightSums[j * tableWidth + i] += height;
+				}
+			}
+		};
 
-					if(diff > 0.0f)
-					{
-						//! @todo Investigate the reason for this check
-						if(s_buildmap[4 * (i + j * xMapSize)].IsTileTypeNotSet(EBuildMapTileType::CLIFF) )
-							plateau_map[i + j * xPlateauMapSize] += diff;
-					}
-					else
-						plateau_map[i + j * xPlateauMapSize] += diff;
+		// number and height sum of higher center tiles within [0, cx) x [0, cy)
+		auto addPrefixSums = [&](int cx, int cy, int sign, int& tiles, double& heightSum)
+		{
+			for(int j = cy; j > 0; j -= (j & -j))
+			{
+				for(int i = cx; i > 0; i -= (i & -i))
+				{
+					tiles     += sign * higherTiles[j * tableWidth + i];
+					heightSum += sign * higherTilesHeightSums[j * tableWidth + i];
 				}
 			}
+		};
+
+		auto nextCenterTile = centerTiles.begin();
+
+		for(const auto& cliffTile : cliffTiles)
+		{
+			for( ; (nextCenterTile != centerTiles.end()) && (heightOfCenterTile(*nextCenterTile) > cliffTile.height); ++nextCenterTile)
+				addCenterTile(*nextCenterTile % xCenters, *nextCenterTile / xCenters, heightOfCenterTile(*nextCenterTile));
+
+			int    higherCenterTiles(0);
+			double heightSum(0.0);
+			addPrefixSums(cliffTile.xMax + 1, cliffTile.yMax + 1,  1, higherCenterTiles, heightSum);
+			addPrefixSums(cliffTile.xMin,     cliffTile.yMax + 1, -1, higherCenterTiles, heightSum);
+			addPrefixSums(cliffTile.xMax + 1, cliffTile.yMin,     -1, higherCenterTiles, heightSum);
+			addPrefixSums(cliffTile.xMin,     cliffTile.yMin,      1, higherCenterTiles, heightSum);
+
+			plateau_map[cliffTile.tileIndex] = static_cast<float>(static_cast<double>(higherCenterTiles) * static_cast<double>(cliffTile.height) - heightSum);
 		}
 	}
 
-	for(int y = 0; y < yPlateauMapSize; ++y)
+	for(int y = yStart; y < yEnd; ++y)
 	{
 		for(int x = 0; x < xPlateauMapSize; ++x)
 		{
@@ -1323,7 +1508,7 @@ void AAIMap::DetermineMapType()
 }
 
 // algorithm more or less by krogothe - thx very much
-void AAIMap::DetectMetalSpots()
+void AAIMap::DetectMetalSpots(AAIThreadPool& threadPool)
 {
 	const UnitDefId largestExtractor = ai->s_buildTree.GetLargestExtractor();
 	if ( largestExtractor.IsValid() == false ) 
@@ -1335,160 +1520,52 @@ void AAIMap::DetectMetalSpots()
 	const springLegacyAI::UnitDef* def = &ai->BuildTable()->GetUnitDef(largestExtractor.id);
 	const UnitFootprint largestExtractorFootprint = ai->s_buildTree.GetFootprint(largestExtractor);
 
-	s_isMetalMap = false;
-	bool Stopme = false;
-	int TotalMetal = 0;
-	int MaxMetal = 0;
-	int TempMetal = 0;
-	int SpotsFound = 0;
-	int coordx = 0, coordy = 0;
-//	float AverageMetal;
+	// the minimum scaled yield (0-255, relative to best spot) a spot needs to have to be saved. Prevents crappier spots in between taken spaces.
+	// They are still perfectly valid and will generate metal mind you!
+	constexpr int minScaledYieldForSpot(30);
 
-	AAIMetalSpot temp;
+	// If more spots than that are found the map is considered a metalmap, tweak this as needed
+	constexpr int maxSpots(5000);
 
-	int MinMetalForSpot = 30; // from 0-255, the minimum percentage of metal a spot needs to have
-							//from the maximum to be saved. Prevents crappier spots in between taken spaces.
-							//They are still perfectly valid and will generate metal mind you!
-	int MaxSpots = 5000; //If more spots than that are found the map is considered a metalmap, tweak this as needed
+	const int xMetalMapSize = ai->GetAICallback()->GetMapWidth()  / 2; // metal map has 1/2 resolution of normal map
+	const int yMetalMapSize = ai->GetAICallback()->GetMapHeight() / 2;
 
-	int MetalMapHeight = ai->GetAICallback()->GetMapHeight() / 2; //metal map has 1/2 resolution of normal map
-	int MetalMapWidth = ai->GetAICallback()->GetMapWidth() / 2;
-	int TotalCells = MetalMapHeight * MetalMapWidth;
-	unsigned char XtractorRadius = ai->GetAICallback()->GetExtractorRadius()/ 16.0;
-	unsigned char DoubleRadius = ai->GetAICallback()->GetExtractorRadius() / 8.0;
-	int SquareRadius = (ai->GetAICallback()->GetExtractorRadius() / 16.0) * (ai->GetAICallback()->GetExtractorRadius() / 16.0); //used to speed up loops so no recalculation needed
-	int DoubleSquareRadius = (ai->GetAICallback()->GetExtractorRadius() / 8.0) * (ai->GetAICallback()->GetExtractorRadius() / 8.0); // same as above
-//	int CellsInRadius = PI * XtractorRadius * XtractorRadius; //yadda yadda
-	unsigned char* MexArrayA = new unsigned char [TotalCells];
-	unsigned char* MexArrayB = new unsigned char [TotalCells];
-	int* TempAverage = new int [TotalCells];
+	const double extractorRadius = ai->GetAICallback()->GetExtractorRadius() / 16.0;
 
-	//Load up the metal Values in each pixel
-	for (int i = 0; i != TotalCells - 1; i++)
-	{
-		MexArrayA[i] = *(ai->GetAICallback()->GetMetalMap() + i);
-		TotalMetal += MexArrayA[i];		// Count the total metal so you can work out an average of the whole map
-	}
+	AAIMetalYieldMap yieldMap(threadPool, ai->GetAICallback()->GetMetalMap(), xMetalMapSize, yMetalMapSize, static_cast<int>(extractorRadius), static_cast<int>(extractorRadius * extractorRadius), minScaledYieldForSpot);
 
-//	AverageMetal = ((float)TotalMetal) / ((float)TotalCells);  //do the average
+	const float maxMetal = ai->GetAICallback()->GetMaxMetal();
 
-	// Now work out how much metal each spot can make by adding up the metal from nearby spots
-	for (int y = 0; y != MetalMapHeight; y++)
-	{
-		for (int x = 0; x != MetalMapWidth; x++)
-		{
-			TotalMetal = 0;
-			for (int myx = x - XtractorRadius; myx != x + XtractorRadius; myx++)
-			{
-				if (myx >= 0 && myx < MetalMapWidth)
-				{
-					for (int myy = y - XtractorRadius; myy != y + XtractorRadius; myy++)
-					{
-						if (myy >= 0 && myy < MetalMapHeight && ((x - myx)*(x - myx) + (y - myy)*(y - myy)) <= SquareRadius)
-						{
-							TotalMetal += MexArrayA[myy * MetalMapWidth + myx]; //get the metal from all pixels around the extractor radius
-						}
-					}
-				}
-			}
-			TempAverage[y * MetalMapWidth + x] = TotalMetal; //set that spots metal making ability (divide by cells to values are small)
-			if (MaxMetal < TotalMetal)
-				MaxMetal = TotalMetal;  //find the spot with the highest metal to set as the map's max
-		}
-	}
-	for (int i = 0; i != TotalCells; i++) // this will get the total metal a mex placed at each spot would make
-	{
-		MexArrayB[i] = spring::SafeDivide(TempAverage[i] * 255,  MaxMetal);  //scale the metal so any map will have values 0-255, no matter how much metal it has
-	}
+	int SpotsFound(0);
+	MapPos spot;
+	int scaledYield;
 
-	for (int a = 0; a != MaxSpots; a++)
+	for(int i = 0; (i < maxSpots) && yieldMap.DetermineBestSpot(spot, scaledYield); ++i)
 	{
-		if(!Stopme)
-			TempMetal = 0; //reset tempmetal so it can find new spots
-		for (int i = 0; i != TotalCells; i=i+2)
-		{			//finds the best spot on the map and gets its coords
-			if (MexArrayB[i] > TempMetal && !Stopme)
-			{
-				TempMetal = MexArrayB[i];
-				coordx = i%MetalMapWidth;
-				coordy = i/MetalMapWidth;
-			}
-		}
-		if (TempMetal < MinMetalForSpot)
-			Stopme = true; // if the spots get too crappy it will stop running the loops to speed it all up
-
-		if (!Stopme)
-		{
-			//pos.x = coordx * 2 * SQUARE_SIZE;
-			//pos.z = coordy * 2 * SQUARE_SIZE;	
-			temp.pos = ConvertMapPosToUnitPos(MapPos(2*coordx, 2*coordy), largestExtractorFootprint);
-			ConvertPositionToFinalBuildsite(temp.pos, largestExtractorFootprint);
-
-			temp.pos.y = ai->GetAICallback()->GetElevation(temp.pos.x, temp.pos.z);
-
-			temp.amount = TempMetal * ai->GetAICallback()->GetMaxMetal() * MaxMetal / 255.0f;
-			temp.occupied = false;
+		AAIMetalSpot temp;
+		temp.pos = ConvertMapPosToUnitPos(MapPos(2*spot.x, 2*spot.y), largestExtractorFootprint);
+		ConvertPositionToFinalBuildsite(temp.pos, largestExtractorFootprint);
 
-			//if(ai->Getcb()->CanBuildAt(def, pos))
-			//{
-				const MapPos mapPos = Pos2BuildMapPos(temp.pos, largestExtractorFootprint);
+		temp.pos.y = ai->GetAICallback()->GetElevation(temp.pos.x, temp.pos.z);
 
-				if( (mapPos.x >= 2) && (mapPos.y >= 2) && (mapPos.x < xMapSize-2) && (mapPos.y < yMapSize-2) )
-				{
-					if(CanBuildAt(mapPos, largestExtractorFootprint))
-					{
-						metal_spots.push_back(temp);
-						++SpotsFound;
+		temp.amount   = scaledYield * maxMetal * yieldMap.GetMaxYield() / 255.0f;
+		temp.occupied = false;
 
-						ChangeBuildMapOccupation(mapPos.x-2, mapPos.y-2, largestExtractorFootprint.xSize+2, largestExtractorFootprint.ySize+2, true);
-					}
-				}
-			//}
+		const MapPos mapPos = Pos2BuildMapPos(temp.pos, largestExtractorFootprint);
 
-			for (int myx = coordx - XtractorRadius; myx != coordx + XtractorRadius; myx++)
+		if( (mapPos.x >= 2) && (mapPos.y >= 2) && (mapPos.x < xMapSize-2) && (mapPos.y < yMapSize-2) )
+		{
+			if(CanBuildAt(mapPos, largestExtractorFootprint))
 			{
-				if (myx >= 0 && myx < MetalMapWidth)
-				{
-					for (int myy = coordy - XtractorRadius; myy != coordy + XtractorRadius; myy++)
-					{
-						if (myy >= 0 && myy < MetalMapHeight && ((coordx - myx)*(coordx - myx) + (coordy - myy)*(coordy - myy)) <= SquareRadius)
-						{
-							MexArrayA[myy * MetalMapWidth + myx] = 0; //wipes the metal around the spot so its not counted twice
-							MexArrayB[myy * MetalMapWidth + myx] = 0;
-						}
-					}
-				}
-			}
+				metal_spots.push_back(temp);
+				++SpotsFound;
 
-			// Redo the whole averaging process around the picked spot so other spots can be found around it
-			for (int y = coordy - DoubleRadius; y != coordy + DoubleRadius; y++)
-			{
-				if(y >=0 && y < MetalMapHeight)
-				{
-					for (int x = coordx - DoubleRadius; x != coordx + DoubleRadius; x++)
-					{//funcion below is optimized so it will only update spots between r and 2r, greatly speeding it up
-						if((coordx - x)*(coordx - x) + (coordy - y)*(coordy - y) <= DoubleSquareRadius && x >=0 && x < MetalMapWidth && MexArrayB[y * MetalMapWidth + x])
-						{
-							TotalMetal = 0;
-							for (int myx = x - XtractorRadius; myx != x + XtractorRadius; myx++)
-							{
-								if (myx >= 0 && myx < MetalMapWidth)
-								{
-									for (int myy = y - XtractorRadius; myy != y + XtractorRadius; myy++)
-									{
-										if (myy >= 0 && myy < MetalMapHeight && ((x - myx)*(x - myx) + (y - myy)*(y - myy)) <= SquareRadius)
-										{
-											TotalMetal += MexArrayA[myy * MetalMapWidth + myx]; //recalculate nearby spots to account for deleted metal from chosen spot
-										}
-									}
-								}
-							}
-							MexArrayB[y * MetalMapWidth + x] = spring::SafeDivide(TotalMetal * 255, MaxMetal); //set that spots metal amount
-						}
-					}
-				}
+				ChangeBuildMapOccupation(mapPos.x-2, mapPos.y-2, largestExtractorFootprint.xSize+2, largestExtractorFootprint.ySize+2, true);
 			}
 		}
+
+		// wipe the metal around the spot so its not counted twice
+		yieldMap.TakeSpot(spot);
 	}
 
 	if(SpotsFound > 500)
@@ -1499,10 +1576,6 @@ void AAIMap::DetectMetalSpots()
 	}
 	else
 		s_isMetalMap = false;
-
-	spring::SafeDeleteArray(MexArrayA);
-	spring::SafeDeleteArray(MexArrayB);
-	spring::SafeDeleteArray(TempAverage);
 }
 
 void AAIMap::CheckUnitsInLOSUpdate(bool forceUpdate)
@@ -1522,77 +1595,210 @@ void AAIMap::CheckUnitsInLOSUpdate(bool forceUpdate)
 void AAIMap::UpdateEnemyUnitsInLOS()
 {
 	//
-	// reset scouted buildings for all cells within current los
+	// reset scouted buildings for all cells within current los that changed since last update
 	//
-	const int* losMap = ai->GetLosMap();
+	const AAILosMap& losMap = GetLosMap();
+
+	const int frame = losMap.GetFrame();
 
-	const int frame = ai->GetAICallback()->GetCurrentFrame();
+	m_scoutedEnemyUnitsMap.ResetTilesInLOS(losMap);
 
-	int cellIndex(0);
-	for(int y = 0; y < yLOSMapSize; ++y)
+	// update enemy units (units entering/leaving LOS or radar coverage are registered/removed by the corresponding events)
+	MobileTargetTypeValues spottedEnemyCombatUnitsByTargetType;
+
+	for(auto& registeredUnit : m_enemyUnits)
 	{
-		for(int x = 0; x < xLOSMapSize; ++x)
+		const UnitId  unitId(registeredUnit.first);
+		AAIEnemyUnit& enemyUnit = registeredUnit.second;
+
+		UpdateEnemyUnitPosition(enemyUnit, ai->UnitData()->GetUnitPos(unitId));
+
+		// make sure unit is within the map (e.g. no aircraft that has flown outside of the map)
+		if(enemyUnit.inLOS && enemyUnit.unitDefId.IsValid() && m_scoutedEnemyUnitsMap.GetScoutMapTile(enemyUnit.position).IsValid())
 		{
-			if(losMap[cellIndex] > 0)
+			const AAIUnitCategory& category = ai->s_buildTree.GetUnitCategory(enemyUnit.unitDefId);
+
+			// add (finished) buildings/combat units to scout map
+			if( category.IsBuilding() || category.IsCombatUnit() )
 			{
-				m_scoutedEnemyUnitsMap.ResetTiles(x, y, frame);
+				AddEnemyUnitToScoutMap(unitId, enemyUnit, frame);
+
+				ai->UnitTable()->CheckBombTarget(unitId, enemyUnit.unitDefId, category, enemyUnit.position);
 			}
 
-			++cellIndex;
+			if(category.IsCombatUnit())
+			{
+				const AAITargetType& targetType = ai->s_buildTree.GetTargetType(enemyUnit.unitDefId);
+				spottedEnemyCombatUnitsByTargetType[targetType] += 1.0f;
+			}
 		}
 	}
 
-	for(int y = 0; y < ySectors; ++y)
-	{
-		for(int x = 0; x < xSectors; ++x)
-			m_sectorMap[x][y].m_enemyUnitsDetectedBySensor = 0;
-	}
+	ai->Brain()->UpdateMaxCombatUnitsSpotted(spottedEnemyCombatUnitsByTargetType);
+}
 
-	// update enemy units
-	MobileTargetTypeValues spottedEnemyCombatUnitsByTargetType;
+void AAIMap::EnemyEnteredLOS(UnitId unitId)
+{
+	const AAIEnemyUnit* enemyUnit = GetEnemyUnit(unitId);
+	SetEnemyUnitVisibility(unitId, true, enemyUnit ? enemyUnit->inRadar : false);
+}
+
+void AAIMap::EnemyLeftLOS(UnitId unitId)
+{
+	const AAIEnemyUnit* enemyUnit = GetEnemyUnit(unitId);
+	SetEnemyUnitVisibility(unitId, false, enemyUnit ? enemyUnit->inRadar : false);
+}
+
+void AAIMap::EnemyEnteredRadar(UnitId unitId)
+{
+	const AAIEnemyUnit* enemyUnit = GetEnemyUnit(unitId);
+	SetEnemyUnitVisibility(unitId, enemyUnit ? enemyUnit->inLOS : false, true);
+}
+
+void AAIMap::EnemyLeftRadar(UnitId unitId)
+{
+	const AAIEnemyUnit* enemyUnit = GetEnemyUnit(unitId);
+	SetEnemyUnitVisibility(unitId, enemyUnit ? enemyUnit->inLOS : false, false);
+}
+
+void AAIMap::EnemyDestroyed(UnitId unitId)
+{
+	SetEnemyUnitVisibility(unitId, false, false);
+}
+
+void AAIMap::AddEnemyUnit(UnitId unitId)
+{
+	const float3 position = ai->UnitData()->GetUnitPos(unitId);
+	const bool   inLOS    = IsPositionInLOS(position);
+	const bool   inRadar  = IsPositionInRadar(ai->GetRadarMap(), position, inLOS);
+
+	SetEnemyUnitVisibility(unitId, inLOS, inRadar);
+}
+
+void AAIMap::ReconcileEnemyUnits()
+{
 	const int numberOfEnemyUnits = ai->GetAICallback()->GetEnemyUnitsInRadarAndLos(&(m_unitsInLOS.front()));
 
-	for(int i = 0; i < numberOfEnemyUnits; ++i)
+	//-----------------------------------------------------------------------------------------------------------------
+	// remove registered units that are no longer detected (i.e. leave or destroyed event has been missed)
+	//-----------------------------------------------------------------------------------------------------------------
+	std::sort(m_unitsInLOS.begin(), m_unitsInLOS.begin() + numberOfEnemyUnits);
+
+	for(auto registeredUnit = m_enemyUnits.begin(); registeredUnit != m_enemyUnits.end(); )
 	{
-		const float3                   pos = ai->GetAICallback()->GetUnitPos(m_unitsInLOS[i]);
-		const springLegacyAI::UnitDef* def = ai->GetAICallback()->GetUnitDef(m_unitsInLOS[i]);
+		if(std::binary_search(m_unitsInLOS.begin(), m_unitsInLOS.begin() + numberOfEnemyUnits, registeredUnit->first))
+			++registeredUnit;
+		else
+			registeredUnit = m_enemyUnits.erase(registeredUnit);
+	}
 
-		if(def) // unit is within los
+	//-----------------------------------------------------------------------------------------------------------------
+	// register/update detected units (units not within LOS are detected by radar)
+	//-----------------------------------------------------------------------------------------------------------------
+	if(numberOfEnemyUnits > 0)
+	{
+		const std::vector<int> radarMap = ai->GetRadarMap();
+
+		for(int i = 0; i < numberOfEnemyUnits; ++i)
 		{
-			ScoutMapTile tile = m_scoutedEnemyUnitsMap.GetScoutMapTile(pos);
+			const UnitId unitId(m_unitsInLOS[i]);
+			const float3 position = ai->UnitData()->GetUnitPos(unitId);
+			const bool   inLOS    = IsPositionInLOS(position);
 
-			// make sure unit is within the map (e.g. no aircraft that has flown outside of the map)
-			if(tile.IsValid())
-			{
-				const UnitDefId defId(def->id);
-				const AAIUnitCategory& category = ai->s_buildTree.GetUnitCategory(defId);
+			SetEnemyUnitVisibility(unitId, inLOS, !inLOS || IsPositionInRadar(radarMap, position, true));
+		}
+	}
 
-				// add (finished) buildings/combat units to scout map
-				if( category.IsBuilding() || category.IsCombatUnit() )
-				{
-					if(ai->GetAICallback()->UnitBeingBuilt(m_unitsInLOS[i]) == false)
-						m_scoutedEnemyUnitsMap.AddEnemyUnit(defId, tile);
+	//-----------------------------------------------------------------------------------------------------------------
+	// recount units detected by sensors only (counts of sectors get out of sync if events have been missed)
+	//-----------------------------------------------------------------------------------------------------------------
+	for(auto& sectors : m_sectorMap)
+	{
+		for(auto& sector : sectors)
+			sector.m_enemyUnitsDetectedBySensor = 0;
+	}
 
-					ai->UnitTable()->CheckBombTarget(UnitId(m_unitsInLOS[i]), defId, category, pos);
-				}
+	for(const auto& registeredUnit : m_enemyUnits)
+	{
+		if(registeredUnit.second.IsDetectedBySensorOnly() && registeredUnit.second.sector)
+			registeredUnit.second.sector->m_enemyUnitsDetectedBySensor += 1;
+	}
+}
 
-				if(category.IsCombatUnit())
-				{
-					const AAITargetType& targetType = ai->s_buildTree.GetTargetType(defId);
-					spottedEnemyCombatUnitsByTargetType[targetType] += 1.0f;
-				}
-			}
-		}
-		else // unit on radar only
-		{
-			AAISector* sector = GetSectorOfPos(pos);
+const AAIEnemyUnit* AAIMap::GetEnemyUnit(UnitId unitId) const
+{
+	const auto registeredUnit = m_enemyUnits.find(unitId.id);
+	return (registeredUnit != m_enemyUnits.end()) ? &(registeredUnit->second) : nullptr;
+}
 
-			if(sector)
-				sector->m_enemyUnitsDetectedBySensor += 1;
-		}
+void AAIMap::SetEnemyUnitVisibility(UnitId unitId, bool inLOS, bool inRadar)
+{
+	auto registeredUnit = m_enemyUnits.find(unitId.id);
+
+	if(registeredUnit == m_enemyUnits.end())
+	{
+		if(!inLOS && !inRadar)
+			return;
+
+		registeredUnit = m_enemyUnits.emplace(unitId.id, AAIEnemyUnit()).first;
 	}
 
-	ai->Brain()->UpdateMaxCombatUnitsSpotted(spottedEnemyCombatUnitsByTargetType);
+	AAIEnemyUnit& enemyUnit = registeredUnit->second;
+
+	// update number of units detected by sensors in the sector of the last known position
+	const bool detectedBySensorOnly = enemyUnit.IsDetectedBySensorOnly();
+
+	enemyUnit.inLOS   = inLOS;
+	enemyUnit.inRadar = inRadar;
+
+	if( enemyUnit.sector && (detectedBySensorOnly != enemyUnit.IsDetectedBySensorOnly()) )
+		enemyUnit.sector->m_enemyUnitsDetectedBySensor += detectedBySensorOnly ? -1 : 1;
+
+	if(!inLOS && !inRadar)
+	{
+		m_enemyUnits.erase(registeredUnit);
+		return;
+	}
+
+	// unit type is only known if unit is/has been within LOS
+	if(inLOS && !enemyUnit.unitDefId.IsValid())
+		enemyUnit.unitDefId = ai->GetUnitDefId(unitId);
+
+	UpdateEnemyUnitPosition(enemyUnit, ai->UnitData()->GetUnitPos(unitId));
+
+	// add unit to scout map right away (instead of waiting for next update of units in LOS)
+	if(inLOS)
+		AddEnemyUnitToScoutMap(unitId, enemyUnit, ai->GetAICallback()->GetCurrentFrame());
+}
+
+void AAIMap::UpdateEnemyUnitPosition(AAIEnemyUnit& enemyUnit, const float3& position)
+{
+	AAISector* sector = GetSectorOfPos(position);
+
+	if( enemyUnit.IsDetectedBySensorOnly() && (sector != enemyUnit.sector) )
+	{
+		if(enemyUnit.sector)
+			enemyUnit.sector->m_enemyUnitsDetectedBySensor -= 1;
+
+		if(sector)
+			sector->m_enemyUnitsDetectedBySensor += 1;
+	}
+
+	enemyUnit.position = position;
+	enemyUnit.sector   = sector;
+}
+
+void AAIMap::AddEnemyUnitToScoutMap(UnitId unitId, const AAIEnemyUnit& enemyUnit, int frame)
+{
+	const ScoutMapTile tile = m_scoutedEnemyUnitsMap.GetScoutMapTile(enemyUnit.position);
+
+	if(tile.IsValid() && enemyUnit.unitDefId.IsValid())
+	{
+		const AAIUnitCategory& category = ai->s_buildTree.GetUnitCategory(enemyUnit.unitDefId);
+
+		if( (category.IsBuilding() || category.IsCombatUnit()) && (ai->GetAICallback()->UnitBeingBuilt(unitId.id) == false) )
+			m_scoutedEnemyUnitsMap.AddEnemyUnit(enemyUnit.unitDefId, tile, frame);
+	}
 }
 
 void AAIMap::UpdateFriendlyUnitsInLos()
@@ -1608,18 +1814,18 @@ void AAIMap::UpdateFriendlyUnitsInLos()
 	for(int i = 0; i < numberOfFriendlyUnits; ++i)
 	{
 		// get unit def & category
-		const springLegacyAI::UnitDef* def = ai->GetAICallback()->GetUnitDef(m_unitsInLOS[i]);
+		const springLegacyAI::UnitDef* def = ai->UnitData()->GetUnitDef(UnitId(m_unitsInLOS[i]));
 		const UnitDefId unitDefId(def->id);
 
 		const AAIUnitCategory& category = ai->s_buildTree.GetUnitCategory(unitDefId);
 
 		if( category.IsBuilding() || category.IsCombatUnit() )
 		{
-			AAISector* sector = GetSectorOfPos( ai->GetAICallback()->GetUnitPos(m_unitsInLOS[i]) );
+			AAISector* sector = GetSectorOfPos( ai->UnitData()->GetUnitPos(UnitId(m_unitsInLOS[i])) );
 
 			if(sector)
 			{
-				if(category.IsBuilding() && (ai->GetAICallback()->GetUnitTeam(m_unitsInLOS[i]) != ai->GetMyTeamId()))
+				if(category.IsBuilding() && (ai->UnitData()->GetUnitTeam(UnitId(m_unitsInLOS[i])) != ai->GetMyTeamId()))
 				{
 					++sector->m_alliedBuildings;
 				}
@@ -1665,16 +1871,62 @@ bool AAIMap::CheckPositionForScoutedUnit(const float3& position, UnitId unitId)
 
 bool AAIMap::IsPositionInLOS(const float3& position) const
 {
-	const int* losMap = ai->GetLosMap();
+	const AAILosMap& losMap = GetLosMap();
 
 	const int xPos = (int)position.x / (losMapResolution * SQUARE_SIZE);
 	const int yPos = (int)position.z / (losMapResolution * SQUARE_SIZE);
 
 	// make sure unit is within the map
-	if( (xPos >= 0) && (xPos < xLOSMapSize) && (yPos >= 0) && (yPos < yLOSMapSize) )
-		return (losMap[xPos + yPos * xLOSMapSize] > 0);
+	if( losMap.IsValidTile(xPos, yPos) )
+		return losMap.IsInLOS(xPos, yPos);
 	else
-		return false;	
+		return false;
+}
+
+bool AAIMap::IsPositionInRadar(const std::vector<int>& radarMap, const float3& position, bool defaultValue)
+{
+	// resolution of the radar map depends on the game settings -> determine it from the size of the radar map (upon first call)
+	if(m_radarMapResolution < 0)
+	{
+		int radarMapResolution(1);
+		while( (radarMapResolution < xMapSize) && ((xMapSize / radarMapResolution) * (yMapSize / radarMapResolution) > static_cast<int>(radarMap.size())) )
+			radarMapResolution *= 2;
+
+		const bool radarMapMatching = (radarMap.empty() == false) && ((xMapSize / radarMapResolution) * (yMapSize / radarMapResolution) == static_cast<int>(radarMap.size()));
+
+		if(radarMapMatching)
+			m_radarMapResolution = radarMapResolution;
+		else
+		{
+			m_radarMapResolution = 0;
+			ai->Log(ELogLevel::WARNING, ELogCategory::MAP, "Could not determine resolution of radar map (size %i) - radar coverage of enemy units derived from LOS\n", static_cast<int>(radarMap.size()));
+		}
+	}
+
+	if(m_radarMapResolution == 0)
+		return defaultValue;
+
+	const int xRadarMapSize = xMapSize / m_radarMapResolution;
+	const int yRadarMapSize = yMapSize / m_radarMapResolution;
+
+	if(xRadarMapSize * yRadarMapSize != static_cast<int>(radarMap.size()))
+		return defaultValue;
+
+	const int xRadar = std::max(0, std::min(static_cast<int>(position.x) / (m_radarMapResolution * SQUARE_SIZE), xRadarMapSize-1));
+	const int yRadar = std::max(0, std::min(static_cast<int>(position.z) / (m_radarMapResolution * SQUARE_SIZE), yRadarMapSize-1));
+
+	return (radarMap[xRadar + yRadar * xRadarMapSize] > 0);
+}
+
+const AAILosMap& AAIMap::GetLosMap() const
+{
+	const int currentFrame = ai->GetAICallback()->GetCurrentFrame();
+
+	// fetch LOS map from engine only once per frame
+	if(m_losMap.GetFrame() != currentFrame)
+		m_losMap.Update(ai->GetLosMap(), currentFrame);
+
+	return m_losMap;
 }
 
 bool AAIMap::IsPositionWithinMap(const float3& position) const
@@ -1732,7 +1984,7 @@ float3 AAIMap::DeterminePositionOfEnemyBuildingInSector(int xStart, int xEnd, in
 		}
 	}
 
-	ai->Log("Error: Could not find position of enemy building in sector (%i, %i) despite enemy buildings in sector!\n", xStart/xSectorSizeMap, yStart/ySectorSizeMap);
+	ai->Log(ELogLevel::FAILURE, ELogCategory::MAP, "Could not find position of enemy building in sector (%i, %i) despite enemy buildings in sector!\n", xStart/xSectorSizeMap, yStart/ySectorSizeMap);
 
 	float3 selectedPosition;
 	selectedPosition.x = static_cast<float>(xStart * SQUARE_SIZE);
@@ -1841,11 +2093,11 @@ void AAIMap::UpdateNeighbouringSectors(std::vector< std::list<AAISector*> >& sec
 
 float3 AAIMap::GetNewScoutDest(UnitId scoutUnitId)
 {
-	const springLegacyAI::UnitDef*  def    = ai->GetAICallback()->GetUnitDef(scoutUnitId.id);
+	const springLegacyAI::UnitDef*  def    = ai->UnitData()->GetUnitDef(scoutUnitId);
 	const AAIMovementType& scoutMoveType   = ai->s_buildTree.GetMovementType( UnitDefId(def->id) );
 	const AAITargetType&   scoutTargetType = ai->s_buildTree.GetTargetType( UnitDefId(def->id) );
 
-	const float3 currentPositionOfScout    = ai->GetAICallback()->GetUnitPos(scoutUnitId.id);
+	const float3 currentPositionOfScout    = ai->UnitData()->GetUnitPos(scoutUnitId);
 	const int    continentId               = scoutMoveType.CannotMoveToOtherContinents() ? ai->Map()->DetermineSmartContinentID(currentPositionOfScout, scoutMoveType) : AAIMap::ignoreContinentID;
 
 	float3     selectedScoutDestination(ZeroVector);
@@ -1905,18 +2157,6 @@ const AAISector* AAIMap::DetermineSectorToContinueAttack(const AAISector *curren
 	return selectedSector;
 }
 
-const char* AAIMap::GetMapTypeString(const AAIMapType& mapType) const
-{
-	if(mapType.IsLand())
-		return "LAND_MAP";
-	else if(mapType.IsLandWater())
-		return "LAND_WATER_MAP";
-	else if(mapType.IsWater())
-		return "WATER_MAP";
-	else
-		return "UNKNOWN_MAP";
-}
-
 void AAIMap::DetermineSpottedEnemyBuildingsOnContinentType(int& enemyBuildingsOnLand, int& enemyBuildingsOnSea) const
 {
 	enemyBuildingsOnLand = 0;
@@ -22,8 +22,11 @@
 #include <vector>
 #include <list>
 #include <string>
+#include <unordered_map>
+#include <memory>
 
 class AAI;
+class AAIThreadPool;
 
 class AAIMap
 {
@@ -123,6 +126,31 @@ public:
 
 	//! @brief Triggers an update of the current units in LOS if there are enough frames since the last update or it is enforced
 	void CheckUnitsInLOSUpdate(bool forceUpdate = false);
+
+	//! @brief Registers that the given enemy unit has entered LOS (unit is added to scout map immediately)
+	void EnemyEnteredLOS(UnitId unitId);
+
+	//! @brief Registers that the given enemy unit has left LOS
+	void EnemyLeftLOS(UnitId unitId);
+
+	//! @brief Registers that the given enemy unit has entered radar/sonar coverage
+	void EnemyEnteredRadar(UnitId unitId);
+
+	//! @brief Registers that the given enemy unit has left radar/sonar coverage
+	void EnemyLeftRadar(UnitId unitId);
+
+	//! @brief Removes the given enemy unit from the registry of enemy units
+	void EnemyDestroyed(UnitId unitId);
+
+	//! @brief Registers the given enemy unit if it is within LOS/radar coverage (e.g. unit changed from an allied to an enemy team)
+	void AddEnemyUnit(UnitId unitId);
+
+	//! @brief Compares the registered enemy units with the ones currently within LOS/radar coverage: missing units are registered, visibility
+	//!        of registered units is updated, and units no longer detected are removed (in case events have been missed)
+	void ReconcileEnemyUnits();
+
+	//! @brief Returns the last known data of the given enemy unit (nullptr if unit is neither within LOS nor radar coverage)
+	const AAIEnemyUnit* GetEnemyUnit(UnitId unitId) const;
 	
 	//! @brief Returns whether given unit is still known to be at given position (used to detect buildings that have been destroyed while not within LOS)
 	bool CheckPositionForScoutedUnit(const float3& position, UnitId unitId);
@@ -130,6 +158,9 @@ public:
 	//! @brief Returns whether given position lies within current LOS
 	bool IsPositionInLOS(const float3& position) const;
 
+	//! @brief Returns the LOS map of the current frame (fetched from the engine upon first access within a frame)
+	const AAILosMap& GetLosMap() const;
+
 	//! @brief Returns whether given position lies within map (e.g. aircraft may leave map)
 	bool IsPositionWithinMap(const float3& position) const;
 
@@ -191,7 +222,10 @@ public:
 	static AAITeamSectorMap s_teamSectorMap;
 
 	//! The buildmap stores the type/occupation status of every cell;
-	static std::vector<BuildMapTileType> s_buildmap;
+	static AAIBuildMap s_buildmap;
+
+	//! Number of tiles of the buildmap with certain tile types (for fast checks of building footprints)
+	static AAIBuildMapTileCounts s_buildMapTileCounts;
 
 	//! The defence maps (storing combat power by static defences vs the different mobile target types)
 	static AAIDefenceMaps s_defenceMaps;
@@ -202,6 +236,18 @@ private:
 	//! @brief Updates spotted enemy buildings/units on the map (incl. data per sector)
 	void UpdateEnemyUnitsInLOS();
 
+	//! @brief Sets LOS/radar status of the given enemy unit (unit is removed from registry if neither within LOS nor radar coverage)
+	void SetEnemyUnitVisibility(UnitId unitId, bool inLOS, bool inRadar);
+
+	//! @brief Returns whether the given position is covered by the given radar map (returns the default value if the resolution of the radar map cannot be determined)
+	bool IsPositionInRadar(const std::vector<int>& radarMap, const float3& position, bool defaultValue);
+
+	//! @brief Updates position and sector of the given enemy unit (incl. number of units detected by sensors in the sector)
+	void UpdateEnemyUnitPosition(AAIEnemyUnit& enemyUnit, const float3& position);
+
+	//! @brief Adds the given enemy unit to the scout map (if it is a finished building or combat unit within the map)
+	void AddEnemyUnitToScoutMap(UnitId unitId, const AAIEnemyUnit& enemyUnit, int frame);
+
 	//! @brief Updates own/allied buildings/units on the map (in each sector)
 	void UpdateFriendlyUnitsInLos();
 
@@ -215,16 +261,16 @@ private:
 	MapPos Pos2BuildMapPos(const float3& position, const UnitFootprint& footprint) const;
 
 	// krogothe's metal spot finder
-	void DetectMetalSpots();
-
-	//! @brief Returns descriptor for map type (used to save map type)
-	const char* GetMapTypeString(const AAIMapType& mapType) const;
+	void DetectMetalSpots(AAIThreadPool& threadPool);
 
 	//! @brief Returns which movement types are suitable for the given map type
 	uint32_t GetSuitableMovementTypes(const AAIMapType& mapType) const;
 
 	//! @brief Determine the type of every map tile (e.g. water, flat. cliff) and calculates the plateue map
-	void AnalyseMap();
+	void AnalyseMap(AAIThreadPool& threadPool);
+
+	//! @brief Calculates the given rows of the plateau map (positive values indicate elevated terrain compared to tiles within the given range)
+	static void CalculatePlateauMap(const float* heightMap, int terrainDetectionRange, int yStart, int yEnd);
 
 	//! @brief Determines the type of map
 	void DetermineMapType();
@@ -235,15 +281,25 @@ private:
 	//! @brief Read the learning data for this map (or initialize with defualt data if none are available)
 	void ReadMapLearnFile();
 
-	//! 
-	void InitContinents();
+	//! @brief Loads continent data from cache file (or detects continents and creates new cache file if not available); the given
+	//!        thread pool is created when continents have to be detected
+	void InitContinents(std::unique_ptr<AAIThreadPool>& threadPool);
+
+	//! @brief Loads continent map and continents from the given binary cache file (returns whether successful)
+	bool LoadContinentCache(const std::string& filename);
 
-	//! @brief Reads continent data from given cache file (returns whether successful)
-	bool ReadContinentFile(const std::string& filename);
+	//! @brief Stores continent map and continents to the given binary cache file
+	void SaveContinentCache(const std::string& filename);
 
 	// reads map cache file (and creates new one if necessary)
-	// loads mex spots, cliffs etc. from file or creates new one
-	void ReadMapCacheFile();
+	// loads mex spots, cliffs etc. from file or creates new one (the given thread pool is created when the map has to be analysed)
+	void ReadMapCacheFile(std::unique_ptr<AAIThreadPool>& threadPool);
+
+	//! @brief Loads build map, plateau map and metal spots from the given binary cache file (returns whether successful)
+	bool LoadMapCache(const std::string& filename);
+
+	//! @brief Stores build map, plateau map and metal spots to the given binary cache file
+	void SaveMapCache(const std::string& filename);
 
 	//! @brief Returns whether x/y specify a valid sector
 	bool IsValidSector(const SectorIndex& index) const { return( (index.x >= 0) && (index.y >= 0) && (index.x < xSectors) && (index.y < ySectors) ); }
@@ -290,6 +346,9 @@ private:
 	//! Stores the defId of the building or combat unit placed on that cell (0 if none), same resolution as los map
 	AAIScoutedUnitsMap m_scoutedEnemyUnitsMap;
 
+	//! Last known data of all enemy units currently within LOS or radar coverage (key = unit id)
+	std::unordered_map<int, AAIEnemyUnit> m_enemyUnits;
+
 	//! The number of scouted enemy units on the given continent
 	std::vector<int>   m_buildingsOnContinent;
 
@@ -299,6 +358,12 @@ private:
 	//! The frame in which the last update of the units in LOS has been performed
 	int                m_lastLOSUpdateInFrame;
 
+	//! Snapshot of the LOS map (updated at most once per frame)
+	mutable AAILosMap  m_losMap;
+
+	//! Number of map tiles per radar map tile in x and y direction (0 if it could not be determined, -1 if not determined yet)
+	int                m_radarMapResolution;
+
 	///////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	// static (shared with other ai players)
 	///////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -329,6 +394,9 @@ private:
 
 	//! Minimum, maximum, and average size (in tiles) of land continents
 	static StatisticalData s_seaContinentSizeStatistics;
+
+	//! Footprints with up to this number of tiles are checked tile by tile in CanBuildAt() (instead of using the tile counts)
+	static constexpr int maxTilesCheckedDirectly = 16;
 };
 
 #endif
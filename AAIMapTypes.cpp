@@ -10,18 +10,25 @@
 #include "AAIMapTypes.h"
 #include "AAIConfig.h"
 #include "AAIMap.h"
+#include "AAIThreadPool.h"
+
+#include <algorithm>
+#include <limits>
 
 void AAIDefenceMaps::Init(int xMapSize, int yMapSize)
 { 
 	m_xDefenceMapSize = xMapSize/defenceMapResolution;
 	m_yDefenceMapSize = yMapSize/defenceMapResolution;
-	m_defenceMaps.resize(AAITargetType::numberOfMobileTargetTypes, std::vector<float>(m_xDefenceMapSize*m_yDefenceMapSize, 0.0f) );
+	m_defenceMaps.assign(AAITargetType::numberOfMobileTargetTypes, std::vector<float>(m_xDefenceMapSize*m_yDefenceMapSize, 0.0f) );
+
+	m_summedAreaTables.assign(AAITargetType::numberOfMobileTargetTypes, std::vector<double>((m_xDefenceMapSize+1)*(m_yDefenceMapSize+1), 0.0) );
+	m_summedAreaTableOutdated.assign(AAITargetType::numberOfMobileTargetTypes, false);
 }
 
 void AAIDefenceMaps::ModifyTiles(const float3& position, float maxWeaponRange, const UnitFootprint& footprint, const TargetTypeValues& combatPower, bool addValues)
 {
 	// decide which function shall be used to modify tile values
-	void (AAIDefenceMaps::*modifyDefenceMapTile) (int , const TargetTypeValues& ) = addValues ? &AAIDefenceMaps::AddDefence : &AAIDefenceMaps::RemoveDefence;
+	void (AAIDefenceMaps::*modifyDefenceMapTiles) (int, int, const TargetTypeValues& ) = addValues ? &AAIDefenceMaps::AddDefence : &AAIDefenceMaps::RemoveDefence;
 
 	const int range = static_cast<int>(maxWeaponRange) / (SQUARE_SIZE * defenceMapResolution);
 	const int xPos  = static_cast<int>(position.x) / (SQUARE_SIZE * defenceMapResolution) + footprint.xSize/defenceMapResolution;
@@ -31,20 +38,40 @@ void AAIDefenceMaps::ModifyTiles(const float3& position, float maxWeaponRange, c
 	const int yStart = std::max(yPos - range, 0);
 	const int yEnd   = std::min(yPos + range, m_yDefenceMapSize);
 
+	if(yStart < yEnd)
+		m_summedAreaTableOutdated.assign(AAITargetType::numberOfMobileTargetTypes, true);
+
+	const std::vector<int>& discHalfWidths = GetDiscHalfWidths(range);
+
 	for(int y = yStart; y < yEnd; ++y)
 	{
 		// determine x-range
-		const int xRange = (int) floor( fastmath::apxsqrt2( (float) ( std::max(1, range * range - (y - yPos) * (y - yPos)) ) ) + 0.5f );
+		const int xRange = discHalfWidths[y - yPos + range];
 
 		const int xStart = std::max(xPos - xRange, 0);
 		const int xEnd   = std::min(xPos + xRange, m_xDefenceMapSize);
 
-		for(int x = xStart; x < xEnd; ++x)
-		{
-			const int tile = x + m_xDefenceMapSize*y;
-			(this->*modifyDefenceMapTile)(tile, combatPower);
-		}
+		if(xStart < xEnd)
+			(this->*modifyDefenceMapTiles)(xStart + m_xDefenceMapSize*y, xEnd - xStart, combatPower);
+	}
+}
+
+const std::vector<int>& AAIDefenceMaps::GetDiscHalfWidths(int range)
+{
+	if(range >= static_cast<int>(m_discHalfWidths.size()))
+		m_discHalfWidths.resize(range + 1);
+
+	std::vector<int>& discHalfWidths = m_discHalfWidths[range];
+
+	if(discHalfWidths.empty() && (range > 0))
+	{
+		discHalfWidths.resize(2 * range);
+
+		for(int dy = -range; dy < range; ++dy)
+			discHalfWidths[dy + range] = (int) floor( fastmath::apxsqrt2( (float) ( std::max(1, range * range - dy * dy) ) ) + 0.5f );
 	}
+
+	return discHalfWidths;
 }
 
 float AAIDefenceMaps::CalculateValueForArea(const MapPos& topLeft, const MapPos& bottomRight, const AAITargetType& targetType) const
@@ -55,41 +82,133 @@ float AAIDefenceMaps::CalculateValueForArea(const MapPos& topLeft, const MapPos&
 	const int yStart = topLeft.y     / defenceMapResolution;
 	const int yEnd   = bottomRight.y / defenceMapResolution;
 
-	const std::vector<float>& defenceMap = m_defenceMaps[targetType.GetArrayIndex()];
+	if( (xStart >= xEnd) || (yStart >= yEnd) )
+		return 0.0f;
 
-	float sum(0.0f);
+	const int targetTypeIndex = targetType.GetArrayIndex();
 
-	for(int y = yStart; y < yEnd; ++y)
+	if(m_summedAreaTableOutdated[targetTypeIndex])
+		UpdateSummedAreaTable(targetTypeIndex);
+
+	const std::vector<double>& summedAreaTable = m_summedAreaTables[targetTypeIndex];
+	const int tableWidth = m_xDefenceMapSize + 1;
+
+	const double sum =   summedAreaTable[yEnd   * tableWidth + xEnd]   - summedAreaTable[yStart * tableWidth + xEnd]
+	                   - summedAreaTable[yEnd   * tableWidth + xStart] + summedAreaTable[yStart * tableWidth + xStart];
+
+	return static_cast<float>(sum);
+}
+
+void AAIDefenceMaps::UpdateSummedAreaTable(int targetTypeIndex) const
+{
+	const std::vector<float>& defenceMap      = m_defenceMaps[targetTypeIndex];
+	std::vector<double>&      summedAreaTable = m_summedAreaTables[targetTypeIndex];
+	const int tableWidth = m_xDefenceMapSize + 1;
+
+	// first row and column of the table remain zero
+	for(int y = 0; y < m_yDefenceMapSize; ++y)
 	{
-		for(int x = xStart; x < xEnd; ++x)
+		double rowSum(0.0);
+
+		for(int x = 0; x < m_xDefenceMapSize; ++x)
 		{
-			const int tile = x + m_xDefenceMapSize*y;
-			sum += defenceMap[tile];
+			rowSum += static_cast<double>(defenceMap[x + m_xDefenceMapSize*y]);
+			summedAreaTable[(y+1) * tableWidth + x + 1] = rowSum + summedAreaTable[y * tableWidth + x + 1];
 		}
 	}
 
-	return sum;
+	m_summedAreaTableOutdated[targetTypeIndex] = false;
 }
 
-void AAIDefenceMaps::AddDefence(int tile, const TargetTypeValues& combatPower)
+void AAIDefenceMaps::AddDefence(int firstTile, int numberOfTiles, const TargetTypeValues& combatPower)
 {
 	for(const auto targetType : AAITargetType::m_mobileTargetTypes)
 	{
-		const int targetTypeIndex = static_cast<int>(targetType);
-		m_defenceMaps[targetTypeIndex][tile] += combatPower[targetType];
+		float* tiles      = &m_defenceMaps[static_cast<int>(targetType)][firstTile];
+		const float value = combatPower[targetType];
+
+		for(int i = 0; i < numberOfTiles; ++i)
+			tiles[i] += value;
 	}
 }
 
-void AAIDefenceMaps::RemoveDefence(int tile, const TargetTypeValues& combatPower)
+void AAIDefenceMaps::RemoveDefence(int firstTile, int numberOfTiles, const TargetTypeValues& combatPower)
 {
 	for(const auto targetType : AAITargetType::m_mobileTargetTypes)
 	{
-		const int targetTypeIndex = static_cast<int>(targetType);
+		float* tiles      = &m_defenceMaps[static_cast<int>(targetType)][firstTile];
+		const float value = combatPower[targetType];
+
+		for(int i = 0; i < numberOfTiles; ++i)
+			tiles[i] = std::max(tiles[i] - value, 0.0f);
+	}
+}
+
+void AAILosMap::Init(int xLosMapSize, int yLosMapSize)
+{
+	m_xLosMapSize   = xLosMapSize;
+	m_yLosMapSize   = yLosMapSize;
+	m_wordsPerRow   = (xLosMapSize + bitsPerWord - 1) / bitsPerWord;
+	m_updateInFrame = -1;
+
+	m_losTiles.assign(m_wordsPerRow * m_yLosMapSize, 0u);
+}
+
+void AAILosMap::Update(const int* losMap, int frame)
+{
+	int tileIndex(0);
+
+	for(int y = 0; y < m_yLosMapSize; ++y)
+	{
+		uint64_t* row = &m_losTiles[y * m_wordsPerRow];
+
+		for(int word = 0; word < m_wordsPerRow; ++word)
+		{
+			const int tilesInWord = std::min(bitsPerWord, m_xLosMapSize - word * bitsPerWord);
+			uint64_t bits(0u);
+
+			for(int bit = 0; bit < tilesInWord; ++bit)
+			{
+				if(losMap[tileIndex] > 0)
+					bits |= (static_cast<uint64_t>(1u) << bit);
 
-		m_defenceMaps[targetTypeIndex][tile]  -= combatPower[targetType];
+				++tileIndex;
+			}
 
-		if(m_defenceMaps[targetTypeIndex][tile] < 0.0f)
-			m_defenceMaps[targetTypeIndex][tile] = 0.0f;
+			row[word] = bits;
+		}
+	}
+
+	m_updateInFrame = frame;
+}
+
+void AAILosMap::DetermineTilesEnteringLOS(const AAILosMap& previousLosMap, std::vector<MapPos>& tilesEnteringLOS) const
+{
+	tilesEnteringLOS.clear();
+
+	// no valid previous snapshot -> all tiles within LOS entered it
+	const bool previousSnapshotValid = (previousLosMap.m_xLosMapSize == m_xLosMapSize) && (previousLosMap.m_yLosMapSize == m_yLosMapSize);
+
+	for(int y = 0; y < m_yLosMapSize; ++y)
+	{
+		const int rowStart = y * m_wordsPerRow;
+
+		for(int word = 0; word < m_wordsPerRow; ++word)
+		{
+			const uint64_t currentTiles  = m_losTiles[rowStart + word];
+			const uint64_t previousTiles = previousSnapshotValid ? previousLosMap.m_losTiles[rowStart + word] : 0u;
+
+			// changed tiles which are currently within LOS
+			uint64_t enteringTiles = (currentTiles ^ previousTiles) & currentTiles;
+
+			while(enteringTiles != 0u)
+			{
+				const int bit = __builtin_ctzll(enteringTiles);
+				tilesEnteringLOS.push_back( MapPos(word * bitsPerWord + bit, y) );
+
+				enteringTiles &= (enteringTiles - 1u);
+			}
+		}
 	}
 }
 
@@ -97,9 +216,39 @@ AAIScoutedUnitsMap::AAIScoutedUnitsMap(int xMapSize, int yMapSize, int losMapRes
 	m_xScoutMapSize(xMapSize / scoutMapResolution),
 	m_yScoutMapSize(yMapSize / scoutMapResolution),
 	m_losToScoutMapResolution(losMapResolution / scoutMapResolution),
+	m_losMapResolution(losMapResolution),
 	m_scoutedUnitsMap(m_xScoutMapSize*m_yScoutMapSize, 0),
 	m_lastUpdateInFrameMap(m_xScoutMapSize*m_yScoutMapSize, 0)
 {
+	m_losMapOfLastUpdate.Init(xMapSize / losMapResolution, yMapSize / losMapResolution);
+}
+
+void AAIScoutedUnitsMap::ResetTilesInLOS(const AAILosMap& losMap)
+{
+	const int frame = losMap.GetFrame();
+
+	// units spotted during the last update may have moved or been destroyed in the meantime -> erase them if tile is still within LOS
+	for(const int tileIndex : m_tilesWithSpottedUnits)
+	{
+		const int xLosMap = ( (tileIndex % m_xScoutMapSize) * scoutMapResolution ) / m_losMapResolution;
+		const int yLosMap = ( (tileIndex / m_xScoutMapSize) * scoutMapResolution ) / m_losMapResolution;
+
+		if(losMap.IsValidTile(xLosMap, yLosMap) && losMap.IsInLOS(xLosMap, yLosMap))
+		{
+			m_scoutedUnitsMap[tileIndex]      = 0;
+			m_lastUpdateInFrameMap[tileIndex] = frame;
+		}
+	}
+
+	m_tilesWithSpottedUnits.clear();
+
+	// tiles that have been within LOS at the last update as well do not contain any other units
+	losMap.DetermineTilesEnteringLOS(m_losMapOfLastUpdate, m_tilesEnteringLOS);
+
+	for(const auto& tile : m_tilesEnteringLOS)
+		ResetTiles(tile.x, tile.y, frame);
+
+	m_losMapOfLastUpdate = losMap;
 }
 
 void AAIScoutedUnitsMap::ResetTiles(int xLosMap, int yLosMap, int frame)
@@ -153,26 +302,579 @@ void AAIScoutedUnitsMap::UpdateSectorWithScoutedUnits(AAISector *sector, std::ve
 	}
 }
 
+#ifndef AAI_BUILD_MAP_BIT_PLANES
+
+static_assert(sizeof(BuildMapTileType) == sizeof(uint8_t), "Build map tiles are stored as one byte per tile in the map cache file");
+
+void AAIBuildMap::Init(int xMapSize, int yMapSize)
+{
+	m_xMapSize = xMapSize;
+	m_yMapSize = yMapSize;
+
+	m_tiles.assign(xMapSize * yMapSize, BuildMapTileType());
+}
+
+void AAIBuildMap::Clear()
+{
+	m_tiles.clear();
+	m_tiles.shrink_to_fit();
+}
+
+void AAIBuildMap::OccupyTiles(int xStart, int yStart, int xEnd, int yEnd)
+{
+	for(int y = yStart; y < yEnd; ++y)
+	{
+		for(int x = xStart; x < xEnd; ++x)
+			m_tiles[x + y * m_xMapSize].OccupyTile();
+	}
+}
+
+void AAIBuildMap::FreeTiles(int xStart, int yStart, int xEnd, int yEnd)
+{
+	for(int y = yStart; y < yEnd; ++y)
+	{
+		for(int x = xStart; x < xEnd; ++x)
+			m_tiles[x + y * m_xMapSize].FreeTile();
+	}
+}
+
+bool AAIBuildMap::IsTileTypeSetInArea(BuildMapTileType tileTypes, int xStart, int yStart, int xEnd, int yEnd) const
+{
+	for(int y = yStart; y < yEnd; ++y)
+	{
+		for(int x = xStart; x < xEnd; ++x)
+		{
+			if(m_tiles[x + y * m_xMapSize].IsTileTypeSet(tileTypes))
+				return true;
+		}
+	}
+
+	return false;
+}
+
+int AAIBuildMap::CountTiles(BuildMapTileType tileTypes, int xStart, int yStart, int xEnd, int yEnd) const
+{
+	int tiles(0);
+
+	for(int y = yStart; y < yEnd; ++y)
+	{
+		for(int x = xStart; x < xEnd; ++x)
+		{
+			if(m_tiles[x + y * m_xMapSize].IsTileTypeSet(tileTypes))
+				++tiles;
+		}
+	}
+
+	return tiles;
+}
+
+uint64_t AAIBuildMap::GetTilesInRow(BuildMapTileType tileTypes, int y, int xStart, int xEnd) const
+{
+	uint64_t tiles(0u);
+
+	const BuildMapTileType* row = &m_tiles[y * m_xMapSize];
+
+	for(int x = xStart; x < std::min(xEnd, xStart + 64); ++x)
+	{
+		if(row[x].IsTileTypeSet(tileTypes))
+			tiles |= static_cast<uint64_t>(1u) << (x - xStart);
+	}
+
+	return tiles;
+}
+
+#else
+
+void AAIBuildMap::Init(int xMapSize, int yMapSize)
+{
+	m_xMapSize    = xMapSize;
+	m_yMapSize    = yMapSize;
+	m_wordsPerRow = (xMapSize + bitsPerWord - 1) / bitsPerWord;
+
+	m_planes.assign(numberOfPlanes * m_yMapSize * m_wordsPerRow, 0u);
+}
+
+void AAIBuildMap::Clear()
+{
+	m_planes.clear();
+	m_planes.shrink_to_fit();
+}
+
+BuildMapTileType AAIBuildMap::GetTileType(int x, int y) const
+{
+	BuildMapTileType tileType;
+
+	const int      word = x / bitsPerWord;
+	const uint64_t mask = static_cast<uint64_t>(1u) << (x % bitsPerWord);
+
+	for(int plane = 0; plane < numberOfPlanes; ++plane)
+	{
+		if(m_planes[(y * m_wordsPerRow + word) * numberOfPlanes + plane] & mask)
+			tileType.m_tileType |= static_cast<uint8_t>(1u << plane);
+	}
+
+	return tileType;
+}
+
+void AAIBuildMap::BlockTile(int x, int y)
+{
+	const int      word = x / bitsPerWord;
+	const uint64_t mask = static_cast<uint64_t>(1u) << (x % bitsPerWord);
+
+	ClearTiles(EBuildMapTileType::FREE,        y, word, mask);
+	SetTiles(EBuildMapTileType::BLOCKED_SPACE, y, word, mask);
+}
+
+void AAIBuildMap::OccupyTiles(int xStart, int yStart, int xEnd, int yEnd)
+{
+	for(int y = yStart; y < yEnd; ++y)
+	{
+		for(int word = xStart / bitsPerWord; word <= (xEnd - 1) / bitsPerWord; ++word)
+		{
+			const uint64_t mask = GetMask(word, xStart, xEnd);
+
+			ClearTiles(EBuildMapTileType::FREE,   y, word, mask);
+			SetTiles(EBuildMapTileType::OCCUPIED, y, word, mask);
+		}
+	}
+}
+
+void AAIBuildMap::FreeTiles(int xStart, int yStart, int xEnd, int yEnd)
+{
+	for(int y = yStart; y < yEnd; ++y)
+	{
+		for(int word = xStart / bitsPerWord; word <= (xEnd - 1) / bitsPerWord; ++word)
+		{
+			const uint64_t mask = GetMask(word, xStart, xEnd);
+
+			ClearTiles(EBuildMapTileType::OCCUPIED,      y, word, mask);
+			ClearTiles(EBuildMapTileType::BLOCKED_SPACE, y, word, mask);
+			SetTiles(EBuildMapTileType::FREE,            y, word, mask);
+		}
+	}
+}
+
+bool AAIBuildMap::IsTileTypeSetInArea(BuildMapTileType tileTypes, int xStart, int yStart, int xEnd, int yEnd) const
+{
+	for(int y = yStart; y < yEnd; ++y)
+	{
+		for(int word = xStart / bitsPerWord; word <= (xEnd - 1) / bitsPerWord; ++word)
+		{
+			if(GetRowTiles(tileTypes, y, word) & GetMask(word, xStart, xEnd))
+				return true;
+		}
+	}
+
+	return false;
+}
+
+int AAIBuildMap::CountTiles(BuildMapTileType tileTypes, int xStart, int yStart, int xEnd, int yEnd) const
+{
+	int tiles(0);
+
+	for(int y = yStart; y < yEnd; ++y)
+	{
+		for(int word = xStart / bitsPerWord; word <= (xEnd - 1) / bitsPerWord; ++word)
+			tiles += __builtin_popcountll( GetRowTiles(tileTypes, y, word) & GetMask(word, xStart, xEnd) );
+	}
+
+	return tiles;
+}
+
+uint64_t AAIBuildMap::GetTilesInRow(BuildMapTileType tileTypes, int y, int xStart, int xEnd) const
+{
+	const int word  = xStart / bitsPerWord;
+	const int shift = xStart % bitsPerWord;
+
+	uint64_t tiles = GetRowTiles(tileTypes, y, word) >> shift;
+
+	// remaining tiles are stored in the next word
+	if( (shift > 0) && (word + 1 < m_wordsPerRow) )
+		tiles |= GetRowTiles(tileTypes, y, word + 1) << (bitsPerWord - shift);
+
+	const int numberOfTiles = xEnd - xStart;
+
+	return (numberOfTiles < bitsPerWord) ? (tiles & ((static_cast<uint64_t>(1u) << numberOfTiles) - 1u)) : tiles;
+}
+
+uint64_t AAIBuildMap::GetMask(int word, int xStart, int xEnd)
+{
+	const int firstBit = std::max(xStart - word * bitsPerWord, 0);
+	const int endBit   = std::min(xEnd   - word * bitsPerWord, bitsPerWord);
+
+	const uint64_t upperMask = (endBit < bitsPerWord) ? ((static_cast<uint64_t>(1u) << endBit) - 1u) : ~static_cast<uint64_t>(0u);
+
+	return upperMask & ~((static_cast<uint64_t>(1u) << firstBit) - 1u);
+}
+
+#endif
+
+void AAIBuildMapTileCounts::Init(const AAIBuildMap* buildMap, int xMapSize, int yMapSize)
+{
+	m_buildMap = buildMap;
+	m_xMapSize = xMapSize;
+	m_yMapSize = yMapSize;
+	m_xBlocks  = (xMapSize + blockSize - 1) / blockSize;
+	m_yBlocks  = (yMapSize + blockSize - 1) / blockSize;
+
+	m_tileTypes.clear();
+	m_tileCounts.clear();
+	m_blockOutdated.assign(m_xBlocks * m_yBlocks, true);
+}
+
+void AAIBuildMapTileCounts::SetAreaOutdated(int xStart, int yStart, int xEnd, int yEnd)
+{
+	const int xStartBlock = std::max(xStart, 0) / blockSize;
+	const int yStartBlock = std::max(yStart, 0) / blockSize;
+	const int xEndBlock   = (std::min(xEnd, m_xMapSize) - 1) / blockSize;
+	const int yEndBlock   = (std::min(yEnd, m_yMapSize) - 1) / blockSize;
+
+	for(int yBlock = yStartBlock; yBlock <= yEndBlock; ++yBlock)
+	{
+		for(int xBlock = xStartBlock; xBlock <= xEndBlock; ++xBlock)
+			m_blockOutdated[yBlock * m_xBlocks + xBlock] = true;
+	}
+}
+
+int AAIBuildMapTileCounts::CountTiles(BuildMapTileType tileTypes, int xStart, int yStart, int xEnd, int yEnd)
+{
+	if( (tileTypes.m_tileType == 0) || (xStart >= xEnd) || (yStart >= yEnd) )
+		return 0;
+
+	const int tileTypesIndex = GetTileTypesIndex(tileTypes);
+	const uint8_t* tileCounts = m_tileCounts[tileTypesIndex].data();
+
+	int tiles(0);
+
+	for(int yBlock = yStart / blockSize; yBlock <= (yEnd - 1) / blockSize; ++yBlock)
+	{
+		for(int xBlock = xStart / blockSize; xBlock <= (xEnd - 1) / blockSize; ++xBlock)
+		{
+			const int block = yBlock * m_xBlocks + xBlock;
+
+			if(m_blockOutdated[block])
+			{
+				for(int i = 0; i < static_cast<int>(m_tileTypes.size()); ++i)
+					UpdateBlock(block, i);
+
+				m_blockOutdated[block] = false;
+			}
+
+			// area within block (end exclusive)
+			const int x1 = std::max(xStart, xBlock * blockSize) - xBlock * blockSize;
+			const int y1 = std::max(yStart, yBlock * blockSize) - yBlock * blockSize;
+			const int x2 = std::min(xEnd,   (xBlock+1) * blockSize) - xBlock * blockSize;
+			const int y2 = std::min(yEnd,   (yBlock+1) * blockSize) - yBlock * blockSize;
+
+			const uint8_t* blockTileCounts = tileCounts + block * tableSize * tableSize;
+
+			tiles +=   blockTileCounts[y2 * tableSize + x2] - blockTileCounts[y2 * tableSize + x1]
+			         - blockTileCounts[y1 * tableSize + x2] + blockTileCounts[y1 * tableSize + x1];
+		}
+	}
+
+	return tiles;
+}
+
+int AAIBuildMapTileCounts::GetTileTypesIndex(BuildMapTileType tileTypes)
+{
+	for(int i = 0; i < static_cast<int>(m_tileTypes.size()); ++i)
+	{
+		if(m_tileTypes[i] == tileTypes.m_tileType)
+			return i;
+	}
+
+	// create counts for new combination of tile types (outdated blocks will be updated when accessed)
+	const int tileTypesIndex = static_cast<int>(m_tileTypes.size());
+
+	m_tileTypes.push_back(tileTypes.m_tileType);
+	m_tileCounts.push_back( std::vector<uint8_t>(m_xBlocks * m_yBlocks * tableSize * tableSize, 0) );
+
+	for(int block = 0; block < m_xBlocks * m_yBlocks; ++block)
+	{
+		if(m_blockOutdated[block] == false)
+			UpdateBlock(block, tileTypesIndex);
+	}
+
+	return tileTypesIndex;
+}
+
+void AAIBuildMapTileCounts::UpdateBlock(int block, int tileTypesIndex)
+{
+	const int xStart = (block % m_xBlocks) * blockSize;
+	const int yStart = (block / m_xBlocks) * blockSize;
+
+	const BuildMapTileType tileTypes( static_cast<EBuildMapTileType>(m_tileTypes[tileTypesIndex]) );
+	uint8_t* tileCounts = &m_tileCounts[tileTypesIndex][block * tableSize * tableSize];
+
+	// first row and column of the table remain zero; tiles outside of the map (if map size is not a multiple of the block size) are not counted
+	const int xEnd = std::min(xStart + blockSize, m_xMapSize);
+
+	for(int y = 0; y < blockSize; ++y)
+	{
+		const uint64_t tiles = (yStart + y < m_yMapSize) ? m_buildMap->GetTilesInRow(tileTypes, yStart + y, xStart, xEnd) : 0u;
+
+		int rowSum(0);
+
+		for(int x = 0; x < blockSize; ++x)
+		{
+			rowSum += static_cast<int>((tiles >> x) & 1u);
+
+			tileCounts[(y+1) * tableSize + x + 1] = static_cast<uint8_t>(rowSum + tileCounts[y * tableSize + x + 1]);
+		}
+	}
+}
+
+AAIMetalYieldMap::AAIMetalYieldMap(AAIThreadPool& threadPool, const unsigned char* metalMap, int xMetalMapSize, int yMetalMapSize, int extractorRadius, int squaredExtractorRadius, int minScaledYield) :
+	m_xMetalMapSize(xMetalMapSize),
+	m_yMetalMapSize(yMetalMapSize),
+	m_extractorRadius(extractorRadius),
+	m_minScaledYield(std::max(1, minScaledYield)),
+	m_maxYield(0),
+	m_metal(metalMap, metalMap + xMetalMapSize * yMetalMapSize),
+	m_yield(xMetalMapSize * yMetalMapSize, 0),
+	m_scaledYield(xMetalMapSize * yMetalMapSize, 0)
+{
+	//-----------------------------------------------------------------------------------------------------------------
+	// determine extraction area: all tiles within [-radius, radius-1] in each direction and within squared radius
+	//-----------------------------------------------------------------------------------------------------------------
+	for(int yOffset = -extractorRadius; yOffset < extractorRadius; ++yOffset)
+	{
+		int halfWidth(-1);
+
+		while( (halfWidth + 1) * (halfWidth + 1) + yOffset * yOffset <= squaredExtractorRadius )
+			++halfWidth;
+
+		if(halfWidth >= 0)
+		{
+			ExtractionAreaRow row;
+			row.yOffset = yOffset;
+			row.xMin    = -std::min(extractorRadius, halfWidth);
+			row.xMax    =  std::min(extractorRadius - 1, halfWidth);
+
+			m_extractionArea.push_back(row);
+		}
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// calculate yield of every tile: sum up metal of every row of the extraction area using prefix sums of the metal map rows
+	//-----------------------------------------------------------------------------------------------------------------
+	std::vector<int> rowPrefixSums( (xMetalMapSize + 1) * yMetalMapSize, 0);
+
+	threadPool.ProcessRowBands(yMetalMapSize, rowsPerBand, [&](int band, int yStart, int yEnd)
+	{
+		for(int y = yStart; y < yEnd; ++y)
+		{
+			for(int x = 0; x < xMetalMapSize; ++x)
+				rowPrefixSums[y * (xMetalMapSize + 1) + x + 1] = rowPrefixSums[y * (xMetalMapSize + 1) + x] + m_metal[y * xMetalMapSize + x];
+		}
+	});
+
+	std::vector<int> maxYieldPerBand(AAIThreadPool::GetNumberOfBands(yMetalMapSize, rowsPerBand), 0);
+
+	threadPool.ProcessRowBands(yMetalMapSize, rowsPerBand, [&](int band, int yStart, int yEnd)
+	{
+		for(int y = yStart; y < yEnd; ++y)
+		{
+			for(int x = 0; x < xMetalMapSize; ++x)
+			{
+				int yield(0);
+
+				for(const auto& row : m_extractionArea)
+				{
+					const int yRow = y + row.yOffset;
+
+					if( (yRow >= 0) && (yRow < yMetalMapSize) )
+					{
+						const int xStart = std::max(0,                 x + row.xMin);
+						const int xEnd   = std::min(xMetalMapSize - 1, x + row.xMax);
+
+						if(xStart <= xEnd)
+							yield += rowPrefixSums[yRow * (xMetalMapSize + 1) + xEnd + 1] - rowPrefixSums[yRow * (xMetalMapSize + 1) + xStart];
+					}
+				}
+
+				m_yield[y * xMetalMapSize + x] = yield;
+				maxYieldPerBand[band] = std::max(maxYieldPerBand[band], yield);
+			}
+		}
+	});
+
+	for(int maxYield : maxYieldPerBand)
+		m_maxYield = std::max(m_maxYield, maxYield);
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// scale yield and add candidates (only every second tile) - as the yield may only decrease, tiles with insufficient 
+	// yield will never become a candidate later on
+	//-----------------------------------------------------------------------------------------------------------------
+	std::vector< std::pair<int, int> > spotCandidates;
+
+	for(int tileIndex = 0; tileIndex < xMetalMapSize * yMetalMapSize; ++tileIndex)
+	{
+		m_scaledYield[tileIndex] = ScaleYield(m_yield[tileIndex]);
+
+		if( (tileIndex % 2 == 0) && (m_scaledYield[tileIndex] >= m_minScaledYield) )
+			spotCandidates.push_back( std::pair<int, int>(m_scaledYield[tileIndex], -tileIndex) );
+	}
+
+	m_spotCandidates = std::priority_queue< std::pair<int, int> >(std::less< std::pair<int, int> >(), std::move(spotCandidates));
+}
+
+bool AAIMetalYieldMap::DetermineBestSpot(MapPos& spot, int& scaledYield)
+{
+	while(m_spotCandidates.empty() == false)
+	{
+		const std::pair<int, int> candidate = m_spotCandidates.top();
+		const int tileIndex = -candidate.second;
+
+		// entry is up to date - as the yield of a tile may only decrease, no other tile has a higher yield
+		if(m_scaledYield[tileIndex] == candidate.first)
+		{
+			spot        = MapPos(tileIndex % m_xMetalMapSize, tileIndex / m_xMetalMapSize);
+			scaledYield = candidate.first;
+			return true;
+		}
+
+		// yield has decreased since entry has been added -> readd with current yield if still sufficient
+		m_spotCandidates.pop();
+
+		if(m_scaledYield[tileIndex] >= m_minScaledYield)
+			m_spotCandidates.push( std::pair<int, int>(m_scaledYield[tileIndex], -tileIndex) );
+	}
+
+	return false;
+}
+
+void AAIMetalYieldMap::TakeSpot(const MapPos& spot)
+{
+	//-----------------------------------------------------------------------------------------------------------------
+	// remove metal within extraction area of given spot (row by row) and subtract it from the yield of all tiles within range
+	//-----------------------------------------------------------------------------------------------------------------
+	for(const auto& row : m_extractionArea)
+	{
+		const int y      = spot.y + row.yOffset;
+		const int xStart = std::max(0,                   spot.x + row.xMin);
+		const int xEnd   = std::min(m_xMetalMapSize - 1, spot.x + row.xMax);
+
+		if( (y < 0) || (y >= m_yMetalMapSize) || (xStart > xEnd) )
+			continue;
+
+		// prefix sums of the removed metal within the row
+		m_removedMetal.resize(xEnd - xStart + 2);
+		m_removedMetal[0] = 0;
+
+		for(int x = xStart; x <= xEnd; ++x)
+		{
+			const int tileIndex = y * m_xMetalMapSize + x;
+			m_removedMetal[x - xStart + 1] = m_removedMetal[x - xStart] + m_metal[tileIndex];
+
+			m_metal[tileIndex]       = 0;
+			m_scaledYield[tileIndex] = 0;
+		}
+
+		if(m_removedMetal.back() == 0)
+			continue;
+
+		// removed metal lies within row yOffset of the extraction area of tiles in row y - yOffset
+		for(const auto& affectedRow : m_extractionArea)
+		{
+			const int yAffected = y - affectedRow.yOffset;
+
+			if( (yAffected < 0) || (yAffected >= m_yMetalMapSize) )
+				continue;
+
+			const int xAffectedStart = std::max(0,                   xStart - affectedRow.xMax);
+			const int xAffectedEnd   = std::min(m_xMetalMapSize - 1, xEnd   - affectedRow.xMin);
+
+			for(int xAffected = xAffectedStart; xAffected <= xAffectedEnd; ++xAffected)
+			{
+				const int removedStart = std::max(xStart, xAffected + affectedRow.xMin);
+				const int removedEnd   = std::min(xEnd,   xAffected + affectedRow.xMax);
+
+				m_yield[yAffected * m_xMetalMapSize + xAffected] -= m_removedMetal[removedEnd - xStart + 1] - m_removedMetal[removedStart - xStart];
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// update scaled yield of affected tiles (tiles within radius of a taken spot remain zero)
+	//-----------------------------------------------------------------------------------------------------------------
+	const int range = 2 * m_extractorRadius;
+
+	for(int y = std::max(0, spot.y - range); y <= std::min(m_yMetalMapSize - 1, spot.y + range); ++y)
+	{
+		for(int x = std::max(0, spot.x - range); x <= std::min(m_xMetalMapSize - 1, spot.x + range); ++x)
+		{
+			const int tileIndex = y * m_xMetalMapSize + x;
+
+			if(m_scaledYield[tileIndex] > 0)
+				m_scaledYield[tileIndex] = ScaleYield(m_yield[tileIndex]);
+		}
+	}
+}
+
 void AAIContinentMap::Init(int xMapSize, int yMapSize)
 { 
 	m_xContMapSize = xMapSize / continentMapResolution;
 	m_yContMapSize = yMapSize / continentMapResolution;
 
-	m_continentMap.resize(m_xContMapSize*m_yContMapSize, -1);
+	m_continentMap.assign(m_xContMapSize*m_yContMapSize, -1);
 }
 
-void AAIContinentMap::LoadFromFile(FILE* file)
+void AAIContinentMap::EncodeRunLength(std::vector<int32_t>& runs) const
 {
+	runs.clear();
+
 	for(int y = 0; y < m_yContMapSize; ++y)
 	{
-		for(int x = 0; x < m_xContMapSize; ++x)
+		const int rowStart = y * m_xContMapSize;
+		int x = 0;
+
+		while(x < m_xContMapSize)
 		{
-			fscanf(file, "%i ", &m_continentMap[y * m_xContMapSize + x]);
+			const int continentId = m_continentMap[rowStart + x];
+			const int runStart    = x;
+
+			while( (x < m_xContMapSize) && (m_continentMap[rowStart + x] == continentId) )
+				++x;
+
+			runs.push_back(continentId);
+			runs.push_back(x - runStart);
 		}
 	}
 }
 
-void AAIContinentMap::SaveToFile(FILE* file)
+bool AAIContinentMap::DecodeRunLength(const std::vector<int32_t>& runs)
+{
+	if(runs.size() % 2 != 0)
+		return false;
+
+	int x(0), y(0);
+
+	for(size_t run = 0; run < runs.size(); run += 2)
+	{
+		const int continentId = runs[run];
+		const int length      = runs[run+1];
+
+		if( (y >= m_yContMapSize) || (length <= 0) || (length > m_xContMapSize - x) )
+			return false;
+
+		int* rowStart = &m_continentMap[y * m_xContMapSize];
+		std::fill(rowStart + x, rowStart + x + length, continentId);
+
+		x += length;
+
+		if(x == m_xContMapSize)
+		{
+			x = 0;
+			++y;
+		}
+	}
+
+	return (y == m_yContMapSize);
+}
+
+void AAIContinentMap::SaveToFile(FILE* file) const
 {
 	for(int y = 0; y < m_yContMapSize; ++y)
 	{
@@ -202,122 +904,203 @@ int AAIContinentMap::GetContinentID(const float3& pos) const
 	return m_continentMap[x + y * m_xContMapSize];
 }
 
-void AAIContinentMap::CheckIfTileBelongsToLandContinent(int continentMapTileIndex, float tileHeight, std::vector<AAIContinent>& continents, int continentId, std::vector<int>* nextEdgeCells)
+void AAIContinentMap::DetectContinents(AAIThreadPool& threadPool, std::vector<AAIContinent>& continents, const float *heightMap, const int xMapSize, const int yMapSize)
 {
-	if(m_continentMap[continentMapTileIndex] == -1)
+	//-----------------------------------------------------------------------------------------------------------------
+	// classify tiles: shallow water does not belong to land continents but connects land masses for non amphibious units
+	//-----------------------------------------------------------------------------------------------------------------
+	std::vector<EContinentTileType> tileTypes(m_xContMapSize * m_yContMapSize);
+
+	const float maxWaterDepth = cfg->NON_AMPHIB_MAX_WATERDEPTH;
+
+	threadPool.ProcessRowBands(m_yContMapSize, rowsPerBand, [&](int band, int yStart, int yEnd)
 	{
-		// if height is above sea level, the tile belongs to the same continent
-		// -> set it on list whose neighbours shall be checked in the next iteration
-		if(tileHeight >= 0.0f)
+		for(int y = yStart; y < yEnd; ++y)
 		{
-			m_continentMap[continentMapTileIndex] = continentId;
-			continents[continentId].size += 1;
-			nextEdgeCells->push_back( continentMapTileIndex );
-		}
-		// if height is below sea level but not below maximum water depth for non amphibious land units
-		// -> tile does not belong to land continent but check its neighbours in the next iteration
-		// -> ensures that connected land masses are detected as one continent
-		else if(tileHeight >= - cfg->NON_AMPHIB_MAX_WATERDEPTH)
-		{
-			m_continentMap[continentMapTileIndex] = -2;
-			nextEdgeCells->push_back( continentMapTileIndex );
+			for(int x = 0; x < m_xContMapSize; ++x)
+			{
+				const float tileHeight = heightMap[continentMapResolution * (y * xMapSize + x)];
+
+				if(tileHeight >= 0.0f)
+					tileTypes[y * m_xContMapSize + x] = EContinentTileType::LAND;
+				else if(tileHeight >= - maxWaterDepth)
+					tileTypes[y * m_xContMapSize + x] = EContinentTileType::SHALLOW_WATER;
+				else
+					tileTypes[y * m_xContMapSize + x] = EContinentTileType::DEEP_WATER;
+			}
 		}
-	}
+	});
+
+	// land continents first, followed by sea continents
+	DetectConnectedTiles(threadPool, tileTypes, EContinentTileType::SHALLOW_WATER, EContinentTileType::LAND,          EContinentTileType::LAND,       false, continents);
+	DetectConnectedTiles(threadPool, tileTypes, EContinentTileType::DEEP_WATER,    EContinentTileType::SHALLOW_WATER, EContinentTileType::DEEP_WATER, true,  continents);
 }
 
-void AAIContinentMap::CheckIfTileBelongsToSeaContinent(int continentMapTileIndex, float tileHeight, std::vector<AAIContinent>& continents, int continentId, std::vector<int>* nextEdgeCells)
+void AAIContinentMap::DetectConnectedTiles(AAIThreadPool& threadPool, const std::vector<EContinentTileType>& tileTypes, EContinentTileType minType, EContinentTileType maxType, 
+                                           EContinentTileType minContinentType, bool water, std::vector<AAIContinent>& continents)
 {
-	if( (m_continentMap[continentMapTileIndex] < 0) && (tileHeight < 0.0f) )
+	//-----------------------------------------------------------------------------------------------------------------
+	// determine runs of connected tiles in every row
+	//-----------------------------------------------------------------------------------------------------------------
+	std::vector< std::vector<TileRun> > runsPerRow(m_yContMapSize);
+
+	threadPool.ProcessRowBands(m_yContMapSize, rowsPerBand, [&](int band, int yStart, int yEnd)
 	{
-		m_continentMap[continentMapTileIndex] = continentId;
-		continents[continentId].size += 1;
-		nextEdgeCells->push_back(continentMapTileIndex);	
-	}
-}
-				
-void AAIContinentMap::DetectContinents(std::vector<AAIContinent>& continents, const float *heightMap, const int xMapSize, const int yMapSize)
-{
-	// In every iteration, one of those two containers will be used to store the newly identified edge tiles
-	// After each iteration, the containers will be flipped  to check for further neighbours.
-	// When no new edge cells are found the detection of the current continent has been completed.
-	std::vector<int> edgeTiles1, edgeTiles2;
+		for(int y = yStart; y < yEnd; ++y)
+		{
+			const EContinentTileType* rowTileTypes = &tileTypes[y * m_xContMapSize];
+
+			for(int x = 0; x < m_xContMapSize; )
+			{
+				if( (rowTileTypes[x] < minType) || (rowTileTypes[x] > maxType) )
+				{
+					++x;
+					continue;
+				}
+
+				TileRun run;
+				run.xStart          = x;
+				run.continentTiles  = 0;
+				run.firstTileX      = -1;
+
+				for( ; (x < m_xContMapSize) && (rowTileTypes[x] >= minType) && (rowTileTypes[x] <= maxType); ++x)
+				{
+					if(rowTileTypes[x] >= minContinentType)
+					{
+						if(run.continentTiles == 0)
+							run.firstTileX = x;
+
+						++run.continentTiles;
+					}
+				}
+
+				run.xEnd = x;
+				runsPerRow[y].push_back(run);
+			}
+		}
+	});
+
+	std::vector<int> firstRunOfRow(m_yContMapSize + 1, 0);
 
-	std::vector<int>* new_edge_cells(&edgeTiles1);
-	std::vector<int>* old_edge_cells(&edgeTiles2);
+	for(int y = 0; y < m_yContMapSize; ++y)
+		firstRunOfRow[y+1] = firstRunOfRow[y] + static_cast<int>(runsPerRow[y].size());
 
-	int continentId(0);
+	//-----------------------------------------------------------------------------------------------------------------
+	// union-find: join overlapping runs of consecutive rows (each root is the run with the lowest index of its group)
+	//-----------------------------------------------------------------------------------------------------------------
+	std::vector<int> parentRun(firstRunOfRow.back());
 
-	std::array<bool, 2> detectSeaContinents = {false, true};
+	auto findRoot = [&](int run)
+	{
+		while(parentRun[run] != run)
+		{
+			parentRun[run] = parentRun[parentRun[run]];
+			run = parentRun[run];
+		}
+		return run;
+	};
 
-	for(auto water : detectSeaContinents)
+	auto joinOverlappingRuns = [&](int y)
 	{
-		// decide which function shall be used to check if a tile belongs to the current continent
-		void (AAIContinentMap::*checkMapTile) (int, float, std::vector<AAIContinent>&, int, std::vector<int>* ) = water ? 
-								&AAIContinentMap::CheckIfTileBelongsToSeaContinent : &AAIContinentMap::CheckIfTileBelongsToLandContinent;
+		const std::vector<TileRun>& previousRow = runsPerRow[y-1];
+		const std::vector<TileRun>& currentRow  = runsPerRow[y];
 
-		for(int i = 0; i < m_xContMapSize; i += 1)
+		size_t previous(0), current(0);
+
+		while( (previous < previousRow.size()) && (current < currentRow.size()) )
 		{
-			for(int j = 0; j < m_yContMapSize; j += 1)
+			if( (previousRow[previous].xStart < currentRow[current].xEnd) && (currentRow[current].xStart < previousRow[previous].xEnd) )
 			{
-				// sea continents are checked in the second iteration
-				const bool tileHeightCheckPassed = water || (heightMap[4 * (j * xMapSize + i)] >= 0.0f);
+				const int root1 = findRoot(firstRunOfRow[y-1] + static_cast<int>(previous));
+				const int root2 = findRoot(firstRunOfRow[y]   + static_cast<int>(current));
 
-				// add new continent if cell has not been visited yet
-				if( (m_continentMap[j * m_xContMapSize + i] < 0) && tileHeightCheckPassed )
-				{
-					AAIContinent newContinent(continentId, 1, water);
-					continents.push_back(newContinent);
+				parentRun[std::max(root1, root2)] = std::min(root1, root2);
+			}
 
-					m_continentMap[j * m_xContMapSize + i] = continentId;
+			// advance the run that ends first
+			if(previousRow[previous].xEnd < currentRow[current].xEnd)
+				++previous;
+			else
+				++current;
+		}
+	};
 
-					old_edge_cells->push_back(j * m_xContMapSize + i);
+	// runs of different bands are not joined yet, i.e. every band only accesses its own runs
+	threadPool.ProcessRowBands(m_yContMapSize, rowsPerBand, [&](int band, int yStart, int yEnd)
+	{
+		for(int run = firstRunOfRow[yStart]; run < firstRunOfRow[yEnd]; ++run)
+			parentRun[run] = run;
 
-					// check edges of the continent as long as new cells have been added to the continent during the last loop
-					while(old_edge_cells->size() > 0)
-					{
-						for(auto cell : *old_edge_cells)
-						{
-							// get cell indizes
-							const int x = cell%m_xContMapSize;
-							const int y = (cell - x) / m_xContMapSize;
-
-							const int continentMapTileIndex = y * m_xContMapSize + x;
-							const int heightMapTileIndex    = 4 * (y * xMapSize + x);
-
-							if(x > 0)
-								(this->*checkMapTile)(continentMapTileIndex-1, heightMap[heightMapTileIndex-continentMapResolution], continents, continentId, new_edge_cells);
-
-							if(x < m_xContMapSize-1)
-								(this->*checkMapTile)(continentMapTileIndex+1, heightMap[heightMapTileIndex+continentMapResolution], continents, continentId, new_edge_cells);
-
-							if(y > 0)
-								(this->*checkMapTile)(continentMapTileIndex-m_xContMapSize, heightMap[heightMapTileIndex-continentMapResolution*xMapSize], continents, continentId, new_edge_cells);					
-
-							if(y < m_yContMapSize-1)
-								(this->*checkMapTile)(continentMapTileIndex+m_xContMapSize, heightMap[heightMapTileIndex+continentMapResolution*xMapSize], continents, continentId, new_edge_cells);
-						}
-
-						old_edge_cells->clear();
-
-						// invert pointers to new/old edge cells
-						if(new_edge_cells == &edgeTiles1)
-						{
-							new_edge_cells = &edgeTiles2;
-							old_edge_cells = &edgeTiles1;
-						}
-						else
-						{
-							new_edge_cells = &edgeTiles1;
-							old_edge_cells = &edgeTiles2;
-						}
-					}
+		for(int y = yStart + 1; y < yEnd; ++y)
+			joinOverlappingRuns(y);
+	});
 
-					// finished adding continent
-					++continentId;
-					old_edge_cells->clear();
-					new_edge_cells->clear();
-				}
+	for(int y = rowsPerBand; y < m_yContMapSize; y += rowsPerBand)
+		joinOverlappingRuns(y);
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// determine size and first tile of every group of runs, groups that contain continent tiles become continents
+	// (ids in order of the first continent tile when traversing the map column by column)
+	//-----------------------------------------------------------------------------------------------------------------
+	std::vector<int> continentTiles(parentRun.size(), 0);
+	std::vector<int> firstTile(parentRun.size(), std::numeric_limits<int>::max());
+
+	for(int y = 0; y < m_yContMapSize; ++y)
+	{
+		for(int run = firstRunOfRow[y]; run < firstRunOfRow[y+1]; ++run)
+		{
+			const TileRun& tileRun = runsPerRow[y][run - firstRunOfRow[y]];
+			const int root = findRoot(run);
+			parentRun[run] = root;
+
+			if(tileRun.continentTiles > 0)
+			{
+				continentTiles[root] += tileRun.continentTiles;
+				firstTile[root]       = std::min(firstTile[root], tileRun.firstTileX * m_yContMapSize + y);
 			}
 		}
 	}
+
+	std::vector<int> continentRoots;
+
+	for(int run = 0; run < static_cast<int>(parentRun.size()); ++run)
+	{
+		if( (parentRun[run] == run) && (continentTiles[run] > 0) )
+			continentRoots.push_back(run);
+	}
+
+	std::sort(continentRoots.begin(), continentRoots.end(), [&](int lhs, int rhs) { return firstTile[lhs] < firstTile[rhs]; });
+
+	std::vector<int> continentIdOfRoot(parentRun.size(), -1);
+
+	for(int root : continentRoots)
+	{
+		const int continentId = static_cast<int>(continents.size());
+		continentIdOfRoot[root] = continentId;
+		continents.push_back( AAIContinent(continentId, continentTiles[root], water) );
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// assign continent tiles to continents
+	//-----------------------------------------------------------------------------------------------------------------
+	threadPool.ProcessRowBands(m_yContMapSize, rowsPerBand, [&](int band, int yStart, int yEnd)
+	{
+		for(int y = yStart; y < yEnd; ++y)
+		{
+			for(int run = firstRunOfRow[y]; run < firstRunOfRow[y+1]; ++run)
+			{
+				const TileRun& tileRun   = runsPerRow[y][run - firstRunOfRow[y]];
+				const int    continentId = continentIdOfRoot[parentRun[run]];
+
+				if( (continentId < 0) || (tileRun.continentTiles == 0) )
+					continue;
+
+				for(int x = tileRun.firstTileX; x < tileRun.xEnd; ++x)
+				{
+					if(tileTypes[y * m_xContMapSize + x] >= minContinentType)
+						m_continentMap[y * m_xContMapSize + x] = continentId;
+				}
+			}
+		}
+	});
 }
@@ -14,6 +14,11 @@
 #include "AAISector.h"
 #include "AAIMapRelatedTypes.h"
 #include <vector>
+#include <queue>
+#include <utility>
+#include <cstdint>
+
+class AAIThreadPool;
 
 //! The map storing which sector has been taken (as base) by which AAI team. Used to avoid that multiple AAI instances expand 
 //! into the same sector or build defences in the sector of an allied player.
@@ -23,7 +28,7 @@ public:
 	AAITeamSectorMap() {}
 	
 	//! @brief Initializes all sectors as unoccupied
-	void Init(int xSectors, int ySectors) { m_teamMap.resize(xSectors, std::vector<int>(ySectors, sectorUnoccupied) ); }
+	void Init(int xSectors, int ySectors) { m_teamMap.assign(xSectors, std::vector<int>(ySectors, sectorUnoccupied) ); }
 
 	//! Returns whether sector has been occupied by any AAI player (allied, enemy, or own instance)
 	bool IsSectorOccupied(const SectorIndex& sector)                const { return (m_teamMap[sector.x][sector.y] != sectorUnoccupied); }
@@ -69,19 +74,34 @@ public:
 	//!        Used to add or remove defences
 	void ModifyTiles(const float3& position, float maxWeaponRange, const UnitFootprint& footprint, const TargetTypeValues& combatPower, bool addValues);
 
-	//! @brief Calculates current sum of defence map values for all tiles of the area
+	//! @brief Calculates current sum of defence map values for all tiles of the area (summed area table is updated if outdated)
 	float CalculateValueForArea(const MapPos& topLeft, const MapPos& bottomRight, const AAITargetType& targetType) const;
 
 private:
-	//! @brief Adds combat power values to given tile
-	void AddDefence(int tile, const TargetTypeValues& combatPower);
+	//! @brief Recalculates the summed area table of the given target type
+	void UpdateSummedAreaTable(int targetTypeIndex) const;
+
+	//! @brief Adds combat power values to the given number of consecutive tiles (starting with the given tile)
+	void AddDefence(int firstTile, int numberOfTiles, const TargetTypeValues& combatPower);
+
+	//! @brief Removes combat power values from the given number of consecutive tiles (starting with the given tile)
+	void RemoveDefence(int firstTile, int numberOfTiles, const TargetTypeValues& combatPower);
 
-	//! @brief Removes combat power values to given tile
-	void RemoveDefence(int tile, const TargetTypeValues& combatPower);
+	//! @brief Returns the half width of every row of a disc with the given radius (rows from -range to range-1 relative to the center)
+	const std::vector<int>& GetDiscHalfWidths(int range);
 
 	//! The maps itself
 	std::vector< std::vector<float> > m_defenceMaps;
 
+	//! Summed area tables of the defence maps (one additional leading row/column of zeros), updated on demand
+	mutable std::vector< std::vector<double> > m_summedAreaTables;
+
+	//! Flag for every target type whether the summed area table needs to be updated
+	mutable std::vector<bool> m_summedAreaTableOutdated;
+
+	//! Half widths of the rows of discs (i.e. area covered by a defence) for already requested ranges (index = range)
+	std::vector< std::vector<int> > m_discHalfWidths;
+
 	//! Horizontal size of the defence map
 	int m_xDefenceMapSize;
 	
@@ -92,6 +112,299 @@ private:
 	static constexpr int defenceMapResolution = 4;
 };
 
+#ifndef AAI_BUILD_MAP_BIT_PLANES
+
+//! The build map stores the type/occupation status of every build map tile (one byte per tile containing all its tile types).
+//! Default representation as footprint and row checks (which stop at the first matching tile) are faster than with bit planes.
+class AAIBuildMap
+{
+public:
+	AAIBuildMap() : m_xMapSize(0), m_yMapSize(0) {}
+
+	//! @brief Initializes all tiles as not set
+	void Init(int xMapSize, int yMapSize);
+
+	//! @brief Frees the memory of the build map
+	void Clear();
+
+	//! @brief Returns the tile types of the given tile
+	BuildMapTileType GetTileType(int x, int y) const { return m_tiles[x + y * m_xMapSize]; }
+
+	//! @brief Returns whether any of the given tile types is set for the given tile
+	bool IsTileTypeSet(int x, int y, BuildMapTileType tileTypes) const { return m_tiles[x + y * m_xMapSize].IsTileTypeSet(tileTypes); }
+
+	//! @brief Sets the given tile type for the given tile (other tile types remain unchanged)
+	void SetTileType(int x, int y, EBuildMapTileType tileType) { m_tiles[x + y * m_xMapSize].SetTileType(tileType); }
+
+	//! @brief Marks the given tile as blocked (i.e. no longer free)
+	void BlockTile(int x, int y) { m_tiles[x + y * m_xMapSize].BlockTile(); }
+
+	//! @brief Marks the given tile as free (i.e. neither occupied nor blocked)
+	void FreeTile(int x, int y) { m_tiles[x + y * m_xMapSize].FreeTile(); }
+
+	//! @brief Marks all tiles within the given area (end exclusive, must lie within the map) as occupied
+	void OccupyTiles(int xStart, int yStart, int xEnd, int yEnd);
+
+	//! @brief Marks all tiles within the given area (end exclusive, must lie within the map) as free
+	void FreeTiles(int xStart, int yStart, int xEnd, int yEnd);
+
+	//! @brief Returns whether any tile within the given area (end exclusive, must lie within the map) has any of the given tile types set
+	bool IsTileTypeSetInArea(BuildMapTileType tileTypes, int xStart, int yStart, int xEnd, int yEnd) const;
+
+	//! @brief Returns the number of tiles within the given area (end exclusive, must lie within the map) with any of the given tile types set
+	int CountTiles(BuildMapTileType tileTypes, int xStart, int yStart, int xEnd, int yEnd) const;
+
+	//! @brief Returns the tiles of the given row (starting with xStart, at most 64 tiles, end exclusive) with any of the given tile types set as bit mask
+	uint64_t GetTilesInRow(BuildMapTileType tileTypes, int y, int xStart, int xEnd) const;
+
+	//! @brief Returns the tiles (e.g. to store them in a cache file)
+	BuildMapTileType* GetData() { return m_tiles.data(); }
+
+	//! @brief Returns the size of the tiles in bytes
+	size_t GetDataSize() const { return m_tiles.size() * sizeof(BuildMapTileType); }
+
+private:
+	//! The tile types of every tile (stored row by row)
+	std::vector<BuildMapTileType> m_tiles;
+
+	//! Horizontal size of the build map
+	int m_xMapSize;
+
+	//! Vertical size of the build map
+	int m_yMapSize;
+};
+
+#else
+
+//! The build map stores the type/occupation status of every build map tile as bit planes, i.e. one bit per tile for every
+//! tile type (every row starts with a new word, the words of all planes covering the same tiles are stored next to each other).
+//! Selected by defining AAI_BUILD_MAP_BIT_PLANES: needs 7 instead of 8 bits per tile, but checks of single tiles and short rows
+//! are slower than with one byte per tile.
+class AAIBuildMap
+{
+public:
+	AAIBuildMap() : m_xMapSize(0), m_yMapSize(0), m_wordsPerRow(0) {}
+
+	//! @brief Initializes all tiles as not set
+	void Init(int xMapSize, int yMapSize);
+
+	//! @brief Frees the memory of the build map
+	void Clear();
+
+	//! @brief Returns the tile types of the given tile
+	BuildMapTileType GetTileType(int x, int y) const;
+
+	//! @brief Returns whether any of the given tile types is set for the given tile
+	bool IsTileTypeSet(int x, int y, BuildMapTileType tileTypes) const { return (GetRowTiles(tileTypes, y, x / bitsPerWord) >> (x % bitsPerWord)) & 1u; }
+
+	//! @brief Sets the given tile type for the given tile (other tile types remain unchanged)
+	void SetTileType(int x, int y, EBuildMapTileType tileType) { SetTiles(tileType, y, x / bitsPerWord, static_cast<uint64_t>(1u) << (x % bitsPerWord)); }
+
+	//! @brief Marks the given tile as blocked (i.e. no longer free)
+	void BlockTile(int x, int y);
+
+	//! @brief Marks the given tile as free (i.e. neither occupied nor blocked)
+	void FreeTile(int x, int y) { FreeTiles(x, y, x+1, y+1); }
+
+	//! @brief Marks all tiles within the given area (end exclusive, must lie within the map) as occupied
+	void OccupyTiles(int xStart, int yStart, int xEnd, int yEnd);
+
+	//! @brief Marks all tiles within the given area (end exclusive, must lie within the map) as free
+	void FreeTiles(int xStart, int yStart, int xEnd, int yEnd);
+
+	//! @brief Returns whether any tile within the given area (end exclusive, must lie within the map) has any of the given tile types set
+	bool IsTileTypeSetInArea(BuildMapTileType tileTypes, int xStart, int yStart, int xEnd, int yEnd) const;
+
+	//! @brief Returns the number of tiles within the given area (end exclusive, must lie within the map) with any of the given tile types set
+	int CountTiles(BuildMapTileType tileTypes, int xStart, int yStart, int xEnd, int yEnd) const;
+
+	//! @brief Returns the tiles of the given row (starting with xStart, at most 64 tiles, end exclusive) with any of the given tile types set as bit mask
+	uint64_t GetTilesInRow(BuildMapTileType tileTypes, int y, int xStart, int xEnd) const;
+
+	//! @brief Returns the bit planes (e.g. to store them in a cache file)
+	uint64_t* GetData() { return m_planes.data(); }
+
+	//! @brief Returns the size of the bit planes in bytes
+	size_t GetDataSize() const { return m_planes.size() * sizeof(uint64_t); }
+
+private:
+	//! @brief Returns the tiles of the given word of a row with any of the given tile types set
+	uint64_t GetRowTiles(BuildMapTileType tileTypes, int y, int word) const
+	{
+		uint64_t tiles(0u);
+
+		const uint64_t* words = &m_planes[(y * m_wordsPerRow + word) * numberOfPlanes];
+
+		for(uint8_t types = tileTypes.m_tileType; types != 0u; types &= (types - 1u))
+			tiles |= words[__builtin_ctz(types)];
+
+		return tiles;
+	}
+
+	//! @brief Sets the given tile type for the tiles of the given word of a row selected by the mask
+	void SetTiles(EBuildMapTileType tileType, int y, int word, uint64_t mask) { GetWord(tileType, y, word) |= mask; }
+
+	//! @brief Clears the given tile type for the tiles of the given word of a row selected by the mask
+	void ClearTiles(EBuildMapTileType tileType, int y, int word, uint64_t mask) { GetWord(tileType, y, word) &= ~mask; }
+
+	//! @brief Returns the given word of a row of the plane of the given tile type
+	uint64_t& GetWord(EBuildMapTileType tileType, int y, int word) { return m_planes[(y * m_wordsPerRow + word) * numberOfPlanes + __builtin_ctz(static_cast<unsigned int>(tileType))]; }
+
+	//! @brief Returns the mask selecting the tiles within the given range (end exclusive) of the given word of a row
+	static uint64_t GetMask(int word, int xStart, int xEnd);
+
+	//! One bit plane per tile type (stored row by row, for every word of a row the words of all planes)
+	std::vector<uint64_t> m_planes;
+
+	//! Horizontal size of the build map
+	int m_xMapSize;
+
+	//! Vertical size of the build map
+	int m_yMapSize;
+
+	//! Number of words needed to store one row of a plane
+	int m_wordsPerRow;
+
+	//! Number of bit planes (one for every tile type except NOT_SET)
+	static constexpr int numberOfPlanes = 7;
+
+	//! Number of tiles stored per word
+	static constexpr int bitsPerWord = 64;
+};
+
+#endif
+
+//! Stores the number of build map tiles with certain tile types (e.g. the tile types a building cannot be constructed on) as summed
+//! area table per block of the build map. This allows to check whether a building fits at a certain position with a few lookups 
+//! instead of checking every tile of its footprint. Counts for a combination of tile types are created when queried for the first
+//! time. Blocks are marked as outdated when the build map changes and updated when accessed the next time.
+class AAIBuildMapTileCounts
+{
+public:
+	AAIBuildMapTileCounts() : m_buildMap(nullptr), m_xMapSize(0), m_yMapSize(0), m_xBlocks(0), m_yBlocks(0) {}
+
+	//! @brief Sets the build map whose tiles shall be counted (all blocks are outdated)
+	void Init(const AAIBuildMap* buildMap, int xMapSize, int yMapSize);
+
+	//! @brief Marks all blocks overlapping the given area (end exclusive) as outdated; must be called whenever tiles of the build map have been changed
+	void SetAreaOutdated(int xStart, int yStart, int xEnd, int yEnd);
+
+	//! @brief Returns the number of tiles within the given area (end exclusive, must lie within the map) with any of the given tile types set
+	int CountTiles(BuildMapTileType tileTypes, int xStart, int yStart, int xEnd, int yEnd);
+
+private:
+	//! @brief Returns the index of the counts of the given tile types (counts are created if not available yet)
+	int GetTileTypesIndex(BuildMapTileType tileTypes);
+
+	//! @brief Updates the summed area table of the given block for the given tile types
+	void UpdateBlock(int block, int tileTypesIndex);
+
+	//! The build map
+	const AAIBuildMap* m_buildMap;
+
+	//! Horizontal size of the build map
+	int m_xMapSize;
+
+	//! Vertical size of the build map
+	int m_yMapSize;
+
+	//! Number of blocks in x-direction
+	int m_xBlocks;
+
+	//! Number of blocks in y-direction
+	int m_yBlocks;
+
+	//! The combinations of tile types for which tiles are counted
+	std::vector<uint8_t> m_tileTypes;
+
+	//! Summed area table of every block for every combination of tile types
+	std::vector< std::vector<uint8_t> > m_tileCounts;
+
+	//! Flag for every block whether the summed area tables need to be updated
+	std::vector<bool> m_blockOutdated;
+
+	//! Size of the blocks (in build map tiles; counts must fit into uint8_t)
+	static constexpr int blockSize = 15;
+
+	//! Size of the summed area table of a block (leading row/column of zeros)
+	static constexpr int tableSize = blockSize + 1;
+};
+
+//! Bit packed snapshot of the line of sight map (one bit per LOS map tile, every row starts with a new word).
+//! The snapshot is taken at most once per frame and shared by all LOS queries of an AAI instance.
+class AAILosMap
+{
+public:
+	AAILosMap() : m_xLosMapSize(0), m_yLosMapSize(0), m_wordsPerRow(0), m_updateInFrame(-1) {}
+
+	//! @brief Initializes all tiles as not within LOS
+	void Init(int xLosMapSize, int yLosMapSize);
+
+	//! @brief Packs the given LOS map (one int per tile as provided by the engine) and stores the frame of the snapshot
+	void Update(const int* losMap, int frame);
+
+	//! @brief Returns the frame in which the snapshot has been taken (-1 if not taken yet)
+	int GetFrame() const { return m_updateInFrame; }
+
+	//! @brief Returns the horizontal size of the LOS map
+	int GetXSize() const { return m_xLosMapSize; }
+
+	//! @brief Returns the vertical size of the LOS map
+	int GetYSize() const { return m_yLosMapSize; }
+
+	//! @brief Returns whether the given tile lies within the LOS map
+	bool IsValidTile(int x, int y) const { return (x >= 0) && (x < m_xLosMapSize) && (y >= 0) && (y < m_yLosMapSize); }
+
+	//! @brief Returns whether the given tile is currently within LOS (tile must be valid)
+	bool IsInLOS(int x, int y) const { return ( m_losTiles[y * m_wordsPerRow + x / bitsPerWord] >> (x % bitsPerWord) ) & 1u; }
+
+	//! @brief Determines the tiles that are within LOS in this snapshot but have not been in the given (older) snapshot
+	void DetermineTilesEnteringLOS(const AAILosMap& previousLosMap, std::vector<MapPos>& tilesEnteringLOS) const;
+
+private:
+	//! One bit per tile, set if tile is within LOS
+	std::vector<uint64_t> m_losTiles;
+
+	//! Horizontal size of the LOS map
+	int m_xLosMapSize;
+
+	//! Vertical size of the LOS map
+	int m_yLosMapSize;
+
+	//! Number of words needed to store one row of the LOS map
+	int m_wordsPerRow;
+
+	//! The frame of the last update
+	int m_updateInFrame;
+
+	//! Number of tiles stored per word
+	static constexpr int bitsPerWord = 64;
+};
+
+//! Last known data of an enemy unit within LOS or radar coverage (maintained based on the LOS/radar events of the engine)
+struct AAIEnemyUnit
+{
+	AAIEnemyUnit() : position(ZeroVector), sector(nullptr), inLOS(false), inRadar(false) {}
+
+	//! @brief Returns whether unit is only detected by radar/sonar (i.e. unit type is not known)
+	bool IsDetectedBySensorOnly() const { return inRadar && !inLOS; }
+
+	//! Unit type (only valid if unit has been within LOS)
+	UnitDefId  unitDefId;
+
+	//! Last known position
+	float3     position;
+
+	//! Sector of last known position (nullptr if outside of the map)
+	AAISector* sector;
+
+	//! Flag whether unit is currently within LOS
+	bool       inLOS;
+
+	//! Flag whether unit is currently within radar/sonar coverage
+	bool       inRadar;
+};
+
 //! This type is used to access a specific tile of a scout map
 class ScoutMapTile
 {
@@ -125,10 +438,16 @@ public:
 	int GetUnitAt(const ScoutMapTile& tile) const { return m_scoutedUnitsMap[tile.m_tileIndex]; }
 
 	//! @brief Adds unit to tile
-	void AddEnemyUnit(UnitDefId defId, ScoutMapTile tile) { m_scoutedUnitsMap[tile.m_tileIndex] = defId.id; }
+	void AddEnemyUnit(UnitDefId defId, ScoutMapTile tile, int frame)
+	{
+		m_scoutedUnitsMap[tile.m_tileIndex]      = defId.id;
+		m_lastUpdateInFrameMap[tile.m_tileIndex] = frame;
+		m_tilesWithSpottedUnits.push_back(tile.m_tileIndex);
+	}
 
-	//! @brief Erases the given tiles
-	void ResetTiles(int xLosMap, int yLosMap, int frame);
+	//! @brief Erases the tiles that entered LOS since the last update as well as tiles with units spotted during 
+	//!        the last update that are still within LOS (all other tiles within LOS are unchanged since the last update)
+	void ResetTilesInLOS(const AAILosMap& losMap);
 
 	//! @brief Return tile index to corresponding position (int unit coordinates)
 	ScoutMapTile GetScoutMapTile(const float3& position) const
@@ -146,6 +465,9 @@ public:
 	void UpdateSectorWithScoutedUnits(AAISector *sector, std::vector<int>& buildingsOnContinent, int currentFrame);
 
 private:
+	//! @brief Erases the tiles belonging to the given LOS map tile
+	void ResetTiles(int xLosMap, int yLosMap, int frame);
+
 	//! Horizontal size of the scouted units map
 	int m_xScoutMapSize;
 	
@@ -155,6 +477,9 @@ private:
 	//! Factor how much larger the resolution of the scout map is compared to the LOS map
 	int m_losToScoutMapResolution;
 
+	//! Lower resolution factor of the LOS map with respect to map resolution
+	int m_losMapResolution;
+
 	//! Lower resolution factor with respect to map resolution
 	static constexpr int scoutMapResolution = 2;
 
@@ -163,6 +488,81 @@ private:
 
 	//! The map storing the frame of the last update of each tile
 	std::vector<int> m_lastUpdateInFrameMap;
+
+	//! The LOS map at the time of the last update
+	AAILosMap        m_losMapOfLastUpdate;
+
+	//! Indices of the tiles to which spotted units have been added since the last update
+	std::vector<int> m_tilesWithSpottedUnits;
+
+	//! Buffer for the LOS map tiles that entered LOS since the last update
+	std::vector<MapPos> m_tilesEnteringLOS;
+};
+
+//! The metal yield map stores how much metal an extractor would yield at every tile of the metal map. It is used to 
+//! successively determine the best spots for metal extractors: tiles are retrieved from a max heap with lazy invalidation,
+//! metal within the radius of a taken spot is removed and the yield of the tiles within range is updated accordingly.
+class AAIMetalYieldMap
+{
+public:
+	//! @brief Calculates the yield of every tile (extractor radius in metal map tiles, split into bands of rows processed by the given thread pool); 
+	//!        only tiles with at least the given scaled yield are considered as spots
+	AAIMetalYieldMap(AAIThreadPool& threadPool, const unsigned char* metalMap, int xMetalMapSize, int yMetalMapSize, int extractorRadius, int squaredExtractorRadius, int minScaledYield);
+
+	//! @brief Returns the highest yield of any tile of the initial metal map
+	int GetMaxYield() const { return m_maxYield; }
+
+	//! @brief Determines the tile with the highest scaled yield (0-255, first tile in case of equal yield); returns false if no tile with sufficient yield is left
+	bool DetermineBestSpot(MapPos& spot, int& scaledYield);
+
+	//! @brief Removes all metal within extractor radius of the given spot and updates the yield of the affected tiles
+	void TakeSpot(const MapPos& spot);
+
+private:
+	//! @brief Returns the yield scaled to 0-255 with respect to the max yield
+	unsigned char ScaleYield(int yield) const { return static_cast<unsigned char>( (m_maxYield > 0) ? (yield * 255) / m_maxYield : yield * 255); }
+
+	//! Number of rows per band when calculation of yield is split up
+	static constexpr int rowsPerBand = 32;
+
+	//! Row of the (circular) extraction area, i.e. offsets [xMin, xMax] in row yOffset relative to the extractor position
+	struct ExtractionAreaRow
+	{
+		int yOffset, xMin, xMax;
+	};
+
+	//! Horizontal size of the metal map
+	int m_xMetalMapSize;
+
+	//! Vertical size of the metal map
+	int m_yMetalMapSize;
+
+	//! Radius of the extractor (in metal map tiles)
+	int m_extractorRadius;
+
+	//! Minimum scaled yield of a tile to be considered as spot
+	int m_minScaledYield;
+
+	//! Highest yield of the initial metal map
+	int m_maxYield;
+
+	//! Tiles of the extraction area (row by row)
+	std::vector<ExtractionAreaRow> m_extractionArea;
+
+	//! Amount of metal of every tile (metal within radius of taken spots is removed)
+	std::vector<unsigned char> m_metal;
+
+	//! Metal an extractor would yield at every tile
+	std::vector<int> m_yield;
+
+	//! Scaled yield of every tile (zero for tiles within the radius of taken spots)
+	std::vector<unsigned char> m_scaledYield;
+
+	//! Candidates for spots (scaled yield when entry has been added, negative tile index to prefer first tile in case of equal yield)
+	std::priority_queue< std::pair<int, int> > m_spotCandidates;
+
+	//! Buffer for the prefix sums of the metal removed from one row when a spot is taken
+	std::vector<int> m_removedMetal;
 };
 
 //! This class stores the continent map
@@ -172,11 +572,14 @@ public:
 	//! @brief Initializes all tiles as not belonging to any continent
 	void Init(int xMapSize, int yMapSize);
 
-	//! @brief Loads continent map from given file
-	void LoadFromFile(FILE* file);
+	//! @brief Run length encodes the continent map row by row (pairs of continent id and number of tiles, runs do not span multiple rows)
+	void EncodeRunLength(std::vector<int32_t>& runs) const;
+
+	//! @brief Decodes the given runs (as created by EncodeRunLength()) into the continent map; returns false if runs do not exactly cover the map
+	bool DecodeRunLength(const std::vector<int32_t>& runs);
 
-	//! @brief Stores continent map to given file
-	void SaveToFile(FILE* file);
+	//! @brief Stores continent map as text to given file (for debugging purposes)
+	void SaveToFile(FILE* file) const;
 
 	//! @brief Returns the id of continent the cell belongs to
 	int GetContinentID(const MapPos& mapPosition) const { return m_continentMap[(mapPosition.y/continentMapResolution) * m_xContMapSize + mapPosition.x / continentMapResolution]; }
@@ -187,15 +590,38 @@ public:
 	//! @brief Returns the number of tiles of the continent map
 	int GetSize() const { return m_xContMapSize * m_yContMapSize; }
 
-	//! @brief Determines the continents, i.e. which parts of the map are connected
-	void DetectContinents(std::vector<AAIContinent>& continents, const float *heightMap, const int xMapSize, const int yMapSize);
+	//! @brief Determines the continents, i.e. which parts of the map are connected (bands of rows processed by the given thread pool)
+	void DetectContinents(AAIThreadPool& threadPool, std::vector<AAIContinent>& continents, const float *heightMap, const int xMapSize, const int yMapSize);
 
 private:
-	//! @brief Helper function for detection of continents - checks if a given tile belongs to a continent and sets values accordingly
-	void CheckIfTileBelongsToLandContinent(int continentMapTileIndex, float tileHeight, std::vector<AAIContinent>& continents, int continentId, std::vector<int>* nextEdgeCells);
+	//! Type of a tile with respect to the detection of continents (in order of ascending height)
+	enum class EContinentTileType : uint8_t
+	{
+		DEEP_WATER    = 0, //!< Water too deep for non amphibious land units
+		SHALLOW_WATER = 1, //!< Water passable for non amphibious land units (connects land masses but does not belong to land continents)
+		LAND          = 2  //!< Tile above sea level
+	};
+
+	//! Horizontal run of connected tiles within a row of the continent map
+	struct TileRun
+	{
+		//! First tile of the run
+		int xStart;
 
-	//! @brief Helper function for detection of continents - checks if a given tile belongs to a sea continent and sets values accordingly
-	void CheckIfTileBelongsToSeaContinent(int continentMapTileIndex, float tileHeight, std::vector<AAIContinent>& continents, int continentId, std::vector<int>* nextEdgeCells);
+		//! Tile after the last tile of the run
+		int xEnd;
+
+		//! Number of tiles of the run that belong to a continent
+		int continentTiles;
+
+		//! First tile of the run that belongs to a continent (-1 if none)
+		int firstTileX;
+	};
+
+	//! @brief Detects groups of connected tiles of type [minType, maxType] via scanline labelling with union-find; every group containing tiles
+	//!        of at least minContinentType is added as continent (ids in order of their first tile when traversing the map column by column)
+	void DetectConnectedTiles(AAIThreadPool& threadPool, const std::vector<EContinentTileType>& tileTypes, EContinentTileType minType, EContinentTileType maxType, 
+	                          EContinentTileType minContinentType, bool water, std::vector<AAIContinent>& continents);
 
 	//! Id of continent a map tile belongs to
 	std::vector<int> m_continentMap;
@@ -208,6 +634,9 @@ private:
 
 	//! Lower resolution factor with respect to map resolution
 	static constexpr int continentMapResolution = 4;
+
+	//! Number of rows per band when detection of continents is split up
+	static constexpr int rowsPerBand = 32;
 };
 
 #endif
@@ -0,0 +1,310 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <mutex>
+
+#include "AAIProfiler.h"
+
+std::vector<const char*> AAIProfiler::s_sectionNames;
+
+//! Protects the section names (instances of AAI may run in different threads)
+static std::mutex s_sectionNamesMutex;
+
+//! Max number of calls recorded per frame (further calls are only added to the statistics)
+static const size_t s_maxCallsPerFrame = 4096;
+
+//! Max number of frames stored in the spike report (only the worst ones are kept)
+static const size_t s_maxSpikes = 20;
+
+//! Converts nanoseconds to microseconds
+static double ToMicroseconds(uint64_t time) { return static_cast<double>(time) * 0.001; }
+
+void AAIProfiler::SectionStatistics::AddTime(uint64_t time)
+{
+	++calls;
+	totalTime += time;
+	maxTime    = std::max(maxTime, time);
+	lastTime   = time;
+	++histogram[GetBucket(time)];
+}
+
+uint64_t AAIProfiler::SectionStatistics::GetPercentile(float percentile) const
+{
+	if(calls == 0u)
+		return 0u;
+
+	const uint64_t targetCount = std::max(static_cast<uint64_t>(percentile * static_cast<float>(calls) + 0.5f), static_cast<uint64_t>(1u));
+
+	uint64_t count(0u);
+	for(int bucket = 0; bucket < numberOfBuckets; ++bucket)
+	{
+		count += histogram[bucket];
+
+		if(count >= targetCount)
+			return std::min(GetBucketUpperBound(bucket), maxTime);
+	}
+
+	return maxTime;
+}
+
+AAIProfiler::AAIProfiler() :
+	m_currentFrame(0),
+	m_currentFrameTime(0u),
+	m_callsTruncated(false),
+	m_spikeThreshold(0u)
+{
+	m_calls.reserve(1024);
+	m_activeSections.reserve(16);
+}
+
+int AAIProfiler::GetSectionId(const char* name)
+{
+	std::lock_guard<std::mutex> lock(s_sectionNamesMutex);
+
+	for(size_t id = 0; id < s_sectionNames.size(); ++id)
+	{
+		if(strcmp(s_sectionNames[id], name) == 0)
+			return static_cast<int>(id);
+	}
+
+	s_sectionNames.push_back(name);
+	return static_cast<int>(s_sectionNames.size()) - 1;
+}
+
+int AAIProfiler::GetBucket(uint64_t time)
+{
+	if(time < 4u)
+		return static_cast<int>(time);
+
+	// determine most significant bit
+	int      msb(0);
+	uint64_t value(time);
+	for(int shift = 32; shift > 0; shift /= 2)
+	{
+		if(value >= (static_cast<uint64_t>(1u) << shift))
+		{
+			value >>= shift;
+			msb    += shift;
+		}
+	}
+
+	// 4 buckets per power of two determined by the two bits following the most significant one
+	const int subBucket = static_cast<int>((time >> (msb - 2)) & 3u);
+	return 4 * (msb - 1) + subBucket;
+}
+
+uint64_t AAIProfiler::GetBucketUpperBound(int bucket)
+{
+	if(bucket < 4)
+		return static_cast<uint64_t>(bucket + 1);
+
+	const int msb       = bucket / 4 + 1;
+	const int subBucket = bucket % 4;
+
+	if(msb >= 62)
+		return std::numeric_limits<uint64_t>::max();
+
+	return static_cast<uint64_t>(4 + subBucket + 1) << (msb - 2);
+}
+
+void AAIProfiler::BeginFrame(int frame)
+{
+	if(frame != m_currentFrame)
+	{
+		FinishFrame();
+		m_currentFrame = frame;
+	}
+}
+
+float AAIProfiler::GetLastTime(int sectionId) const
+{
+	if( (sectionId < 0) || (sectionId >= static_cast<int>(m_sections.size())) )
+		return 0.0f;
+
+	return static_cast<float>( ToMicroseconds(m_sections[sectionId].lastTime) );
+}
+
+void AAIProfiler::EnterSection(int sectionId)
+{
+	if(sectionId >= static_cast<int>(m_sections.size()))
+		m_sections.resize(sectionId + 1);
+
+	const Clock::time_point now = Clock::now();
+
+	if( m_calls.empty() && m_activeSections.empty() )
+		m_frameStart = now;
+
+	int callIndex(-1);
+
+	if(m_calls.size() < s_maxCallsPerFrame)
+	{
+		const uint64_t start = static_cast<uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_frameStart).count() );
+		m_calls.push_back(SectionCall(sectionId, static_cast<int>(m_activeSections.size()), start));
+		callIndex = static_cast<int>(m_calls.size()) - 1;
+	}
+	else
+		m_callsTruncated = true;
+
+	m_activeSections.push_back(ActiveSection(sectionId, callIndex, now));
+}
+
+void AAIProfiler::LeaveSection()
+{
+	const ActiveSection& section = m_activeSections.back();
+	const uint64_t time = static_cast<uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - section.start).count() );
+
+	m_sections[section.sectionId].AddTime(time);
+
+	if(section.callIndex >= 0)
+		m_calls[section.callIndex].time = time;
+
+	m_activeSections.pop_back();
+
+	if(m_activeSections.empty())
+		m_currentFrameTime += time;
+}
+
+void AAIProfiler::FinishFrame()
+{
+	if(m_calls.empty() && (m_callsTruncated == false))
+		return;
+
+	m_frameStatistics.AddTime(m_currentFrameTime);
+
+	if( (m_spikeThreshold > 0u) && (m_currentFrameTime > m_spikeThreshold) )
+	{
+		// replace spike with lowest time if max number of spikes has been reached
+		Spike* spike(nullptr);
+
+		if(m_spikes.size() < s_maxSpikes)
+		{
+			m_spikes.push_back(Spike());
+			spike = &m_spikes.back();
+		}
+		else
+		{
+			auto lowestSpike = std::min_element(m_spikes.begin(), m_spikes.end(), [](const Spike& lhs, const Spike& rhs) { return lhs.time < rhs.time; });
+
+			if(lowestSpike->time < m_currentFrameTime)
+				spike = &(*lowestSpike);
+		}
+
+		if(spike)
+		{
+			spike->frame     = m_currentFrame;
+			spike->time      = m_currentFrameTime;
+			spike->truncated = m_callsTruncated;
+			spike->calls     = m_calls;
+		}
+	}
+
+	m_calls.clear();
+	m_currentFrameTime = 0u;
+	m_callsTruncated   = false;
+}
+
+bool AAIProfiler::ExportCSV(const char* filename)
+{
+	FinishFrame();
+
+	FILE* file = fopen(filename, "w");
+
+	if(file == nullptr)
+		return false;
+
+	fprintf(file, "section,calls,total_ms,mean_us,p50_us,p95_us,p99_us,max_us\n");
+
+	std::lock_guard<std::mutex> lock(s_sectionNamesMutex);
+
+	for(size_t id = 0; id <= m_sections.size(); ++id)
+	{
+		// time per frame is written first
+		const SectionStatistics& statistics = (id == 0) ? m_frameStatistics : m_sections[id-1];
+		const char*              name       = (id == 0) ? "Frame"            : s_sectionNames[id-1];
+
+		if(statistics.calls == 0u)
+			continue;
+
+		fprintf(file, "%s,%llu,%.3f,%.1f,%.1f,%.1f,%.1f,%.1f\n", name, static_cast<unsigned long long>(statistics.calls),
+					ToMicroseconds(statistics.totalTime) * 0.001, ToMicroseconds(statistics.totalTime) / static_cast<double>(statistics.calls),
+					ToMicroseconds(statistics.GetPercentile(0.5f)), ToMicroseconds(statistics.GetPercentile(0.95f)),
+					ToMicroseconds(statistics.GetPercentile(0.99f)), ToMicroseconds(statistics.maxTime));
+	}
+
+	fclose(file);
+	return true;
+}
+
+bool AAIProfiler::ExportJSON(const char* filename)
+{
+	FinishFrame();
+
+	FILE* file = fopen(filename, "w");
+
+	if(file == nullptr)
+		return false;
+
+	std::lock_guard<std::mutex> lock(s_sectionNamesMutex);
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// statistics per section (time per frame first)
+	//-----------------------------------------------------------------------------------------------------------------
+	fprintf(file, "{\n\t\"spike_threshold_us\": %.1f,\n\t\"sections\": [", ToMicroseconds(m_spikeThreshold));
+
+	bool firstEntry(true);
+	for(size_t id = 0; id <= m_sections.size(); ++id)
+	{
+		const SectionStatistics& statistics = (id == 0) ? m_frameStatistics : m_sections[id-1];
+		const char*              name       = (id == 0) ? "Frame"            : s_sectionNames[id-1];
+
+		if(statistics.calls == 0u)
+			continue;
+
+		fprintf(file, "%s\n\t\t{\"name\": \"%s\", \"calls\": %llu, \"total_ms\": %.3f, \"p50_us\": %.1f, \"p95_us\": %.1f, \"p99_us\": %.1f, \"max_us\": %.1f}",
+					firstEntry ? "" : ",", name, static_cast<unsigned long long>(statistics.calls), ToMicroseconds(statistics.totalTime) * 0.001,
+					ToMicroseconds(statistics.GetPercentile(0.5f)), ToMicroseconds(statistics.GetPercentile(0.95f)),
+					ToMicroseconds(statistics.GetPercentile(0.99f)), ToMicroseconds(statistics.maxTime));
+		firstEntry = false;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// spike report (worst frame first), calls in order of their start (i.e. call tree given by depth)
+	//-----------------------------------------------------------------------------------------------------------------
+	std::vector<const Spike*> spikes;
+	for(const auto& spike : m_spikes)
+		spikes.push_back(&spike);
+
+	std::sort(spikes.begin(), spikes.end(), [](const Spike* lhs, const Spike* rhs) { return lhs->time > rhs->time; });
+
+	fprintf(file, "\n\t],\n\t\"spikes\": [");
+
+	for(size_t i = 0; i < spikes.size(); ++i)
+	{
+		fprintf(file, "%s\n\t\t{\"frame\": %i, \"time_us\": %.1f, \"truncated\": %s, \"calls\": [", (i == 0) ? "" : ",",
+					spikes[i]->frame, ToMicroseconds(spikes[i]->time), spikes[i]->truncated ? "true" : "false");
+
+		for(size_t c = 0; c < spikes[i]->calls.size(); ++c)
+		{
+			const SectionCall& call = spikes[i]->calls[c];
+			fprintf(file, "%s\n\t\t\t{\"section\": \"%s\", \"depth\": %i, \"start_us\": %.1f, \"time_us\": %.1f}", (c == 0) ? "" : ",",
+						s_sectionNames[call.sectionId], call.depth, ToMicroseconds(call.start), ToMicroseconds(call.time));
+		}
+
+		fprintf(file, "\n\t\t]}");
+	}
+
+	fprintf(file, "\n\t]\n}\n");
+
+	fclose(file);
+	return true;
+}
@@ -0,0 +1,170 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_PROFILER_H
+#define AAI_PROFILER_H
+
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <chrono>
+
+//! @brief Measures the time spent in the sections marked via AAI_SCOPED_TIMER (event handlers and periodic tasks) of one AAI instance.
+//!        For every section a histogram of the execution times (log scale buckets with max. 25% relative error) is maintained to
+//!        determine percentiles. Furthermore, the calls within a frame (i.e. between two calls of AAI::Update()) are recorded;
+//!        if the time spent in a frame exceeds the spike threshold, the call tree of that frame is kept for the spike report.
+//!        Statistics are exported to a CSV (per section) and a JSON (sections and spikes) file at the end of the game.
+class AAIProfiler
+{
+public:
+	//! Measures the time from construction to destruction and adds it to the statistics of the given section
+	class ScopedSection
+	{
+	public:
+		ScopedSection(AAIProfiler* profiler, int sectionId) : m_profiler(profiler) { if(m_profiler) m_profiler->EnterSection(sectionId); }
+
+		~ScopedSection() { if(m_profiler) m_profiler->LeaveSection(); }
+
+	private:
+		AAIProfiler* m_profiler;
+	};
+
+	AAIProfiler();
+
+	//! @brief Frames exceeding the given threshold (in microseconds, 0 to deactivate) will be stored in the spike report
+	void SetSpikeThreshold(int spikeThreshold) { m_spikeThreshold = static_cast<uint64_t>(spikeThreshold > 0 ? spikeThreshold : 0) * 1000u; }
+
+	//! @brief Returns the id of the section with the given name (shared by all AAI instances, call once per call site)
+	static int GetSectionId(const char* name);
+
+	//! @brief Marks the begin of the given frame (checks previous frame for spike)
+	void BeginFrame(int frame);
+
+	//! @brief Returns the execution time of the last call of the given section in microseconds (0 if section has not been called yet)
+	float GetLastTime(int sectionId) const;
+
+	//! @brief Writes the statistics of all sections to the given CSV file; returns false if file could not be opened
+	bool ExportCSV(const char* filename);
+
+	//! @brief Writes the statistics of all sections and the spike report to the given JSON file; returns false if file could not be opened
+	bool ExportJSON(const char* filename);
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	//! Number of buckets of the histograms (4 buckets per power of two of the time in nanoseconds)
+	static const int numberOfBuckets = 256;
+
+	//! Execution time statistics of one section
+	struct SectionStatistics
+	{
+		SectionStatistics() : calls(0u), totalTime(0u), maxTime(0u), lastTime(0u) { histogram.fill(0u); }
+
+		void AddTime(uint64_t time);
+
+		//! @brief Returns the given percentile (0 - 1) of the execution time in nanoseconds (upper bound of corresponding bucket)
+		uint64_t GetPercentile(float percentile) const;
+
+		uint64_t calls;
+
+		//! Total, max, and last execution time in nanoseconds
+		uint64_t totalTime, maxTime, lastTime;
+
+		std::array<uint32_t, numberOfBuckets> histogram;
+	};
+
+	//! A call of a section within the current frame
+	struct SectionCall
+	{
+		SectionCall(int sectionId, int depth, uint64_t start) : sectionId(sectionId), depth(depth), start(start), time(0u) {}
+
+		int      sectionId;
+
+		//! Nesting level (0 for sections called directly by the engine)
+		int      depth;
+
+		//! Start (relative to the first call in the frame) and execution time in nanoseconds
+		uint64_t start, time;
+	};
+
+	//! A frame exceeding the spike threshold
+	struct Spike
+	{
+		int                      frame;
+
+		//! Total time of all sections with depth 0 in nanoseconds
+		uint64_t                 time;
+
+		//! True if not all calls of the frame could be recorded
+		bool                     truncated;
+
+		std::vector<SectionCall> calls;
+	};
+
+	//! A section that is currently measured
+	struct ActiveSection
+	{
+		ActiveSection(int sectionId, int callIndex, Clock::time_point start) : sectionId(sectionId), callIndex(callIndex), start(start) {}
+
+		int               sectionId;
+
+		//! Index of the call in the current frame (-1 if not recorded)
+		int               callIndex;
+
+		Clock::time_point start;
+	};
+
+	//! @brief Returns the index of the bucket for the given time in nanoseconds
+	static int GetBucket(uint64_t time);
+
+	//! @brief Returns the (exclusive) upper bound of the given bucket in nanoseconds
+	static uint64_t GetBucketUpperBound(int bucket);
+
+	//! @brief Starts measuring the given section
+	void EnterSection(int sectionId);
+
+	//! @brief Stops measuring the innermost active section
+	void LeaveSection();
+
+	//! @brief Adds the time of the current frame to the statistics and stores it in the spike report if threshold is exceeded
+	void FinishFrame();
+
+	//! Names of all sections (index = section id)
+	static std::vector<const char*> s_sectionNames;
+
+	//! Statistics of the sections (index = section id)
+	std::vector<SectionStatistics> m_sections;
+
+	//! Statistics of the time per frame (sum of all sections with depth 0)
+	SectionStatistics              m_frameStatistics;
+
+	//! Calls in the current frame
+	std::vector<SectionCall>       m_calls;
+
+	//! Sections that are currently measured (innermost section at the back)
+	std::vector<ActiveSection>     m_activeSections;
+
+	//! Time of the first call in the current frame
+	Clock::time_point              m_frameStart;
+
+	//! Current frame and time of all sections with depth 0 in current frame (in nanoseconds)
+	int                            m_currentFrame;
+	uint64_t                       m_currentFrameTime;
+
+	//! True if not all calls of the current frame could be recorded
+	bool                           m_callsTruncated;
+
+	//! Frames exceeding this time (in nanoseconds) are stored in the spike report (0 if deactivated)
+	uint64_t                       m_spikeThreshold;
+
+	//! The worst frames exceeding the spike threshold
+	std::vector<Spike>             m_spikes;
+};
+
+#endif
@@ -0,0 +1,67 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_RANDOM_H
+#define AAI_RANDOM_H
+
+#include <cstdint>
+
+//! @brief Pseudo random number generator (xoshiro128**) used by one AAI instance. In contrast to rand(), the state is not shared with
+//!        other AI instances (or other code) in the same process, i.e. the sequence of random numbers only depends on the seed.
+class AAIRandom
+{
+public:
+	AAIRandom() { Seed(0u); }
+
+	//! @brief Initializes the state from the given seed (expanded via splitmix64)
+	void Seed(uint64_t seed)
+	{
+		for(int i = 0; i < 4; ++i)
+		{
+			seed += 0x9E3779B97F4A7C15ull;
+			uint64_t z = seed;
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			m_state[i] = static_cast<uint32_t>((z ^ (z >> 31)) >> 32);
+		}
+	}
+
+	//! @brief Returns the next random number (uniformly distributed over all 32 bit values)
+	uint32_t Next()
+	{
+		const uint32_t result = RotateLeft(m_state[1] * 5u, 7) * 9u;
+		const uint32_t t      = m_state[1] << 9;
+
+		m_state[2] ^= m_state[0];
+		m_state[3] ^= m_state[1];
+		m_state[1] ^= m_state[2];
+		m_state[0] ^= m_state[3];
+		m_state[2] ^= t;
+		m_state[3]  = RotateLeft(m_state[3], 11);
+
+		return result;
+	}
+
+	//! @brief Returns a random number in the interval [0, range) (0 if range is not positive); replacement for rand()%range
+	int NextInt(int range)
+	{
+		if(range <= 0)
+			return 0;
+
+		return static_cast<int>( (static_cast<uint64_t>(Next()) * static_cast<uint64_t>(range)) >> 32 );
+	}
+
+private:
+	static uint32_t RotateLeft(uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+
+	//! The state of the generator
+	uint32_t m_state[4];
+};
+
+#endif
@@ -0,0 +1,166 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include "AAIRecordingCallback.h"
+#include "AAIEventRecorder.h"
+
+#include "LegacyCpp/UnitDef.h"
+#include "LegacyCpp/CommandQueue.h"
+#include "Sim/Units/CommandAI/Command.h"
+
+AAIRecordingCallback::AAIRecordingCallback(springLegacyAI::IAICallback* aiCallback, int skirmishAIId, const struct SSkirmishAICallback* skirmishAICallbacks, AAIEventRecorder* eventRecorder) :
+	springLegacyAI::CAIAICallback(skirmishAIId, skirmishAICallbacks),
+	m_aiCallback(aiCallback),
+	m_eventRecorder(eventRecorder)
+{
+}
+
+int AAIRecordingCallback::GetCurrentFrame()
+{
+	const int frame = m_aiCallback->GetCurrentFrame();
+	m_eventRecorder->RecordResponse(ERecordedEvent::CURRENT_FRAME, {frame});
+	return frame;
+}
+
+float3 AAIRecordingCallback::GetUnitPos(int unitId)
+{
+	const float3 position = m_aiCallback->GetUnitPos(unitId);
+	m_eventRecorder->RecordResponse(ERecordedEvent::UNIT_POS, {unitId, position.x, position.y, position.z});
+	return position;
+}
+
+const springLegacyAI::UnitDef* AAIRecordingCallback::GetUnitDef(int unitId)
+{
+	const springLegacyAI::UnitDef* unitDef = m_aiCallback->GetUnitDef(unitId);
+	m_eventRecorder->RecordResponse(ERecordedEvent::UNIT_DEF, {unitId, unitDef ? unitDef->id : 0});
+	return unitDef;
+}
+
+float AAIRecordingCallback::GetUnitHealth(int unitId)
+{
+	const float health = m_aiCallback->GetUnitHealth(unitId);
+	m_eventRecorder->RecordResponse(ERecordedEvent::UNIT_HEALTH, {unitId, health});
+	return health;
+}
+
+int AAIRecordingCallback::GetUnitTeam(int unitId)
+{
+	const int team = m_aiCallback->GetUnitTeam(unitId);
+	m_eventRecorder->RecordResponse(ERecordedEvent::UNIT_TEAM, {unitId, team});
+	return team;
+}
+
+int AAIRecordingCallback::GetUnitAllyTeam(int unitId)
+{
+	const int allyTeam = m_aiCallback->GetUnitAllyTeam(unitId);
+	m_eventRecorder->RecordResponse(ERecordedEvent::UNIT_ALLY_TEAM, {unitId, allyTeam});
+	return allyTeam;
+}
+
+bool AAIRecordingCallback::UnitBeingBuilt(int unitId)
+{
+	const bool beingBuilt = m_aiCallback->UnitBeingBuilt(unitId);
+	m_eventRecorder->RecordResponse(ERecordedEvent::UNIT_BEING_BUILT, {unitId, beingBuilt});
+	return beingBuilt;
+}
+
+const springLegacyAI::CCommandQueue* AAIRecordingCallback::GetCurrentUnitCommands(int unitId)
+{
+	// AAI only checks whether units are busy -> number of commands is sufficient
+	const springLegacyAI::CCommandQueue* commands = m_aiCallback->GetCurrentUnitCommands(unitId);
+	m_eventRecorder->RecordResponse(ERecordedEvent::UNIT_COMMANDS, {unitId, commands ? static_cast<int32_t>(commands->size()) : 0});
+	return commands;
+}
+
+int AAIRecordingCallback::GetEnemyUnits(int* unitIds, int unitIds_max)
+{
+	const int numberOfUnits = m_aiCallback->GetEnemyUnits(unitIds, unitIds_max);
+	m_eventRecorder->RecordUnitList(ERecordedEvent::ENEMY_UNITS, unitIds, numberOfUnits);
+	return numberOfUnits;
+}
+
+int AAIRecordingCallback::GetEnemyUnits(int* unitIds, const float3& pos, float radius, int unitIds_max)
+{
+	const int numberOfUnits = m_aiCallback->GetEnemyUnits(unitIds, pos, radius, unitIds_max);
+	m_eventRecorder->RecordUnitList(ERecordedEvent::ENEMY_UNITS_IN_AREA, unitIds, numberOfUnits, {pos.x, pos.y, pos.z, radius});
+	return numberOfUnits;
+}
+
+int AAIRecordingCallback::GetEnemyUnitsInRadarAndLos(int* unitIds, int unitIds_max)
+{
+	const int numberOfUnits = m_aiCallback->GetEnemyUnitsInRadarAndLos(unitIds, unitIds_max);
+	m_eventRecorder->RecordUnitList(ERecordedEvent::ENEMY_UNITS_IN_RADAR_AND_LOS, unitIds, numberOfUnits);
+	return numberOfUnits;
+}
+
+int AAIRecordingCallback::GetFriendlyUnits(int* unitIds, int unitIds_max)
+{
+	const int numberOfUnits = m_aiCallback->GetFriendlyUnits(unitIds, unitIds_max);
+	m_eventRecorder->RecordUnitList(ERecordedEvent::FRIENDLY_UNITS, unitIds, numberOfUnits);
+	return numberOfUnits;
+}
+
+bool AAIRecordingCallback::CanBuildAt(const springLegacyAI::UnitDef* unitDef, float3 pos, int facing)
+{
+	const bool possible = m_aiCallback->CanBuildAt(unitDef, pos, facing);
+	m_eventRecorder->RecordResponse(ERecordedEvent::CAN_BUILD_AT, {unitDef ? unitDef->id : 0, pos.x, pos.y, pos.z, facing, possible});
+	return possible;
+}
+
+float3 AAIRecordingCallback::ClosestBuildSite(const springLegacyAI::UnitDef* unitDef, float3 pos, float searchRadius, int minDist, int facing)
+{
+	const float3 buildsite = m_aiCallback->ClosestBuildSite(unitDef, pos, searchRadius, minDist, facing);
+	m_eventRecorder->RecordResponse(ERecordedEvent::CLOSEST_BUILD_SITE, {unitDef ? unitDef->id : 0, pos.x, pos.y, pos.z, searchRadius, minDist, facing,
+	                                                                     buildsite.x, buildsite.y, buildsite.z});
+	return buildsite;
+}
+
+float AAIRecordingCallback::GetElevation(float x, float z)
+{
+	const float elevation = m_aiCallback->GetElevation(x, z);
+	m_eventRecorder->RecordResponse(ERecordedEvent::ELEVATION, {x, z, elevation});
+	return elevation;
+}
+
+int AAIRecordingCallback::GetTeamAllyTeam(int team)
+{
+	const int allyTeam = m_aiCallback->GetTeamAllyTeam(team);
+	m_eventRecorder->RecordResponse(ERecordedEvent::TEAM_ALLY_TEAM, {team, allyTeam});
+	return allyTeam;
+}
+
+bool AAIRecordingCallback::IsAllied(int firstAllyTeamId, int secondAllyTeamId)
+{
+	const bool allied = m_aiCallback->IsAllied(firstAllyTeamId, secondAllyTeamId);
+	m_eventRecorder->RecordResponse(ERecordedEvent::IS_ALLIED, {firstAllyTeamId, secondAllyTeamId, allied});
+	return allied;
+}
+
+//! @brief Records the given amount of the given resource and returns it
+static float RecordResource(AAIEventRecorder* eventRecorder, ERecordedResource resource, float value)
+{
+	eventRecorder->RecordResponse(ERecordedEvent::RESOURCE, {static_cast<int32_t>(resource), value});
+	return value;
+}
+
+float AAIRecordingCallback::GetMetal()         { return RecordResource(m_eventRecorder, ERecordedResource::METAL,          m_aiCallback->GetMetal()); }
+float AAIRecordingCallback::GetMetalIncome()   { return RecordResource(m_eventRecorder, ERecordedResource::METAL_INCOME,   m_aiCallback->GetMetalIncome()); }
+float AAIRecordingCallback::GetMetalUsage()    { return RecordResource(m_eventRecorder, ERecordedResource::METAL_USAGE,    m_aiCallback->GetMetalUsage()); }
+float AAIRecordingCallback::GetMetalStorage()  { return RecordResource(m_eventRecorder, ERecordedResource::METAL_STORAGE,  m_aiCallback->GetMetalStorage()); }
+float AAIRecordingCallback::GetEnergy()        { return RecordResource(m_eventRecorder, ERecordedResource::ENERGY,         m_aiCallback->GetEnergy()); }
+float AAIRecordingCallback::GetEnergyIncome()  { return RecordResource(m_eventRecorder, ERecordedResource::ENERGY_INCOME,  m_aiCallback->GetEnergyIncome()); }
+float AAIRecordingCallback::GetEnergyUsage()   { return RecordResource(m_eventRecorder, ERecordedResource::ENERGY_USAGE,   m_aiCallback->GetEnergyUsage()); }
+float AAIRecordingCallback::GetEnergyStorage() { return RecordResource(m_eventRecorder, ERecordedResource::ENERGY_STORAGE, m_aiCallback->GetEnergyStorage()); }
+
+int AAIRecordingCallback::GiveOrder(int unitId, Command* c)
+{
+	const int result = m_aiCallback->GiveOrder(unitId, c);
+	m_eventRecorder->RecordResponse(ERecordedEvent::GIVE_ORDER, {unitId, c->GetID(), result});
+	return result;
+}
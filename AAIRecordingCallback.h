@@ -0,0 +1,105 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_RECORDINGCALLBACK_H
+#define AAI_RECORDINGCALLBACK_H
+
+#include "LegacyCpp/AIAICallback.h"
+
+class AAIEventRecorder;
+
+//! @brief Decorator of the AI callback that passes all queries of AAI to the engine and records the responses that depend on the
+//!        state of the game (units, resources, build sites, ...) via the event recorder. Static data (map, mod, unit definitions)
+//!        is stored once in the header of the recording and is not recorded per query. Used instead of the callback of the engine
+//!        while events are recorded (i.e. AAI itself is not aware of the recording).
+class AAIRecordingCallback : public springLegacyAI::CAIAICallback
+{
+public:
+	AAIRecordingCallback(springLegacyAI::IAICallback* aiCallback, int skirmishAIId, const struct SSkirmishAICallback* skirmishAICallbacks, AAIEventRecorder* eventRecorder);
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// recorded responses
+	//-----------------------------------------------------------------------------------------------------------------
+	int GetCurrentFrame() override;
+
+	float3 GetUnitPos(int unitId) override;
+	const springLegacyAI::UnitDef* GetUnitDef(int unitId) override;
+	float  GetUnitHealth(int unitId) override;
+	int    GetUnitTeam(int unitId) override;
+	int    GetUnitAllyTeam(int unitId) override;
+	bool   UnitBeingBuilt(int unitId) override;
+	const springLegacyAI::CCommandQueue* GetCurrentUnitCommands(int unitId) override;
+
+	int GetEnemyUnits(int* unitIds, int unitIds_max = -1) override;
+	int GetEnemyUnits(int* unitIds, const float3& pos, float radius, int unitIds_max = -1) override;
+	int GetEnemyUnitsInRadarAndLos(int* unitIds, int unitIds_max = -1) override;
+	int GetFriendlyUnits(int* unitIds, int unitIds_max = -1) override;
+
+	bool   CanBuildAt(const springLegacyAI::UnitDef* unitDef, float3 pos, int facing = 0) override;
+	float3 ClosestBuildSite(const springLegacyAI::UnitDef* unitDef, float3 pos, float searchRadius, int minDist, int facing = 0) override;
+	float  GetElevation(float x, float z) override;
+
+	int  GetTeamAllyTeam(int team) override;
+	bool IsAllied(int firstAllyTeamId, int secondAllyTeamId) override;
+
+	float GetMetal() override;
+	float GetMetalIncome() override;
+	float GetMetalUsage() override;
+	float GetMetalStorage() override;
+	float GetEnergy() override;
+	float GetEnergyIncome() override;
+	float GetEnergyUsage() override;
+	float GetEnergyStorage() override;
+
+	int GiveOrder(int unitId, Command* c) override;
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// static data (stored in the header of the recording) and calls without response
+	//-----------------------------------------------------------------------------------------------------------------
+	int GetMyTeam() override     { return m_aiCallback->GetMyTeam(); }
+	int GetMyAllyTeam() override { return m_aiCallback->GetMyAllyTeam(); }
+	int GetMaxUnits() override   { return m_aiCallback->GetMaxUnits(); }
+
+	const char* GetModName() override      { return m_aiCallback->GetModName(); }
+	const char* GetModHumanName() override { return m_aiCallback->GetModHumanName(); }
+	const char* GetModShortName() override { return m_aiCallback->GetModShortName(); }
+	int         GetModHash() override      { return m_aiCallback->GetModHash(); }
+
+	const char* GetMapName() override   { return m_aiCallback->GetMapName(); }
+	int         GetMapHash() override   { return m_aiCallback->GetMapHash(); }
+	int         GetMapWidth() override  { return m_aiCallback->GetMapWidth(); }
+	int         GetMapHeight() override { return m_aiCallback->GetMapHeight(); }
+
+	const float*         GetHeightMap() override { return m_aiCallback->GetHeightMap(); }
+	const unsigned char* GetMetalMap() override  { return m_aiCallback->GetMetalMap(); }
+	int GetLosMapResolution() override           { return m_aiCallback->GetLosMapResolution(); }
+
+	float GetMaxMetal() const override        { return m_aiCallback->GetMaxMetal(); }
+	float GetExtractorRadius() const override { return m_aiCallback->GetExtractorRadius(); }
+	float GetMinWind() const override         { return m_aiCallback->GetMinWind(); }
+	float GetMaxWind() const override         { return m_aiCallback->GetMaxWind(); }
+	float GetTidalStrength() const override   { return m_aiCallback->GetTidalStrength(); }
+
+	// unit definitions must be the ones of the callback of the engine (AAI keeps pointers to them)
+	int  GetNumUnitDefs() override                                           { return m_aiCallback->GetNumUnitDefs(); }
+	void GetUnitDefList(const springLegacyAI::UnitDef** list) override       { m_aiCallback->GetUnitDefList(list); }
+	const springLegacyAI::UnitDef* GetUnitDef(const char* unitName) override { return m_aiCallback->GetUnitDef(unitName); }
+
+	bool GetValue(int valueId, void* data) override       { return m_aiCallback->GetValue(valueId, data); }
+	void SendTextMsg(const char* text, int zone) override { m_aiCallback->SendTextMsg(text, zone); }
+
+private:
+	//! The callback of the engine all queries are passed to
+	springLegacyAI::IAICallback* m_aiCallback;
+
+	//! Records the responses of the engine
+	AAIEventRecorder*            m_eventRecorder;
+};
+
+#endif
@@ -14,6 +14,7 @@
 #include "AAIConfig.h"
 #include "AAIMap.h"
 #include "AAIThreatMap.h"
+#include "AAILogger.h"
 
 #include "LegacyCpp/IGlobalAICallback.h"
 #include "LegacyCpp/UnitDef.h"
@@ -54,7 +55,7 @@ void AAISector::Init(AAI *ai, int x, int y)
 	const float3 center = GetCenter();
 	m_continentId = AAIMap::GetContinentID(center);
 
-	importance_this_game = 1.0f + (rand()%5)/20.0f;
+	importance_this_game = 1.0f + (ai->Random().NextInt(5))/20.0f;
 }
 
 void AAISector::LoadDataFromFile(FILE* file)
@@ -64,13 +65,13 @@ void AAISector::LoadDataFromFile(FILE* file)
 		fscanf(file, "%f %f %f", &m_flatTilesRatio, &m_waterTilesRatio, &importance_learned);
 			
 		if(importance_learned < 1.0f)
-			importance_learned += (rand()%5)/20.0f;
+			importance_learned += (ai->Random().NextInt(5))/20.0f;
 
 		m_attacksByTargetTypeInPreviousGames.LoadFromFile(file);
 	}
 	else // no learning data available -> init with default data
 	{
-		importance_learned = 1.0f + (rand()%5)/20.0f;
+		importance_learned = 1.0f + (ai->Random().NextInt(5))/20.0f;
 		m_flatTilesRatio  = DetermineFlatRatio();
 		m_waterTilesRatio = DetermineWaterRatio();
 	}
@@ -104,7 +105,7 @@ bool AAISector::AddToBase(bool addToBase)
 		// check if already occupied (may happen if two coms start in same sector)
 		if(AAIMap::s_teamSectorMap.IsSectorOccupied(m_sectorIndex))
 		{
-			ai->Log("\nTeam %i could not add sector %i,%i to base, already occupied by ally team %i!\n\n",ai->GetAICallback()->GetMyAllyTeam(), m_sectorIndex.x, m_sectorIndex.y, AAIMap::s_teamSectorMap.GetTeam(m_sectorIndex));
+			ai->Log(ELogLevel::WARNING, ELogCategory::MAP, "Team %i could not add sector %i,%i to base, already occupied by ally team %i!\n",ai->GetAICallback()->GetMyAllyTeam(), m_sectorIndex.x, m_sectorIndex.y, AAIMap::s_teamSectorMap.GetTeam(m_sectorIndex));
 			return false;
 		}
 
@@ -544,16 +545,8 @@ float AAISector::GetEnemyCombatPowerVsUnits(const MobileTargetTypeValues& unitsO
 
 float AAISector::DetermineWaterRatio() const
 {
-	int waterCells(0);
-
-	for(int yPos = m_sectorIndex.y * AAIMap::ySectorSizeMap; yPos < (m_sectorIndex.y+1) * AAIMap::ySectorSizeMap; ++yPos)
-	{
-		for(int xPos = m_sectorIndex.x * AAIMap::xSectorSizeMap; xPos < (m_sectorIndex.x+1) * AAIMap::xSectorSizeMap; ++xPos)
-		{
-			if(AAIMap::s_buildmap[xPos + yPos * AAIMap::xMapSize].IsTileTypeSet(EBuildMapTileType::WATER))
-				++waterCells;
-		}
-	}
+	const int waterCells = AAIMap::s_buildmap.CountTiles(EBuildMapTileType::WATER, m_sectorIndex.x * AAIMap::xSectorSizeMap,     m_sectorIndex.y * AAIMap::ySectorSizeMap,
+	                                                                                (m_sectorIndex.x+1) * AAIMap::xSectorSizeMap, (m_sectorIndex.y+1) * AAIMap::ySectorSizeMap);
 
 	const int totalCells = AAIMap::xSectorSizeMap * AAIMap::ySectorSizeMap;
 
@@ -639,8 +632,8 @@ float3 AAISector::DetermineUnitMovePos(AAIMovementType moveType, int continentId
 	for(int i = 0; i < 6; ++i)
 	{
 		float3 position;
-		position.x = xPosStart + static_cast<float>(AAIMap::xSectorSize) * (0.1f + 0.08f * (float)(rand()%11) );
-		position.z = yPosStart + static_cast<float>(AAIMap::ySectorSize) * (0.1f + 0.08f * (float)(rand()%11) );
+		position.x = xPosStart + static_cast<float>(AAIMap::xSectorSize) * (0.1f + 0.08f * (float)(ai->Random().NextInt(11)) );
+		position.z = yPosStart + static_cast<float>(AAIMap::ySectorSize) * (0.1f + 0.08f * (float)(ai->Random().NextInt(11)) );
 
 		if(IsValidMovePos(position, forbiddenMapTileTypes, continentId))
 		{
@@ -674,7 +667,7 @@ bool AAISector::IsValidMovePos(const float3& pos, BuildMapTileType forbiddenMapT
 	const int x = (int) (pos.x / SQUARE_SIZE);
 	const int y = (int) (pos.z / SQUARE_SIZE);
 
-	if(AAIMap::s_buildmap[x + y * AAIMap::xMapSize].IsTileTypeNotSet(forbiddenMapTileTypes))
+	if(AAIMap::s_buildmap.GetTileType(x, y).IsTileTypeNotSet(forbiddenMapTileTypes))
 	{
 		if( (continentId == AAIMap::ignoreContinentID) || (AAIMap::GetContinentID(pos) == continentId) )
 			return true;
@@ -90,6 +90,9 @@ public:
 	//! @brief Returns the number of buildings belonging to hostile players 
 	int GetNumberOfEnemyBuildings() const { return m_enemyBuildings; }
 
+	//! @brief Returns the number of enemy units detected by radar/sonar only (i.e. unit type unknown)
+	int GetNumberOfEnemyUnitsDetectedBySensor() const { return m_enemyUnitsDetectedBySensor; }
+
 	//! @brief Resets the own combat power / number of allied buildings
 	void ResetLocalCombatPower();
 
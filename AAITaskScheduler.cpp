@@ -0,0 +1,128 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include <algorithm>
+
+#include "AAITaskScheduler.h"
+#include "AAIProfiler.h"
+#include "AAI.h"
+
+AAITaskScheduler::AAITaskScheduler(const AAIProfiler* profiler, int frameBudget, int phaseShift) :
+	m_profiler(profiler),
+	m_frameBudget(static_cast<float>(frameBudget)),
+	m_phaseShift(phaseShift),
+	m_framesWithTasks(0u),
+	m_framesOverBudget(0u),
+	m_maxFrameTime(0.0f)
+{
+}
+
+void AAITaskScheduler::AddTask(const char* name, int period, int offset, float priority, std::function<void()> task)
+{
+	period = std::max(period, 1);
+	const int phase = (offset + m_phaseShift) % period;
+
+	m_tasks.push_back( ScheduledTask(name, AAIProfiler::GetSectionId(name), period, phase, priority, task) );
+}
+
+void AAITaskScheduler::Update(int frame)
+{
+	//-----------------------------------------------------------------------------------------------------------------
+	// determine tasks that are due
+	//-----------------------------------------------------------------------------------------------------------------
+	m_dueTasks.clear();
+
+	for(int i = 0; i < static_cast<int>(m_tasks.size()); ++i)
+	{
+		ScheduledTask& task = m_tasks[i];
+
+		// first frame after registration: determine next frame matching phase of task
+		if(task.dueFrame < 0)
+			task.dueFrame = frame + (task.period - (frame + task.phase) % task.period) % task.period;
+
+		if(task.dueFrame <= frame)
+			m_dueTasks.push_back(i);
+	}
+
+	if(m_dueTasks.empty())
+		return;
+
+	// tasks with equal priority are executed in order of registration
+	std::stable_sort(m_dueTasks.begin(), m_dueTasks.end(), [&](int lhs, int rhs) {
+		return GetCurrentPriority(m_tasks[lhs], frame) > GetCurrentPriority(m_tasks[rhs], frame);
+	});
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// execute tasks until budget is used up; at least one task is executed per frame and tasks that are overdue
+	// for a whole period are always executed (to prevent starvation of expensive tasks)
+	//-----------------------------------------------------------------------------------------------------------------
+	float usedTime(0.0f);
+	bool  taskExecuted(false);
+
+	for(const int index : m_dueTasks)
+	{
+		ScheduledTask& task = m_tasks[index];
+
+		const bool starving = (frame - task.dueFrame) >= task.period;
+
+		if( (taskExecuted == false) || starving || (usedTime + task.estimatedCost <= m_frameBudget) )
+		{
+			usedTime += ExecuteTask(task, frame);
+			taskExecuted = true;
+		}
+		else
+			++task.deferrals;
+	}
+
+	++m_framesWithTasks;
+
+	if(usedTime > m_frameBudget)
+		++m_framesOverBudget;
+
+	m_maxFrameTime = std::max(m_maxFrameTime, usedTime);
+}
+
+float AAITaskScheduler::ExecuteTask(ScheduledTask& task, int frame)
+{
+	task.task();
+
+	const float cost = m_profiler ? m_profiler->GetLastTime(task.sectionId) : 0.0f;
+
+	// update statistics
+	const int latency = frame - task.dueFrame;
+
+	task.estimatedCost  = (task.executions > 0u) ? (0.8f * task.estimatedCost + 0.2f * cost) : cost;
+	task.totalCost     += static_cast<double>(cost);
+	task.maxCost        = std::max(task.maxCost, cost);
+	task.totalLatency  += static_cast<unsigned int>(latency);
+	task.maxLatency     = std::max(task.maxLatency, latency);
+	++task.executions;
+
+	// next execution is due at the next frame matching the phase of the task (i.e. deferrals do not shift the phase)
+	while(task.dueFrame <= frame)
+		task.dueFrame += task.period;
+
+	return cost;
+}
+
+void AAITaskScheduler::LogStatistics(AAI* ai) const
+{
+	ai->Log("\nScheduled tasks (budget %.0f us): %u frames with tasks, %u frames over budget, max time per frame %.0f us\n",
+				m_frameBudget, m_framesWithTasks, m_framesOverBudget, m_maxFrameTime);
+	ai->Log("Task                           executions / deferrals / avg cost (us) / max cost (us) / avg latency (frames) / max latency (frames)\n");
+
+	for(const auto& task : m_tasks)
+	{
+		const float executions = static_cast<float>(std::max(task.executions, 1u));
+
+		ai->Log("%-30s %u / %u / %.1f / %.1f / %.2f / %i\n", task.name, task.executions, task.deferrals,
+					static_cast<float>(task.totalCost) / executions, task.maxCost,
+					static_cast<float>(task.totalLatency) / executions, task.maxLatency);
+	}
+}
@@ -0,0 +1,111 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_TASKSCHEDULER_H
+#define AAI_TASKSCHEDULER_H
+
+#include <vector>
+#include <functional>
+
+class AAI;
+class AAIProfiler;
+
+//! @brief Executes periodic tasks (e.g. update of sectors, check of construction) within a given time budget per frame. Tasks that are
+//!        due are executed in order of their priority which increases the longer a task is overdue; tasks are deferred to a later frame
+//!        if their cost (as measured by the profiler) exceeds the remaining budget. The phases of all tasks are shifted by a given offset to avoid that
+//!        several AAI instances execute expensive tasks in the same frame.
+class AAITaskScheduler
+{
+public:
+	//! @brief Creates a scheduler with the given time budget (in microseconds per frame) and phase shift (in frames) for all tasks; the
+	//!        execution times of the tasks are taken from the given profiler
+	AAITaskScheduler(const AAIProfiler* profiler, int frameBudget, int phaseShift);
+
+	//! @brief Adds a task that shall be executed every period frames (in frames where (frame + offset) is a multiple of period if not deferred);
+	//!        the task must measure its execution time in a profiler section with the same name (i.e. via AAI_SCOPED_TIMER(name))
+	void AddTask(const char* name, int period, int offset, float priority, std::function<void()> task);
+
+	//! @brief Executes the tasks that are due in the given frame (as long as time budget is not exceeded)
+	void Update(int frame);
+
+	//! @brief Writes the execution statistics (cost and latency) of every task to the log file
+	void LogStatistics(AAI* ai) const;
+
+private:
+	struct ScheduledTask
+	{
+		ScheduledTask(const char* name, int sectionId, int period, int phase, float priority, std::function<void()> task) :
+			name(name), task(task), sectionId(sectionId), period(period), phase(phase), priority(priority), dueFrame(-1), estimatedCost(0.0f),
+			executions(0u), deferrals(0u), totalLatency(0u), maxLatency(0), totalCost(0.0), maxCost(0.0f) {}
+
+		//! Name of the task (used for logging)
+		const char*           name;
+
+		//! The function to be executed
+		std::function<void()> task;
+
+		//! Id of the profiler section measuring the execution time of the task
+		int                   sectionId;
+
+		//! Number of frames between two executions
+		int                   period;
+
+		//! Phase of the task, i.e. task is due in frames where (frame + phase) is a multiple of the period
+		int                   phase;
+
+		//! The base priority of the task
+		float                 priority;
+
+		//! Frame the next execution is due (-1 if not determined yet)
+		int                   dueFrame;
+
+		//! Estimated cost of the task in microseconds (moving average of execution times measured by the profiler)
+		float                 estimatedCost;
+
+		//! Statistics: number of executions/deferrals
+		unsigned int          executions, deferrals;
+
+		//! Statistics: sum and max of frames between due frame and execution
+		unsigned int          totalLatency;
+		int                   maxLatency;
+
+		//! Statistics: sum and max of execution times in microseconds
+		double                totalCost;
+		float                 maxCost;
+	};
+
+	//! @brief Returns the priority of the given task in the given frame (priority increases the longer the task is overdue)
+	float GetCurrentPriority(const ScheduledTask& task, int frame) const { return task.priority * (1.0f + static_cast<float>(frame - task.dueFrame) / static_cast<float>(task.period)); }
+
+	//! @brief Executes the given task and determines next due frame; returns the execution time (as measured by the profiler)
+	float ExecuteTask(ScheduledTask& task, int frame);
+
+	//! The registered tasks
+	std::vector<ScheduledTask> m_tasks;
+
+	//! Indices of the tasks that are due in the current frame (member to avoid reallocation every frame)
+	std::vector<int>           m_dueTasks;
+
+	//! Profiler measuring the execution times of the tasks
+	const AAIProfiler*         m_profiler;
+
+	//! Time budget per frame in microseconds
+	float                      m_frameBudget;
+
+	//! Offset added to the phase of every task
+	int                        m_phaseShift;
+
+	//! Statistics: number of frames in which tasks have been executed / in which the budget has been exceeded
+	unsigned int               m_framesWithTasks, m_framesOverBudget;
+
+	//! Statistics: max time spent on tasks in a single frame in microseconds
+	float                      m_maxFrameTime;
+};
+
+#endif
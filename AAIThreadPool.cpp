@@ -0,0 +1,102 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include "AAIThreadPool.h"
+
+#include <algorithm>
+
+AAIThreadPool::AAIThreadPool(int numberOfThreads) :
+	m_unfinishedTasks(0),
+	m_shutdown(false)
+{
+	if(numberOfThreads <= 0)
+		numberOfThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+	for(int i = 1; i < numberOfThreads; ++i)
+		m_workers.push_back( std::thread(&AAIThreadPool::ProcessTasks, this) );
+}
+
+AAIThreadPool::~AAIThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_shutdown = true;
+	}
+
+	m_tasksAvailable.notify_all();
+
+	for(auto& worker : m_workers)
+		worker.join();
+}
+
+void AAIThreadPool::ProcessRowBands(int numberOfRows, int rowsPerBand, const std::function<void(int, int, int)>& processBand)
+{
+	const int numberOfBands = GetNumberOfBands(numberOfRows, rowsPerBand);
+
+	if(m_workers.empty())
+	{
+		for(int band = 0; band < numberOfBands; ++band)
+			processBand(band, band * rowsPerBand, std::min(numberOfRows, (band+1) * rowsPerBand));
+
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		for(int band = 0; band < numberOfBands; ++band)
+			m_tasks.push( [=, &processBand]() { processBand(band, band * rowsPerBand, std::min(numberOfRows, (band+1) * rowsPerBand)); } );
+
+		m_unfinishedTasks += numberOfBands;
+	}
+
+	m_tasksAvailable.notify_all();
+
+	// calling thread helps processing the bands and waits until the remaining ones are finished by the worker threads
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while(m_tasks.empty() == false)
+	{
+		std::function<void()> task = std::move(m_tasks.front());
+		m_tasks.pop();
+
+		lock.unlock();
+		task();
+		lock.lock();
+
+		--m_unfinishedTasks;
+	}
+
+	m_tasksFinished.wait(lock, [this]() { return (m_unfinishedTasks == 0); });
+}
+
+void AAIThreadPool::ProcessTasks()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while(true)
+	{
+		m_tasksAvailable.wait(lock, [this]() { return m_shutdown || (m_tasks.empty() == false); });
+
+		if(m_tasks.empty())	// shutdown
+			return;
+
+		std::function<void()> task = std::move(m_tasks.front());
+		m_tasks.pop();
+
+		lock.unlock();
+		task();
+		lock.lock();
+
+		--m_unfinishedTasks;
+
+		if(m_unfinishedTasks == 0)
+			m_tasksFinished.notify_all();
+	}
+}
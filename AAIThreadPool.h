@@ -0,0 +1,67 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_THREADPOOL_H
+#define AAI_THREADPOOL_H
+
+#include <vector>
+#include <queue>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+//! A small pool of worker threads used to split up expensive calculations (e.g. analysis of the map at game start) into
+//! bands of rows. The bands only depend on the number of rows and the band size (not on the number of threads), thus
+//! results merged in order of the bands are identical regardless of the number of threads. With one thread, all bands
+//! are processed serially by the calling thread.
+class AAIThreadPool
+{
+public:
+	//! @brief Starts the worker threads (the calling thread is counted as one thread, 0 to use all available cores)
+	explicit AAIThreadPool(int numberOfThreads);
+
+	~AAIThreadPool();
+
+	//! @brief Returns the number of threads (including the calling thread) processing the bands
+	int GetNumberOfThreads() const { return static_cast<int>(m_workers.size()) + 1; }
+
+	//! @brief Returns the number of bands the given number of rows is split into
+	static int GetNumberOfBands(int numberOfRows, int rowsPerBand) { return (numberOfRows + rowsPerBand - 1) / rowsPerBand; }
+
+	//! @brief Calls the given function (band index, first row, end row) for every band of rows and returns after all bands have been processed
+	void ProcessRowBands(int numberOfRows, int rowsPerBand, const std::function<void(int, int, int)>& processBand);
+
+private:
+	//! @brief Processes queued tasks until the pool is shut down (executed by the worker threads)
+	void ProcessTasks();
+
+	//! The worker threads
+	std::vector<std::thread>           m_workers;
+
+	//! Tasks waiting to be processed
+	std::queue< std::function<void()> > m_tasks;
+
+	//! Number of tasks that have been queued but not finished yet
+	int                                m_unfinishedTasks;
+
+	//! Indicates whether worker threads shall stop
+	bool                               m_shutdown;
+
+	//! Mutex protecting tasks, number of unfinished tasks and shutdown flag
+	std::mutex                         m_mutex;
+
+	//! Signals that new tasks are available (or pool is shut down)
+	std::condition_variable            m_tasksAvailable;
+
+	//! Signals that all queued tasks have been finished
+	std::condition_variable            m_tasksFinished;
+};
+
+#endif
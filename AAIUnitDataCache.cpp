@@ -0,0 +1,116 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include "AAIUnitDataCache.h"
+
+#include "LegacyCpp/IAICallback.h"
+#include "LegacyCpp/UnitDef.h"
+
+AAIUnitDataCache::AAIUnitDataCache(springLegacyAI::IAICallback* aiCallback) :
+	m_aiCallback(aiCallback),
+	m_generation(1u)
+{
+	m_cachedUnitData.resize(m_aiCallback->GetMaxUnits());
+
+	m_numberOfRequests.fill(0);
+	m_numberOfEngineCalls.fill(0);
+}
+
+void AAIUnitDataCache::InvalidateUnit(UnitId unitId)
+{
+	if( unitId.IsValid() && (unitId.id < static_cast<int>(m_cachedUnitData.size())) )
+		m_cachedUnitData[unitId.id].generation.fill(0);
+}
+
+bool AAIUnitDataCache::LookUp(UnitId unitId, EUnitDataRequest request, CachedUnitData*& cachedUnitData)
+{
+	const int requestIndex = static_cast<int>(request);
+	++m_numberOfRequests[requestIndex];
+
+	if(unitId.id >= static_cast<int>(m_cachedUnitData.size()))
+		m_cachedUnitData.resize(unitId.id + 1);
+
+	cachedUnitData = &m_cachedUnitData[unitId.id];
+
+	if(cachedUnitData->generation[requestIndex] == m_generation)
+		return true;
+
+	cachedUnitData->generation[requestIndex] = m_generation;
+	++m_numberOfEngineCalls[requestIndex];
+	return false;
+}
+
+float3 AAIUnitDataCache::GetUnitPos(UnitId unitId)
+{
+	if(unitId.IsValid() == false)
+		return ZeroVector;
+
+	CachedUnitData* cachedUnitData;
+
+	if(LookUp(unitId, EUnitDataRequest::POSITION, cachedUnitData) == false)
+		cachedUnitData->position = m_aiCallback->GetUnitPos(unitId.id);
+
+	return cachedUnitData->position;
+}
+
+const springLegacyAI::UnitDef* AAIUnitDataCache::GetUnitDef(UnitId unitId)
+{
+	if(unitId.IsValid() == false)
+		return nullptr;
+
+	CachedUnitData* cachedUnitData;
+
+	if(LookUp(unitId, EUnitDataRequest::UNIT_DEF, cachedUnitData) == false)
+		cachedUnitData->unitDef = m_aiCallback->GetUnitDef(unitId.id);
+
+	return cachedUnitData->unitDef;
+}
+
+float AAIUnitDataCache::GetUnitHealth(UnitId unitId)
+{
+	if(unitId.IsValid() == false)
+		return 0.0f;
+
+	CachedUnitData* cachedUnitData;
+
+	if(LookUp(unitId, EUnitDataRequest::HEALTH, cachedUnitData) == false)
+		cachedUnitData->health = m_aiCallback->GetUnitHealth(unitId.id);
+
+	return cachedUnitData->health;
+}
+
+int AAIUnitDataCache::GetUnitTeam(UnitId unitId)
+{
+	if(unitId.IsValid() == false)
+		return -1;
+
+	CachedUnitData* cachedUnitData;
+
+	if(LookUp(unitId, EUnitDataRequest::TEAM, cachedUnitData) == false)
+		cachedUnitData->team = m_aiCallback->GetUnitTeam(unitId.id);
+
+	return cachedUnitData->team;
+}
+
+const char* AAIUnitDataCache::GetRequestName(EUnitDataRequest request)
+{
+	switch(request)
+	{
+		case EUnitDataRequest::POSITION:
+			return "Position";
+		case EUnitDataRequest::UNIT_DEF:
+			return "Unit def";
+		case EUnitDataRequest::HEALTH:
+			return "Health";
+		case EUnitDataRequest::TEAM:
+			return "Team";
+		default:
+			return "Unknown";
+	}
+}
@@ -0,0 +1,107 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_UNITDATACACHE_H
+#define AAI_UNITDATACACHE_H
+
+#include <vector>
+#include <array>
+#include <cstdint>
+
+#include "System/float3.h"
+#include "aidef.h"
+
+namespace springLegacyAI {
+	class IAICallback;
+	struct UnitDef;
+}
+
+//! The different kinds of unit data that are requested from the engine via the unit data cache
+enum class EUnitDataRequest : int
+{
+	POSITION = 0,
+	UNIT_DEF = 1,
+	HEALTH   = 2,
+	TEAM     = 3,
+	NUMBER_OF_REQUEST_TYPES = 4
+};
+
+//! @brief Facade for the AI callback that memoises frequently requested unit data (position, unit definition, health, team).
+//!        Every value is fetched from the engine at most once per frame - the cache is invalidated by starting a new generation
+//!        every frame (i.e. no data is cleared/copied). Data of single units may be invalidated earlier (e.g. if a unit has been
+//!        destroyed or enemy unit left LOS).
+class AAIUnitDataCache
+{
+public:
+	explicit AAIUnitDataCache(springLegacyAI::IAICallback* aiCallback);
+
+	//! @brief Invalidates all cached data (to be called at the beginning of every frame)
+	void NextFrame() { ++m_generation; }
+
+	//! @brief Invalidates the cached data of the given unit (e.g. because it has been destroyed or an enemy unit entered/left LOS)
+	void InvalidateUnit(UnitId unitId);
+
+	//! @brief Returns the position of the given unit (ZeroVector if unit is not visible)
+	float3 GetUnitPos(UnitId unitId);
+
+	//! @brief Returns the unit definition of the given unit (nullptr if unit is not visible/does not exist)
+	const springLegacyAI::UnitDef* GetUnitDef(UnitId unitId);
+
+	//! @brief Returns the current health of the given unit
+	float GetUnitHealth(UnitId unitId);
+
+	//! @brief Returns the team of the given unit
+	int GetUnitTeam(UnitId unitId);
+
+	//! @brief Returns how often the given type of data has been requested
+	uint64_t GetNumberOfRequests(EUnitDataRequest request) const { return m_numberOfRequests[static_cast<int>(request)]; }
+
+	//! @brief Returns how often the given type of data had to be fetched from the engine
+	uint64_t GetNumberOfEngineCalls(EUnitDataRequest request) const { return m_numberOfEngineCalls[static_cast<int>(request)]; }
+
+	//! @brief Returns the name of the given request type (used for logging)
+	static const char* GetRequestName(EUnitDataRequest request);
+
+private:
+	//! Cached data of a single unit; every value is valid if its generation matches the current generation of the cache
+	struct CachedUnitData
+	{
+		CachedUnitData() : position(ZeroVector), unitDef(nullptr), health(0.0f), team(-1) { generation.fill(0); }
+
+		std::array<uint32_t, static_cast<int>(EUnitDataRequest::NUMBER_OF_REQUEST_TYPES)> generation;
+
+		float3                         position;
+
+		const springLegacyAI::UnitDef* unitDef;
+
+		float                          health;
+
+		int                            team;
+	};
+
+	//! @brief Returns the cache entry for the given unit (and updates the statistics); returns whether cached value is still up to date
+	bool LookUp(UnitId unitId, EUnitDataRequest request, CachedUnitData*& cachedUnitData);
+
+	//! The AI callback used to fetch data from the engine
+	springLegacyAI::IAICallback* m_aiCallback;
+
+	//! Cached data, accessed by unit id (sized for the maximum number of units, resized on demand if necessary)
+	std::vector<CachedUnitData>  m_cachedUnitData;
+
+	//! The current generation; cached values with a different generation are outdated
+	uint32_t                     m_generation;
+
+	//! Number of requests for the different types of unit data
+	std::array<uint64_t, static_cast<int>(EUnitDataRequest::NUMBER_OF_REQUEST_TYPES)> m_numberOfRequests;
+
+	//! Number of calls to the engine for the different types of unit data
+	std::array<uint64_t, static_cast<int>(EUnitDataRequest::NUMBER_OF_REQUEST_TYPES)> m_numberOfEngineCalls;
+};
+
+#endif
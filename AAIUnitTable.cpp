@@ -16,6 +16,8 @@
 #include "AAIConfig.h"
 #include "AAIMap.h"
 #include "AAIGroup.h"
+#include "AAIUnitDataCache.h"
+#include "AAILogger.h"
 #include "AAIConstructor.h"
 
 #include "LegacyCpp/UnitDef.h"
@@ -88,7 +90,7 @@ bool AAIUnitTable::AddUnit(int unit_id, int def_id, AAIGroup *group, AAIConstruc
 	}
 	else
 	{
-		ai->Log("ERROR: AAIUnitTable::AddUnit() index %i out of range", unit_id);
+		ai->Log(ELogLevel::FAILURE, ELogCategory::GENERAL, "AAIUnitTable::AddUnit() index %i out of range", unit_id);
 		return false;
 	}
 }
@@ -104,7 +106,7 @@ void AAIUnitTable::RemoveUnit(int unit_id)
 	}
 	else
 	{
-		ai->Log("ERROR: AAIUnitTable::RemoveUnit() index %i out of range", unit_id);
+		ai->Log(ELogLevel::FAILURE, ELogCategory::GENERAL, "AAIUnitTable::RemoveUnit() index %i out of range", unit_id);
 	}
 }
 
@@ -263,7 +265,7 @@ AvailableConstructor AAIUnitTable::FindClosestBuilder(UnitDefId building, const
 			if(    builder->IsAvailableForConstruction()
 				&& ai->s_buildTree.CanBuildUnitType(builder->m_myDefId, building) )
 			{
-				const float3 builderPosition = ai->GetAICallback()->GetUnitPos(builder->m_myUnitId.id);
+				const float3 builderPosition = ai->UnitData()->GetUnitPos(builder->m_myUnitId);
 
 				const bool continentCheckPassed =    (ai->s_buildTree.GetMovementType(builder->m_myDefId).CannotMoveToOtherContinents() == false) 
 												  || (AAIMap::GetContinentID(builderPosition) == continent);
@@ -306,7 +308,7 @@ AAIConstructor* AAIUnitTable::FindClosestAssistant(const float3& pos, int /*impo
 			// find idle assister
 			if(assistant->IsIdle())
 			{
-				const float3 assistantPosition = ai->GetAICallback()->GetUnitPos(assistant->m_myUnitId.id);
+				const float3 assistantPosition = ai->UnitData()->GetUnitPos(assistant->m_myUnitId);
 				const AAIMovementType& moveType = ai->s_buildTree.GetMovementType(assistant->m_myDefId);
 
 				const bool continentCheckPassed = (moveType.CannotMoveToOtherContinents() == false) || (AAIMap::GetContinentID(assistantPosition) == continent);
@@ -18,10 +18,14 @@
 #include <list>
 
 #define AAI_VERSION aiexport_getVersion()
-#define MAP_CACHE_VERSION "MAP_DATA_0_92b"
+#ifdef AAI_BUILD_MAP_BIT_PLANES
+	#define MAP_CACHE_VERSION "MAP_DATA_0_94_BIT_PLANES"
+#else
+	#define MAP_CACHE_VERSION "MAP_DATA_0_94"
+#endif
 #define MAP_LEARN_VERSION "MAP_LEARN_0_91"
 #define MOD_LEARN_VERSION "MOD_LEARN_0_92"
-#define CONTINENT_DATA_VERSION "MOVEMENT_MAPS_0_90"
+#define CONTINENT_DATA_VERSION "CONTINENT_DATA_0_91"
 
 #define AILOG_PATH "log/"
 #define MAP_LEARN_PATH "learn/mod/"
@@ -0,0 +1,436 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+// only part of the headless driver (sources of the AI library are collected recursively)
+#ifdef AAI_HEADLESS
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <cmath>
+#include <algorithm>
+#include <map>
+
+#include "AAIHeadlessCallback.h"
+
+#include "Sim/Misc/GlobalConstants.h"
+#include "Sim/Units/CommandAI/Command.h"
+
+//! The callbacks of the skirmish AIs (accessed by skirmish AI id) to route calls of the C callback
+static std::map<int, AAIHeadlessCallback*> s_headlessCallbacks;
+
+//! @brief Copies the values of the given map to the buffer provided by AAI (size of the map is returned)
+static int CopyMap(const std::vector<int>& map, int* values, int values_sizeMax)
+{
+	if(values != nullptr)
+		std::copy(map.begin(), map.begin() + std::min(static_cast<int>(map.size()), values_sizeMax), values);
+
+	return static_cast<int>(map.size());
+}
+
+static int CALLING_CONV Map_getLosMap(int skirmishAIId, int* losValues, int losValues_sizeMax)
+{
+	return s_headlessCallbacks[skirmishAIId]->GetLosMapValues(losValues, losValues_sizeMax);
+}
+
+static int CALLING_CONV Map_getRadarMap(int skirmishAIId, int* radarValues, int radarValues_sizeMax)
+{
+	return s_headlessCallbacks[skirmishAIId]->GetRadarMapValues(radarValues, radarValues_sizeMax);
+}
+
+static int CALLING_CONV getUnitDefs(int /*skirmishAIId*/, int* /*unitDefIds*/, int /*unitDefIds_sizeMax*/)
+{
+	// definitions are served by the stand-in directly (i.e. the caches of the wrapper are not used)
+	return 0;
+}
+
+static int CALLING_CONV getFeatureDefs(int /*skirmishAIId*/, int* /*featureDefIds*/, int /*featureDefIds_sizeMax*/)
+{
+	return 0;
+}
+
+static int CALLING_CONV getWeaponDefs(int /*skirmishAIId*/)
+{
+	return 0;
+}
+
+static int CALLING_CONV Unit_getCurrentCommands(int /*skirmishAIId*/, int /*unitId*/)
+{
+	return 0;
+}
+
+static int CALLING_CONV Unit_CurrentCommand_getType(int /*skirmishAIId*/, int /*unitId*/)
+{
+	return 0;
+}
+
+AAIHeadlessSkirmishAICallbacks::AAIHeadlessSkirmishAICallbacks()
+{
+	memset(&m_skirmishAICallbacks, 0, sizeof(m_skirmishAICallbacks));
+
+	m_skirmishAICallbacks.getUnitDefs                 = &getUnitDefs;
+	m_skirmishAICallbacks.getFeatureDefs              = &getFeatureDefs;
+	m_skirmishAICallbacks.getWeaponDefs               = &getWeaponDefs;
+	m_skirmishAICallbacks.Map_getLosMap               = &Map_getLosMap;
+	m_skirmishAICallbacks.Map_getRadarMap             = &Map_getRadarMap;
+	m_skirmishAICallbacks.Unit_getCurrentCommands     = &Unit_getCurrentCommands;
+	m_skirmishAICallbacks.Unit_CurrentCommand_getType = &Unit_CurrentCommand_getType;
+}
+
+AAIHeadlessCallback::AAIHeadlessCallback(int skirmishAIId, const std::string& workDirectory, const std::string& dataDirectory) :
+	AAIHeadlessSkirmishAICallbacks(),
+	springLegacyAI::CAIAICallback(skirmishAIId, &m_skirmishAICallbacks),
+	m_emptyCommandQueue(*CAIAICallback::GetCurrentUnitCommands(0)),
+	m_busyCommandQueue(m_emptyCommandQueue),
+	m_skirmishAIId(skirmishAIId),
+	m_workDirectory(workDirectory),
+	m_dataDirectory(dataDirectory),
+	m_currentFrame(0),
+	m_numberOfOrders(0)
+{
+	m_busyCommandQueue.push_back(Command(CMD_WAIT));
+
+	s_headlessCallbacks[m_skirmishAIId] = this;
+}
+
+AAIHeadlessCallback::~AAIHeadlessCallback()
+{
+	s_headlessCallbacks.erase(m_skirmishAIId);
+}
+
+void AAIHeadlessCallback::SetGameSetup(const AAIHeadlessGameSetup& gameSetup)
+{
+	m_gameSetup = gameSetup;
+
+	m_units.clear();
+	m_units.resize(m_gameSetup.maxUnits);
+
+	m_losMap.assign( (m_gameSetup.xMapSize / m_gameSetup.losMapResolution) * (m_gameSetup.yMapSize / m_gameSetup.losMapResolution), 0);
+	m_radarMap.assign( (m_gameSetup.xMapSize / m_gameSetup.radarMapResolution) * (m_gameSetup.yMapSize / m_gameSetup.radarMapResolution), 0);
+
+	m_enemyUnitsInLOS.clear();
+	m_enemyUnitsInRadarAndLOS.clear();
+}
+
+springLegacyAI::UnitDef* AAIHeadlessCallback::AddUnitDef(const std::string& name)
+{
+	m_unitDefs.push_back( std::unique_ptr<springLegacyAI::UnitDef>(new springLegacyAI::UnitDef()) );
+
+	springLegacyAI::UnitDef* unitDef = m_unitDefs.back().get();
+	unitDef->id        = static_cast<int>(m_unitDefs.size()); // unit def ids start with 1
+	unitDef->name      = name;
+	unitDef->humanName = name;
+	unitDef->movedata  = nullptr;
+	return unitDef;
+}
+
+springLegacyAI::WeaponDef* AAIHeadlessCallback::AddWeaponDef(const std::string& name)
+{
+	m_weaponDefs.push_back( std::unique_ptr<springLegacyAI::WeaponDef>(new springLegacyAI::WeaponDef()) );
+	m_weaponDefs.back()->name = name;
+	return m_weaponDefs.back().get();
+}
+
+void AAIHeadlessCallback::SetMoveData(springLegacyAI::UnitDef* unitDef, springLegacyAI::MoveData::MoveFamily moveFamily, float depth, bool subMarine)
+{
+	unitDef->movedata = new springLegacyAI::MoveData();
+	unitDef->movedata->moveFamily = moveFamily;
+	unitDef->movedata->depth      = depth;
+	unitDef->movedata->subMarine  = subMarine;
+}
+
+const springLegacyAI::UnitDef* AAIHeadlessCallback::GetUnitDefWithId(int unitDefId) const
+{
+	if( (unitDefId > 0) && (unitDefId <= static_cast<int>(m_unitDefs.size())) )
+		return m_unitDefs[unitDefId-1].get();
+	else
+		return nullptr;
+}
+
+AAIHeadlessUnit& AAIHeadlessCallback::Unit(int unitId)
+{
+	if(unitId >= static_cast<int>(m_units.size()))
+		m_units.resize(unitId+1);
+
+	return m_units[unitId];
+}
+
+void AAIHeadlessCallback::RemoveUnit(int unitId)
+{
+	if(IsValidUnit(unitId))
+		m_units[unitId] = AAIHeadlessUnit();
+}
+
+int AAIHeadlessCallback::GetFreeUnitId() const
+{
+	// unit id 0 is not used to avoid confusion with invalid ids
+	for(int unitId = 1; unitId < m_gameSetup.maxUnits; ++unitId)
+	{
+		if( (unitId >= static_cast<int>(m_units.size())) || (m_units[unitId].IsAlive() == false) )
+			return unitId;
+	}
+
+	return -1;
+}
+
+std::vector<AAIHeadlessOrder> AAIHeadlessCallback::TakeOrders()
+{
+	std::vector<AAIHeadlessOrder> orders;
+	orders.swap(m_orders);
+	return orders;
+}
+
+int AAIHeadlessCallback::GetLosMapValues(int* values, int values_sizeMax)
+{
+	return CopyMap(m_losMap, values, values_sizeMax);
+}
+
+int AAIHeadlessCallback::GetRadarMapValues(int* values, int values_sizeMax)
+{
+	return CopyMap(m_radarMap, values, values_sizeMax);
+}
+
+int AAIHeadlessCallback::GetTeamAllyTeam(int team)
+{
+	// every team forms its own ally team
+	return (team == m_gameSetup.team) ? m_gameSetup.allyTeam : team;
+}
+
+bool AAIHeadlessCallback::IsAllied(int firstAllyTeamId, int secondAllyTeamId)
+{
+	return (firstAllyTeamId == secondAllyTeamId);
+}
+
+float AAIHeadlessCallback::GetElevation(float x, float z)
+{
+	if(m_gameSetup.heightMap.empty())
+		return 0.0f;
+
+	const int xTile = std::max(0, std::min(static_cast<int>(x) / SQUARE_SIZE, m_gameSetup.xMapSize-1));
+	const int yTile = std::max(0, std::min(static_cast<int>(z) / SQUARE_SIZE, m_gameSetup.yMapSize-1));
+	return m_gameSetup.heightMap[xTile + yTile * m_gameSetup.xMapSize];
+}
+
+void AAIHeadlessCallback::GetUnitDefList(const springLegacyAI::UnitDef** list)
+{
+	for(size_t i = 0; i < m_unitDefs.size(); ++i)
+		list[i] = m_unitDefs[i].get();
+}
+
+const springLegacyAI::UnitDef* AAIHeadlessCallback::GetUnitDef(const char* unitName)
+{
+	for(const auto& unitDef : m_unitDefs)
+	{
+		if(unitDef->name == unitName)
+			return unitDef.get();
+	}
+
+	return nullptr;
+}
+
+const springLegacyAI::UnitDef* AAIHeadlessCallback::GetUnitDef(int unitId)
+{
+	return IsValidUnit(unitId) ? GetUnitDefWithId(m_units[unitId].unitDefId) : nullptr;
+}
+
+float3 AAIHeadlessCallback::GetUnitPos(int unitId)
+{
+	return IsValidUnit(unitId) ? m_units[unitId].position : ZeroVector;
+}
+
+float AAIHeadlessCallback::GetUnitHealth(int unitId)
+{
+	return IsValidUnit(unitId) ? m_units[unitId].health : 0.0f;
+}
+
+int AAIHeadlessCallback::GetUnitTeam(int unitId)
+{
+	return IsValidUnit(unitId) ? m_units[unitId].team : -1;
+}
+
+int AAIHeadlessCallback::GetUnitAllyTeam(int unitId)
+{
+	return IsValidUnit(unitId) ? GetTeamAllyTeam(m_units[unitId].team) : -1;
+}
+
+bool AAIHeadlessCallback::UnitBeingBuilt(int unitId)
+{
+	return IsValidUnit(unitId) ? m_units[unitId].beingBuilt : false;
+}
+
+const springLegacyAI::CCommandQueue* AAIHeadlessCallback::GetCurrentUnitCommands(int unitId)
+{
+	if(IsValidUnit(unitId) && (m_units[unitId].numberOfCommands > 0))
+		return &m_busyCommandQueue;
+	else
+		return &m_emptyCommandQueue;
+}
+
+int AAIHeadlessCallback::CopyUnitList(const std::vector<int>& units, int* unitIds, int unitIds_max)
+{
+	const int numberOfUnits = (unitIds_max >= 0) ? std::min(static_cast<int>(units.size()), unitIds_max) : static_cast<int>(units.size());
+
+	std::copy(units.begin(), units.begin() + numberOfUnits, unitIds);
+	return numberOfUnits;
+}
+
+int AAIHeadlessCallback::GetEnemyUnits(int* unitIds, int unitIds_max)
+{
+	return CopyUnitList(m_enemyUnitsInLOS, unitIds, unitIds_max);
+}
+
+int AAIHeadlessCallback::GetEnemyUnits(int* unitIds, const float3& pos, float radius, int unitIds_max)
+{
+	std::vector<int> unitsInArea;
+
+	for(const int unitId : m_enemyUnitsInLOS)
+	{
+		if(IsValidUnit(unitId) && (m_units[unitId].position.SqDistance2D(pos) <= radius * radius))
+			unitsInArea.push_back(unitId);
+	}
+
+	return CopyUnitList(unitsInArea, unitIds, unitIds_max);
+}
+
+int AAIHeadlessCallback::GetEnemyUnitsInRadarAndLos(int* unitIds, int unitIds_max)
+{
+	return CopyUnitList(m_enemyUnitsInRadarAndLOS, unitIds, unitIds_max);
+}
+
+int AAIHeadlessCallback::GetFriendlyUnits(int* unitIds, int unitIds_max)
+{
+	std::vector<int> friendlyUnits;
+
+	for(size_t unitId = 0; unitId < m_units.size(); ++unitId)
+	{
+		if(m_units[unitId].IsAlive() && (GetTeamAllyTeam(m_units[unitId].team) == m_gameSetup.allyTeam))
+			friendlyUnits.push_back(static_cast<int>(unitId));
+	}
+
+	return CopyUnitList(friendlyUnits, unitIds, unitIds_max);
+}
+
+bool AAIHeadlessCallback::CanBuildAt(const springLegacyAI::UnitDef* unitDef, float3 pos, int /*facing*/)
+{
+	if(unitDef == nullptr)
+		return false;
+
+	const float xHalfSize = 0.5f * static_cast<float>(unitDef->xsize * SQUARE_SIZE);
+	const float zHalfSize = 0.5f * static_cast<float>(unitDef->zsize * SQUARE_SIZE);
+
+	if(    (pos.x < xHalfSize) || (pos.x + xHalfSize > static_cast<float>(m_gameSetup.xMapSize * SQUARE_SIZE))
+		|| (pos.z < zHalfSize) || (pos.z + zHalfSize > static_cast<float>(m_gameSetup.yMapSize * SQUARE_SIZE)) )
+		return false;
+
+	const bool waterUnit = (unitDef->minWaterDepth > 0.0f) || (unitDef->movedata && (unitDef->movedata->moveFamily == springLegacyAI::MoveData::Ship));
+
+	if( waterUnit != (GetElevation(pos.x, pos.z) < 0.0f) )
+		return false;
+
+	// check for overlapping buildings
+	for(const auto& unit : m_units)
+	{
+		if(unit.IsAlive())
+		{
+			const springLegacyAI::UnitDef* def = GetUnitDefWithId(unit.unitDefId);
+
+			if( (def->movedata == nullptr) && (def->canfly == false) )
+			{
+				if(    (std::fabs(unit.position.x - pos.x) < xHalfSize + 0.5f * static_cast<float>(def->xsize * SQUARE_SIZE))
+					&& (std::fabs(unit.position.z - pos.z) < zHalfSize + 0.5f * static_cast<float>(def->zsize * SQUARE_SIZE)) )
+					return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+float3 AAIHeadlessCallback::ClosestBuildSite(const springLegacyAI::UnitDef* unitDef, float3 pos, float searchRadius, int minDist, int facing)
+{
+	// check positions on rings of increasing size around the given position
+	const float stepSize = static_cast<float>( std::max(2, minDist) * SQUARE_SIZE );
+
+	for(float radius = 0.0f; radius <= searchRadius; radius += stepSize)
+	{
+		const int steps = std::max(1, static_cast<int>(2.0f * 3.14159f * radius / stepSize));
+
+		for(int step = 0; step < steps; ++step)
+		{
+			const float  angle = 2.0f * 3.14159f * static_cast<float>(step) / static_cast<float>(steps);
+			float3 buildsite(pos.x + radius * std::cos(angle), 0.0f, pos.z + radius * std::sin(angle));
+
+			if(CanBuildAt(unitDef, buildsite, facing))
+			{
+				buildsite.y = GetElevation(buildsite.x, buildsite.z);
+				return buildsite;
+			}
+		}
+	}
+
+	// like the engine: x = -1 if no buildsite has been found
+	return float3(-1.0f, 0.0f, 0.0f);
+}
+
+int AAIHeadlessCallback::GiveOrder(int unitId, Command* c)
+{
+	if(IsValidUnit(unitId) == false)
+		return -1;
+
+	AAIHeadlessOrder order;
+	order.frame     = m_currentFrame;
+	order.unitId    = unitId;
+	order.commandId = c->GetID();
+
+	for(unsigned int i = 0; i < c->GetNumParams(); ++i)
+		order.params.push_back(c->GetParam(i));
+
+	m_orders.push_back(order);
+	++m_numberOfOrders;
+
+	m_units[unitId].numberOfCommands = (order.commandId == CMD_STOP) ? 0 : 1;
+	return 0;
+}
+
+void AAIHeadlessCallback::SendTextMsg(const char* text, int /*zone*/)
+{
+	printf("[frame %i] %s\n", m_currentFrame, text);
+}
+
+bool AAIHeadlessCallback::GetValue(int valueId, void* data)
+{
+	if( (valueId != AIVAL_LOCATE_FILE_R) && (valueId != AIVAL_LOCATE_FILE_W) )
+		return false;
+
+	// buffers passed by AAI have the size used by the wrapper
+	char* filename = static_cast<char*>(data);
+	const std::string relativePath(filename);
+
+	std::string path = m_workDirectory + "/" + relativePath;
+
+	if(valueId == AIVAL_LOCATE_FILE_W)
+		CreateDirectories(path);
+	else
+	{
+		struct stat fileStatus;
+		if(stat(path.c_str(), &fileStatus) != 0)
+			path = m_dataDirectory + "/" + relativePath;
+	}
+
+	snprintf(filename, 2048, "%s", path.c_str());
+	return true;
+}
+
+void AAIHeadlessCallback::CreateDirectories(const std::string& path)
+{
+	for(size_t separator = path.find('/', 1); separator != std::string::npos; separator = path.find('/', separator+1))
+		mkdir(path.substr(0, separator).c_str(), 0755);
+}
+
+#endif
@@ -0,0 +1,317 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_HEADLESSCALLBACK_H
+#define AAI_HEADLESSCALLBACK_H
+
+#include <vector>
+#include <string>
+#include <memory>
+
+#include "ExternalAI/Interface/SSkirmishAICallback.h"
+#include "LegacyCpp/AIAICallback.h"
+#include "LegacyCpp/IGlobalAICallback.h"
+#include "LegacyCpp/CommandQueue.h"
+#include "LegacyCpp/UnitDef.h"
+#include "LegacyCpp/WeaponDef.h"
+#include "LegacyCpp/MoveData.h"
+#include "System/float3.h"
+
+#include "../AAIEventRecorder.h"
+
+//! A unit known to the stand-in engine
+struct AAIHeadlessUnit
+{
+	AAIHeadlessUnit() : unitDefId(0), position(ZeroVector), health(0.0f), team(-1), beingBuilt(false), numberOfCommands(0) {}
+
+	bool IsAlive() const { return (unitDefId > 0); }
+
+	//! Unit definition id (0 if unit does not exist)
+	int    unitDefId;
+
+	float3 position;
+
+	float  health;
+
+	int    team;
+
+	bool   beingBuilt;
+
+	//! Number of commands in the command queue of the unit (AAI only checks whether units are busy)
+	int    numberOfCommands;
+};
+
+//! An order given by AAI via GiveOrder()
+struct AAIHeadlessOrder
+{
+	int                frame;
+
+	int                unitId;
+
+	//! Command id (negative unit def id for build orders)
+	int                commandId;
+
+	std::vector<float> params;
+};
+
+//! An event to be passed to AAI by the driver (same types and values as stored by the event recorder)
+struct AAIHeadlessEvent
+{
+	AAIHeadlessEvent(ERecordedEvent type, int value1 = 0, int value2 = 0, int value3 = 0, int value4 = 0) : type(type), values{value1, value2, value3, value4} {}
+
+	ERecordedEvent type;
+
+	int            values[4];
+};
+
+//! Static data of the game (i.e. values that do not change after game start)
+struct AAIHeadlessGameSetup
+{
+	AAIHeadlessGameSetup() : team(0), allyTeam(0), maxUnits(2000), xMapSize(0), yMapSize(0), losMapResolution(4), radarMapResolution(8), mapHash(0), modHash(0),
+		extractorRadius(64.0f), maxMetal(1.0f), minWind(0.0f), maxWind(20.0f), tidalStrength(0.0f) {}
+
+	int         team, allyTeam;
+
+	int         maxUnits;
+
+	//! Size of the map in map tiles (i.e. SQUARE_SIZE x SQUARE_SIZE elmos)
+	int         xMapSize, yMapSize;
+
+	//! Number of map tiles per LOS/radar map tile (in x and y direction)
+	int         losMapResolution, radarMapResolution;
+
+	std::string mapName, modName, modHumanName, modShortName;
+
+	int         mapHash, modHash;
+
+	float       extractorRadius, maxMetal;
+
+	float       minWind, maxWind, tidalStrength;
+
+	//! Height of every map tile (xMapSize * yMapSize values)
+	std::vector<float>         heightMap;
+
+	//! Metal of every metal map tile (half resolution of the map)
+	std::vector<unsigned char> metalMap;
+};
+
+//! @brief Function table of the C callback used by the stand-in engine (base class of the stand-in to be set up before the legacy wrapper
+//!        which already queries it in its constructor); every entry not used by AAI or the wrapper is null
+struct AAIHeadlessSkirmishAICallbacks
+{
+	AAIHeadlessSkirmishAICallbacks();
+
+	SSkirmishAICallback m_skirmishAICallbacks;
+};
+
+//! @brief Stand-in for the engine that allows to run AAI in a plain executable (no engine, no GPU). All queries of AAI are answered from the
+//!        game state stored in the callback (units, maps, resources) which is maintained by the driver (e.g. a mock game simulating the
+//!        orders of AAI). Orders given by AAI are recorded. Derived from the legacy C++ wrapper to only provide the part of the
+//!        interface used by AAI; the data AAI fetches via the C callback directly (LOS and radar map) is served by a function table
+//!        routed to the callback of the corresponding skirmish AI id.
+class AAIHeadlessCallback : private AAIHeadlessSkirmishAICallbacks, public springLegacyAI::CAIAICallback
+{
+public:
+	//! Provides the callback to AAI::InitAI()
+	class GlobalCallback : public springLegacyAI::IGlobalAICallback
+	{
+	public:
+		explicit GlobalCallback(AAIHeadlessCallback* aiCallback) : m_aiCallback(aiCallback) {}
+
+		springLegacyAI::IAICheats*   GetCheatInterface() override { return nullptr; }
+
+		springLegacyAI::IAICallback* GetAICallback() override { return m_aiCallback; }
+
+	private:
+		AAIHeadlessCallback* m_aiCallback;
+	};
+
+	//! Resources of the team of the AI
+	struct Resources
+	{
+		Resources() : metal(0.0f), metalIncome(0.0f), metalUsage(0.0f), metalStorage(0.0f), energy(0.0f), energyIncome(0.0f), energyUsage(0.0f), energyStorage(0.0f) {}
+
+		float metal, metalIncome, metalUsage, metalStorage;
+		float energy, energyIncome, energyUsage, energyStorage;
+	};
+
+	//! @brief Files requested by AAI are written to/read from the work directory; files not present there are read from the data directory
+	AAIHeadlessCallback(int skirmishAIId, const std::string& workDirectory, const std::string& dataDirectory);
+
+	~AAIHeadlessCallback();
+
+	//! @brief Returns the function table to be passed to the constructor of AAI
+	const SSkirmishAICallback* GetSkirmishAICallbacks() const { return &m_skirmishAICallbacks; }
+
+	//! @brief Sets map, team, and mod data; resets units, LOS and radar map
+	void SetGameSetup(const AAIHeadlessGameSetup& gameSetup);
+
+	const AAIHeadlessGameSetup& GetGameSetup() const { return m_gameSetup; }
+
+	//! @brief Returns the directory files are read from if not present in the work directory
+	const std::string& GetDataDirectory() const { return m_dataDirectory; }
+
+	//! @brief Adds a new unit definition (id is assigned by the callback, the name must be unique)
+	springLegacyAI::UnitDef* AddUnitDef(const std::string& name);
+
+	//! @brief Adds a new weapon definition (to be referenced by unit definitions)
+	springLegacyAI::WeaponDef* AddWeaponDef(const std::string& name);
+
+	//! @brief Sets the move data of the given unit definition (allocated like by the wrapper, i.e. owned by the unit definition)
+	static void SetMoveData(springLegacyAI::UnitDef* unitDef, springLegacyAI::MoveData::MoveFamily moveFamily, float depth, bool subMarine);
+
+	//! @brief Returns the unit definition with the given id (nullptr if invalid)
+	const springLegacyAI::UnitDef* GetUnitDefWithId(int unitDefId) const;
+
+	//! @brief Returns the given unit (resizes unit table if necessary)
+	AAIHeadlessUnit& Unit(int unitId);
+
+	//! @brief Removes the given unit (i.e. it does not exist anymore)
+	void RemoveUnit(int unitId);
+
+	//! @brief Returns the id of a unit that does not exist (-1 if max number of units has been reached)
+	int GetFreeUnitId() const;
+
+	void SetCurrentFrame(int frame) { m_currentFrame = frame; }
+
+	Resources& GetResources() { return m_resources; }
+
+	//! @brief Returns the LOS map (xMapSize/losMapResolution * yMapSize/losMapResolution values, non zero if within LOS)
+	std::vector<int>& LosMap() { return m_losMap; }
+
+	//! @brief Returns the radar map (xMapSize/radarMapResolution * yMapSize/radarMapResolution values, non zero if covered)
+	std::vector<int>& RadarMap() { return m_radarMap; }
+
+	//! @brief Copies the LOS map to the given buffer (if not nullptr) and returns its size (called via the C callback)
+	virtual int GetLosMapValues(int* values, int values_sizeMax);
+
+	//! @brief Copies the radar map to the given buffer (if not nullptr) and returns its size (called via the C callback)
+	virtual int GetRadarMapValues(int* values, int values_sizeMax);
+
+	//! Enemy units within LOS/radar coverage (answers to GetEnemyUnits(), GetEnemyUnitsInRadarAndLos())
+	std::vector<int>& EnemyUnitsInLOS()         { return m_enemyUnitsInLOS; }
+	std::vector<int>& EnemyUnitsInRadarAndLOS() { return m_enemyUnitsInRadarAndLOS; }
+
+	//! @brief Returns the orders given by AAI since the last call (and clears the list)
+	std::vector<AAIHeadlessOrder> TakeOrders();
+
+	//! @brief Returns the number of orders given by AAI in total
+	int GetNumberOfOrders() const { return m_numberOfOrders; }
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// IAICallback (the part used by AAI)
+	//-----------------------------------------------------------------------------------------------------------------
+	int GetCurrentFrame() override { return m_currentFrame; }
+	int GetMyTeam() override       { return m_gameSetup.team; }
+	int GetMyAllyTeam() override   { return m_gameSetup.allyTeam; }
+	int GetMaxUnits() override     { return m_gameSetup.maxUnits; }
+
+	int GetTeamAllyTeam(int team) override;
+	bool IsAllied(int firstAllyTeamId, int secondAllyTeamId) override;
+
+	const char* GetModName() override      { return m_gameSetup.modName.c_str(); }
+	const char* GetModHumanName() override { return m_gameSetup.modHumanName.c_str(); }
+	const char* GetModShortName() override { return m_gameSetup.modShortName.c_str(); }
+	int         GetModHash() override      { return m_gameSetup.modHash; }
+
+	const char* GetMapName() override   { return m_gameSetup.mapName.c_str(); }
+	int         GetMapHash() override   { return m_gameSetup.mapHash; }
+	int         GetMapWidth() override  { return m_gameSetup.xMapSize; }
+	int         GetMapHeight() override { return m_gameSetup.yMapSize; }
+
+	const float*         GetHeightMap() override { return m_gameSetup.heightMap.data(); }
+	const unsigned char* GetMetalMap() override  { return m_gameSetup.metalMap.data(); }
+	int   GetLosMapResolution() override         { return m_gameSetup.losMapResolution * m_gameSetup.losMapResolution; }
+	float GetElevation(float x, float z) override;
+
+	float GetMaxMetal() const override        { return m_gameSetup.maxMetal; }
+	float GetExtractorRadius() const override { return m_gameSetup.extractorRadius; }
+	float GetMinWind() const override         { return m_gameSetup.minWind; }
+	float GetMaxWind() const override         { return m_gameSetup.maxWind; }
+	float GetTidalStrength() const override   { return m_gameSetup.tidalStrength; }
+
+	float GetMetal() override         { return m_resources.metal; }
+	float GetMetalIncome() override   { return m_resources.metalIncome; }
+	float GetMetalUsage() override    { return m_resources.metalUsage; }
+	float GetMetalStorage() override  { return m_resources.metalStorage; }
+	float GetEnergy() override        { return m_resources.energy; }
+	float GetEnergyIncome() override  { return m_resources.energyIncome; }
+	float GetEnergyUsage() override   { return m_resources.energyUsage; }
+	float GetEnergyStorage() override { return m_resources.energyStorage; }
+
+	int  GetNumUnitDefs() override { return static_cast<int>(m_unitDefs.size()); }
+	void GetUnitDefList(const springLegacyAI::UnitDef** list) override;
+	const springLegacyAI::UnitDef* GetUnitDef(const char* unitName) override;
+	const springLegacyAI::UnitDef* GetUnitDef(int unitId) override;
+
+	float3 GetUnitPos(int unitId) override;
+	float  GetUnitHealth(int unitId) override;
+	int    GetUnitTeam(int unitId) override;
+	int    GetUnitAllyTeam(int unitId) override;
+	bool   UnitBeingBuilt(int unitId) override;
+	const springLegacyAI::CCommandQueue* GetCurrentUnitCommands(int unitId) override;
+
+	int GetEnemyUnits(int* unitIds, int unitIds_max = -1) override;
+	int GetEnemyUnits(int* unitIds, const float3& pos, float radius, int unitIds_max = -1) override;
+	int GetEnemyUnitsInRadarAndLos(int* unitIds, int unitIds_max = -1) override;
+	int GetFriendlyUnits(int* unitIds, int unitIds_max = -1) override;
+
+	bool   CanBuildAt(const springLegacyAI::UnitDef* unitDef, float3 pos, int facing = 0) override;
+	float3 ClosestBuildSite(const springLegacyAI::UnitDef* unitDef, float3 pos, float searchRadius, int minDist, int facing = 0) override;
+
+	int  GiveOrder(int unitId, Command* c) override;
+	void SendTextMsg(const char* text, int zone) override;
+	bool GetValue(int valueId, void* data) override;
+
+protected:
+	//! @brief Returns true if given unit exists (and is known to the callback)
+	bool IsValidUnit(int unitId) const { return (unitId >= 0) && (unitId < static_cast<int>(m_units.size())) && m_units[unitId].IsAlive(); }
+
+	//! @brief Copies the given list of units to the buffer provided by AAI (at most unitIds_max units if unitIds_max >= 0)
+	static int CopyUnitList(const std::vector<int>& units, int* unitIds, int unitIds_max);
+
+	//! Static data of the game
+	AAIHeadlessGameSetup m_gameSetup;
+
+	//! Command queues returned for idle/busy units (copies of a queue created by the base class as command queues cannot be created directly)
+	const springLegacyAI::CCommandQueue m_emptyCommandQueue;
+	springLegacyAI::CCommandQueue       m_busyCommandQueue;
+
+private:
+	//! @brief Creates the directories of the given path (if not already existing)
+	static void CreateDirectories(const std::string& path);
+
+	const int   m_skirmishAIId;
+
+	std::string m_workDirectory;
+	std::string m_dataDirectory;
+
+	int         m_currentFrame;
+
+	Resources   m_resources;
+
+	std::vector< std::unique_ptr<springLegacyAI::UnitDef> >   m_unitDefs;
+	std::vector< std::unique_ptr<springLegacyAI::WeaponDef> > m_weaponDefs;
+
+	//! Units, accessed by unit id
+	std::vector<AAIHeadlessUnit> m_units;
+
+	std::vector<int> m_losMap;
+	std::vector<int> m_radarMap;
+
+	std::vector<int> m_enemyUnitsInLOS;
+	std::vector<int> m_enemyUnitsInRadarAndLOS;
+
+	//! Orders that have not been taken by the driver yet
+	std::vector<AAIHeadlessOrder> m_orders;
+
+	int m_numberOfOrders;
+};
+
+#endif
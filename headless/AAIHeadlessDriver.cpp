@@ -0,0 +1,179 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+// only part of the headless driver (sources of the AI library are collected recursively)
+#ifdef AAI_HEADLESS
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+
+#include "AAIHeadlessDriver.h"
+#include "../AAI.h"
+#include "../AIExport.h"
+
+//! Number of worst frames listed in the report
+static const size_t s_numberOfWorstFrames = 10;
+
+//! Id of the skirmish AI run by the driver
+static const int s_skirmishAIId = 0;
+
+const char* aiexport_getVersion()
+{
+	// AIExport.cpp (which fetches the version from the engine) is not part of the headless driver
+	return "headless";
+}
+
+AAIHeadlessDriver::AAIHeadlessDriver(const std::string& workDirectory, int mapSize, uint64_t seed, bool recordEvents) :
+	m_callback(s_skirmishAIId, workDirectory, workDirectory),
+	m_globalCallback(&m_callback),
+	m_mockGame(&m_callback, mapSize, seed, recordEvents),
+	m_currentFrame(0)
+{
+}
+
+AAIHeadlessDriver::~AAIHeadlessDriver()
+{
+	Shutdown();
+}
+
+bool AAIHeadlessDriver::Init()
+{
+	if(m_mockGame.Init() == false)
+		return false;
+
+	m_ai.reset(new AAI(s_skirmishAIId, m_callback.GetSkirmishAICallbacks()));
+	m_ai->InitAI(&m_globalCallback, m_callback.GetMyTeam());
+
+	for(const auto& event : m_mockGame.GetStartEvents())
+		DispatchEvent(*m_ai, event);
+
+	return true;
+}
+
+void AAIHeadlessDriver::RunFrames(int numberOfFrames)
+{
+	if(m_ai == nullptr)
+		return;
+
+	m_frames.reserve(m_frames.size() + numberOfFrames);
+	m_frameTimes.reserve(m_frameTimes.size() + numberOfFrames);
+
+	for(const int lastFrame = m_currentFrame + numberOfFrames; m_currentFrame < lastFrame; ++m_currentFrame)
+	{
+		m_callback.SetCurrentFrame(m_currentFrame);
+
+		// events of the frame are passed to AAI before the update (like by the engine)
+		m_events.clear();
+		m_mockGame.Update(m_currentFrame, m_events);
+		m_events.push_back(AAIHeadlessEvent(ERecordedEvent::UPDATE, m_currentFrame));
+
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		for(const auto& event : m_events)
+			DispatchEvent(*m_ai, event);
+
+		m_frames.push_back(m_currentFrame);
+		m_frameTimes.push_back( std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count() );
+	}
+}
+
+void AAIHeadlessDriver::Shutdown()
+{
+	m_ai.reset();
+}
+
+void AAIHeadlessDriver::DispatchEvent(AAI& ai, const AAIHeadlessEvent& event)
+{
+	const int* values = event.values;
+
+	switch(event.type)
+	{
+		case ERecordedEvent::UPDATE:
+			ai.Update();
+			break;
+		case ERecordedEvent::UNIT_CREATED:
+			ai.UnitCreated(values[0], values[1]);
+			break;
+		case ERecordedEvent::UNIT_FINISHED:
+			ai.UnitFinished(values[0]);
+			break;
+		case ERecordedEvent::UNIT_IDLE:
+			ai.UnitIdle(values[0]);
+			break;
+		case ERecordedEvent::UNIT_DESTROYED:
+			ai.UnitDestroyed(values[0], values[1]);
+			break;
+		case ERecordedEvent::UNIT_DAMAGED:
+			ai.UnitDamaged(values[0], values[1], 0.0f, ZeroVector);
+			break;
+		case ERecordedEvent::UNIT_MOVE_FAILED:
+			ai.UnitMoveFailed(values[0]);
+			break;
+		case ERecordedEvent::ENEMY_ENTER_LOS:
+			ai.EnemyEnterLOS(values[0]);
+			break;
+		case ERecordedEvent::ENEMY_LEAVE_LOS:
+			ai.EnemyLeaveLOS(values[0]);
+			break;
+		case ERecordedEvent::ENEMY_ENTER_RADAR:
+			ai.EnemyEnterRadar(values[0]);
+			break;
+		case ERecordedEvent::ENEMY_LEAVE_RADAR:
+			ai.EnemyLeaveRadar(values[0]);
+			break;
+		case ERecordedEvent::ENEMY_DESTROYED:
+			ai.EnemyDestroyed(values[0], values[1]);
+			break;
+		case ERecordedEvent::HANDLE_EVENT:
+		{
+			IGlobalAI::ChangeTeamEvent changeTeamEvent;
+			changeTeamEvent.unit    = values[1];
+			changeTeamEvent.oldteam = values[2];
+			changeTeamEvent.newteam = values[3];
+			ai.HandleEvent(values[0], &changeTeamEvent);
+			break;
+		}
+		default:
+			// responses of the engine are not passed to AAI
+			break;
+	}
+}
+
+void AAIHeadlessDriver::PrintFrameTimes(const std::vector<int>& frames, const std::vector<float>& frameTimes)
+{
+	if(frameTimes.empty())
+		return;
+
+	std::vector<float> sortedTimes(frameTimes);
+	std::sort(sortedTimes.begin(), sortedTimes.end());
+
+	const float percentiles[] = {0.5f, 0.9f, 0.99f, 0.999f};
+
+	printf("Time per frame (%i frames):", static_cast<int>(sortedTimes.size()));
+	for(const float percentile : percentiles)
+	{
+		const size_t index = std::min(static_cast<size_t>(percentile * static_cast<float>(sortedTimes.size())), sortedTimes.size() - 1);
+		printf("  p%g %.1f us", 100.0f * percentile, sortedTimes[index]);
+	}
+	printf("  max %.1f us\n", sortedTimes.back());
+
+	std::vector<int> indices(frameTimes.size());
+	for(size_t i = 0; i < indices.size(); ++i)
+		indices[i] = static_cast<int>(i);
+
+	const size_t numberOfWorstFrames = std::min(s_numberOfWorstFrames, indices.size());
+	std::partial_sort(indices.begin(), indices.begin() + numberOfWorstFrames, indices.end(), [&frameTimes](int lhs, int rhs) { return frameTimes[lhs] > frameTimes[rhs]; });
+
+	printf("Worst frames:\n");
+	for(size_t i = 0; i < numberOfWorstFrames; ++i)
+		printf("  frame %6i: %.1f us\n", frames[indices[i]], frameTimes[indices[i]]);
+}
+
+#endif
@@ -0,0 +1,80 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_HEADLESSDRIVER_H
+#define AAI_HEADLESSDRIVER_H
+
+#include <vector>
+#include <string>
+#include <memory>
+
+#include "AAIHeadlessCallback.h"
+#include "AAIMockGame.h"
+
+class AAI;
+
+//! @brief Runs an instance of AAI against the mock game frame by frame (used by the headless executable and the tests). The events of
+//!        every frame are passed to AAI before its update (like by the engine); the time AAI spends per frame is measured.
+class AAIHeadlessDriver
+{
+public:
+	//! @brief Config, log, and cache files are written to/read from the given work directory
+	AAIHeadlessDriver(const std::string& workDirectory, int mapSize, uint64_t seed, bool recordEvents);
+
+	~AAIHeadlessDriver();
+
+	//! @brief Sets up the mock game and initializes AAI; returns false if the mock game could not be set up
+	bool Init();
+
+	//! @brief Advances the game by the given number of frames
+	void RunFrames(int numberOfFrames);
+
+	//! @brief Destroys the instance of AAI (which writes its log, statistics, and learning files)
+	void Shutdown();
+
+	//! @brief Passes the given event to AAI
+	static void DispatchEvent(AAI& ai, const AAIHeadlessEvent& event);
+
+	//! @brief Prints percentiles of the time per frame and the worst frames (frameTimes[i] is the time spent in frames[i])
+	static void PrintFrameTimes(const std::vector<int>& frames, const std::vector<float>& frameTimes);
+
+	//! @brief Returns the instance of AAI (nullptr if not initialized or already shut down)
+	AAI* GetAI() { return m_ai.get(); }
+
+	AAIHeadlessCallback& GetCallback() { return m_callback; }
+
+	AAIMockGame& GetMockGame() { return m_mockGame; }
+
+	//! @brief Returns the next frame to be processed
+	int GetCurrentFrame() const { return m_currentFrame; }
+
+	//! @brief Returns the processed frames and the time (in microseconds) AAI spent in every one of them
+	const std::vector<int>&   GetFrames() const     { return m_frames; }
+	const std::vector<float>& GetFrameTimes() const { return m_frameTimes; }
+
+private:
+	AAIHeadlessCallback                 m_callback;
+
+	AAIHeadlessCallback::GlobalCallback m_globalCallback;
+
+	AAIMockGame                         m_mockGame;
+
+	std::unique_ptr<AAI>                m_ai;
+
+	int                                 m_currentFrame;
+
+	std::vector<int>                    m_frames;
+
+	std::vector<float>                  m_frameTimes;
+
+	//! Events of the current frame (buffer reused every frame)
+	std::vector<AAIHeadlessEvent>       m_events;
+};
+
+#endif
@@ -0,0 +1,139 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+// only part of the headless driver (sources of the AI library are collected recursively)
+#ifdef AAI_HEADLESS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "AAIHeadlessDriver.h"
+#include "AAIReplayCallback.h"
+#include "../AAI.h"
+
+static void PrintUsage()
+{
+	printf("Usage: AAIHeadless [--frames <number>] [--map-size <map tiles>] [--seed <number>] [--record] [--work <directory>]\n");
+	printf("  Runs AAI against a mock game (config, log, and cache files are written to the work directory; --record: AAI records the game)\n");
+	printf("       AAIHeadless --replay <recording> [--data <directory>] [--work <directory>]\n");
+	printf("  Replays a game recorded by AAI (config files not present in the work directory are read from the data directory)\n");
+}
+
+//! @brief Runs AAI against the mock game for the given number of frames
+static int RunMockGame(int numberOfFrames, int mapSize, uint64_t seed, bool recordEvents, const std::string& workDirectory)
+{
+	AAIHeadlessDriver driver(workDirectory, mapSize, seed, recordEvents);
+
+	if(driver.Init() == false)
+		return 1;
+
+	driver.RunFrames(numberOfFrames);
+
+	// AAI writes its log, statistics, and learning files when being destroyed
+	driver.Shutdown();
+
+	printf("%i orders given by AAI\n", driver.GetCallback().GetNumberOfOrders());
+	AAIHeadlessDriver::PrintFrameTimes(driver.GetFrames(), driver.GetFrameTimes());
+	return 0;
+}
+
+//! @brief Passes the events of the given recording to AAI (queries of AAI are answered with the recorded responses)
+static int RunReplay(const std::string& recording, const std::string& workDirectory, const std::string& dataDirectory)
+{
+	const int skirmishAIId(0);
+
+	AAIReplayCallback callback(skirmishAIId, workDirectory, dataDirectory);
+	AAIHeadlessCallback::GlobalCallback globalCallback(&callback);
+
+	if( (callback.Load(recording) == false) || (callback.WriteGeneralConfig() == false) )
+		return 1;
+
+	std::vector<int>   frames;
+	std::vector<float> frameTimes;
+
+	{
+		AAI ai(skirmishAIId, callback.GetSkirmishAICallbacks());
+		ai.InitAI(&globalCallback, callback.GetMyTeam());
+
+		// time of the events received since the last update is added to the time of the next update
+		float time(0.0f);
+
+		for(const auto& event : callback.GetEvents())
+		{
+			if(event.type == ERecordedEvent::UPDATE)
+				callback.SetCurrentFrame(event.values[0]);
+
+			const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+			AAIHeadlessDriver::DispatchEvent(ai, event);
+
+			time += std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+			if(event.type == ERecordedEvent::UPDATE)
+			{
+				frames.push_back(event.values[0]);
+				frameTimes.push_back(time);
+				time = 0.0f;
+			}
+		}
+	}
+
+	printf("%i orders given by AAI, %i queries not matching the recording, %i recorded responses not used\n",
+			callback.GetNumberOfGivenOrders(), callback.GetNumberOfMismatches(), callback.GetNumberOfUnusedResponses());
+	AAIHeadlessDriver::PrintFrameTimes(frames, frameTimes);
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	int         numberOfFrames(9000);
+	int         mapSize(512);
+	uint64_t    seed(1u);
+	bool        recordEvents(false);
+	std::string workDirectory("aai_headless");
+	std::string dataDirectory;
+	std::string recording;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		const bool valueGiven = (i + 1 < argc);
+
+		if( (strcmp(argv[i], "--frames") == 0) && valueGiven )
+			numberOfFrames = std::max(1, atoi(argv[++i]));
+		else if( (strcmp(argv[i], "--map-size") == 0) && valueGiven )
+			mapSize = std::max(64, atoi(argv[++i]) / 64 * 64); // map size must be a multiple of the LOS/radar map resolution
+		else if( (strcmp(argv[i], "--seed") == 0) && valueGiven )
+			seed = strtoull(argv[++i], nullptr, 10);
+		else if(strcmp(argv[i], "--record") == 0)
+			recordEvents = true;
+		else if( (strcmp(argv[i], "--work") == 0) && valueGiven )
+			workDirectory = argv[++i];
+		else if( (strcmp(argv[i], "--data") == 0) && valueGiven )
+			dataDirectory = argv[++i];
+		else if( (strcmp(argv[i], "--replay") == 0) && valueGiven )
+			recording = argv[++i];
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if(recording.empty() == false)
+		return RunReplay(recording, workDirectory, dataDirectory.empty() ? workDirectory : dataDirectory);
+	else
+		return RunMockGame(numberOfFrames, mapSize, seed, recordEvents, workDirectory);
+}
+
+#endif
@@ -0,0 +1,998 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+// only part of the headless driver (sources of the AI library are collected recursively)
+#ifdef AAI_HEADLESS
+
+#include <stdio.h>
+#include <cmath>
+#include <algorithm>
+#include <initializer_list>
+
+#include "AAIMockGame.h"
+
+#include "Sim/Misc/GlobalConstants.h"
+#include "Sim/Units/CommandAI/Command.h"
+
+//! Team of the enemy units
+static const int s_enemyTeam = 1;
+
+//! Number of frames between two updates of LOS/radar coverage
+static const int s_sensorUpdateInterval = 15;
+
+//! Number of frames between two waves of enemy units (first wave after two intervals)
+static const int s_enemyWaveInterval = 3 * 60 * GAME_SPEED;
+
+//! Max number of units per wave of enemy units
+static const int s_maxUnitsPerEnemyWave = 10;
+
+//! Max distance (in elmos) between a mobile constructor and the site of the building it constructs
+static const float s_buildDistance = 128.0f;
+
+//! Metal/energy storage of a team without any storage buildings
+static const float s_baseStorage = 1000.0f;
+
+//! Constructions progress at this fraction of the build power if metal or energy has run out
+static const float s_stallingFactor = 0.25f;
+
+//! @brief Sets the properties common to all unit definitions of the mock mod
+static void InitUnitDef(springLegacyAI::UnitDef* unitDef, float metalCost, float energyCost, float buildTime, float health, int size, float losRadius)
+{
+	unitDef->metalCost  = metalCost;
+	unitDef->energyCost = energyCost;
+	unitDef->buildTime  = buildTime;
+	unitDef->health     = health;
+	unitDef->xsize      = size;
+	unitDef->zsize      = size;
+	unitDef->losRadius  = losRadius;
+	unitDef->category   = 1u;
+}
+
+//! @brief Creates a weapon definition with the given range and damage (per shot, one shot per second)
+static const springLegacyAI::WeaponDef* CreateWeaponDef(AAIHeadlessCallback* callback, const char* name, float range, float damage)
+{
+	springLegacyAI::WeaponDef* weaponDef = callback->AddWeaponDef(name);
+	weaponDef->range   = range;
+	weaponDef->reload  = 1.0f;
+	weaponDef->damages = springLegacyAI::DamageArray(1, &damage);
+	return weaponDef;
+}
+
+//! @brief Adds the given weapon to the unit definition (able to target all unit categories)
+static void AddWeapon(springLegacyAI::UnitDef* unitDef, const springLegacyAI::WeaponDef* weaponDef)
+{
+	springLegacyAI::UnitDef::UnitDefWeapon weapon;
+	weapon.name          = weaponDef->name;
+	weapon.def           = weaponDef;
+	weapon.slavedTo      = 0;
+	weapon.badTargetCat  = 0u;
+	weapon.onlyTargetCat = 0xFFFFFFFFu;
+	unitDef->weapons.push_back(weapon);
+}
+
+//! @brief Sets the build options of the given unit definition
+static void SetBuildOptions(springLegacyAI::UnitDef* unitDef, std::initializer_list<const char*> unitNames)
+{
+	unitDef->builder = true;
+
+	int index(0);
+	for(const char* unitName : unitNames)
+		unitDef->buildOptions[index++] = unitName;
+}
+
+//! @brief Increases the coverage of all tiles of the given map within the given radius around the position
+static void AddCoverage(std::vector<int>& map, int xSize, int ySize, int tileSize, const float3& position, float radius)
+{
+	const int xCenter = static_cast<int>(position.x) / tileSize;
+	const int yCenter = static_cast<int>(position.z) / tileSize;
+	const int range   = static_cast<int>(radius) / tileSize;
+
+	for(int y = std::max(0, yCenter - range); y <= std::min(ySize-1, yCenter + range); ++y)
+	{
+		for(int x = std::max(0, xCenter - range); x <= std::min(xSize-1, xCenter + range); ++x)
+		{
+			if( (x-xCenter)*(x-xCenter) + (y-yCenter)*(y-yCenter) <= range*range )
+				++map[x + y * xSize];
+		}
+	}
+}
+
+AAIMockGame::AAIMockGame(AAIHeadlessCallback* callback, int mapSize, uint64_t seed, bool recordEvents) :
+	m_callback(callback),
+	m_mapSize(mapSize),
+	m_recordEvents(recordEvents),
+	m_frameTimeBudget(2000),
+	m_currentFrame(0),
+	m_commanderId(-1),
+	m_metalUsed(0.0f),
+	m_energyUsed(0.0f)
+{
+	m_random.Seed(seed);
+}
+
+bool AAIMockGame::Init()
+{
+	AAIHeadlessGameSetup gameSetup;
+	gameSetup.team            = 0;
+	gameSetup.allyTeam        = 0;
+	gameSetup.xMapSize        = m_mapSize;
+	gameSetup.yMapSize        = m_mapSize;
+	gameSetup.mapName         = "AAIHeadlessMap" + std::to_string(m_mapSize);
+	gameSetup.mapHash         = m_mapSize;
+	gameSetup.modName         = "AAI Headless Mod";
+	gameSetup.modHumanName    = "AAIHeadlessMod";
+	gameSetup.modShortName    = "AAIHM";
+	gameSetup.modHash         = 1;
+	gameSetup.extractorRadius = 80.0f;
+	gameSetup.maxMetal        = 1.0f;
+	gameSetup.minWind         = 5.0f;
+	gameSetup.maxWind         = 20.0f;
+	gameSetup.tidalStrength   = 15.0f;
+	CreateMap(gameSetup);
+
+	m_callback->SetGameSetup(gameSetup);
+	CreateUnitDefs();
+
+	m_enemyInLOS.assign(gameSetup.maxUnits, false);
+	m_enemyInRadar.assign(gameSetup.maxUnits, false);
+
+	AAIHeadlessCallback::Resources& resources = m_callback->GetResources();
+	resources.metal         = s_baseStorage;
+	resources.metalStorage  = s_baseStorage;
+	resources.energy        = s_baseStorage;
+	resources.energyStorage = s_baseStorage;
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// start units: commander of AAI and enemy base in the opposite corner
+	//-----------------------------------------------------------------------------------------------------------------
+	const float mapSizeInElmos = static_cast<float>(m_mapSize * SQUARE_SIZE);
+	m_startPosition     = float3(0.2f * mapSizeInElmos, 0.0f, 0.2f * mapSizeInElmos);
+	m_enemyBasePosition = float3(0.8f * mapSizeInElmos, 0.0f, 0.8f * mapSizeInElmos);
+
+	m_commanderId = AddUnit(m_commander, gameSetup.team, m_startPosition, false);
+
+	AddUnit(m_commander, s_enemyTeam, m_enemyBasePosition, false);
+	AddUnit(m_factory,   s_enemyTeam, m_enemyBasePosition + float3(-160.0f, 0.0f,    0.0f), false);
+	AddUnit(m_tower,     s_enemyTeam, m_enemyBasePosition + float3(-240.0f, 0.0f, -240.0f), false);
+	AddUnit(m_tower,     s_enemyTeam, m_enemyBasePosition + float3(   0.0f, 0.0f, -320.0f), false);
+
+	for(int i = 0; i < 3; ++i)
+		AddUnit(m_tank, s_enemyTeam, m_enemyBasePosition + float3(-80.0f * static_cast<float>(i), 0.0f, 160.0f), false);
+
+	return WriteConfigFiles();
+}
+
+std::vector<AAIHeadlessEvent> AAIMockGame::GetStartEvents() const
+{
+	std::vector<AAIHeadlessEvent> events;
+	events.push_back(AAIHeadlessEvent(ERecordedEvent::UNIT_CREATED, m_commanderId, -1));
+	events.push_back(AAIHeadlessEvent(ERecordedEvent::UNIT_FINISHED, m_commanderId));
+	return events;
+}
+
+void AAIMockGame::Update(int frame, std::vector<AAIHeadlessEvent>& events)
+{
+	m_currentFrame = frame;
+
+	for(const int unitId : m_destroyedUnits)
+		m_callback->RemoveUnit(unitId);
+
+	m_destroyedUnits.clear();
+
+	for(const auto& order : m_callback->TakeOrders())
+		ProcessOrder(order, events);
+
+	UpdateConstructions(events);
+	UpdateMovements(events);
+
+	if(frame % GAME_SPEED == 0)
+	{
+		UpdateResources();
+		UpdateCombat(events);
+	}
+
+	if(frame % s_sensorUpdateInterval == 0)
+		UpdateSensors(events);
+
+	if( (frame > 0) && (frame % s_enemyWaveInterval == 0) && (frame / s_enemyWaveInterval >= 2) )
+		SpawnEnemyWave();
+}
+
+void AAIMockGame::CreateUnitDefs()
+{
+	const springLegacyAI::WeaponDef* commanderLaser = CreateWeaponDef(m_callback, "hcomlaser",  300.0f, 60.0f);
+	const springLegacyAI::WeaponDef* towerLaser     = CreateWeaponDef(m_callback, "htowerlaser", 450.0f, 40.0f);
+	const springLegacyAI::WeaponDef* cannon         = CreateWeaponDef(m_callback, "hcannon",    350.0f, 30.0f);
+	const springLegacyAI::WeaponDef* machineGun     = CreateWeaponDef(m_callback, "hgun",       200.0f,  5.0f);
+
+	springLegacyAI::UnitDef* commander = m_callback->AddUnitDef("hcom");
+	InitUnitDef(commander, 2500.0f, 25000.0f, 75000.0f, 3000.0f, 2, 450.0f);
+	AAIHeadlessCallback::SetMoveData(commander, springLegacyAI::MoveData::Tank, 20.0f, false);
+	commander->speed        = 40.0f;
+	commander->buildSpeed   = 300.0f;
+	commander->buildDistance = s_buildDistance;
+	commander->canAssist    = true;
+	commander->canRepair    = true;
+	commander->canReclaim   = true;
+	commander->isCommander  = true;
+	commander->metalMake    = 1.5f;
+	commander->energyMake   = 25.0f;
+	AddWeapon(commander, commanderLaser);
+	SetBuildOptions(commander, {"hmex", "hsolar", "hlab", "hllt", "hradar", "hstorage"});
+	m_commander = commander->id;
+
+	springLegacyAI::UnitDef* constructor = m_callback->AddUnitDef("hcon");
+	InitUnitDef(constructor, 120.0f, 1500.0f, 4000.0f, 600.0f, 3, 300.0f);
+	AAIHeadlessCallback::SetMoveData(constructor, springLegacyAI::MoveData::Tank, 20.0f, false);
+	constructor->speed         = 60.0f;
+	constructor->buildSpeed    = 100.0f;
+	constructor->buildDistance = s_buildDistance;
+	constructor->canAssist     = true;
+	constructor->canRepair     = true;
+	constructor->canReclaim    = true;
+	SetBuildOptions(constructor, {"hmex", "hsolar", "hlab", "hllt", "hradar", "hstorage", "hnano"});
+	m_constructor = constructor->id;
+
+	springLegacyAI::UnitDef* factory = m_callback->AddUnitDef("hlab");
+	InitUnitDef(factory, 600.0f, 1200.0f, 6500.0f, 3000.0f, 6, 200.0f);
+	factory->buildSpeed = 150.0f;
+	SetBuildOptions(factory, {"hcon", "htank", "hscout"});
+	m_factory = factory->id;
+
+	springLegacyAI::UnitDef* extractor = m_callback->AddUnitDef("hmex");
+	InitUnitDef(extractor, 50.0f, 500.0f, 1800.0f, 300.0f, 3, 150.0f);
+	extractor->extractsMetal = 0.001f;
+	m_extractor = extractor->id;
+
+	springLegacyAI::UnitDef* solar = m_callback->AddUnitDef("hsolar");
+	InitUnitDef(solar, 150.0f, 0.0f, 2800.0f, 500.0f, 4, 150.0f);
+	solar->energyMake = 20.0f;
+	m_solar = solar->id;
+
+	springLegacyAI::UnitDef* storage = m_callback->AddUnitDef("hstorage");
+	InitUnitDef(storage, 200.0f, 500.0f, 3000.0f, 1000.0f, 4, 150.0f);
+	storage->metalStorage  = 1000.0f;
+	storage->energyStorage = 3000.0f;
+	m_storage = storage->id;
+
+	springLegacyAI::UnitDef* radar = m_callback->AddUnitDef("hradar");
+	InitUnitDef(radar, 50.0f, 500.0f, 1000.0f, 200.0f, 2, 400.0f);
+	radar->radarRadius = 2000.0f;
+	m_radar = radar->id;
+
+	springLegacyAI::UnitDef* tower = m_callback->AddUnitDef("hllt");
+	InitUnitDef(tower, 90.0f, 800.0f, 2500.0f, 700.0f, 2, 500.0f);
+	AddWeapon(tower, towerLaser);
+	m_tower = tower->id;
+
+	springLegacyAI::UnitDef* nanoTurret = m_callback->AddUnitDef("hnano");
+	InitUnitDef(nanoTurret, 200.0f, 2500.0f, 5000.0f, 500.0f, 3, 300.0f);
+	nanoTurret->buildSpeed    = 200.0f;
+	nanoTurret->buildDistance = 400.0f;
+	nanoTurret->canAssist     = true;
+	nanoTurret->canRepair     = true;
+	m_nanoTurret = nanoTurret->id;
+
+	springLegacyAI::UnitDef* tank = m_callback->AddUnitDef("htank");
+	InitUnitDef(tank, 150.0f, 1500.0f, 3000.0f, 1000.0f, 3, 350.0f);
+	AAIHeadlessCallback::SetMoveData(tank, springLegacyAI::MoveData::Tank, 20.0f, false);
+	tank->speed = 60.0f;
+	AddWeapon(tank, cannon);
+	m_tank = tank->id;
+
+	springLegacyAI::UnitDef* scout = m_callback->AddUnitDef("hscout");
+	InitUnitDef(scout, 40.0f, 400.0f, 1000.0f, 200.0f, 2, 500.0f);
+	AAIHeadlessCallback::SetMoveData(scout, springLegacyAI::MoveData::Tank, 20.0f, false);
+	scout->speed = 150.0f;
+	AddWeapon(scout, machineGun);
+	m_scout = scout->id;
+}
+
+void AAIMockGame::CreateMap(AAIHeadlessGameSetup& gameSetup)
+{
+	//-----------------------------------------------------------------------------------------------------------------
+	// height map: rolling hills with a lake (away from both start positions)
+	//-----------------------------------------------------------------------------------------------------------------
+	const float lakeX      = 0.3f  * static_cast<float>(m_mapSize);
+	const float lakeY      = 0.75f * static_cast<float>(m_mapSize);
+	const float lakeRadius = 0.12f * static_cast<float>(m_mapSize);
+
+	gameSetup.heightMap.resize(m_mapSize * m_mapSize);
+
+	for(int y = 0; y < m_mapSize; ++y)
+	{
+		for(int x = 0; x < m_mapSize; ++x)
+		{
+			float height = 60.0f + 40.0f * std::sin(0.03f * static_cast<float>(x)) * std::cos(0.02f * static_cast<float>(y))
+			                     + 20.0f * std::sin(0.011f * static_cast<float>(x + y));
+
+			const float distanceToLake = std::sqrt( (static_cast<float>(x) - lakeX) * (static_cast<float>(x) - lakeX) + (static_cast<float>(y) - lakeY) * (static_cast<float>(y) - lakeY) );
+
+			if(distanceToLake < lakeRadius)
+				height -= 200.0f * (1.0f - distanceToLake / lakeRadius);
+
+			gameSetup.heightMap[x + y * m_mapSize] = height;
+		}
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// metal map: spots (3x3 metal map tiles) on a jittered grid (on land only)
+	//-----------------------------------------------------------------------------------------------------------------
+	const int metalMapSize = m_mapSize / 2;
+	const int spotDistance = 24;
+
+	gameSetup.metalMap.assign(metalMapSize * metalMapSize, 0);
+
+	for(int y = spotDistance / 2; y < metalMapSize - 2; y += spotDistance)
+	{
+		for(int x = spotDistance / 2; x < metalMapSize - 2; x += spotDistance)
+		{
+			const int xSpot = std::max(1, std::min(x + m_random.NextInt(9) - 4, metalMapSize - 2));
+			const int ySpot = std::max(1, std::min(y + m_random.NextInt(9) - 4, metalMapSize - 2));
+
+			if(gameSetup.heightMap[2 * xSpot + 2 * ySpot * m_mapSize] <= 0.0f)
+				continue;
+
+			for(int yTile = ySpot - 1; yTile <= ySpot + 1; ++yTile)
+			{
+				for(int xTile = xSpot - 1; xTile <= xSpot + 1; ++xTile)
+					gameSetup.metalMap[xTile + yTile * metalMapSize] = 200;
+			}
+		}
+	}
+}
+
+bool AAIMockGame::WriteConfigFiles()
+{
+	//-----------------------------------------------------------------------------------------------------------------
+	// mod config (file name determined like by AAIConfig)
+	//-----------------------------------------------------------------------------------------------------------------
+	char filename[2048];
+	snprintf(filename, sizeof(filename), "cfg/mod/%s.cfg", m_callback->GetModHumanName());
+	m_callback->GetValue(AIVAL_LOCATE_FILE_W, filename);
+
+	FILE* file = fopen(filename, "w");
+
+	if(file == nullptr)
+	{
+		printf("Unable to write mod config %s\n", filename);
+		return false;
+	}
+
+	fprintf(file, "SIDES 1\nSTART_UNITS hcom\nSIDE_NAMES Mock\n");
+	fprintf(file, "MAX_SCOUTS 2\nMAX_BUILDERS 10\nMAX_BUILDERS_PER_TYPE 4\nMAX_FACTORIES_PER_TYPE 2\n");
+	fprintf(file, "MAX_GROUP_SIZE 8\nMAX_AIR_GROUP_SIZE 4\nMAX_BASE_SIZE 10\n");
+	fprintf(file, "SCOUT_SPEED 120.0\nSEA_ARTY_RANGE 1300.0\nSTATIONARY_ARTY_RANGE 1500.0\nMAX_STAT_ARTY 2\n");
+	fprintf(file, "MIN_ENERGY 18\nMAX_DEFENCES 6\nMETAL_ENERGY_RATIO 25\nMAX_METAL_MAKERS 0\n");
+	fprintf(file, "MAX_MEX_DISTANCE 8\nMAX_MEX_DEFENCE_DISTANCE 7\nNON_AMPHIB_MAX_WATERDEPTH 22\n");
+	fclose(file);
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// general config (random seed of AAI derived from seed of the game)
+	//-----------------------------------------------------------------------------------------------------------------
+	snprintf(filename, sizeof(filename), "cfg/general.cfg");
+	m_callback->GetValue(AIVAL_LOCATE_FILE_W, filename);
+
+	file = fopen(filename, "w");
+
+	if(file == nullptr)
+	{
+		printf("Unable to write general config %s\n", filename);
+		return false;
+	}
+
+	fprintf(file, "LEARN_RATE 5\nWATER_MAP_RATIO 0.7\nLAND_WATER_MAP_RATIO 0.3\nTERRAIN_DETECTION_RANGE 6\n");
+	fprintf(file, "MAP_ANALYSIS_THREADS 0\nFRAME_TIME_BUDGET %i\nRECORD_EVENTS %i\nLOG_LEVEL 1\n", m_frameTimeBudget, m_recordEvents ? 1 : 0);
+	fprintf(file, "PROFILER_SPIKE_THRESHOLD 20000\nEXPORT_CONTINENT_MAP 0\nRANDOM_SEED %i\n", 1 + m_random.NextInt(1 << 30));
+	fclose(file);
+
+	return true;
+}
+
+int AAIMockGame::AddUnit(int unitDefId, int team, const float3& position, bool beingBuilt)
+{
+	const int unitId = m_callback->GetFreeUnitId();
+
+	if(unitId < 0)
+		return -1;
+
+	const springLegacyAI::UnitDef* unitDef = m_callback->GetUnitDefWithId(unitDefId);
+
+	AAIHeadlessUnit& unit = m_callback->Unit(unitId);
+	unit.unitDefId        = unitDefId;
+	unit.position         = float3(position.x, m_callback->GetElevation(position.x, position.z), position.z);
+	unit.health           = beingBuilt ? 1.0f : unitDef->health;
+	unit.team             = team;
+	unit.beingBuilt       = beingBuilt;
+	unit.numberOfCommands = 0;
+	return unitId;
+}
+
+void AAIMockGame::ProcessOrder(const AAIHeadlessOrder& order, std::vector<AAIHeadlessEvent>& events)
+{
+	if(IsActive(order.unitId) == false)
+		return;
+
+	AAIHeadlessUnit& unit = m_callback->Unit(order.unitId);
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// build orders: queued by factories, replace current order of mobile constructors
+	//-----------------------------------------------------------------------------------------------------------------
+	if(order.commandId < 0)
+	{
+		const springLegacyAI::UnitDef* constructedUnitDef = m_callback->GetUnitDefWithId(-order.commandId);
+		const springLegacyAI::UnitDef* builderDef         = GetUnitDef(order.unitId);
+
+		if(constructedUnitDef == nullptr)
+			return;
+
+		Construction construction;
+		construction.unitId    = -1;
+		construction.builderId = order.unitId;
+		construction.unitDefId = constructedUnitDef->id;
+		construction.progress  = 0.0f;
+
+		if(IsStatic(builderDef))
+			construction.position = unit.position + float3(0.0f, 0.0f, static_cast<float>((builderDef->zsize / 2 + 3) * SQUARE_SIZE));
+		else
+		{
+			ClearOrders(order.unitId);
+
+			if(order.params.size() < 3)
+			{
+				SetIdle(order.unitId, events);
+				return;
+			}
+
+			construction.position = float3(order.params[0], order.params[1], order.params[2]);
+		}
+
+		m_constructions.push_back(construction);
+		return;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// other orders replace the current order of the unit
+	//-----------------------------------------------------------------------------------------------------------------
+	ClearOrders(order.unitId);
+
+	switch(order.commandId)
+	{
+		case CMD_STOP:
+			break;
+		case CMD_GUARD:
+		case CMD_REPAIR:
+			if(order.params.size() >= 1)
+			{
+				Assistance assistance;
+				assistance.unitId   = order.unitId;
+				assistance.targetId = static_cast<int>(order.params[0]);
+				m_assistances.push_back(assistance);
+			}
+			break;
+		case CMD_ATTACK:
+		case CMD_MOVE:
+		case CMD_FIGHT:
+		case CMD_PATROL:
+		{
+			Movement movement;
+			movement.unitId = order.unitId;
+
+			if(order.params.size() >= 3)
+				movement.destination = float3(order.params[0], order.params[1], order.params[2]);
+			else if( (order.params.size() == 1) && IsActive(static_cast<int>(order.params[0])) )
+				movement.destination = m_callback->Unit(static_cast<int>(order.params[0])).position;
+			else
+				movement.destination = unit.position;
+
+			m_movements.push_back(movement);
+			break;
+		}
+		default:
+		{
+			// orders that are not simulated (reclaim, resurrect, ...) are finished in the next frame
+			Movement movement;
+			movement.unitId      = order.unitId;
+			movement.destination = unit.position;
+			m_movements.push_back(movement);
+			break;
+		}
+	}
+}
+
+void AAIMockGame::ClearOrders(int unitId)
+{
+	m_movements.erase(std::remove_if(m_movements.begin(), m_movements.end(), [unitId](const Movement& movement) { return movement.unitId == unitId; }), m_movements.end());
+	m_assistances.erase(std::remove_if(m_assistances.begin(), m_assistances.end(), [unitId](const Assistance& assistance) { return assistance.unitId == unitId; }), m_assistances.end());
+
+	// constructions that have not been started yet are dropped, the others remain unfinished until assisted
+	m_constructions.erase(std::remove_if(m_constructions.begin(), m_constructions.end(),
+									[unitId](const Construction& construction) { return (construction.builderId == unitId) && (construction.unitId < 0); }), m_constructions.end());
+
+	for(auto& construction : m_constructions)
+	{
+		if(construction.builderId == unitId)
+			construction.builderId = -1;
+	}
+}
+
+void AAIMockGame::UpdateConstructions(std::vector<AAIHeadlessEvent>& events)
+{
+	const AAIHeadlessCallback::Resources& resources = m_callback->GetResources();
+	const bool stalling = (resources.metal <= 0.0f) || (resources.energy <= 0.0f);
+
+	// only the first construction of every builder is carried out, following ones are queued (in factories)
+	std::vector<int> activeBuilders;
+
+	for(size_t i = 0; i < m_constructions.size(); )
+	{
+		Construction& construction = m_constructions[i];
+
+		if(construction.builderId >= 0)
+		{
+			if(std::find(activeBuilders.begin(), activeBuilders.end(), construction.builderId) != activeBuilders.end())
+			{
+				++i;
+				continue;
+			}
+
+			activeBuilders.push_back(construction.builderId);
+		}
+
+		const springLegacyAI::UnitDef* unitDef = m_callback->GetUnitDefWithId(construction.unitDefId);
+
+		//-----------------------------------------------------------------------------------------------------------------
+		// start construction when builder has reached the build site
+		//-----------------------------------------------------------------------------------------------------------------
+		if(construction.unitId < 0)
+		{
+			const springLegacyAI::UnitDef* builderDef = GetUnitDef(construction.builderId);
+
+			if( (IsStatic(builderDef) == false) && (m_callback->Unit(construction.builderId).position.distance2D(construction.position) > s_buildDistance) )
+			{
+				MoveUnit(construction.builderId, construction.position);
+				++i;
+				continue;
+			}
+
+			if(IsStatic(unitDef) && (m_callback->CanBuildAt(unitDef, construction.position) == false))
+			{
+				const int builderId = construction.builderId;
+				m_constructions.erase(m_constructions.begin() + i);
+				SetIdle(builderId, events);
+				continue;
+			}
+
+			construction.unitId = AddUnit(construction.unitDefId, m_callback->Unit(construction.builderId).team, construction.position, true);
+
+			if(construction.unitId < 0)
+			{
+				const int builderId = construction.builderId;
+				m_constructions.erase(m_constructions.begin() + i);
+				SetIdle(builderId, events);
+				continue;
+			}
+
+			events.push_back(AAIHeadlessEvent(ERecordedEvent::UNIT_CREATED, construction.unitId, construction.builderId));
+		}
+
+		//-----------------------------------------------------------------------------------------------------------------
+		// progress depends on build power of builder and assisting units
+		//-----------------------------------------------------------------------------------------------------------------
+		float buildPower = (construction.builderId >= 0) ? GetUnitDef(construction.builderId)->buildSpeed : 0.0f;
+
+		for(const auto& assistance : m_assistances)
+		{
+			if( (assistance.targetId == construction.unitId) || ((construction.builderId >= 0) && (assistance.targetId == construction.builderId)) )
+				buildPower += GetUnitDef(assistance.unitId)->buildSpeed;
+		}
+
+		float progress = buildPower / (unitDef->buildTime * static_cast<float>(GAME_SPEED));
+
+		if(stalling)
+			progress *= s_stallingFactor;
+
+		progress = std::min(progress, 1.0f - construction.progress);
+
+		construction.progress += progress;
+		m_metalUsed           += progress * unitDef->metalCost;
+		m_energyUsed          += progress * unitDef->energyCost;
+
+		AAIHeadlessUnit& unit = m_callback->Unit(construction.unitId);
+		unit.health = std::max(1.0f, construction.progress * unitDef->health);
+
+		if(construction.progress < 0.99999f)
+		{
+			++i;
+			continue;
+		}
+
+		//-----------------------------------------------------------------------------------------------------------------
+		// construction finished: new unit, builder (if nothing else queued), and repairing units become idle
+		//-----------------------------------------------------------------------------------------------------------------
+		const int unitId    = construction.unitId;
+		const int builderId = construction.builderId;
+
+		unit.beingBuilt = false;
+		unit.health     = unitDef->health;
+
+		m_constructions.erase(m_constructions.begin() + i);
+
+		events.push_back(AAIHeadlessEvent(ERecordedEvent::UNIT_FINISHED, unitId));
+
+		if( (IsStatic(unitDef) == false) || (unitDef->buildOptions.empty() == false) )
+			SetIdle(unitId, events);
+
+		if( (builderId >= 0) && std::none_of(m_constructions.begin(), m_constructions.end(), [builderId](const Construction& c) { return c.builderId == builderId; }) )
+			SetIdle(builderId, events);
+
+		for(auto assistance = m_assistances.begin(); assistance != m_assistances.end(); )
+		{
+			if(assistance->targetId == unitId)
+			{
+				SetIdle(assistance->unitId, events);
+				assistance = m_assistances.erase(assistance);
+			}
+			else
+				++assistance;
+		}
+	}
+}
+
+void AAIMockGame::UpdateMovements(std::vector<AAIHeadlessEvent>& events)
+{
+	for(size_t i = 0; i < m_movements.size(); )
+	{
+		const int unitId = m_movements[i].unitId;
+		const springLegacyAI::UnitDef* unitDef = GetUnitDef(unitId);
+
+		if(MoveUnit(unitId, m_movements[i].destination))
+		{
+			m_movements.erase(m_movements.begin() + i);
+			SetIdle(unitId, events);
+		}
+		// ground units cannot enter deep water
+		else if( (unitDef->movedata != nullptr) && (unitDef->movedata->moveFamily != springLegacyAI::MoveData::Hover) && (unitDef->movedata->moveFamily != springLegacyAI::MoveData::Ship)
+			  && (m_callback->Unit(unitId).position.y < -unitDef->movedata->depth) )
+		{
+			AAIHeadlessUnit& unit = m_callback->Unit(unitId);
+			unit.position.y       = m_callback->GetElevation(unit.position.x, unit.position.z);
+			unit.numberOfCommands = 0;
+
+			m_movements.erase(m_movements.begin() + i);
+
+			if(IsOwnUnit(unitId))
+				events.push_back(AAIHeadlessEvent(ERecordedEvent::UNIT_MOVE_FAILED, unitId));
+		}
+		else
+			++i;
+	}
+}
+
+bool AAIMockGame::MoveUnit(int unitId, const float3& destination)
+{
+	AAIHeadlessUnit& unit = m_callback->Unit(unitId);
+
+	const float stepSize = GetUnitDef(unitId)->speed / static_cast<float>(GAME_SPEED);
+	const float distance = unit.position.distance2D(destination);
+
+	if( (distance <= stepSize) || (stepSize <= 0.0f) )
+	{
+		if(stepSize > 0.0f)
+			unit.position = float3(destination.x, m_callback->GetElevation(destination.x, destination.z), destination.z);
+
+		return true;
+	}
+
+	const float3 newPosition = unit.position + (destination - unit.position) * (stepSize / distance);
+	unit.position = float3(newPosition.x, m_callback->GetElevation(newPosition.x, newPosition.z), newPosition.z);
+	return false;
+}
+
+void AAIMockGame::UpdateResources()
+{
+	AAIHeadlessCallback::Resources& resources = m_callback->GetResources();
+	const AAIHeadlessGameSetup&     gameSetup = m_callback->GetGameSetup();
+
+	float metalIncome(0.0f), energyIncome(0.0f);
+	resources.metalStorage  = s_baseStorage;
+	resources.energyStorage = s_baseStorage;
+
+	for(int unitId = 0; unitId < gameSetup.maxUnits; ++unitId)
+	{
+		const AAIHeadlessUnit& unit = m_callback->Unit(unitId);
+
+		if(IsActive(unitId) && (unit.team == gameSetup.team) && (unit.beingBuilt == false))
+		{
+			const springLegacyAI::UnitDef* unitDef = GetUnitDef(unitId);
+
+			metalIncome  += unitDef->metalMake;
+			energyIncome += unitDef->energyMake;
+
+			if(unitDef->extractsMetal > 0.0f)
+				metalIncome += GetExtractedMetal(unit.position, unitDef->extractsMetal);
+
+			if(unitDef->windGenerator > 0.0f)
+				energyIncome += std::min(0.5f * (gameSetup.minWind + gameSetup.maxWind), unitDef->windGenerator);
+
+			if(unitDef->tidalGenerator > 0.0f)
+				energyIncome += gameSetup.tidalStrength;
+
+			resources.metalStorage  += unitDef->metalStorage;
+			resources.energyStorage += unitDef->energyStorage;
+		}
+	}
+
+	resources.metalIncome  = metalIncome;
+	resources.metalUsage   = m_metalUsed;
+	resources.energyIncome = energyIncome;
+	resources.energyUsage  = m_energyUsed;
+
+	resources.metal  = std::max(0.0f, std::min(resources.metal  + metalIncome  - m_metalUsed,  resources.metalStorage));
+	resources.energy = std::max(0.0f, std::min(resources.energy + energyIncome - m_energyUsed, resources.energyStorage));
+
+	m_metalUsed  = 0.0f;
+	m_energyUsed = 0.0f;
+}
+
+void AAIMockGame::UpdateCombat(std::vector<AAIHeadlessEvent>& events)
+{
+	struct Hit
+	{
+		int   targetId;
+		int   attackerId;
+		float damage;
+	};
+
+	const int maxUnits = m_callback->GetGameSetup().maxUnits;
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// every armed unit fires at the closest enemy within range (hits are applied afterwards)
+	//-----------------------------------------------------------------------------------------------------------------
+	std::vector<Hit> hits;
+
+	for(int attackerId = 0; attackerId < maxUnits; ++attackerId)
+	{
+		const AAIHeadlessUnit& attacker = m_callback->Unit(attackerId);
+
+		if( (IsActive(attackerId) == false) || attacker.beingBuilt )
+			continue;
+
+		const springLegacyAI::UnitDef* attackerDef = GetUnitDef(attackerId);
+
+		if(attackerDef->weapons.empty())
+			continue;
+
+		const springLegacyAI::WeaponDef* weaponDef = attackerDef->weapons.front().def;
+
+		int   targetId(-1);
+		float minDistance(weaponDef->range);
+
+		for(int unitId = 0; unitId < maxUnits; ++unitId)
+		{
+			const AAIHeadlessUnit& unit = m_callback->Unit(unitId);
+
+			if(IsActive(unitId) && (unit.team != attacker.team))
+			{
+				const float distance = unit.position.distance2D(attacker.position);
+
+				if(distance <= minDistance)
+				{
+					minDistance = distance;
+					targetId    = unitId;
+				}
+			}
+		}
+
+		if(targetId >= 0)
+		{
+			Hit hit;
+			hit.targetId   = targetId;
+			hit.attackerId = attackerId;
+			hit.damage     = weaponDef->damages[0];
+			hits.push_back(hit);
+		}
+	}
+
+	for(const auto& hit : hits)
+	{
+		if(IsActive(hit.targetId) == false)
+			continue;
+
+		AAIHeadlessUnit& target = m_callback->Unit(hit.targetId);
+
+		target.health -= hit.damage;
+
+		if(IsOwnUnit(hit.targetId))
+			events.push_back(AAIHeadlessEvent(ERecordedEvent::UNIT_DAMAGED, hit.targetId, hit.attackerId));
+
+		if(target.health <= 0.0f)
+			DestroyUnit(hit.targetId, hit.attackerId, events);
+	}
+}
+
+void AAIMockGame::UpdateSensors(std::vector<AAIHeadlessEvent>& events)
+{
+	const AAIHeadlessGameSetup& gameSetup = m_callback->GetGameSetup();
+
+	const int xLosMapSize   = gameSetup.xMapSize / gameSetup.losMapResolution;
+	const int yLosMapSize   = gameSetup.yMapSize / gameSetup.losMapResolution;
+	const int xRadarMapSize = gameSetup.xMapSize / gameSetup.radarMapResolution;
+	const int yRadarMapSize = gameSetup.yMapSize / gameSetup.radarMapResolution;
+
+	std::vector<int>& losMap   = m_callback->LosMap();
+	std::vector<int>& radarMap = m_callback->RadarMap();
+
+	std::fill(losMap.begin(), losMap.end(), 0);
+	std::fill(radarMap.begin(), radarMap.end(), 0);
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// coverage of own units
+	//-----------------------------------------------------------------------------------------------------------------
+	for(int unitId = 0; unitId < gameSetup.maxUnits; ++unitId)
+	{
+		const AAIHeadlessUnit& unit = m_callback->Unit(unitId);
+
+		if(IsActive(unitId) && (unit.team == gameSetup.team) && (unit.beingBuilt == false))
+		{
+			const springLegacyAI::UnitDef* unitDef = GetUnitDef(unitId);
+
+			AddCoverage(losMap, xLosMapSize, yLosMapSize, gameSetup.losMapResolution * SQUARE_SIZE, unit.position, unitDef->losRadius);
+
+			if(unitDef->radarRadius > 0.0f)
+				AddCoverage(radarMap, xRadarMapSize, yRadarMapSize, gameSetup.radarMapResolution * SQUARE_SIZE, unit.position, unitDef->radarRadius);
+		}
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// enemy units entering/leaving LOS or radar coverage
+	//-----------------------------------------------------------------------------------------------------------------
+	std::vector<int>& enemyUnitsInLOS         = m_callback->EnemyUnitsInLOS();
+	std::vector<int>& enemyUnitsInRadarAndLOS = m_callback->EnemyUnitsInRadarAndLOS();
+	enemyUnitsInLOS.clear();
+	enemyUnitsInRadarAndLOS.clear();
+
+	for(int unitId = 0; unitId < gameSetup.maxUnits; ++unitId)
+	{
+		const AAIHeadlessUnit& unit = m_callback->Unit(unitId);
+
+		if( (IsActive(unitId) == false) || (unit.team == gameSetup.team) )
+			continue;
+
+		const int xLos   = std::max(0, std::min(static_cast<int>(unit.position.x) / (gameSetup.losMapResolution * SQUARE_SIZE), xLosMapSize-1));
+		const int yLos   = std::max(0, std::min(static_cast<int>(unit.position.z) / (gameSetup.losMapResolution * SQUARE_SIZE), yLosMapSize-1));
+		const int xRadar = std::max(0, std::min(static_cast<int>(unit.position.x) / (gameSetup.radarMapResolution * SQUARE_SIZE), xRadarMapSize-1));
+		const int yRadar = std::max(0, std::min(static_cast<int>(unit.position.z) / (gameSetup.radarMapResolution * SQUARE_SIZE), yRadarMapSize-1));
+
+		const bool inLOS   = (losMap[xLos + yLos * xLosMapSize] > 0);
+		const bool inRadar = (radarMap[xRadar + yRadar * xRadarMapSize] > 0);
+
+		if(inLOS != m_enemyInLOS[unitId])
+			events.push_back(AAIHeadlessEvent(inLOS ? ERecordedEvent::ENEMY_ENTER_LOS : ERecordedEvent::ENEMY_LEAVE_LOS, unitId));
+
+		if(inRadar != m_enemyInRadar[unitId])
+			events.push_back(AAIHeadlessEvent(inRadar ? ERecordedEvent::ENEMY_ENTER_RADAR : ERecordedEvent::ENEMY_LEAVE_RADAR, unitId));
+
+		m_enemyInLOS[unitId]   = inLOS;
+		m_enemyInRadar[unitId] = inRadar;
+
+		if(inLOS)
+			enemyUnitsInLOS.push_back(unitId);
+
+		if(inLOS || inRadar)
+			enemyUnitsInRadarAndLOS.push_back(unitId);
+	}
+}
+
+void AAIMockGame::SpawnEnemyWave()
+{
+	const int numberOfUnits = std::min(1 + m_currentFrame / s_enemyWaveInterval, s_maxUnitsPerEnemyWave);
+
+	for(int i = 0; i < numberOfUnits; ++i)
+	{
+		const float3 offset(static_cast<float>(m_random.NextInt(400) - 200), 0.0f, static_cast<float>(m_random.NextInt(400) - 200));
+		const int unitId = AddUnit( (i % 4 == 3) ? m_scout : m_tank, s_enemyTeam, m_enemyBasePosition + offset, false);
+
+		if(unitId < 0)
+			return;
+
+		Movement movement;
+		movement.unitId      = unitId;
+		movement.destination = m_startPosition + offset;
+		m_movements.push_back(movement);
+	}
+}
+
+void AAIMockGame::DestroyUnit(int unitId, int attackerId, std::vector<AAIHeadlessEvent>& events)
+{
+	if(IsOwnUnit(unitId))
+		events.push_back(AAIHeadlessEvent(ERecordedEvent::UNIT_DESTROYED, unitId, attackerId));
+	else if(m_enemyInLOS[unitId] || m_enemyInRadar[unitId])
+		events.push_back(AAIHeadlessEvent(ERecordedEvent::ENEMY_DESTROYED, unitId, attackerId));
+
+	ClearOrders(unitId);
+
+	// constructions of the destroyed unit are aborted, units repairing it become idle
+	for(size_t i = 0; i < m_constructions.size(); )
+	{
+		if(m_constructions[i].unitId == unitId)
+		{
+			const int builderId = m_constructions[i].builderId;
+			m_constructions.erase(m_constructions.begin() + i);
+
+			if(builderId >= 0)
+				SetIdle(builderId, events);
+		}
+		else
+			++i;
+	}
+
+	for(auto assistance = m_assistances.begin(); assistance != m_assistances.end(); )
+	{
+		if(assistance->targetId == unitId)
+		{
+			SetIdle(assistance->unitId, events);
+			assistance = m_assistances.erase(assistance);
+		}
+		else
+			++assistance;
+	}
+
+	m_enemyInLOS[unitId]   = false;
+	m_enemyInRadar[unitId] = false;
+
+	std::vector<int>& enemyUnitsInLOS         = m_callback->EnemyUnitsInLOS();
+	std::vector<int>& enemyUnitsInRadarAndLOS = m_callback->EnemyUnitsInRadarAndLOS();
+	enemyUnitsInLOS.erase(std::remove(enemyUnitsInLOS.begin(), enemyUnitsInLOS.end(), unitId), enemyUnitsInLOS.end());
+	enemyUnitsInRadarAndLOS.erase(std::remove(enemyUnitsInRadarAndLOS.begin(), enemyUnitsInRadarAndLOS.end(), unitId), enemyUnitsInRadarAndLOS.end());
+
+	m_callback->Unit(unitId).health = 0.0f;
+	m_destroyedUnits.push_back(unitId);
+
+	if(unitId == m_commanderId)
+		m_commanderId = -1;
+}
+
+void AAIMockGame::SetIdle(int unitId, std::vector<AAIHeadlessEvent>& events)
+{
+	if(IsActive(unitId) == false)
+		return;
+
+	m_callback->Unit(unitId).numberOfCommands = 0;
+
+	if(IsOwnUnit(unitId))
+		events.push_back(AAIHeadlessEvent(ERecordedEvent::UNIT_IDLE, unitId));
+}
+
+float AAIMockGame::GetExtractedMetal(const float3& position, float extractsMetal) const
+{
+	const AAIHeadlessGameSetup& gameSetup = m_callback->GetGameSetup();
+
+	// metal map has half the resolution of the map
+	const int metalMapSize = gameSetup.xMapSize / 2;
+	const int tileSize     = 2 * SQUARE_SIZE;
+	const int xCenter      = static_cast<int>(position.x) / tileSize;
+	const int yCenter      = static_cast<int>(position.z) / tileSize;
+	const int range        = static_cast<int>(gameSetup.extractorRadius) / tileSize;
+
+	int metal(0);
+
+	for(int y = std::max(0, yCenter - range); y <= std::min(gameSetup.yMapSize / 2 - 1, yCenter + range); ++y)
+	{
+		for(int x = std::max(0, xCenter - range); x <= std::min(metalMapSize - 1, xCenter + range); ++x)
+		{
+			if( (x-xCenter)*(x-xCenter) + (y-yCenter)*(y-yCenter) <= range*range )
+				metal += gameSetup.metalMap[x + y * metalMapSize];
+		}
+	}
+
+	return static_cast<float>(metal) * extractsMetal;
+}
+
+#endif
@@ -0,0 +1,166 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_MOCKGAME_H
+#define AAI_MOCKGAME_H
+
+#include <vector>
+#include <string>
+
+#include "AAIHeadlessCallback.h"
+#include "../AAIRandom.h"
+
+//! @brief Synthetic game to run AAI without the engine: sets up a small mod (one side: commander, constructor, factory, extractor, solar,
+//!        storage, radar, defence tower, nano turret, tank, scout), a generated map (hills, a lake, metal spots), the config files,
+//!        and an enemy base. The orders given by AAI are carried out in a simplified way (units move in straight lines, buildings are
+//!        constructed at the given position, armed units fire at enemies within range) to produce the events AAI reacts to.
+//!        The simulation is deterministic for a given seed.
+class AAIMockGame
+{
+public:
+	//! @brief The game is set up for the given map size (in map tiles); if recordEvents is set, AAI is configured to record the game
+	AAIMockGame(AAIHeadlessCallback* callback, int mapSize, uint64_t seed, bool recordEvents);
+
+	//! @brief Sets the time budget per frame for periodic tasks (in microseconds) written to the general config (must be called before Init())
+	void SetFrameTimeBudget(int frameTimeBudget) { m_frameTimeBudget = frameTimeBudget; }
+
+	//! @brief Sets up mod, map, and units; writes the mod/general config to the work directory; returns false if files could not be written
+	bool Init();
+
+	//! @brief Returns the events that have to be passed to AAI at game start (creation of the commander)
+	std::vector<AAIHeadlessEvent> GetStartEvents() const;
+
+	//! @brief Carries out the orders given by AAI and advances the game to the given frame; resulting events are added to the list
+	void Update(int frame, std::vector<AAIHeadlessEvent>& events);
+
+private:
+	//! A construction in progress (or queued in a factory)
+	struct Construction
+	{
+		int   unitId;
+		int   builderId;
+		int   unitDefId;
+		float3 position;
+		float  progress;
+	};
+
+	//! Movement of a unit towards its destination
+	struct Movement
+	{
+		int    unitId;
+		float3 destination;
+	};
+
+	//! A unit assisting (guarding/repairing) another unit
+	struct Assistance
+	{
+		int unitId;
+		int targetId;
+	};
+
+	//! @brief Creates the unit definitions of the mod
+	void CreateUnitDefs();
+
+	//! @brief Creates height and metal map
+	void CreateMap(AAIHeadlessGameSetup& gameSetup);
+
+	//! @brief Writes the config files needed by AAI; returns false if files could not be written
+	bool WriteConfigFiles();
+
+	//! @brief Adds a unit of the given type and team at the given position (returns unit id, -1 if max number of units reached)
+	int AddUnit(int unitDefId, int team, const float3& position, bool beingBuilt);
+
+	//! @brief Carries out the given order
+	void ProcessOrder(const AAIHeadlessOrder& order, std::vector<AAIHeadlessEvent>& events);
+
+	//! @brief Removes all orders of the given unit (constructions already started are continued only if assisted)
+	void ClearOrders(int unitId);
+
+	//! @brief Advances constructions by one frame
+	void UpdateConstructions(std::vector<AAIHeadlessEvent>& events);
+
+	//! @brief Moves units towards their destination
+	void UpdateMovements(std::vector<AAIHeadlessEvent>& events);
+
+	//! @brief Updates income, usage, and storage of resources (called every second)
+	void UpdateResources();
+
+	//! @brief Armed units fire at enemies within range (called every second)
+	void UpdateCombat(std::vector<AAIHeadlessEvent>& events);
+
+	//! @brief Updates LOS/radar coverage and the enemy units within it
+	void UpdateSensors(std::vector<AAIHeadlessEvent>& events);
+
+	//! @brief Sends a group of enemy units towards the base of AAI
+	void SpawnEnemyWave();
+
+	//! @brief Destroys the given unit (and aborts the corresponding constructions/movements); the unit is removed in the next update
+	//!        as it still has to exist when AAI is notified (like in the engine)
+	void DestroyUnit(int unitId, int attackerId, std::vector<AAIHeadlessEvent>& events);
+
+	//! @brief Sets the given unit idle (and creates corresponding event if it belongs to AAI)
+	void SetIdle(int unitId, std::vector<AAIHeadlessEvent>& events);
+
+	//! @brief Moves the given unit towards the destination by the distance it travels per frame; returns true if destination has been reached
+	bool MoveUnit(int unitId, const float3& destination);
+
+	//! @brief Returns the metal per second extracted at the given position
+	float GetExtractedMetal(const float3& position, float extractsMetal) const;
+
+	//! @brief Returns the unit definition of the given unit
+	const springLegacyAI::UnitDef* GetUnitDef(int unitId) const { return m_callback->GetUnitDefWithId(m_callback->Unit(unitId).unitDefId); }
+
+	//! @brief Returns true if the given unit exists and has not been destroyed
+	bool IsActive(int unitId) const { return m_callback->Unit(unitId).IsAlive() && (m_callback->Unit(unitId).health > 0.0f); }
+
+	bool IsOwnUnit(int unitId) const { return (m_callback->Unit(unitId).team == m_callback->GetMyTeam()); }
+
+	//! @brief Returns true if the given unit has no move data (and cannot fly), i.e. it is a building
+	static bool IsStatic(const springLegacyAI::UnitDef* unitDef) { return (unitDef->movedata == nullptr) && (unitDef->canfly == false); }
+
+	AAIHeadlessCallback* m_callback;
+
+	AAIRandom            m_random;
+
+	int                  m_mapSize;
+
+	//! Whether AAI shall record the events/responses of the game (set in the general config)
+	bool                 m_recordEvents;
+
+	//! Time budget per frame for periodic tasks of AAI in microseconds (set in the general config)
+	int                  m_frameTimeBudget;
+
+	int                  m_currentFrame;
+
+	//! The unit def ids of the mod
+	int m_commander, m_constructor, m_factory, m_extractor, m_solar, m_storage, m_radar, m_tower, m_nanoTurret, m_tank, m_scout;
+
+	//! Unit id of the commander of AAI
+	int m_commanderId;
+
+	//! Position of the commander of AAI and the enemy base at game start
+	float3 m_startPosition, m_enemyBasePosition;
+
+	//! Resources spent on constructions since last update of resources
+	float m_metalUsed, m_energyUsed;
+
+	std::vector<Construction> m_constructions;
+
+	std::vector<Movement>     m_movements;
+
+	std::vector<Assistance>   m_assistances;
+
+	//! Units destroyed in the last update (to be removed in the next one)
+	std::vector<int>          m_destroyedUnits;
+
+	//! Enemy units within LOS/radar in last update
+	std::vector<bool>         m_enemyInLOS, m_enemyInRadar;
+};
+
+#endif
@@ -0,0 +1,552 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+// only part of the headless driver (sources of the AI library are collected recursively)
+#ifdef AAI_HEADLESS
+
+#include <stdio.h>
+#include <cmath>
+#include <algorithm>
+
+#include "AAIReplayCallback.h"
+
+#include "Sim/Units/CommandAI/Command.h"
+
+//! Max number of recorded responses that are skipped to find one matching the query of AAI
+static const size_t s_maxSkippedResponses = 64;
+
+//! @brief Reads the values stored by the event recorder (reading beyond the end of the data marks the reader as invalid)
+class AAIRecordingReader
+{
+public:
+	explicit AAIRecordingReader(const std::vector<uint8_t>& data) : m_data(data), m_position(0), m_valid(true) {}
+
+	bool IsValid() const { return m_valid; }
+
+	bool AtEnd() const { return m_position >= m_data.size(); }
+
+	void ReadBytes(void* values, size_t size)
+	{
+		if(m_position + size > m_data.size())
+		{
+			m_valid = false;
+			memset(values, 0, size);
+			return;
+		}
+
+		memcpy(values, &m_data[m_position], size);
+		m_position += size;
+	}
+
+	uint8_t ReadByte()   { uint8_t value; ReadBytes(&value, sizeof(value)); return value; }
+
+	int32_t ReadInt()    { int32_t value; ReadBytes(&value, sizeof(value)); return value; }
+
+	float   ReadFloat()  { float value;   ReadBytes(&value, sizeof(value)); return value; }
+
+	std::string ReadString()
+	{
+		const int32_t length = ReadInt();
+
+		if( (length < 0) || (m_position + length > m_data.size()) )
+		{
+			m_valid = false;
+			return std::string();
+		}
+
+		const std::string text(reinterpret_cast<const char*>(&m_data[m_position]), length);
+		m_position += length;
+		return text;
+	}
+
+private:
+	const std::vector<uint8_t>& m_data;
+
+	size_t                      m_position;
+
+	bool                        m_valid;
+};
+
+//! @brief Reads a unit definition (as written by AAIEventRecorder::Open()) and adds it to the given callback; returns false if the id
+//!        of the unit definition does not match the one assigned by the callback
+static bool ReadUnitDef(AAIRecordingReader& reader, AAIReplayCallback* callback)
+{
+	const int         unitDefId = reader.ReadInt();
+	const std::string name      = reader.ReadString();
+
+	if(reader.IsValid() == false)
+		return false;
+
+	springLegacyAI::UnitDef* unitDef = callback->AddUnitDef(name);
+
+	if(unitDef->id != unitDefId)
+	{
+		printf("Unit definition %s: id %i not supported (ids of unit definitions must be contiguous starting with 1)\n", name.c_str(), unitDefId);
+		return false;
+	}
+
+	unitDef->humanName          = reader.ReadString();
+	unitDef->xsize              = reader.ReadInt();
+	unitDef->zsize              = reader.ReadInt();
+	unitDef->highTrajectoryType = reader.ReadInt();
+	unitDef->category           = static_cast<unsigned int>(reader.ReadInt());
+	unitDef->canfly             = (reader.ReadInt() != 0);
+	unitDef->canCloak           = (reader.ReadInt() != 0);
+	unitDef->canAssist          = (reader.ReadInt() != 0);
+	unitDef->canResurrect       = (reader.ReadInt() != 0);
+	unitDef->floater            = (reader.ReadInt() != 0);
+	unitDef->builder            = (reader.ReadInt() != 0);
+	unitDef->isAirBase          = (reader.ReadInt() != 0);
+	unitDef->needGeo            = (reader.ReadInt() != 0);
+
+	float* const floatValues[] = { &unitDef->metalCost, &unitDef->energyCost, &unitDef->buildTime, &unitDef->energyUpkeep, &unitDef->metalMake,
+	                               &unitDef->energyMake, &unitDef->metalStorage, &unitDef->energyStorage, &unitDef->extractsMetal,
+	                               &unitDef->windGenerator, &unitDef->tidalGenerator, &unitDef->speed, &unitDef->turnRate, &unitDef->buildSpeed,
+	                               &unitDef->losRadius, &unitDef->radarRadius, &unitDef->sonarRadius, &unitDef->jammerRadius,
+	                               &unitDef->sonarJamRadius, &unitDef->seismicRadius, &unitDef->minWaterDepth, &unitDef->health, &unitDef->power };
+	for(float* value : floatValues)
+		*value = reader.ReadFloat();
+
+	const int   moveFamily = reader.ReadInt();
+	const float depth      = reader.ReadFloat();
+	const bool  subMarine  = (reader.ReadInt() != 0);
+
+	if(moveFamily >= 0)
+		AAIHeadlessCallback::SetMoveData(unitDef, static_cast<springLegacyAI::MoveData::MoveFamily>(moveFamily), depth, subMarine);
+
+	const int numberOfBuildOptions = reader.ReadInt();
+	for(int i = 0; (i < numberOfBuildOptions) && reader.IsValid(); ++i)
+		unitDef->buildOptions[i] = reader.ReadString();
+
+	const int numberOfWeapons = reader.ReadInt();
+	for(int i = 0; (i < numberOfWeapons) && reader.IsValid(); ++i)
+	{
+		springLegacyAI::WeaponDef* weaponDef = callback->AddWeaponDef(reader.ReadString());
+
+		springLegacyAI::UnitDef::UnitDefWeapon weapon;
+		weapon.name          = weaponDef->name;
+		weapon.def           = weaponDef;
+		weapon.slavedTo      = 0;
+		weapon.badTargetCat  = 0u;
+		weapon.onlyTargetCat = static_cast<unsigned int>(reader.ReadInt());
+
+		weaponDef->range        = reader.ReadFloat();
+		weaponDef->stockpile    = (reader.ReadInt() != 0);
+		weaponDef->noAutoTarget = (reader.ReadInt() != 0);
+		weaponDef->isShield     = (reader.ReadInt() != 0);
+
+		std::vector<float> damages( std::max(0, reader.ReadInt()) );
+		for(float& damage : damages)
+			damage = reader.ReadFloat();
+
+		weaponDef->damages = springLegacyAI::DamageArray(static_cast<int>(damages.size()), damages.data());
+
+		unitDef->weapons.push_back(weapon);
+	}
+
+	return reader.IsValid();
+}
+
+AAIReplayCallback::AAIReplayCallback(int skirmishAIId, const std::string& workDirectory, const std::string& dataDirectory) :
+	AAIHeadlessCallback(skirmishAIId, workDirectory, dataDirectory),
+	m_randomSeed(0),
+	m_nextResponse(0),
+	m_numberOfMismatches(0),
+	m_numberOfGivenOrders(0)
+{
+}
+
+bool AAIReplayCallback::Load(const std::string& filename)
+{
+	FILE* file = fopen(filename.c_str(), "rb");
+
+	if(file == nullptr)
+	{
+		printf("Unable to open recording %s\n", filename.c_str());
+		return false;
+	}
+
+	std::vector<uint8_t> data;
+	uint8_t buffer[64 * 1024];
+	size_t  bytesRead;
+
+	while( (bytesRead = fread(buffer, 1, sizeof(buffer), file)) > 0 )
+		data.insert(data.end(), buffer, buffer + bytesRead);
+
+	fclose(file);
+
+	AAIRecordingReader reader(data);
+
+	char magic[sizeof(AAIEventRecorder::s_fileMagic)];
+	reader.ReadBytes(magic, sizeof(magic));
+	const int version = reader.ReadInt();
+
+	if( (memcmp(magic, AAIEventRecorder::s_fileMagic, sizeof(magic)) != 0) || (version != AAIEventRecorder::s_fileVersion) )
+	{
+		printf("%s is not a recording of AAI or has an unsupported version\n", filename.c_str());
+		return false;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// static data of the game (see AAIEventRecorder::Open())
+	//-----------------------------------------------------------------------------------------------------------------
+	AAIHeadlessGameSetup gameSetup;
+	reader.ReadInt(); // skirmish AI id of the recorded game (replay uses the one passed to the constructor)
+	m_randomSeed               = reader.ReadInt();
+	gameSetup.team             = reader.ReadInt();
+	gameSetup.allyTeam         = reader.ReadInt();
+	gameSetup.maxUnits         = reader.ReadInt();
+	gameSetup.xMapSize         = reader.ReadInt();
+	gameSetup.yMapSize         = reader.ReadInt();
+	gameSetup.losMapResolution = std::max(1, static_cast<int>(std::lround(std::sqrt(static_cast<float>(reader.ReadInt())))));
+	gameSetup.mapName          = reader.ReadString();
+	gameSetup.mapHash          = reader.ReadInt();
+	gameSetup.modName          = reader.ReadString();
+	gameSetup.modHumanName     = reader.ReadString();
+	gameSetup.modShortName     = reader.ReadString();
+	gameSetup.modHash          = reader.ReadInt();
+	gameSetup.extractorRadius  = reader.ReadFloat();
+	gameSetup.maxMetal         = reader.ReadFloat();
+	gameSetup.minWind          = reader.ReadFloat();
+	gameSetup.maxWind          = reader.ReadFloat();
+	gameSetup.tidalStrength    = reader.ReadFloat();
+
+	if( (reader.IsValid() == false) || (gameSetup.xMapSize <= 0) || (gameSetup.yMapSize <= 0) || (gameSetup.maxUnits <= 0) )
+	{
+		printf("Header of recording %s is corrupted\n", filename.c_str());
+		return false;
+	}
+
+	gameSetup.heightMap.resize(gameSetup.xMapSize * gameSetup.yMapSize);
+	reader.ReadBytes(gameSetup.heightMap.data(), gameSetup.heightMap.size() * sizeof(float));
+
+	gameSetup.metalMap.resize( (gameSetup.xMapSize/2) * (gameSetup.yMapSize/2) );
+	reader.ReadBytes(gameSetup.metalMap.data(), gameSetup.metalMap.size());
+
+	const int numberOfUnitDefs = reader.ReadInt();
+	for(int i = 0; i < numberOfUnitDefs; ++i)
+	{
+		if(ReadUnitDef(reader, this) == false)
+		{
+			printf("Unable to read unit definitions from recording %s\n", filename.c_str());
+			return false;
+		}
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// events and responses
+	//-----------------------------------------------------------------------------------------------------------------
+	while( (reader.AtEnd() == false) && reader.IsValid() )
+	{
+		const ERecordedEvent type           = static_cast<ERecordedEvent>(reader.ReadByte());
+		const int            numberOfValues = AAIEventRecorder::GetNumberOfValues(type);
+
+		if(type <= ERecordedEvent::HANDLE_EVENT)
+		{
+			int values[4] = {0, 0, 0, 0};
+			for(int i = 0; i < numberOfValues; ++i)
+				values[i] = reader.ReadInt();
+
+			if(reader.IsValid())
+				m_events.push_back(AAIHeadlessEvent(type, values[0], values[1], values[2], values[3]));
+			continue;
+		}
+
+		if(type > ERecordedEvent::GIVE_ORDER)
+		{
+			printf("Unknown record type %i in recording %s\n", static_cast<int>(type), filename.c_str());
+			return false;
+		}
+
+		AAIRecordedResponse response;
+		response.type = type;
+
+		if( (type == ERecordedEvent::LOS_MAP) || (type == ERecordedEvent::RADAR_MAP) )
+		{
+			// run length encoded: number of runs, (value, length) for every run
+			const int runs = reader.ReadInt();
+			for(int run = 0; (run < runs) && reader.IsValid(); ++run)
+			{
+				const int value  = reader.ReadInt();
+				const int length = reader.ReadInt();
+
+				if( (length < 0) || (response.values.size() + length > gameSetup.heightMap.size()) )
+				{
+					printf("Corrupted map in recording %s\n", filename.c_str());
+					return false;
+				}
+
+				response.values.insert(response.values.end(), length, value);
+			}
+		}
+		else if(numberOfValues < 0)
+		{
+			// list of units (area of the query stored in front of it)
+			const int areaValues = (type == ERecordedEvent::ENEMY_UNITS_IN_AREA) ? 4 : 0;
+			for(int i = 0; i < areaValues; ++i)
+				response.values.push_back(reader.ReadInt());
+
+			const int numberOfUnits = reader.ReadInt();
+			for(int i = 0; (i < numberOfUnits) && reader.IsValid(); ++i)
+				response.values.push_back(reader.ReadInt());
+		}
+		else
+		{
+			for(int i = 0; i < numberOfValues; ++i)
+				response.values.push_back(reader.ReadInt());
+		}
+
+		if(reader.IsValid())
+			m_responses.push_back(response);
+	}
+
+	if(reader.IsValid() == false)
+		printf("Recording %s ends within a record (game not shut down properly?) - last record is ignored\n", filename.c_str());
+
+	// resolution of the radar map is not part of the header -> determine it from the size of the recorded radar maps (like AAI)
+	for(const auto& response : m_responses)
+	{
+		if(response.type == ERecordedEvent::RADAR_MAP)
+		{
+			int radarMapResolution(1);
+			while( (radarMapResolution < gameSetup.xMapSize)
+			    && ((gameSetup.xMapSize / radarMapResolution) * (gameSetup.yMapSize / radarMapResolution) > static_cast<int>(response.values.size())) )
+				radarMapResolution *= 2;
+
+			gameSetup.radarMapResolution = radarMapResolution;
+			break;
+		}
+	}
+
+	SetGameSetup(gameSetup);
+
+	printf("Recording %s: map %s, mod %s, team %i, %i unit definitions, %i events, %i responses\n", filename.c_str(), gameSetup.mapName.c_str(),
+			gameSetup.modHumanName.c_str(), gameSetup.team, numberOfUnitDefs, static_cast<int>(m_events.size()), static_cast<int>(m_responses.size()));
+	return true;
+}
+
+bool AAIReplayCallback::WriteGeneralConfig()
+{
+	// read the general config from the data directory (the one in the work directory might have been written by a previous replay)
+	std::string generalConfig;
+
+	FILE* file = fopen( (GetDataDirectory() + "/cfg/general.cfg").c_str(), "r");
+
+	if(file != nullptr)
+	{
+		char buffer[1024];
+		size_t bytesRead;
+
+		while( (bytesRead = fread(buffer, 1, sizeof(buffer), file)) > 0 )
+			generalConfig.append(buffer, bytesRead);
+
+		fclose(file);
+	}
+
+	char filename[2048];
+	snprintf(filename, sizeof(filename), "cfg/general.cfg");
+	GetValue(AIVAL_LOCATE_FILE_W, filename);
+
+	file = fopen(filename, "w");
+
+	if(file == nullptr)
+	{
+		printf("Unable to write general config %s\n", filename);
+		return false;
+	}
+
+	// later values override earlier ones
+	fprintf(file, "%s\nRANDOM_SEED %i\nRECORD_EVENTS 0\n", generalConfig.c_str(), m_randomSeed);
+	fclose(file);
+
+	return true;
+}
+
+const AAIRecordedResponse* AAIReplayCallback::NextResponse(ERecordedEvent type, std::initializer_list<AAIEventRecorder::Value> query)
+{
+	const size_t lastResponse = std::min(m_responses.size(), m_nextResponse + s_maxSkippedResponses + 1);
+
+	for(size_t index = m_nextResponse; index < lastResponse; ++index)
+	{
+		const AAIRecordedResponse& response = m_responses[index];
+
+		if( (response.type != type) || (response.values.size() < query.size()) )
+			continue;
+
+		if( std::equal(query.begin(), query.end(), response.values.begin(), [](const AAIEventRecorder::Value& lhs, int rhs) { return lhs.GetBits() == rhs; }) )
+		{
+			m_numberOfMismatches += static_cast<int>(index - m_nextResponse);
+			m_nextResponse = index + 1;
+			return &response;
+		}
+	}
+
+	++m_numberOfMismatches;
+	return nullptr;
+}
+
+float AAIReplayCallback::GetResource(ERecordedResource resource, float value)
+{
+	const AAIRecordedResponse* response = NextResponse(ERecordedEvent::RESOURCE, {static_cast<int32_t>(resource)});
+	return response ? response->GetFloat(1) : value;
+}
+
+int AAIReplayCallback::CopyRecordedUnits(const AAIRecordedResponse& response, size_t firstUnit, int* unitIds, int unitIds_max)
+{
+	const std::vector<int> units(response.values.begin() + firstUnit, response.values.end());
+	return CopyUnitList(units, unitIds, unitIds_max);
+}
+
+int AAIReplayCallback::GetLosMapValues(int* values, int values_sizeMax)
+{
+	// only requests of the values (not of the size of the map) are recorded
+	if(values != nullptr)
+	{
+		const AAIRecordedResponse* response = NextResponse(ERecordedEvent::LOS_MAP, {});
+
+		if(response && (response->values.size() == LosMap().size()))
+			LosMap() = response->values;
+	}
+
+	return AAIHeadlessCallback::GetLosMapValues(values, values_sizeMax);
+}
+
+int AAIReplayCallback::GetRadarMapValues(int* values, int values_sizeMax)
+{
+	if(values != nullptr)
+	{
+		const AAIRecordedResponse* response = NextResponse(ERecordedEvent::RADAR_MAP, {});
+
+		if(response && (response->values.size() == RadarMap().size()))
+			RadarMap() = response->values;
+	}
+
+	return AAIHeadlessCallback::GetRadarMapValues(values, values_sizeMax);
+}
+
+int AAIReplayCallback::GetCurrentFrame()
+{
+	const AAIRecordedResponse* response = NextResponse(ERecordedEvent::CURRENT_FRAME, {});
+	return response ? response->GetInt(0) : AAIHeadlessCallback::GetCurrentFrame();
+}
+
+float3 AAIReplayCallback::GetUnitPos(int unitId)
+{
+	const AAIRecordedResponse* response = NextResponse(ERecordedEvent::UNIT_POS, {unitId});
+	return response ? float3(response->GetFloat(1), response->GetFloat(2), response->GetFloat(3)) : AAIHeadlessCallback::GetUnitPos(unitId);
+}
+
+const springLegacyAI::UnitDef* AAIReplayCallback::GetUnitDef(int unitId)
+{
+	const AAIRecordedResponse* response = NextResponse(ERecordedEvent::UNIT_DEF, {unitId});
+	return response ? GetUnitDefWithId(response->GetInt(1)) : AAIHeadlessCallback::GetUnitDef(unitId);
+}
+
+float AAIReplayCallback::GetUnitHealth(int unitId)
+{
+	const AAIRecordedResponse* response = NextResponse(ERecordedEvent::UNIT_HEALTH, {unitId});
+	return response ? response->GetFloat(1) : AAIHeadlessCallback::GetUnitHealth(unitId);
+}
+
+int AAIReplayCallback::GetUnitTeam(int unitId)
+{
+	const AAIRecordedResponse* response = NextResponse(ERecordedEvent::UNIT_TEAM, {unitId});
+	return response ? response->GetInt(1) : AAIHeadlessCallback::GetUnitTeam(unitId);
+}
+
+int AAIReplayCallback::GetUnitAllyTeam(int unitId)
+{
+	const AAIRecordedResponse* response = NextResponse(ERecordedEvent::UNIT_ALLY_TEAM, {unitId});
+	return response ? response->GetInt(1) : AAIHeadlessCallback::GetUnitAllyTeam(unitId);
+}
+
+bool AAIReplayCallback::UnitBeingBuilt(int unitId)
+{
+	const AAIRecordedResponse* response = NextResponse(ERecordedEvent::UNIT_BEING_BUILT, {unitId});
+	return response ? (response->GetInt(1) != 0) : AAIHeadlessCallback::UnitBeingBuilt(unitId);
+}
+
+const springLegacyAI::CCommandQueue* AAIReplayCallback::GetCurrentUnitCommands(int unitId)
+{
+	const AAIRecordedResponse* response = NextResponse(ERecordedEvent::UNIT_COMMANDS, {unitId});
+
+	if(response)
+		return (response->GetInt(1) > 0) ? &m_busyCommandQueue : &m_emptyCommandQueue;
+	else
+		return AAIHeadlessCallback::GetCurrentUnitCommands(unitId);
+}
+
+int AAIReplayCallback::GetEnemyUnits(int* unitIds, int unitIds_max)
+{
+	const AAIRecordedResponse* response = NextResponse(ERecordedEvent::ENEMY_UNITS, {});
+	return response ? CopyRecordedUnits(*response, 0, unitIds, unitIds_max) : AAIHeadlessCallback::GetEnemyUnits(unitIds, unitIds_max);
+}
+
+int AAIReplayCallback::GetEnemyUnits(int* unitIds, const float3& pos, float radius, int unitIds_max)
+{
+	const AAIRecordedResponse* response = NextResponse(ERecordedEvent::ENEMY_UNITS_IN_AREA, {pos.x, pos.y, pos.z, radius});
+	return response ? CopyRecordedUnits(*response, 4, unitIds, unitIds_max) : AAIHeadlessCallback::GetEnemyUnits(unitIds, pos, radius, unitIds_max);
+}
+
+int AAIReplayCallback::GetEnemyUnitsInRadarAndLos(int* unitIds, int unitIds_max)
+{
+	const AAIRecordedResponse* response = NextResponse(ERecordedEvent::ENEMY_UNITS_IN_RADAR_AND_LOS, {});
+	return response ? CopyRecordedUnits(*response, 0, unitIds, unitIds_max) : AAIHeadlessCallback::GetEnemyUnitsInRadarAndLos(unitIds, unitIds_max);
+}
+
+int AAIReplayCallback::GetFriendlyUnits(int* unitIds, int unitIds_max)
+{
+	const AAIRecordedResponse* response = NextResponse(ERecordedEvent::FRIENDLY_UNITS, {});
+	return response ? CopyRecordedUnits(*response, 0, unitIds, unitIds_max) : AAIHeadlessCallback::GetFriendlyUnits(unitIds, unitIds_max);
+}
+
+bool AAIReplayCallback::CanBuildAt(const springLegacyAI::UnitDef* unitDef, float3 pos, int facing)
+{
+	const AAIRecordedResponse* response = NextResponse(ERecordedEvent::CAN_BUILD_AT, {unitDef ? unitDef->id : 0, pos.x, pos.y, pos.z, facing});
+	return response ? (response->GetInt(5) != 0) : AAIHeadlessCallback::CanBuildAt(unitDef, pos, facing);
+}
+
+float3 AAIReplayCallback::ClosestBuildSite(const springLegacyAI::UnitDef* unitDef, float3 pos, float searchRadius, int minDist, int facing)
+{
+	const AAIRecordedResponse* response = NextResponse(ERecordedEvent::CLOSEST_BUILD_SITE, {unitDef ? unitDef->id : 0, pos.x, pos.y, pos.z, searchRadius, minDist, facing});
+
+	if(response)
+		return float3(response->GetFloat(7), response->GetFloat(8), response->GetFloat(9));
+	else
+		return AAIHeadlessCallback::ClosestBuildSite(unitDef, pos, searchRadius, minDist, facing);
+}
+
+float AAIReplayCallback::GetElevation(float x, float z)
+{
+	const AAIRecordedResponse* response = NextResponse(ERecordedEvent::ELEVATION, {x, z});
+	return response ? response->GetFloat(2) : AAIHeadlessCallback::GetElevation(x, z);
+}
+
+int AAIReplayCallback::GetTeamAllyTeam(int team)
+{
+	const AAIRecordedResponse* response = NextResponse(ERecordedEvent::TEAM_ALLY_TEAM, {team});
+	return response ? response->GetInt(1) : AAIHeadlessCallback::GetTeamAllyTeam(team);
+}
+
+bool AAIReplayCallback::IsAllied(int firstAllyTeamId, int secondAllyTeamId)
+{
+	const AAIRecordedResponse* response = NextResponse(ERecordedEvent::IS_ALLIED, {firstAllyTeamId, secondAllyTeamId});
+	return response ? (response->GetInt(2) != 0) : AAIHeadlessCallback::IsAllied(firstAllyTeamId, secondAllyTeamId);
+}
+
+int AAIReplayCallback::GiveOrder(int unitId, Command* c)
+{
+	++m_numberOfGivenOrders;
+
+	// units only exist in the recording -> orders are not carried out
+	const AAIRecordedResponse* response = NextResponse(ERecordedEvent::GIVE_ORDER, {unitId, c->GetID()});
+	return response ? response->GetInt(2) : -1;
+}
+
+#endif
@@ -0,0 +1,126 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_REPLAYCALLBACK_H
+#define AAI_REPLAYCALLBACK_H
+
+#include <string.h>
+#include <vector>
+#include <string>
+
+#include "AAIHeadlessCallback.h"
+
+//! A response of the engine stored in a recording (query followed by the result; floats are stored bitwise in the int values)
+struct AAIRecordedResponse
+{
+	int   GetInt(size_t index) const   { return values[index]; }
+
+	float GetFloat(size_t index) const { float value; memcpy(&value, &values[index], sizeof(value)); return value; }
+
+	ERecordedEvent   type;
+
+	std::vector<int> values;
+};
+
+//! @brief Stand-in for the engine that replays a game recorded by AAI (see AAIEventRecorder): map, mod, and unit definitions are set up
+//!        from the header of the recording, the recorded events are passed to AAI by the driver, and the queries of AAI are answered
+//!        with the recorded responses in the order they have been recorded. As AAI behaves deterministically for a given random seed
+//!        and given responses, its queries match the recorded ones unless the files read by AAI (config, learning data) differ from
+//!        the ones of the recorded game. Queries not matching the next recorded responses are counted and answered from the
+//!        (mostly empty) state of the stand-in.
+class AAIReplayCallback : public AAIHeadlessCallback
+{
+public:
+	AAIReplayCallback(int skirmishAIId, const std::string& workDirectory, const std::string& dataDirectory);
+
+	//! @brief Reads the given recording; returns false if it could not be read or has an unsupported version
+	bool Load(const std::string& filename);
+
+	//! @brief Writes the general config used for the replay to the work directory: the one of the data directory (if present) with the
+	//!        random seed of the recorded game and recording of events deactivated; returns false if file could not be written
+	bool WriteGeneralConfig();
+
+	//! @brief Returns the recorded events (in the order they have to be passed to AAI)
+	const std::vector<AAIHeadlessEvent>& GetEvents() const { return m_events; }
+
+	//! @brief Returns the number of queries of AAI that did not match the next recorded response plus the number of skipped responses
+	int GetNumberOfMismatches() const { return m_numberOfMismatches; }
+
+	//! @brief Returns the number of recorded responses that have not been requested by AAI (yet)
+	int GetNumberOfUnusedResponses() const { return static_cast<int>(m_responses.size() - m_nextResponse); }
+
+	//! @brief Returns the number of orders given by AAI
+	int GetNumberOfGivenOrders() const { return m_numberOfGivenOrders; }
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// responses of the engine taken from the recording
+	//-----------------------------------------------------------------------------------------------------------------
+	int GetLosMapValues(int* values, int values_sizeMax) override;
+	int GetRadarMapValues(int* values, int values_sizeMax) override;
+
+	int GetCurrentFrame() override;
+
+	float3 GetUnitPos(int unitId) override;
+	const springLegacyAI::UnitDef* GetUnitDef(int unitId) override;
+	float  GetUnitHealth(int unitId) override;
+	int    GetUnitTeam(int unitId) override;
+	int    GetUnitAllyTeam(int unitId) override;
+	bool   UnitBeingBuilt(int unitId) override;
+	const springLegacyAI::CCommandQueue* GetCurrentUnitCommands(int unitId) override;
+
+	int GetEnemyUnits(int* unitIds, int unitIds_max = -1) override;
+	int GetEnemyUnits(int* unitIds, const float3& pos, float radius, int unitIds_max = -1) override;
+	int GetEnemyUnitsInRadarAndLos(int* unitIds, int unitIds_max = -1) override;
+	int GetFriendlyUnits(int* unitIds, int unitIds_max = -1) override;
+
+	bool   CanBuildAt(const springLegacyAI::UnitDef* unitDef, float3 pos, int facing = 0) override;
+	float3 ClosestBuildSite(const springLegacyAI::UnitDef* unitDef, float3 pos, float searchRadius, int minDist, int facing = 0) override;
+	float  GetElevation(float x, float z) override;
+
+	int  GetTeamAllyTeam(int team) override;
+	bool IsAllied(int firstAllyTeamId, int secondAllyTeamId) override;
+
+	float GetMetal() override         { return GetResource(ERecordedResource::METAL,          AAIHeadlessCallback::GetMetal()); }
+	float GetMetalIncome() override   { return GetResource(ERecordedResource::METAL_INCOME,   AAIHeadlessCallback::GetMetalIncome()); }
+	float GetMetalUsage() override    { return GetResource(ERecordedResource::METAL_USAGE,    AAIHeadlessCallback::GetMetalUsage()); }
+	float GetMetalStorage() override  { return GetResource(ERecordedResource::METAL_STORAGE,  AAIHeadlessCallback::GetMetalStorage()); }
+	float GetEnergy() override        { return GetResource(ERecordedResource::ENERGY,         AAIHeadlessCallback::GetEnergy()); }
+	float GetEnergyIncome() override  { return GetResource(ERecordedResource::ENERGY_INCOME,  AAIHeadlessCallback::GetEnergyIncome()); }
+	float GetEnergyUsage() override   { return GetResource(ERecordedResource::ENERGY_USAGE,   AAIHeadlessCallback::GetEnergyUsage()); }
+	float GetEnergyStorage() override { return GetResource(ERecordedResource::ENERGY_STORAGE, AAIHeadlessCallback::GetEnergyStorage()); }
+
+	int GiveOrder(int unitId, Command* c) override;
+
+private:
+	//! @brief Returns the next recorded response if it matches the given query (type and first values of the response); recorded responses
+	//!        are skipped if a matching one follows shortly after. Returns nullptr if no matching response has been found.
+	const AAIRecordedResponse* NextResponse(ERecordedEvent type, std::initializer_list<AAIEventRecorder::Value> query);
+
+	//! @brief Returns the recorded amount of the given resource (or the given value if not matching the recording)
+	float GetResource(ERecordedResource resource, float value);
+
+	//! @brief Copies the units of the given response (starting at the given value) to the buffer provided by AAI
+	static int CopyRecordedUnits(const AAIRecordedResponse& response, size_t firstUnit, int* unitIds, int unitIds_max);
+
+	//! Random seed used by AAI in the recorded game
+	int                              m_randomSeed;
+
+	std::vector<AAIHeadlessEvent>    m_events;
+
+	std::vector<AAIRecordedResponse> m_responses;
+
+	//! Index of the next recorded response (i.e. responses before have been used or skipped)
+	size_t                           m_nextResponse;
+
+	int                              m_numberOfMismatches;
+
+	int                              m_numberOfGivenOrders;
+};
+
+#endif
@@ -0,0 +1,53 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_TEST_H
+#define AAI_TEST_H
+
+#include <stdio.h>
+#include <vector>
+#include <string>
+
+//! A test (returns whether successful)
+typedef bool (*AAITestFunction)();
+
+//! @brief Registry of the tests run by the test executable (tests register themselves via AAI_TEST)
+class AAITestRegistry
+{
+public:
+	struct Test
+	{
+		const char*     name;
+		AAITestFunction function;
+	};
+
+	//! @brief Adds the given test; returns true (to allow registration via initialization of a static variable)
+	static bool Add(const char* name, AAITestFunction function) { GetTests().push_back(Test{name, function}); return true; }
+
+	static std::vector<Test>& GetTests() { static std::vector<Test> tests; return tests; }
+};
+
+//! @brief Returns the work directory (config, log, and cache files) for the given test (emptied before the test)
+std::string PrepareTestDirectory(const char* testName);
+
+//! Defines and registers a test; the body returns true if successful (use AAI_CHECK to report failed checks)
+#define AAI_TEST(name) \
+	static bool name(); \
+	static const bool s_registered##name = AAITestRegistry::Add(#name, &name); \
+	static bool name()
+
+//! Reports a failed check and ends the test unsuccessfully
+#define AAI_CHECK(condition) \
+	if( !(condition) ) \
+	{ \
+		printf("%s:%i: check failed: %s\n", __FILE__, __LINE__, #condition); \
+		return false; \
+	}
+
+#endif
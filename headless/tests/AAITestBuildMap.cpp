@@ -0,0 +1,166 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+// only part of the headless tests (sources of the AI library are collected recursively)
+#ifdef AAI_HEADLESS
+
+#include "AAITest.h"
+#include "../../AAIMapTypes.h"
+#include "../../AAIRandom.h"
+
+//! Size of the build map used by the tests (no multiple of the block size of the tile counts or the word size of the bit planes)
+static const int s_xMapSize = 203;
+static const int s_yMapSize = 131;
+
+//! @brief Returns the number of tiles within the given area with any of the given tile types set by checking every tile
+static int CountTilesBruteForce(const AAIBuildMap& buildMap, BuildMapTileType tileTypes, int xStart, int yStart, int xEnd, int yEnd)
+{
+	int tiles(0);
+
+	for(int y = yStart; y < yEnd; ++y)
+	{
+		for(int x = xStart; x < xEnd; ++x)
+		{
+			if(buildMap.GetTileType(x, y).IsTileTypeSet(tileTypes))
+				++tiles;
+		}
+	}
+
+	return tiles;
+}
+
+//! @brief Sets up a build map with random terrain (every tile free)
+static void InitRandomBuildMap(AAIBuildMap& buildMap, AAIRandom& random)
+{
+	buildMap.Init(s_xMapSize, s_yMapSize);
+
+	for(int y = 0; y < s_yMapSize; ++y)
+	{
+		for(int x = 0; x < s_xMapSize; ++x)
+		{
+			buildMap.SetTileType(x, y, (random.NextInt(4) == 0) ? EBuildMapTileType::WATER : EBuildMapTileType::LAND);
+			buildMap.SetTileType(x, y, (random.NextInt(3) == 0) ? EBuildMapTileType::CLIFF : EBuildMapTileType::FLAT);
+			buildMap.SetTileType(x, y, EBuildMapTileType::FREE);
+		}
+	}
+}
+
+//! @brief Occupies, blocks, or frees a random area of the build map (like placing/removing buildings) and marks it as outdated in the tile counts
+static void ChangeRandomArea(AAIBuildMap& buildMap, AAIBuildMapTileCounts& tileCounts, AAIRandom& random)
+{
+	const int xSize  = 1 + random.NextInt(12);
+	const int ySize  = 1 + random.NextInt(12);
+	const int xStart = random.NextInt(s_xMapSize - xSize + 1);
+	const int yStart = random.NextInt(s_yMapSize - ySize + 1);
+
+	switch(random.NextInt(3))
+	{
+		case 0:
+			buildMap.OccupyTiles(xStart, yStart, xStart + xSize, yStart + ySize);
+			break;
+		case 1:
+			buildMap.FreeTiles(xStart, yStart, xStart + xSize, yStart + ySize);
+			break;
+		default:
+			for(int y = yStart; y < yStart + ySize; ++y)
+			{
+				for(int x = xStart; x < xStart + xSize; ++x)
+					buildMap.BlockTile(x, y);
+			}
+			break;
+	}
+
+	tileCounts.SetAreaOutdated(xStart, yStart, xStart + xSize, yStart + ySize);
+}
+
+//! The number of tiles within arbitrary areas determined by the block-wise tile counts and the build map matches counting tile by tile
+AAI_TEST(BuildMapTileCounts)
+{
+	AAIRandom random;
+	random.Seed(9u);
+
+	AAIBuildMap buildMap;
+	InitRandomBuildMap(buildMap, random);
+
+	AAIBuildMapTileCounts tileCounts;
+	tileCounts.Init(&buildMap, s_xMapSize, s_yMapSize);
+
+	for(int round = 0; round < 200; ++round)
+	{
+		ChangeRandomArea(buildMap, tileCounts, random);
+
+		for(int query = 0; query < 50; ++query)
+		{
+			// combinations of tile types are added over time (counts for new combinations are created for up-to-date and outdated blocks)
+			const BuildMapTileType tileTypes( static_cast<EBuildMapTileType>(1u + random.NextInt(0x7F)) );
+
+			const int xStart = random.NextInt(s_xMapSize);
+			const int yStart = random.NextInt(s_yMapSize);
+			const int xEnd   = xStart + 1 + random.NextInt(s_xMapSize - xStart);
+			const int yEnd   = yStart + 1 + random.NextInt(s_yMapSize - yStart);
+
+			const int expectedTiles = CountTilesBruteForce(buildMap, tileTypes, xStart, yStart, xEnd, yEnd);
+
+			AAI_CHECK(tileCounts.CountTiles(tileTypes, xStart, yStart, xEnd, yEnd) == expectedTiles);
+			AAI_CHECK(buildMap.CountTiles(tileTypes, xStart, yStart, xEnd, yEnd) == expectedTiles);
+			AAI_CHECK(buildMap.IsTileTypeSetInArea(tileTypes, xStart, yStart, xEnd, yEnd) == (expectedTiles > 0));
+		}
+	}
+
+	return true;
+}
+
+//! Whether a footprint fits at a position (as checked by AAIMap::CanBuildAt() via the tile counts or the tiles in the area) matches
+//! checking every tile of the footprint for footprints of all sizes at every position of the map with random occupation
+AAI_TEST(BuildMapFootprints)
+{
+	AAIRandom random;
+	random.Seed(13u);
+
+	AAIBuildMap buildMap;
+	InitRandomBuildMap(buildMap, random);
+
+	AAIBuildMapTileCounts tileCounts;
+	tileCounts.Init(&buildMap, s_xMapSize, s_yMapSize);
+
+	const BuildMapTileType invalidTileTypes[] = { BuildMapTileType(EBuildMapTileType::WATER, EBuildMapTileType::CLIFF),
+	                                              BuildMapTileType(EBuildMapTileType::LAND,  EBuildMapTileType::CLIFF) };
+
+	for(int round = 0; round < 5; ++round)
+	{
+		for(int change = 0; change < 40; ++change)
+			ChangeRandomArea(buildMap, tileCounts, random);
+
+		for(int size = 1; size <= 16; size += 3)
+		{
+			for(BuildMapTileType tileTypes : invalidTileTypes)
+			{
+				tileTypes.SetTileType(EBuildMapTileType::OCCUPIED);
+				tileTypes.SetTileType(EBuildMapTileType::BLOCKED_SPACE);
+
+				const UnitFootprint footprint(size, size + round % 2, tileTypes);
+
+				for(int y = 0; y + footprint.ySize <= s_yMapSize; ++y)
+				{
+					for(int x = 0; x + footprint.xSize <= s_xMapSize; ++x)
+					{
+						const bool canBuild = (CountTilesBruteForce(buildMap, footprint.invalidTileTypes, x, y, x + footprint.xSize, y + footprint.ySize) == 0);
+
+						AAI_CHECK((tileCounts.CountTiles(footprint.invalidTileTypes, x, y, x + footprint.xSize, y + footprint.ySize) == 0) == canBuild);
+						AAI_CHECK(buildMap.IsTileTypeSetInArea(footprint.invalidTileTypes, x, y, x + footprint.xSize, y + footprint.ySize) == !canBuild);
+					}
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+#endif
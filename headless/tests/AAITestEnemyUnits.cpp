@@ -0,0 +1,243 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+// only part of the headless tests (sources of the AI library are collected recursively)
+#ifdef AAI_HEADLESS
+
+#include <algorithm>
+
+#include "AAITest.h"
+#include "../AAIHeadlessDriver.h"
+#include "../../AAI.h"
+#include "../../AAIMap.h"
+#include "../../AAISector.h"
+
+//! Team the enemy units of the tests belong to
+static const int s_enemyTeam = 1;
+
+//! @brief Sets LOS and radar coverage of the LOS/radar map tiles containing the given position
+static void SetCoverage(AAIHeadlessCallback& callback, const float3& position, bool inLOS, bool inRadar)
+{
+	const AAIHeadlessGameSetup& gameSetup = callback.GetGameSetup();
+
+	const int xLosMapSize   = gameSetup.xMapSize / gameSetup.losMapResolution;
+	const int xRadarMapSize = gameSetup.xMapSize / gameSetup.radarMapResolution;
+
+	const int xLos   = static_cast<int>(position.x) / (gameSetup.losMapResolution * SQUARE_SIZE);
+	const int yLos   = static_cast<int>(position.z) / (gameSetup.losMapResolution * SQUARE_SIZE);
+	const int xRadar = static_cast<int>(position.x) / (gameSetup.radarMapResolution * SQUARE_SIZE);
+	const int yRadar = static_cast<int>(position.z) / (gameSetup.radarMapResolution * SQUARE_SIZE);
+
+	callback.LosMap()[xLos + yLos * xLosMapSize]           = inLOS   ? 1 : 0;
+	callback.RadarMap()[xRadar + yRadar * xRadarMapSize]   = inRadar ? 1 : 0;
+}
+
+//! @brief Adds an enemy tank at the given position to the game (returns its unit id)
+static int AddEnemyUnit(AAIHeadlessCallback& callback, const float3& position)
+{
+	const int unitId = callback.GetFreeUnitId();
+
+	AAIHeadlessUnit& unit = callback.Unit(unitId);
+	unit.unitDefId = callback.GetUnitDef("htank")->id;
+	unit.team      = s_enemyTeam;
+	unit.position  = position;
+	unit.health    = 100.0f;
+
+	return unitId;
+}
+
+//! @brief Returns the number of enemy units detected by sensors only over all sectors
+static int GetEnemyUnitsDetectedBySensor(AAIMap& map)
+{
+	int units(0);
+
+	for(const auto& sectors : map.GetSectorMap())
+	{
+		for(const auto& sector : sectors)
+			units += sector.GetNumberOfEnemyUnitsDetectedBySensor();
+	}
+
+	return units;
+}
+
+//! Enemy units are registered/removed according to the LOS/radar events (incl. the number of units detected by sensor per sector), units
+//! given by an ally to an enemy team are registered, and missed events are corrected by the reconciliation with the units currently detected
+AAI_TEST(EnemyUnitEvents)
+{
+	AAIHeadlessDriver driver(PrepareTestDirectory("EnemyUnitEvents"), 256, 3u, false);
+	AAI_CHECK(driver.Init());
+
+	// AAI has constructed units of its own afterwards
+	driver.RunFrames(3000);
+
+	AAI&                 ai       = *driver.GetAI();
+	AAIMap&              map      = *ai.Map();
+	AAIHeadlessCallback& callback = driver.GetCallback();
+
+	// the LOS map is fetched by AAI once per frame -> advance frame whenever coverage is changed
+	int frame = driver.GetCurrentFrame();
+
+	// start without any coverage/detected units (enemy units detected in the game so far are removed)
+	std::fill(callback.LosMap().begin(),   callback.LosMap().end(),   0);
+	std::fill(callback.RadarMap().begin(), callback.RadarMap().end(), 0);
+	callback.EnemyUnitsInLOS().clear();
+	callback.EnemyUnitsInRadarAndLOS().clear();
+	callback.SetCurrentFrame(++frame);
+
+	map.ReconcileEnemyUnits();
+	AAI_CHECK(GetEnemyUnitsDetectedBySensor(map) == 0);
+
+	// center of a sector
+	const float3 position(1.5f * static_cast<float>(AAIMap::xSectorSize), 0.0f, 1.5f * static_cast<float>(AAIMap::ySectorSize));
+	const AAISector* sector = map.GetSectorOfPos(position);
+	AAI_CHECK(sector != nullptr);
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// unit entering/leaving radar and LOS
+	//-----------------------------------------------------------------------------------------------------------------
+	const int unitA = AddEnemyUnit(callback, position);
+
+	SetCoverage(callback, position, false, true);
+	callback.SetCurrentFrame(++frame);
+	ai.EnemyEnterRadar(unitA);
+
+	const AAIEnemyUnit* enemyUnit = map.GetEnemyUnit(UnitId(unitA));
+	AAI_CHECK(enemyUnit != nullptr);
+	AAI_CHECK(enemyUnit->inRadar && !enemyUnit->inLOS);
+	AAI_CHECK(enemyUnit->unitDefId.IsValid() == false);
+	AAI_CHECK(enemyUnit->sector == sector);
+	AAI_CHECK(sector->GetNumberOfEnemyUnitsDetectedBySensor() == 1);
+
+	SetCoverage(callback, position, true, true);
+	callback.SetCurrentFrame(++frame);
+	ai.EnemyEnterLOS(unitA);
+
+	enemyUnit = map.GetEnemyUnit(UnitId(unitA));
+	AAI_CHECK(enemyUnit != nullptr);
+	AAI_CHECK(enemyUnit->inRadar && enemyUnit->inLOS);
+	AAI_CHECK(enemyUnit->unitDefId.id == callback.GetUnitDef("htank")->id);
+	AAI_CHECK(sector->GetNumberOfEnemyUnitsDetectedBySensor() == 0);
+
+	SetCoverage(callback, position, false, true);
+	callback.SetCurrentFrame(++frame);
+	ai.EnemyLeaveLOS(unitA);
+
+	enemyUnit = map.GetEnemyUnit(UnitId(unitA));
+	AAI_CHECK(enemyUnit != nullptr);
+	AAI_CHECK(enemyUnit->inRadar && !enemyUnit->inLOS);
+	AAI_CHECK(enemyUnit->unitDefId.IsValid());
+	AAI_CHECK(sector->GetNumberOfEnemyUnitsDetectedBySensor() == 1);
+
+	SetCoverage(callback, position, false, false);
+	callback.SetCurrentFrame(++frame);
+	ai.EnemyLeaveRadar(unitA);
+
+	AAI_CHECK(map.GetEnemyUnit(UnitId(unitA)) == nullptr);
+	AAI_CHECK(sector->GetNumberOfEnemyUnitsDetectedBySensor() == 0);
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// units given by AAI to an enemy team: one within LOS, one within radar coverage only
+	//-----------------------------------------------------------------------------------------------------------------
+	const int commanderDefId = callback.GetUnitDef("hcom")->id;
+	std::vector<int> givenUnits;
+
+	for(int unitId = 0; (unitId < callback.GetGameSetup().maxUnits) && (givenUnits.size() < 2); ++unitId)
+	{
+		const AAIHeadlessUnit& unit = callback.Unit(unitId);
+
+		if(unit.IsAlive() && (unit.team == callback.GetMyTeam()) && (unit.beingBuilt == false) && (unit.unitDefId != commanderDefId))
+			givenUnits.push_back(unitId);
+	}
+
+	AAI_CHECK(givenUnits.size() == 2);
+
+	// neighbouring sector
+	const float3 givenUnitPositions[2] = { position - float3(static_cast<float>(AAIMap::xSectorSize), 0.0f, 0.0f),
+	                                       position - float3(static_cast<float>(AAIMap::xSectorSize), 0.0f, 100.0f) };
+
+	for(int i = 0; i < 2; ++i)
+	{
+		callback.Unit(givenUnits[i]).position = givenUnitPositions[i];
+		SetCoverage(callback, givenUnitPositions[i], (i == 0), true);
+	}
+
+	callback.SetCurrentFrame(++frame);
+
+	for(int i = 0; i < 2; ++i)
+	{
+		callback.Unit(givenUnits[i]).team = s_enemyTeam;
+
+		IGlobalAI::ChangeTeamEvent changeTeamEvent;
+		changeTeamEvent.unit    = givenUnits[i];
+		changeTeamEvent.oldteam = callback.GetMyTeam();
+		changeTeamEvent.newteam = s_enemyTeam;
+		ai.HandleEvent(AI_EVENT_UNITGIVEN, &changeTeamEvent);
+	}
+
+	enemyUnit = map.GetEnemyUnit(UnitId(givenUnits[0]));
+	AAI_CHECK(enemyUnit != nullptr);
+	AAI_CHECK(enemyUnit->inRadar && enemyUnit->inLOS);
+	AAI_CHECK(enemyUnit->unitDefId.IsValid());
+
+	enemyUnit = map.GetEnemyUnit(UnitId(givenUnits[1]));
+	AAI_CHECK(enemyUnit != nullptr);
+	AAI_CHECK(enemyUnit->inRadar && !enemyUnit->inLOS);
+	AAI_CHECK(enemyUnit->sector != sector);
+	AAI_CHECK(GetEnemyUnitsDetectedBySensor(map) == 1);
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// missed events: unit C left radar coverage, unit D entered LOS, unit E entered radar coverage without AAI being notified
+	//-----------------------------------------------------------------------------------------------------------------
+	const float3 positionC = position + float3(  0.0f, 0.0f, 100.0f);
+	const float3 positionD = position + float3(100.0f, 0.0f,   0.0f);
+	const float3 positionE = position + float3(100.0f, 0.0f, 100.0f);
+
+	const int unitC = AddEnemyUnit(callback, positionC);
+	const int unitD = AddEnemyUnit(callback, positionD);
+	const int unitE = AddEnemyUnit(callback, positionE);
+
+	SetCoverage(callback, positionC, false, true);
+	SetCoverage(callback, positionD, false, true);
+	callback.SetCurrentFrame(++frame);
+	ai.EnemyEnterRadar(unitC);
+	ai.EnemyEnterRadar(unitD);
+	AAI_CHECK(sector->GetNumberOfEnemyUnitsDetectedBySensor() == 2);
+
+	SetCoverage(callback, positionC, false, false);
+	SetCoverage(callback, positionD, true,  true);
+	SetCoverage(callback, positionE, false, true);
+	callback.SetCurrentFrame(++frame);
+
+	// the given units are not detected anymore either
+	callback.EnemyUnitsInLOS()         = { unitD };
+	callback.EnemyUnitsInRadarAndLOS() = { unitE, unitD };
+
+	map.ReconcileEnemyUnits();
+
+	AAI_CHECK(map.GetEnemyUnit(UnitId(unitC)) == nullptr);
+	AAI_CHECK(map.GetEnemyUnit(UnitId(givenUnits[0])) == nullptr);
+	AAI_CHECK(map.GetEnemyUnit(UnitId(givenUnits[1])) == nullptr);
+
+	enemyUnit = map.GetEnemyUnit(UnitId(unitD));
+	AAI_CHECK(enemyUnit != nullptr);
+	AAI_CHECK(enemyUnit->inRadar && enemyUnit->inLOS);
+	AAI_CHECK(enemyUnit->unitDefId.IsValid());
+
+	enemyUnit = map.GetEnemyUnit(UnitId(unitE));
+	AAI_CHECK(enemyUnit != nullptr);
+	AAI_CHECK(enemyUnit->inRadar && !enemyUnit->inLOS);
+	AAI_CHECK(enemyUnit->sector == sector);
+
+	AAI_CHECK(sector->GetNumberOfEnemyUnitsDetectedBySensor() == 1);
+	AAI_CHECK(GetEnemyUnitsDetectedBySensor(map) == 1);
+
+	return true;
+}
+
+#endif
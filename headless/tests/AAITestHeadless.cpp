@@ -0,0 +1,112 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+// only part of the headless tests (sources of the AI library are collected recursively)
+#ifdef AAI_HEADLESS
+
+#include <stdio.h>
+
+#include "AAITest.h"
+#include "../AAIHeadlessDriver.h"
+
+//! @brief Returns the number of (finished or unfinished) units of AAI in the mock game
+static int GetNumberOfOwnUnits(AAIHeadlessCallback& callback)
+{
+	std::vector<int> unitIds(callback.GetMaxUnits());
+	const int numberOfUnits = callback.GetFriendlyUnits(unitIds.data());
+
+	int numberOfOwnUnits(0);
+	for(int i = 0; i < numberOfUnits; ++i)
+	{
+		if(callback.Unit(unitIds[i]).team == callback.GetMyTeam())
+			++numberOfOwnUnits;
+	}
+
+	return numberOfOwnUnits;
+}
+
+//! AAI can be started and ticked against the mock game and builds up a base
+AAI_TEST(HeadlessMockGame)
+{
+	AAIHeadlessDriver driver(PrepareTestDirectory("HeadlessMockGame"), 256, 1u, false);
+
+	AAI_CHECK(driver.Init());
+	AAI_CHECK(driver.GetAI() != nullptr);
+
+	driver.RunFrames(3000);
+
+	AAI_CHECK(driver.GetFrameTimes().size() == 3000u);
+	AAI_CHECK(driver.GetCallback().GetNumberOfOrders() > 0);
+	AAI_CHECK(GetNumberOfOwnUnits(driver.GetCallback()) > 1);
+
+	driver.Shutdown();
+	AAI_CHECK(driver.GetAI() == nullptr);
+	return true;
+}
+
+//! Games with the same seed lead to the same game state (also checks that AAI can be run again after the last instance has been destroyed)
+AAI_TEST(HeadlessDeterminism)
+{
+	int                 numberOfOrders[2];
+	std::vector<float3> unitPositions[2];
+
+	for(int run = 0; run < 2; ++run)
+	{
+		// separate work directories as learning data written at the end of the first game would influence the second one
+		AAIHeadlessDriver driver(PrepareTestDirectory(run == 0 ? "HeadlessDeterminism1" : "HeadlessDeterminism2"), 256, 7u, false);
+		AAI_CHECK(driver.Init());
+
+		driver.RunFrames(2000);
+
+		AAIHeadlessCallback& callback = driver.GetCallback();
+		numberOfOrders[run] = callback.GetNumberOfOrders();
+
+		for(int unitId = 0; unitId < callback.GetMaxUnits(); ++unitId)
+		{
+			if(callback.Unit(unitId).IsAlive())
+				unitPositions[run].push_back(callback.Unit(unitId).position);
+		}
+	}
+
+	AAI_CHECK(numberOfOrders[0] > 0);
+	AAI_CHECK(numberOfOrders[0] == numberOfOrders[1]);
+	AAI_CHECK(unitPositions[0].size() == unitPositions[1].size());
+
+	for(size_t i = 0; i < unitPositions[0].size(); ++i)
+		AAI_CHECK(unitPositions[0][i] == unitPositions[1][i]);
+
+	return true;
+}
+
+//! Benchmark of the tail of the time per frame: the same game is played with an unlimited time budget for the periodic tasks (i.e. all
+//! tasks are executed when due), the default budget, and a budget small enough to defer tasks in the (small) mock game; percentiles
+//! and worst frames are printed for comparison
+AAI_TEST(SchedulerFrameTimes)
+{
+	const int   frameTimeBudgets[] = { 1000000, 2000, 20 };
+	const char* workDirectories[]  = { "SchedulerFrameTimesUnlimited", "SchedulerFrameTimesDefault", "SchedulerFrameTimesSmall" };
+
+	for(int run = 0; run < 3; ++run)
+	{
+		AAIHeadlessDriver driver(PrepareTestDirectory(workDirectories[run]), 256, 11u, false);
+		driver.GetMockGame().SetFrameTimeBudget(frameTimeBudgets[run]);
+		AAI_CHECK(driver.Init());
+
+		// long enough for the tasks with the longest periods to be executed several times
+		driver.RunFrames(9000);
+		AAI_CHECK(driver.GetFrameTimes().size() == 9000u);
+
+		printf("Frame time budget %i us:\n", frameTimeBudgets[run]);
+		AAIHeadlessDriver::PrintFrameTimes(driver.GetFrames(), driver.GetFrameTimes());
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,68 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+// only part of the headless tests (sources of the AI library are collected recursively)
+#ifdef AAI_HEADLESS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "AAITest.h"
+
+std::string PrepareTestDirectory(const char* testName)
+{
+	const std::string directory = std::string("aai_test_") + testName;
+
+	// files of previous runs (e.g. cache files) must not influence the test
+	const std::string command = std::string("rm -rf ") + directory;
+
+	if(system(command.c_str()) != 0)
+		printf("Unable to clear test directory %s\n", directory.c_str());
+
+	return directory;
+}
+
+//! @brief Runs the tests given as arguments (all tests if none given); returns 0 if all tests have been successful
+int main(int argc, char* argv[])
+{
+	int numberOfTests(0), numberOfFailedTests(0);
+
+	for(const auto& test : AAITestRegistry::GetTests())
+	{
+		bool selected = (argc < 2);
+
+		for(int i = 1; i < argc; ++i)
+			selected |= (strcmp(argv[i], test.name) == 0);
+
+		if(selected)
+		{
+			++numberOfTests;
+			printf("Running %s\n", test.name);
+
+			const bool successful = test.function();
+
+			if(successful == false)
+				++numberOfFailedTests;
+
+			printf("%s %s\n", test.name, successful ? "passed" : "FAILED");
+		}
+	}
+
+	if(numberOfTests == 0)
+	{
+		printf("No matching test found\n");
+		return 1;
+	}
+
+	printf("%i of %i tests passed\n", numberOfTests - numberOfFailedTests, numberOfTests);
+	return (numberOfFailedTests == 0) ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,272 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+// only part of the headless tests (sources of the AI library are collected recursively)
+#ifdef AAI_HEADLESS
+
+#include <stdio.h>
+#include <string.h>
+#include <dirent.h>
+#include <cmath>
+
+#include "AAITest.h"
+#include "../AAIHeadlessDriver.h"
+#include "../../AAI.h"
+#include "../../AAIMap.h"
+#include "../../AAICacheFile.h"
+
+//! The map data stored in the map cache (as far as accessible from outside of AAIMap)
+struct MapCacheSnapshot
+{
+	std::vector<uint8_t> buildMap;
+
+	int                  mapType;
+
+	bool                 isMetalMap;
+
+	float                waterTilesRatio;
+
+	int                  metalSpotsOnLand, metalSpotsInSea;
+
+	//! Position and amount of the metal spots (sector by sector)
+	std::vector<float>   metalSpots;
+};
+
+//! @brief Returns the map data of the running game
+static MapCacheSnapshot TakeMapCacheSnapshot(AAI& ai)
+{
+	MapCacheSnapshot snapshot;
+
+	for(int y = 0; y < AAIMap::yMapSize; ++y)
+	{
+		for(int x = 0; x < AAIMap::xMapSize; ++x)
+			snapshot.buildMap.push_back(AAIMap::s_buildmap.GetTileType(x, y).m_tileType);
+	}
+
+	snapshot.mapType          = ai.Map()->GetMapType().GetArrayIndex();
+	snapshot.isMetalMap       = AAIMap::s_isMetalMap;
+	snapshot.waterTilesRatio  = AAIMap::s_waterTilesRatio;
+	snapshot.metalSpotsOnLand = AAIMap::s_metalSpotsOnLand;
+	snapshot.metalSpotsInSea  = AAIMap::s_metalSpotsInSea;
+
+	for(const auto& sectors : ai.Map()->GetSectorMap())
+	{
+		for(const auto& sector : sectors)
+		{
+			for(const auto spot : sector.metalSpots)
+			{
+				snapshot.metalSpots.push_back(spot->pos.x);
+				snapshot.metalSpots.push_back(spot->pos.z);
+				snapshot.metalSpots.push_back(spot->amount);
+			}
+		}
+	}
+
+	return snapshot;
+}
+
+//! @brief Starts a game in the given work directory and returns its map data (returns false if game could not be started)
+static bool RunGame(const std::string& workDirectory, MapCacheSnapshot& snapshot)
+{
+	AAIHeadlessDriver driver(workDirectory, 256, 5u, false);
+
+	if(driver.Init() == false)
+		return false;
+
+	// map data is set up when AAI is initialized (buildings placed later on would modify the build map)
+	snapshot = TakeMapCacheSnapshot(*driver.GetAI());
+	return true;
+}
+
+//! @brief Returns the first file in the given directory whose name ends with the given suffix (empty string if none found)
+static std::string FindFile(const std::string& directory, const char* suffix)
+{
+	std::string filename;
+
+	DIR* dir = opendir(directory.c_str());
+
+	if(dir == nullptr)
+		return filename;
+
+	while(const dirent* entry = readdir(dir))
+	{
+		const size_t length       = strlen(entry->d_name);
+		const size_t suffixLength = strlen(suffix);
+
+		if( (length >= suffixLength) && (strcmp(entry->d_name + length - suffixLength, suffix) == 0) )
+		{
+			filename = directory + "/" + entry->d_name;
+			break;
+		}
+	}
+
+	closedir(dir);
+	return filename;
+}
+
+//! @brief Reads the given file (returns empty buffer if it could not be read)
+static std::vector<char> ReadFile(const std::string& filename)
+{
+	std::vector<char> data;
+
+	FILE* file = fopen(filename.c_str(), "rb");
+
+	if(file == nullptr)
+		return data;
+
+	char buffer[4096];
+	size_t bytesRead;
+
+	while( (bytesRead = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		data.insert(data.end(), buffer, buffer + bytesRead);
+
+	fclose(file);
+	return data;
+}
+
+static bool WriteFile(const std::string& filename, const std::vector<char>& data)
+{
+	FILE* file = fopen(filename.c_str(), "wb");
+
+	if(file == nullptr)
+		return false;
+
+	const bool successful = (fwrite(data.data(), 1, data.size(), file) == data.size());
+	fclose(file);
+	return successful;
+}
+
+//! @brief Returns how often the given text occurs in the log of the given work directory
+static int CountInLog(const std::string& workDirectory, const char* text)
+{
+	const std::vector<char> log = ReadFile(workDirectory + "/log/AAI_log_team_0.txt");
+	const std::string       logText(log.begin(), log.end());
+
+	int count(0);
+	for(size_t position = logText.find(text); position != std::string::npos; position = logText.find(text, position + 1))
+		++count;
+
+	return count;
+}
+
+static bool operator==(const MapCacheSnapshot& lhs, const MapCacheSnapshot& rhs)
+{
+	// water ratio of the map is recalculated from the sector data which is read from the (text based) map learning file if available
+	const float maxWaterTilesRatioDeviation = 0.0001f;
+
+	return     (lhs.buildMap         == rhs.buildMap)
+			&& (lhs.mapType          == rhs.mapType)
+			&& (lhs.isMetalMap       == rhs.isMetalMap)
+			&& (std::fabs(lhs.waterTilesRatio - rhs.waterTilesRatio) < maxWaterTilesRatioDeviation)
+			&& (lhs.metalSpotsOnLand == rhs.metalSpotsOnLand)
+			&& (lhs.metalSpotsInSea  == rhs.metalSpotsInSea)
+			&& (lhs.metalSpots       == rhs.metalSpots);
+}
+
+//! Sections written to a cache file are read back unchanged; files not matching version, map, number of sections, or checksums are rejected
+AAI_TEST(CacheFileRoundTrip)
+{
+	const std::string filename = PrepareTestDirectory("CacheFileRoundTrip") + ".dat";
+
+	std::vector<int32_t> section1(1000);
+	std::vector<float>   section2(333);
+	const char           section3[] = "last section";
+
+	for(size_t i = 0; i < section1.size(); ++i)
+		section1[i] = static_cast<int32_t>(i * i) - 500;
+
+	for(size_t i = 0; i < section2.size(); ++i)
+		section2[i] = 0.25f * static_cast<float>(i);
+
+	AAICacheFile cacheFile("TEST_VERSION", 0x1234u, 64, 32);
+	cacheFile.AddSection(section1.data(), section1.size() * sizeof(int32_t));
+	cacheFile.AddSection(section2.data(), section2.size() * sizeof(float));
+	cacheFile.AddSection(section3, sizeof(section3));
+	AAI_CHECK(cacheFile.Write(filename));
+
+	AAICacheFile readFile("TEST_VERSION", 0x1234u, 64, 32);
+	AAI_CHECK(readFile.Read(filename, 3));
+	AAI_CHECK(readFile.GetNumberOfSections() == 3);
+
+	std::vector<int32_t> readSection1(section1.size());
+	std::vector<float>   readSection2(section2.size());
+	AAI_CHECK(readFile.CopySection(0, readSection1.data(), readSection1.size() * sizeof(int32_t)));
+	AAI_CHECK(readFile.CopySection(1, readSection2.data(), readSection2.size() * sizeof(float)));
+	AAI_CHECK(readSection1 == section1);
+	AAI_CHECK(readSection2 == section2);
+	AAI_CHECK(readFile.GetSectionSize(2) == sizeof(section3));
+	AAI_CHECK(memcmp(readFile.GetSectionData(2), section3, sizeof(section3)) == 0);
+
+	// size of section must match
+	AAI_CHECK(readFile.CopySection(0, readSection1.data(), readSection1.size() * sizeof(int32_t) - 1) == false);
+
+	// other version, map, map size, or number of sections
+	AAI_CHECK(AAICacheFile("OTHER_VERSION", 0x1234u, 64, 32).Read(filename, 3) == false);
+	AAI_CHECK(AAICacheFile("TEST_VERSION",  0x4321u, 64, 32).Read(filename, 3) == false);
+	AAI_CHECK(AAICacheFile("TEST_VERSION",  0x1234u, 32, 64).Read(filename, 3) == false);
+	AAI_CHECK(AAICacheFile("TEST_VERSION",  0x1234u, 64, 32).Read(filename, 2) == false);
+
+	// corrupted data (checksum) or truncated file
+	const std::vector<char> data = ReadFile(filename);
+	AAI_CHECK(data.size() > sizeof(section3));
+
+	std::vector<char> corruptedData(data);
+	corruptedData[corruptedData.size() - sizeof(section3) - 10] ^= 0x01;
+	AAI_CHECK(WriteFile(filename, corruptedData));
+	AAI_CHECK(AAICacheFile("TEST_VERSION", 0x1234u, 64, 32).Read(filename, 3) == false);
+
+	const std::vector<char> truncatedData(data.begin(), data.end() - 1);
+	AAI_CHECK(WriteFile(filename, truncatedData));
+	AAI_CHECK(AAICacheFile("TEST_VERSION", 0x1234u, 64, 32).Read(filename, 3) == false);
+
+	AAI_CHECK(AAICacheFile("TEST_VERSION", 0x1234u, 64, 32).Read(filename + ".missing", 3) == false);
+
+	remove(filename.c_str());
+	return true;
+}
+
+//! The map data loaded from the map cache matches the data determined by the analysis of the map; a corrupted cache is replaced
+AAI_TEST(MapCacheRoundTrip)
+{
+	const std::string workDirectory = PrepareTestDirectory("MapCacheRoundTrip");
+	const char*       cacheLoaded   = "Map cache file successfully loaded";
+
+	// first game: no cache available -> map is analysed and cache is written
+	MapCacheSnapshot analysedMap;
+	AAI_CHECK(RunGame(workDirectory, analysedMap));
+	AAI_CHECK(CountInLog(workDirectory, cacheLoaded) == 0);
+	AAI_CHECK(analysedMap.metalSpots.empty() == false);
+
+	const std::string cacheFilename = FindFile(workDirectory + "/learn/mod", "_mapcache.dat");
+	AAI_CHECK(cacheFilename.empty() == false);
+
+	// second game: map data is loaded from cache
+	MapCacheSnapshot cachedMap;
+	AAI_CHECK(RunGame(workDirectory, cachedMap));
+	AAI_CHECK(CountInLog(workDirectory, cacheLoaded) == 1);
+	AAI_CHECK(cachedMap == analysedMap);
+
+	// third game: corrupted cache is rejected (map is analysed again) and replaced by a valid one
+	const std::vector<char> cacheData = ReadFile(cacheFilename);
+	AAI_CHECK(cacheData.empty() == false);
+
+	std::vector<char> corruptedCacheData(cacheData);
+	corruptedCacheData[corruptedCacheData.size() / 2] ^= 0x10;
+	AAI_CHECK(WriteFile(cacheFilename, corruptedCacheData));
+
+	MapCacheSnapshot reanalysedMap;
+	AAI_CHECK(RunGame(workDirectory, reanalysedMap));
+	AAI_CHECK(CountInLog(workDirectory, cacheLoaded) == 0);
+	AAI_CHECK(reanalysedMap == analysedMap);
+	AAI_CHECK(ReadFile(cacheFilename) == cacheData);
+
+	return true;
+}
+
+#endif